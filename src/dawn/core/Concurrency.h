@@ -16,6 +16,7 @@ using Thread = std::thread;
 // Synchronisation primitives.
 template <typename T> using Atomic = std::atomic<T>;
 using Mutex = std::mutex;
+using RecursiveMutex = std::recursive_mutex;
 template <typename T> using LockGuard = std::lock_guard<T>;
 template <typename T> using UniqueLock = std::unique_lock<T>;
 using ConditionVariable = std::condition_variable;
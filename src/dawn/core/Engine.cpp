@@ -7,8 +7,11 @@
 #include "core/App.h"
 #include "core/Engine.h"
 #include "core/GameSession.h"
+#include "core/ThreadPool.h"
 #include "input/Input.h"
 #include "renderer/Renderer.h"
+#include "renderer/ShaderCache.h"
+#include "renderer/TextureStreamer.h"
 #include "resource/ResourceCache.h"
 #include "script/LuaState.h"
 
@@ -27,6 +30,44 @@
 #endif
 
 namespace dw {
+namespace {
+// Default number of updates per second.
+const float default_tick_rate = 60.0f;
+
+// In headless mode, if the loop falls more than this many ticks behind, the missed ticks are
+// skipped instead of being run back to back.
+const double max_ticks_behind = 5.0;
+
+// Interval between tick statistics reports in headless mode, in seconds.
+const double tick_report_interval = 10.0;
+
+// Parses a numeric command line argument. Returns nothing if it isn't a number.
+Option<float> parseFloat(const String& value) {
+    try {
+        return std::stof(value);
+    } catch (const std::exception&) {
+        return {};
+    }
+}
+
+Option<int> parseInt(const String& value) {
+    try {
+        return std::stoi(value);
+    } catch (const std::exception&) {
+        return {};
+    }
+}
+}  // namespace
+
+void TickStats::addTick(double tick_time, double time_per_update) {
+    ticks++;
+    total_time += tick_time;
+    max_time = std::max(max_time, tick_time);
+    if (tick_time > time_per_update) {
+        overruns++;
+    }
+}
+
 SessionId::SessionId(u32 session_index) : session_index_(session_index) {
 }
 
@@ -57,6 +98,7 @@ Engine::Engine(UniquePtr<App> app)
       running_{true},
       save_config_on_exit_{true},
       headless_{false},
+      time_per_update_{1.0f / default_tick_rate},
       app_(std::move(app)),
       log_file_{"engine.log"},
       config_file_{"engine.cfg"} {
@@ -111,6 +153,34 @@ void Engine::setup(const CommandLine& cmdline) {
         log().info("Running in headless mode.");
     }
 
+    // Set the tick rate.
+    auto tick_rate_arg = cmdline.arguments.find("-tick_rate");
+    if (tick_rate_arg != cmdline.arguments.end()) {
+        auto tick_rate = parseFloat(tick_rate_arg->second);
+        if (tick_rate && *tick_rate > 0.0f) {
+            time_per_update_ = 1.0f / *tick_rate;
+        } else {
+            log().warn("Invalid tick rate {}. Using {} instead.", tick_rate_arg->second,
+                       default_tick_rate);
+        }
+    }
+    log().info("Tick rate: {} Hz", 1.0f / time_per_update_);
+
+    // Update game sessions in parallel if requested. 0 picks a number of threads based on the
+    // hardware.
+    auto session_threads_arg = cmdline.arguments.find("-session_threads");
+    if (session_threads_arg != cmdline.arguments.end()) {
+        auto session_threads = parseInt(session_threads_arg->second);
+        if (session_threads && *session_threads >= 0) {
+            session_thread_pool_ = makeUnique<ThreadPool>(static_cast<usize>(*session_threads));
+            log().info("Updating sessions in parallel on {} worker threads.",
+                       session_thread_pool_->numThreads());
+        } else {
+            log().warn("Invalid number of session threads {}. Updating sessions serially.",
+                       session_threads_arg->second);
+        }
+    }
+
     // Build window title.
     String window_title{app_->gameName()};
     window_title += " ";
@@ -155,7 +225,40 @@ void Engine::setup(const CommandLine& cmdline) {
         log().error("Renderer failed to initialise: {}", renderer_result.error());
         std::abort();
     }
-    context_->addModule<ResourceCache>();
+    auto* resource_cache = context_->addModule<ResourceCache>();
+    auto resource_budget_arg = cmdline.arguments.find("-resource_budget_mb");
+    if (resource_budget_arg != cmdline.arguments.end()) {
+        auto resource_budget_mb = parseInt(resource_budget_arg->second);
+        if (resource_budget_mb && *resource_budget_mb > 0) {
+            resource_cache->setMemoryBudget(static_cast<usize>(*resource_budget_mb) * 1024 * 1024);
+            log().info("Resource memory budget: {} MB", *resource_budget_mb);
+        } else {
+            log().warn("Invalid resource memory budget {}. Resources won't be evicted.",
+                       resource_budget_arg->second);
+        }
+    }
+
+    // Compiled shaders are cached on disk between runs.
+    Path shader_cache_dir = context_->module<FileSystem>()->tempDir() + "/dawn-shader-cache";
+    auto shader_cache_arg = cmdline.arguments.find("-shader_cache");
+    if (shader_cache_arg != cmdline.arguments.end()) {
+        shader_cache_dir = shader_cache_arg->second;
+    }
+    context_->addModule<ShaderCache>(shader_cache_dir);
+    log().info("Shader cache: {}", shader_cache_dir);
+
+    auto* texture_streamer = context_->addModule<TextureStreamer>();
+    auto texture_budget_arg = cmdline.arguments.find("-texture_budget_mb");
+    if (texture_budget_arg != cmdline.arguments.end()) {
+        auto texture_budget_mb = parseInt(texture_budget_arg->second);
+        if (texture_budget_mb && *texture_budget_mb > 0) {
+            texture_streamer->setBudget(static_cast<usize>(*texture_budget_mb) * 1024 * 1024);
+            log().info("Texture memory budget: {} MB", *texture_budget_mb);
+        } else {
+            log().warn("Invalid texture memory budget {}. Textures will stream in fully.",
+                       texture_budget_arg->second);
+        }
+    }
 
     // Engine events and UI.
     event_system_ = makeUnique<EventSystem>(context_);
@@ -168,7 +271,13 @@ void Engine::setup(const CommandLine& cmdline) {
     /*
     auto* net = context_->addModule<Networking>();
     auto port_arg = cmdline.arguments.find("-p");
-    u16 port = port_arg != cmdline.arguments.end() ? std::stoi(port_arg->second) : 40000;
+    u16 port = 40000;
+    if (port_arg != cmdline.arguments.end()) {
+        auto parsed_port = parseInt(port_arg->second);
+        if (parsed_port && *parsed_port > 0 && *parsed_port <= 65535) {
+            port = static_cast<u16>(*parsed_port);
+        }
+    }
     if (cmdline.flags.find("-host") != cmdline.flags.end()) {
         net->listen(port, 32);
     } else if (cmdline.arguments.find("-join") != cmdline.arguments.end()) {
@@ -226,8 +335,10 @@ void Engine::shutdown() {
     ui_.reset();
     event_system_.reset();
     game_sessions_.clear();
+    session_thread_pool_.reset();
 
-    // Remove subsystems.
+    // Remove subsystems. The texture streamer reads from the resource cache, so is removed first.
+    context_->removeModule<TextureStreamer>();
     context_->removeModule<ResourceCache>();
     context_->clearModules();
 
@@ -236,7 +347,14 @@ void Engine::shutdown() {
 }
 
 int Engine::run() {
-    float time_per_update = 1.0f / 60.0f;
+#ifndef DW_EMSCRIPTEN
+    if (headless_) {
+        runHeadless();
+        return EXIT_SUCCESS;
+    }
+#endif
+
+    float time_per_update = time_per_update_;
     time::TimePoint previous_time = time::beginTiming();
     double accumulated_time = 0.0;
     double frame_time_ = 0.0;
@@ -246,13 +364,14 @@ int Engine::run() {
         previous_time = current_time;
         accumulated_time += frame_time_;
 
+        // Finish any resources which have loaded in the background, and stream textures based
+        // on the previous frame.
+        context_->module<ResourceCache>()->update();
+        context_->module<TextureStreamer>()->update();
+
         // Update game logic.
         while (accumulated_time >= time_per_update) {
-            forEachSession([time_per_update](GameSession* session) {
-                session->preUpdate();
-                session->update(time_per_update);
-                session->postUpdate();
-            });
+            updateSessions(time_per_update);
             accumulated_time -= time_per_update;
         }
 
@@ -283,6 +402,61 @@ int Engine::run() {
     return EXIT_SUCCESS;
 }
 
+void Engine::runHeadless() {
+    const double time_per_update = time_per_update_;
+    const auto tick_interval =
+        std::chrono::duration_cast<time::_SteadyClock::duration>(time::Duration<time::seconds>{
+            time_per_update});
+
+    TickStats report_stats;
+    time::TimePoint last_report = time::beginTiming();
+    time::TimePoint next_tick = last_report;
+    while (running_) {
+        // Update game logic. Nothing is rendered, and sessions skip their UI logic.
+        time::TimePoint tick_start = time::beginTiming();
+        context_->module<ResourceCache>()->update();
+        updateSessions(time_per_update_);
+        double tick_time = time::elapsed(tick_start);
+        tick_stats_.addTick(tick_time, time_per_update);
+        report_stats.addTick(tick_time, time_per_update);
+
+        // Work out when the next tick is due. If we've fallen too far behind, give up on the
+        // missed ticks rather than running them back to back.
+        next_tick += tick_interval;
+        time::TimePoint now = time::beginTiming();
+        double ticks_behind = time::elapsed(next_tick, now) / time_per_update;
+        if (ticks_behind > max_ticks_behind) {
+            auto skipped = static_cast<u64>(ticks_behind);
+            tick_stats_.skipped_ticks += skipped;
+            report_stats.skipped_ticks += skipped;
+            next_tick = now;
+        }
+
+        // Report tick statistics periodically.
+        if (time::elapsed(last_report, now) >= tick_report_interval) {
+            log().info(
+                "Ticks: {}, average: {:.3f} ms, max: {:.3f} ms, overruns: {}, skipped: {}",
+                report_stats.ticks, report_stats.total_time * 1000.0 / report_stats.ticks,
+                report_stats.max_time * 1000.0, report_stats.overruns, report_stats.skipped_ticks);
+            report_stats = {};
+            last_report = now;
+        }
+
+        // Sleep until the next tick, instead of spinning.
+        if (now < next_tick) {
+            time::sleepUntil(next_tick);
+        }
+    }
+}
+
+float Engine::timePerUpdate() const {
+    return time_per_update_;
+}
+
+const TickStats& Engine::tickStats() const {
+    return tick_stats_;
+}
+
 SessionId Engine::addSession(UniquePtr<GameSession> session) {
     // TODO: Initialise session.
     game_sessions_.emplace_back(std::move(session));
@@ -313,6 +487,45 @@ void Engine::forEachSession(const Function<void(GameSession*)>& functor) {
     }
 }
 
+void Engine::updateSessions(float dt) {
+    auto update_session = [dt](GameSession* session) {
+        session->preUpdate();
+        session->update(dt);
+        session->postUpdate();
+    };
+    if (!session_thread_pool_) {
+        forEachSession(update_session);
+        return;
+    }
+
+    // Sessions using the in-process transport exchange messages directly, so are updated in order
+    // on a single worker. Every other session is updated on its own.
+    Vector<Vector<GameSession*>> groups;
+    Vector<GameSession*> in_process_sessions;
+    for (auto& session : game_sessions_) {
+        if (!session) {
+            continue;
+        }
+        if (session->usesInProcessTransport()) {
+            in_process_sessions.emplace_back(session.get());
+        } else {
+            groups.emplace_back(Vector<GameSession*>{session.get()});
+        }
+    }
+    if (!in_process_sessions.empty()) {
+        groups.emplace_back(std::move(in_process_sessions));
+    }
+    if (groups.size() > 1) {
+        session_thread_pool_->parallelFor(groups.size(), [&](usize i) {
+            for (auto* session : groups[i]) {
+                update_session(session);
+            }
+        });
+    } else {
+        forEachSession(update_session);
+    }
+}
+
 void Engine::printSystemInfo() {
 #if DW_PLATFORM == DW_WIN32
     String platform = "Windows";
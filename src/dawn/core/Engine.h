@@ -23,6 +23,7 @@
 namespace dw {
 class App;
 class GameSession;
+class ThreadPool;
 
 class DW_API SessionId {
 public:
@@ -36,6 +37,17 @@ private:
     friend class Engine;
 };
 
+// Statistics of the fixed rate update loop. Times are in seconds.
+struct DW_API TickStats {
+    u64 ticks = 0;             // Number of ticks run.
+    u64 overruns = 0;          // Ticks which took longer than the tick interval.
+    u64 skipped_ticks = 0;     // Ticks dropped after falling too far behind.
+    double total_time = 0.0;   // Total time spent in ticks.
+    double max_time = 0.0;     // Longest tick.
+
+    void addTick(double tick_time, double time_per_update);
+};
+
 class DW_API Engine : public Object {
 public:
     DW_OBJECT(Engine);
@@ -56,6 +68,12 @@ public:
     /// @returns Exit code to return to the operating system.
     int run();
 
+    /// Time between each update, in seconds. Set with -tick_rate <updates per second>.
+    float timePerUpdate() const;
+
+    /// Tick statistics since the engine started. Only recorded in headless mode.
+    const TickStats& tickStats() const;
+
     // Add a session.
     SessionId addSession(UniquePtr<GameSession> session);
 
@@ -76,6 +94,8 @@ private:
     bool running_;
     bool save_config_on_exit_;
     bool headless_;
+    float time_per_update_;
+    TickStats tick_stats_;
 
     UniquePtr<App> app_;
 
@@ -86,6 +106,16 @@ private:
     Vector<UniquePtr<GameSession>> game_sessions_;
     void forEachSession(const Function<void(GameSession*)>& functor);
 
+    // Runs a single update of every session. If -session_threads is set, sessions are updated in
+    // parallel on a thread pool, so must not share any state other than engine modules. Sessions
+    // connected to each other with the in-process transport are all updated on the same worker.
+    UniquePtr<ThreadPool> session_thread_pool_;
+    void updateSessions(float dt);
+
+    // Dedicated server loop. Updates sessions at a fixed rate without rendering, sleeping between
+    // ticks.
+    void runHeadless();
+
     // Configuration.
     String log_file_;
     String config_file_;
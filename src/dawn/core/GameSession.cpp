@@ -18,11 +18,26 @@ GameSession::GameSession(Context* ctx, const GameSessionInfo& gsi)
     // Initialise networking.
     if (holdsAlternative<GameSessionInfo::CreateNetGame>(gsi.start_info)) {
         auto& info = get<GameSessionInfo::CreateNetGame>(gsi.start_info);
-        net_instance_ =
-            NetInstance::listen(ctx, this, info.host, info.port, info.max_clients, info.transport);
+        net_instance_ = NetInstance::listen(ctx, this, info.host, info.port, info.max_clients,
+                                            info.transport, info.network_thread);
+        if (info.network_conditions) {
+            net_instance_->setNetworkConditions(*info.network_conditions);
+        }
+        if (!info.record_path.empty()) {
+            auto result = net_instance_->startRecording(info.record_path);
+            if (!result) {
+                log().error("Unable to record replay: {}", result.error());
+            }
+        }
     } else if (holdsAlternative<GameSessionInfo::JoinNetGame>(gsi.start_info)) {
         auto& info = get<GameSessionInfo::JoinNetGame>(gsi.start_info);
         net_instance_ = NetInstance::connect(ctx, this, info.host, info.port, info.transport);
+        if (info.network_conditions) {
+            net_instance_->setNetworkConditions(*info.network_conditions);
+        }
+    } else if (holdsAlternative<GameSessionInfo::PlaybackNetGame>(gsi.start_info)) {
+        auto& info = get<GameSessionInfo::PlaybackNetGame>(gsi.start_info);
+        net_instance_ = NetInstance::playback(ctx, this, info.replay_path, info.client);
     }
 }
 
@@ -41,7 +56,9 @@ GameSession::~GameSession() {
 }
 
 void GameSession::preUpdate() {
-    ui_->preUpdate();
+    if (!gsi_.headless) {
+        ui_->preUpdate();
+    }
 }
 
 void GameSession::update(float dt) {
@@ -65,15 +82,26 @@ void GameSession::update(float dt) {
         new_game_mode_.reset();
     }
 
-    ui_->update(dt);
+    // Send any RPCs queued during this update.
+    if (net_instance_) {
+        net_instance_->flush();
+    }
+
+    if (!gsi_.headless) {
+        ui_->update(dt);
+    }
 }
 
 void GameSession::postUpdate() {
-    ui_->postUpdate();
+    if (!gsi_.headless) {
+        ui_->postUpdate();
+    }
 }
 
 void GameSession::preRender() {
-    ui_->preRender();
+    if (!gsi_.headless) {
+        ui_->preRender();
+    }
 }
 
 void GameSession::render(float dt, float interpolation) {
@@ -83,8 +111,8 @@ void GameSession::render(float dt, float interpolation) {
 }
 
 void GameSession::postRender() {
-    ui_->postRender();
     if (!gsi_.headless) {
+        ui_->postRender();
         ui_->render();
     }
 }
@@ -93,6 +121,22 @@ GameMode* GameSession::gameMode() const {
     return game_mode_.get();
 }
 
+bool GameSession::isHeadless() const {
+    return gsi_.headless;
+}
+
+bool GameSession::usesInProcessTransport() const {
+    if (holdsAlternative<GameSessionInfo::CreateNetGame>(gsi_.start_info)) {
+        return get<GameSessionInfo::CreateNetGame>(gsi_.start_info).transport ==
+               NetTransport::InProcess;
+    }
+    if (holdsAlternative<GameSessionInfo::JoinNetGame>(gsi_.start_info)) {
+        return get<GameSessionInfo::JoinNetGame>(gsi_.start_info).transport ==
+               NetTransport::InProcess;
+    }
+    return false;
+}
+
 UserInterface* GameSession::ui() const {
     return ui_.get();
 }
@@ -23,15 +23,26 @@ struct DW_API GameSessionInfo {
         u16 max_clients = 16;
         String scene_name = "unknown";
         NetTransport transport = NetTransport::ReliableUDP;
+        Option<NetworkConditions> network_conditions = {};  // Simulated network conditions.
+        bool network_thread = false;  // Run transport I/O on a dedicated thread.
+        String record_path = "";      // Records a replay to this path if set.
     };
 
     struct JoinNetGame {
         String host = "localhost";
         u16 port = 10000;
         NetTransport transport = NetTransport::ReliableUDP;
+        Option<NetworkConditions> network_conditions = {};  // Simulated network conditions.
     };
 
-    Variant<CreateLocalGame, CreateNetGame, JoinNetGame> start_info = CreateLocalGame{};
+    // Plays back the messages sent to a client in a recorded replay.
+    struct PlaybackNetGame {
+        String replay_path;
+        ClientId client = 0;
+    };
+
+    Variant<CreateLocalGame, CreateNetGame, JoinNetGame, PlaybackNetGame> start_info =
+        CreateLocalGame{};
 
     // Graphics settings.
     bool headless = false;
@@ -57,6 +68,14 @@ public:
     /// Access the current game mode.
     GameMode* gameMode() const;
 
+    /// Returns true if the session isn't rendered. Headless sessions don't update the user
+    /// interface, so must not draw any ImGui windows.
+    bool isHeadless() const;
+
+    /// Returns true if the session connects to another session in this process with the
+    /// in-process transport. Such sessions share state, so must be updated on the same thread.
+    bool usesInProcessTransport() const;
+
     /// Access the user interface.
     UserInterface* ui() const;
 
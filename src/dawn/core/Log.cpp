@@ -19,6 +19,12 @@
 #endif
 
 namespace dw {
+namespace {
+// Object name set by withObjectName(). Each thread has its own, so that an object name set by one
+// thread isn't used for a message logged by another.
+thread_local String object_name = "UNKNOWN";
+}  // namespace
+
 namespace detail {
 void DisplayFatalError(String error_message) {
     error_message += "\n";
@@ -52,22 +58,25 @@ public:
     }
 };
 
-Logger::Logger(Context* context) : Module{context}, object_name_{"UNKNOWN"} {
+Logger::Logger(Context* context) : Module{context} {
     addLogMessageHandler(makeUnique<PlatformLogMessageHandler>());
 }
 
 void Logger::addLogMessageHandler(UniquePtr<LogMessageHandler> handler) {
+    LockGuard<Mutex> lock(mutex_);
     handlers_.emplace_back(std::move(handler));
 }
 
 void Logger::dispatchLogMessage(LogLevel level, const String& message) {
+    String formatted_message = str::format("[{}] {}", object_name, message);
+    LockGuard<Mutex> lock(mutex_);
     for (auto& handler : handlers_) {
-        handler->onMessage(level, str::format("[{}] {}", object_name_, message));
+        handler->onMessage(level, formatted_message);
     }
 }
 
 Logger& Logger::withObjectName(const String& name) {
-    object_name_ = name;
+    object_name = name;
     return *this;
 }
 
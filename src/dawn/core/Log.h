@@ -39,12 +39,16 @@ public:
     template <typename... Args> void warn(const String& format, const Args&... args);
     template <typename... Args> void error(const String& format, const Args&... args);
 
+    // Sets the object name of the next message logged by the calling thread.
     Logger& withObjectName(const String& name);
 
 private:
     void dispatchLogMessage(LogLevel level, const String& message);
+
+    // Messages can be logged from any thread. Handlers are called with the mutex held, so they
+    // don't need to be thread safe themselves.
+    Mutex mutex_;
     Vector<UniquePtr<LogMessageHandler>> handlers_;
-    String object_name_;
 };
 
 template <typename... Args>
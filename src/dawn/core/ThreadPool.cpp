@@ -0,0 +1,98 @@
+/*
+ * Dawn Engine
+ * Written by David Avedissian (c) 2012-2019 (git@dga.dev)
+ */
+#include "Base.h"
+#include "core/ThreadPool.h"
+
+namespace dw {
+ThreadPool::ThreadPool(usize num_threads)
+    : stopping_(false), batch_(0), task_(nullptr), count_(0), busy_workers_(0), next_index_(0) {
+    if (num_threads == 0) {
+        usize hardware_threads = Thread::hardware_concurrency();
+        num_threads = hardware_threads > 1 ? hardware_threads - 1 : 1;
+    }
+    for (usize i = 0; i < num_threads; ++i) {
+        workers_.emplace_back([this]() { workerMain(); });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        LockGuard<Mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    work_available_.notify_all();
+    for (auto& worker : workers_) {
+        worker.join();
+    }
+}
+
+void ThreadPool::parallelFor(usize count, const Function<void(usize)>& task) {
+    if (count == 0) {
+        return;
+    }
+    if (count == 1 || workers_.empty()) {
+        for (usize i = 0; i < count; ++i) {
+            task(i);
+        }
+        return;
+    }
+
+    // Start a new batch.
+    {
+        LockGuard<Mutex> lock(mutex_);
+        task_ = &task;
+        count_ = count;
+        busy_workers_ = workers_.size();
+        next_index_ = 0;
+        batch_++;
+    }
+    work_available_.notify_all();
+
+    // Help out, then wait for the workers to finish.
+    runTasks(task, count);
+    UniqueLock<Mutex> lock(mutex_);
+    work_finished_.wait(lock, [this]() { return busy_workers_ == 0; });
+    task_ = nullptr;
+}
+
+usize ThreadPool::numThreads() const {
+    return workers_.size();
+}
+
+void ThreadPool::workerMain() {
+    u64 last_batch = 0;
+    while (true) {
+        const Function<void(usize)>* task;
+        usize count;
+        {
+            UniqueLock<Mutex> lock(mutex_);
+            work_available_.wait(lock, [&]() { return stopping_ || batch_ != last_batch; });
+            if (stopping_) {
+                return;
+            }
+            last_batch = batch_;
+            task = task_;
+            count = count_;
+        }
+
+        runTasks(*task, count);
+
+        {
+            LockGuard<Mutex> lock(mutex_);
+            busy_workers_--;
+            if (busy_workers_ == 0) {
+                work_finished_.notify_one();
+            }
+        }
+    }
+}
+
+void ThreadPool::runTasks(const Function<void(usize)>& task, usize count) {
+    usize index;
+    while ((index = next_index_.fetch_add(1)) < count) {
+        task(index);
+    }
+}
+}  // namespace dw
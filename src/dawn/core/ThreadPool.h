@@ -0,0 +1,44 @@
+/*
+ * Dawn Engine
+ * Written by David Avedissian (c) 2012-2019 (git@dga.dev)
+ */
+#pragma once
+
+#include "core/Concurrency.h"
+
+namespace dw {
+// A fixed size pool of worker threads which runs batches of independent tasks.
+class DW_API ThreadPool {
+public:
+    // Creates a pool with a number of worker threads. If 0, one less than the number of hardware
+    // threads is used, as the thread which calls parallelFor also runs tasks.
+    explicit ThreadPool(usize num_threads = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // Calls task(i) for each i in [0, count), spread across the worker threads and the calling
+    // thread. Returns once every call has finished. Must only be called from one thread at a time.
+    void parallelFor(usize count, const Function<void(usize)>& task);
+
+    // Number of worker threads, excluding the calling thread.
+    usize numThreads() const;
+
+private:
+    Vector<Thread> workers_;
+
+    Mutex mutex_;
+    ConditionVariable work_available_;
+    ConditionVariable work_finished_;
+    bool stopping_;
+    u64 batch_;                           // Incremented when a new batch starts.
+    const Function<void(usize)>* task_;   // Task of the current batch.
+    usize count_;                         // Number of calls in the current batch.
+    usize busy_workers_;                  // Workers which haven't finished the current batch.
+    Atomic<usize> next_index_;
+
+    void workerMain();
+    void runTasks(const Function<void(usize)>& task, usize count);
+};
+}  // namespace dw
@@ -0,0 +1,43 @@
+/*
+ * Dawn Engine
+ * Written by David Avedissian (c) 2012-2019 (git@dga.dev)
+ */
+#include "Testing.h"
+#include "core/ThreadPool.h"
+
+TEST(ThreadPoolTest, RunsEveryTaskOnce) {
+    dw::ThreadPool pool(4);
+    dw::Vector<int> calls(1000, 0);
+    pool.parallelFor(calls.size(), [&calls](dw::usize i) { calls[i]++; });
+    EXPECT_EQ(dw::Vector<int>(1000, 1), calls);
+}
+
+TEST(ThreadPoolTest, RunsManyBatches) {
+    dw::ThreadPool pool(3);
+    dw::Atomic<int> total{0};
+    for (int batch = 0; batch < 200; ++batch) {
+        pool.parallelFor(8, [&total](dw::usize) { total++; });
+    }
+    EXPECT_EQ(1600, total.load());
+}
+
+TEST(ThreadPoolTest, UsesMultipleThreads) {
+    dw::ThreadPool pool(2);
+    dw::Mutex mutex;
+    dw::Set<std::thread::id> threads;
+    pool.parallelFor(3, [&](dw::usize) {
+        {
+            dw::LockGuard<dw::Mutex> lock(mutex);
+            threads.insert(std::this_thread::get_id());
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    });
+    EXPECT_GT(threads.size(), 1u);
+}
+
+TEST(ThreadPoolTest, EmptyBatch) {
+    dw::ThreadPool pool(2);
+    bool called = false;
+    pool.parallelFor(0, [&called](dw::usize) { called = true; });
+    EXPECT_FALSE(called);
+}
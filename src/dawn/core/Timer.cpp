@@ -6,9 +6,21 @@
 #include "core/Timer.h"
 
 #include <iomanip>
+#include <thread>
 
 namespace dw {
 namespace time {
+namespace {
+// Time before a deadline at which sleepUntil stops sleeping and starts yielding. Must be larger
+// than the amount the OS oversleeps by. Windows rounds sleeps up to the system timer resolution,
+// whereas other platforms sleep with microsecond precision, so yielding for longer than that only
+// wastes CPU time.
+#if DW_PLATFORM == DW_WIN32
+const Duration<milli> sleep_margin{2.0};
+#else
+const Duration<milli> sleep_margin{0.2};
+#endif
+}  // namespace
 
 TimePoint beginTiming() {
     return _SteadyClock::now();
@@ -23,6 +35,17 @@ double elapsed(TimePoint then, TimePoint now) {
     return duration.count();
 }
 
+void sleepUntil(TimePoint deadline) {
+    auto sleep_deadline =
+        deadline - std::chrono::duration_cast<_SteadyClock::duration>(sleep_margin);
+    if (_SteadyClock::now() < sleep_deadline) {
+        std::this_thread::sleep_until(sleep_deadline);
+    }
+    while (_SteadyClock::now() < deadline) {
+        std::this_thread::yield();
+    }
+}
+
 SystemTimePoint now() {
     return _SystemClock::now();
 }
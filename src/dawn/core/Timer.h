@@ -32,9 +32,13 @@ DW_API TimePoint beginTiming();
 // Return the time elapsed in seconds since a time point to when this function was called
 DW_API double elapsed(TimePoint then);
 
-// TODO(David) comment
+// Return the time elapsed in seconds between two time points
 DW_API double elapsed(TimePoint then, TimePoint now);
 
+// Block the calling thread until a time point. The thread sleeps for most of the wait, then yields
+// until the time point is reached, as the OS may oversleep by up to a scheduler tick.
+DW_API void sleepUntil(TimePoint deadline);
+
 // Calendar
 
 // return the current system time
@@ -65,7 +65,9 @@ usize File::writeData(const void* src, usize size) {
         return 0;
     }
 
-    fwrite(src, size, 1, handle_);
+    if (size > 0 && fwrite(src, size, 1, handle_) != 1) {
+        return 0;
+    }
     position_ += size;
     if (position_ > size_) {
         size_ = position_;
@@ -98,11 +100,13 @@ bool File::open(const Path& path, int mode) {
     return true;
 }
 
-void File::close() {
-    if (handle_) {
-        fclose(handle_);
-        handle_ = nullptr;
+bool File::close() {
+    if (!handle_) {
+        return true;
     }
+    bool closed = fclose(handle_) == 0;
+    handle_ = nullptr;
+    return closed;
 }
 
 String File::fileModeMapper(int mode) {
@@ -37,7 +37,9 @@ public:
     usize writeData(const void* src, usize size) override;
 
     bool open(const Path& path, int mode);
-    void close();
+
+    // Returns false if buffered data couldn't be written.
+    bool close();
 
 private:
     FILE* handle_;
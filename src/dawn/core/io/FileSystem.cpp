@@ -14,6 +14,7 @@
 #include <sys/stat.h>
 #endif
 
+#include <cerrno>
 #include <cstdio>
 
 namespace dw {
@@ -83,9 +84,50 @@ bool FileSystem::fileExists(const Path& path) const {
     return true;
 }
 
+bool FileSystem::createDirectory(const Path& path) const {
+#if DW_PLATFORM == DW_WIN32
+    if (::CreateDirectoryA(path.c_str(), nullptr) == FALSE &&
+        ::GetLastError() != ERROR_ALREADY_EXISTS) {
+        log().error("Failed to create directory {}", path);
+        return false;
+    }
+#else
+    if (::mkdir(path.c_str(), 0755) != 0 && errno != EEXIST) {
+        log().error("Failed to create directory {} (errno {})", path, errno);
+        return false;
+    }
+#endif
+
+    return true;
+}
+
+bool FileSystem::createDirectories(const Path& path) const {
+    for (usize i = 1; i < path.size(); ++i) {
+        // Skip the root, and drive letters such as "C:".
+        if ((path[i] == '/' || path[i] == '\\') && path[i - 1] != ':' && path[i - 1] != '/' &&
+            path[i - 1] != '\\') {
+            if (!createDirectory(path.substr(0, i))) {
+                return false;
+            }
+        }
+    }
+    return createDirectory(path);
+}
+
 bool FileSystem::rename(const Path& oldname, const Path& newname) const {
-    // TODO(David): Error handling by errno
-    return ::rename(oldname.c_str(), newname.c_str()) != 0;
+#if DW_PLATFORM == DW_WIN32
+    // Unlike rename(), MoveFileEx can replace an existing file.
+    if (::MoveFileExA(oldname.c_str(), newname.c_str(), MOVEFILE_REPLACE_EXISTING) == FALSE) {
+        log().error("Failed to rename {} to {}", oldname, newname);
+        return false;
+    }
+#else
+    if (::rename(oldname.c_str(), newname.c_str()) != 0) {
+        log().error("Failed to rename {} to {} (errno {})", oldname, newname, errno);
+        return false;
+    }
+#endif
+    return true;
 }
 
 bool FileSystem::deleteFile(const Path& path) const {
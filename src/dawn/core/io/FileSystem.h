@@ -19,6 +19,11 @@ public:
     Path tempDir() const;
 
     bool fileExists(const Path& path) const;
+    // Creates a directory if it doesn't already exist. Its parent directory must exist.
+    bool createDirectory(const Path& path) const;
+    // Creates a directory and any of its parents which don't already exist.
+    bool createDirectories(const Path& path) const;
+    // Renames a file, replacing newname if it exists. Returns true on success.
     bool rename(const Path& oldname, const Path& newname) const;
     bool deleteFile(const Path& path) const;
 
@@ -3,6 +3,7 @@
  * Written by David Avedissian (c) 2012-2019 (git@dga.dev)
  */
 #include "Testing.h"
+#include "core/io/File.h"
 #include "core/io/FileSystem.h"
 
 class FileSystemTest : public ::testing::Test {
@@ -27,3 +28,34 @@ TEST_F(FileSystemTest, FileDoesExist) {
 TEST_F(FileSystemTest, FileDoesNotExist) {
     EXPECT_FALSE(context_->module<dw::FileSystem>()->fileExists("core/io/testfiles/missing.txt"));
 }
+
+TEST_F(FileSystemTest, CreateDirectories) {
+    auto* fs = context_->module<dw::FileSystem>();
+    dw::Path dir = fs->tempDir() + "/dawn-filesystem-test/a/b";
+    EXPECT_TRUE(fs->createDirectories(dir));
+    // Directories which already exist are fine.
+    EXPECT_TRUE(fs->createDirectories(dir + "/"));
+    {
+        dw::File file(context_);
+        EXPECT_TRUE(file.open(dir + "/c.txt", dw::FileMode::Write));
+    }
+    fs->deleteFile(dir + "/c.txt");
+}
+
+TEST_F(FileSystemTest, RenameReplacesExistingFile) {
+    auto* fs = context_->module<dw::FileSystem>();
+    dw::Path from = fs->tempDir() + "/dawn-filesystem-test-from.txt";
+    dw::Path to = fs->tempDir() + "/dawn-filesystem-test-to.txt";
+    for (auto& path : {from, to}) {
+        dw::File file(context_, path, dw::FileMode::Write);
+        file.writeData(path.data(), path.size());
+    }
+    EXPECT_TRUE(fs->rename(from, to));
+    EXPECT_FALSE(fs->fileExists(from));
+    {
+        dw::File file(context_, to, dw::FileMode::Read);
+        EXPECT_EQ(from.size(), file.size());
+    }
+    EXPECT_FALSE(fs->rename(from, to));
+    fs->deleteFile(to);
+}
@@ -0,0 +1,129 @@
+/*
+ * Dawn Engine
+ * Written by David Avedissian (c) 2012-2019 (git@dga.dev)
+ */
+#include "Base.h"
+#include "MappedFile.h"
+
+#if DW_PLATFORM == DW_WIN32
+#include "core/platform/Windows.h"
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace dw {
+MappedFile::MappedFile(Context* context)
+    : Object{context},
+      open_{false},
+      data_{nullptr},
+      size_{0}
+#if DW_PLATFORM == DW_WIN32
+      ,
+      file_handle_{INVALID_HANDLE_VALUE},
+      mapping_handle_{nullptr}
+#endif
+{
+}
+
+MappedFile::MappedFile(Context* context, const Path& path) : MappedFile(context) {
+    open(path);
+}
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+bool MappedFile::open(const Path& path) {
+    close();
+#if DW_PLATFORM == DW_WIN32
+    file_handle_ = ::CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                                 OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file_handle_ == INVALID_HANDLE_VALUE) {
+        log().error("Failed to open file: {}", path);
+        return false;
+    }
+    LARGE_INTEGER size;
+    ::GetFileSizeEx(file_handle_, &size);
+    size_ = static_cast<usize>(size.QuadPart);
+    if (size_ > 0) {
+        mapping_handle_ =
+            ::CreateFileMappingA(file_handle_, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (mapping_handle_) {
+            data_ = static_cast<const byte*>(
+                ::MapViewOfFile(mapping_handle_, FILE_MAP_READ, 0, 0, 0));
+        }
+        if (!data_) {
+            log().error("Failed to map file into memory: {}", path);
+            close();
+            return false;
+        }
+    }
+#else
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        log().error("Failed to open file: {}", path);
+        return false;
+    }
+    struct stat stbuf;
+    if (::fstat(fd, &stbuf) != 0 || !S_ISREG(stbuf.st_mode)) {
+        log().error("Failed to open file: {} is not a regular file.", path);
+        ::close(fd);
+        return false;
+    }
+    size_ = static_cast<usize>(stbuf.st_size);
+    if (size_ > 0) {
+        void* data = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data == MAP_FAILED) {
+            log().error("Failed to map file into memory: {} (errno {})", path, errno);
+            ::close(fd);
+            size_ = 0;
+            return false;
+        }
+        data_ = static_cast<const byte*>(data);
+    }
+
+    // The mapping stays valid after the file descriptor has been closed.
+    ::close(fd);
+#endif
+    open_ = true;
+    return true;
+}
+
+void MappedFile::close() {
+#if DW_PLATFORM == DW_WIN32
+    if (data_) {
+        ::UnmapViewOfFile(data_);
+    }
+    if (mapping_handle_) {
+        ::CloseHandle(mapping_handle_);
+        mapping_handle_ = nullptr;
+    }
+    if (file_handle_ != INVALID_HANDLE_VALUE) {
+        ::CloseHandle(file_handle_);
+        file_handle_ = INVALID_HANDLE_VALUE;
+    }
+#else
+    if (data_) {
+        ::munmap(const_cast<byte*>(data_), size_);
+    }
+#endif
+    open_ = false;
+    data_ = nullptr;
+    size_ = 0;
+}
+
+bool MappedFile::isOpen() const {
+    return open_;
+}
+
+const byte* MappedFile::data() const {
+    return data_;
+}
+
+usize MappedFile::size() const {
+    return size_;
+}
+}  // namespace dw
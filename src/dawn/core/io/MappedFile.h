@@ -0,0 +1,36 @@
+/*
+ * Dawn Engine
+ * Written by David Avedissian (c) 2012-2019 (git@dga.dev)
+ */
+#pragma once
+
+#include "Path.h"
+
+namespace dw {
+// A read only file mapped into memory. Pages are loaded by the OS on first access, so mapping a
+// large file is cheap, and the contents can be read without copying.
+class DW_API MappedFile : public Object {
+public:
+    DW_OBJECT(MappedFile);
+
+    MappedFile(Context* context);
+    MappedFile(Context* context, const Path& path);
+    ~MappedFile() override;
+
+    bool open(const Path& path);
+    void close();
+
+    bool isOpen() const;
+    const byte* data() const;
+    usize size() const;
+
+private:
+    bool open_;
+    const byte* data_;
+    usize size_;
+#if DW_PLATFORM == DW_WIN32
+    void* file_handle_;
+    void* mapping_handle_;
+#endif
+};
+}  // namespace dw
@@ -0,0 +1,33 @@
+/*
+ * Dawn Engine
+ * Written by David Avedissian (c) 2012-2019 (git@dga.dev)
+ */
+#include "Base.h"
+#include "MemoryInputStream.h"
+
+namespace dw {
+MemoryInputStream::MemoryInputStream(const byte* data, usize size, SharedPtr<const void> owner)
+    : InputStream{size}, owner_{std::move(owner)}, data_{data} {
+}
+
+MemoryInputStream::MemoryInputStream(Vector<byte> data)
+    : InputStream{data.size()}, buffer_{std::move(data)}, data_{buffer_.data()} {
+}
+
+usize MemoryInputStream::readData(void* dest, usize size) {
+    if (position_ + size > size_) {
+        return 0;
+    }
+    memcpy(dest, data_ + position_, size);
+    position_ += size;
+    return size;
+}
+
+void MemoryInputStream::seek(usize position) {
+    position_ = std::min(position, size_);
+}
+
+const byte* MemoryInputStream::data() const {
+    return data_;
+}
+}  // namespace dw
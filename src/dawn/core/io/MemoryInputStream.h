@@ -0,0 +1,30 @@
+/*
+ * Dawn Engine
+ * Written by David Avedissian (c) 2012-2019 (git@dga.dev)
+ */
+#pragma once
+
+#include "InputStream.h"
+
+namespace dw {
+// An input stream over a block of memory. The memory is either owned by the stream, or borrowed
+// without copying it. Borrowed memory must outlive the stream, unless an owner is given, which is
+// kept alive for as long as the stream is.
+class DW_API MemoryInputStream : public InputStream {
+public:
+    MemoryInputStream(const byte* data, usize size, SharedPtr<const void> owner = nullptr);
+    explicit MemoryInputStream(Vector<byte> data);
+    ~MemoryInputStream() = default;
+
+    usize readData(void* dest, usize size) override;
+    void seek(usize position) override;
+
+    // Contents of the stream, for readers which can use the memory directly.
+    const byte* data() const;
+
+private:
+    SharedPtr<const void> owner_;
+    Vector<byte> buffer_;
+    const byte* data_;
+};
+}  // namespace dw
@@ -0,0 +1,51 @@
+/*
+ * Dawn Engine
+ * Written by David Avedissian (c) 2012-2019 (git@dga.dev)
+ */
+#include "Testing.h"
+#include "core/io/MemoryInputStream.h"
+
+TEST(MemoryInputStreamTest, ReadBorrowed) {
+    const dw::byte data[] = {1, 2, 3, 4, 5};
+    dw::MemoryInputStream stream{data, sizeof(data)};
+    EXPECT_EQ(data, stream.data());
+    EXPECT_EQ(5, stream.size());
+
+    dw::byte out[3];
+    EXPECT_EQ(3, stream.readData(out, 3));
+    EXPECT_EQ(1, out[0]);
+    EXPECT_EQ(3, out[2]);
+    EXPECT_EQ(3, stream.position());
+
+    // Reading past the end reads nothing.
+    EXPECT_EQ(0, stream.readData(out, 3));
+    EXPECT_EQ(2, stream.readData(out, 2));
+    EXPECT_EQ(5, out[1]);
+    EXPECT_TRUE(stream.eof());
+}
+
+TEST(MemoryInputStreamTest, ReadOwned) {
+    dw::MemoryInputStream stream{dw::Vector<dw::byte>{'a', 'b', 'c'}};
+    EXPECT_EQ("abc", dw::stream::read<dw::String>(stream));
+}
+
+TEST(MemoryInputStreamTest, SeekIsClamped) {
+    const dw::byte data[] = {1, 2, 3};
+    dw::MemoryInputStream stream{data, sizeof(data)};
+    stream.seek(2);
+    EXPECT_EQ(2, stream.position());
+    stream.seek(10);
+    EXPECT_EQ(3, stream.position());
+    EXPECT_TRUE(stream.eof());
+}
+
+TEST(MemoryInputStreamTest, OwnerIsKeptAlive) {
+    auto owner = dw::makeShared<dw::Vector<dw::byte>>(dw::Vector<dw::byte>{7, 8});
+    dw::MemoryInputStream stream{owner->data(), owner->size(), owner};
+    std::weak_ptr<dw::Vector<dw::byte>> weak_owner = owner;
+    owner.reset();
+    EXPECT_FALSE(weak_owner.expired());
+    dw::byte out;
+    stream.read(out);
+    EXPECT_EQ(7, out);
+}
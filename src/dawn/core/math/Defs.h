@@ -82,6 +82,17 @@ inline Quat damp(const Quat& a, const Quat& b, float smoothing, float dt) {
     return Quat::Slerp(a, b, 1.0f - pow(1.0f - smoothing, dt));
 }
 
+/// Rotates an orientation by a constant angular velocity (in radians per second) for a period of
+/// time.
+inline Quat integrateOrientation(const Quat& orientation, const Vec3& angular_velocity, float dt) {
+    float angular_speed = angular_velocity.Length();
+    if (angular_speed < M_EPSILON) {
+        return orientation;
+    }
+    Quat delta = Quat::RotateAxisAngle(angular_velocity / angular_speed, angular_speed * dt);
+    return (delta * orientation).Normalized();
+}
+
 /// Returns the greatest integer which is less than the input value
 inline float floor(float value) {
     return ::floorf(value);
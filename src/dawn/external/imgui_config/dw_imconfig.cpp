@@ -0,0 +1,7 @@
+/*
+ * Dawn Engine
+ * Written by David Avedissian (c) 2012-2019 (git@dga.dev)
+ */
+#include <imgui.h>
+
+thread_local ImGuiContext* DwImGuiCurrentContext = nullptr;
@@ -12,3 +12,9 @@
 #pragma once
 
 #define IMGUI_DISABLE_OBSOLETE_FUNCTIONS
+
+// Each thread has its own current context, so that game sessions can update their UI on worker
+// threads concurrently. Defined in dw_imconfig.cpp.
+struct ImGuiContext;
+extern thread_local ImGuiContext* DwImGuiCurrentContext;
+#define GImGui DwImGuiCurrentContext
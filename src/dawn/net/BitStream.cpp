@@ -6,11 +6,12 @@
 #include "net/BitStream.h"
 
 namespace dw {
-InputBitStream::InputBitStream(const byte* data, usize length) : data_(data), length_(length) {
+InputBitStream::InputBitStream(const byte* data, usize length)
+    : InputStream(length), data_(data), length_(length) {
 }
 
 InputBitStream::InputBitStream(const Vector<byte>& data)
-    : data_(data.data()), length_(data.size()) {
+    : InputStream(data.size()), data_(data.data()), length_(data.size()) {
 }
 
 usize InputBitStream::readData(void* dest, usize size) {
@@ -42,6 +43,10 @@ usize OutputBitStream::writeData(const void* src, usize size) {
     return size;
 }
 
+void OutputBitStream::clear() {
+    data_.clear();
+}
+
 const Vector<byte>& OutputBitStream::vec_data() const {
     return data_;
 }
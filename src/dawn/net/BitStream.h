@@ -34,6 +34,9 @@ public:
 
     usize writeData(const void* src, usize size) override;
 
+    // Discards the contents of the stream, keeping the underlying buffer allocated.
+    void clear();
+
     const Vector<byte>& vec_data() const;
 
     const byte* data() const;
@@ -70,11 +70,12 @@ void CNetData::deserialise(InputStream& in) {
     }
 }
 
-void CNetData::sendRpc(RpcId rpc_id, RpcType type, const Vector<byte>& payload) {
-    net_->sendRpc(entity_->id(), rpc_id, type, payload);
+void CNetData::sendRpc(RpcId rpc_id, RpcType type, RpcChannel channel,
+                       const Vector<byte>& payload) {
+    net_->sendRpc(net_id_, rpc_id, type, channel, payload);
 }
 
-void CNetData::receiveRpc(RpcId rpc_id, const Vector<byte>& payload) {
+void CNetData::receiveRpc(RpcId rpc_id, InputStream& payload) {
     auto rpc_func = rep_layout_.rpc_map_.find(rpc_id);
     if (rpc_func != rep_layout_.rpc_map_.end()) {
         (*rpc_func).second(*entity_).receiveRpcPayload(*entity_, payload);
@@ -91,6 +92,10 @@ NetRole CNetData::remoteRole() const {
     return remote_role_;
 }
 
+NetEntityId CNetData::netId() const {
+    return net_id_;
+}
+
 NetMode CNetData::netMode() const {
     return net_->netMode();
 }
@@ -10,6 +10,7 @@
 #include "core/io/OutputStream.h"
 
 #include "net/BitStream.h"
+#include "net/NetEntityId.h"
 #include "net/NetRole.h"
 #include "net/NetMode.h"
 #include "net/RepProperty.h"
@@ -54,12 +55,15 @@ public:
     void serialise(OutputStream& out);
     void deserialise(InputStream& in);
 
-    void sendRpc(RpcId rpc_id, RpcType type, const Vector<byte>& payload);
-    void receiveRpc(RpcId rpc_id, const Vector<byte>& payload);
+    void sendRpc(RpcId rpc_id, RpcType type, RpcChannel channel, const Vector<byte>& payload);
+    void receiveRpc(RpcId rpc_id, InputStream& payload);
 
     NetRole role() const;
     NetRole remoteRole() const;
 
+    // ID of the entity on the network. Invalid until the entity has been replicated.
+    NetEntityId netId() const;
+
     NetMode netMode() const;
 
 private:
@@ -69,6 +73,7 @@ private:
 
     NetRole role_;
     NetRole remote_role_;
+    NetEntityId net_id_;
 
     friend class NetInstance;
     friend class RpcSender;
@@ -7,59 +7,100 @@
 #include "net/CNetTransform.h"
 #include "scene/PhysicsScene.h"
 
+#include <algorithm>
+
 namespace dw {
+NetTransformState CNetTransform::transformState() {
+    return transform_state;
+}
+
+void CNetTransform::setTransformState(const NetTransformState& state) {
+    transform_state = state;
+
+    TransformSnapshot snapshot;
+    snapshot.time = state.time;
+    snapshot.position = state.position;
+    snapshot.velocity = state.velocity;
+    snapshot.orientation = state.orientation;
+    snapshot.angular_velocity = state.angular_velocity;
+    snapshots.push(snapshot);
+}
+
+SNetTransformSync::SNetTransformSync()
+    : interpolation_delay_(0.1f), max_extrapolation_(0.25f), time_(0.0) {
+}
+
+void SNetTransformSync::setInterpolationDelay(float delay) {
+    interpolation_delay_ = delay;
+}
+
+float SNetTransformSync::interpolationDelay() const {
+    return interpolation_delay_;
+}
+
+void SNetTransformSync::setMaxExtrapolation(float time) {
+    max_extrapolation_ = time;
+}
+
+float SNetTransformSync::maxExtrapolation() const {
+    return max_extrapolation_;
+}
+
 void SNetTransformSync::process(float dt) {
+    time_ += dt;
+
+    // On clients, the server time can't be behind the newest snapshot we've received.
+    for (auto e : entityView()) {
+        auto entity = Entity{scene_mgr_, e};
+        auto& snapshots = entity.component<CNetTransform>()->snapshots;
+        if (entity.component<CNetData>()->role() < NetRole::Authority && snapshots.size() > 0) {
+            time_ = std::max(time_, snapshots.newest().time);
+        }
+    }
+    double render_time = time_ - interpolation_delay_;
+
     for (auto e : entityView()) {
         auto entity = Entity{scene_mgr_, e};
 
         NetRole role = entity.component<CNetData>()->role();
         CSceneNode& transform = *entity.component<CSceneNode>();
-        NetTransformState& net_state = entity.component<CNetTransform>()->transform_state;
+        CNetTransform& net_transform = *entity.component<CNetTransform>();
+        NetTransformState& net_state = net_transform.transform_state;
         CRigidBody* rigid_body = entity.component<CRigidBody>();
 
         if (role >= NetRole::Authority) {
             // If this entity has a rigid body, calculate velocity/angular velocity.
             float inv_dt = 1.0f / dt;
             if (rigid_body) {
-                // Physics state velocities assume a dt of 1.0f / 60.0f
-                float inv_physics_timestep = 60.0f;
-                net_state.velocity =
-                    rigid_body->_rigidBody()->getLinearVelocity() * inv_physics_timestep;
+                // Bullet velocities are already in units per second.
+                net_state.velocity = rigid_body->_rigidBody()->getLinearVelocity();
                 net_state.acceleration = rigid_body->_rigidBody()->getInvMass() *
-                                         rigid_body->_rigidBody()->getTotalForce() *
-                                         inv_physics_timestep;
-                net_state.angular_velocity =
-                    rigid_body->_rigidBody()->getAngularVelocity() * inv_physics_timestep;
+                                         rigid_body->_rigidBody()->getTotalForce();
+                net_state.angular_velocity = rigid_body->_rigidBody()->getAngularVelocity();
                 net_state.angular_acceleration =
                     rigid_body->_rigidBody()->getInvInertiaTensorWorld() *
-                    rigid_body->_rigidBody()->getTotalTorque() * inv_physics_timestep;
+                    rigid_body->_rigidBody()->getTotalTorque();
             } else {
                 net_state.velocity =
-                    (transform.node->transform().position - net_state.position) / inv_dt;
+                    (transform.node->transform().position - net_state.position) * inv_dt;
                 net_state.angular_velocity = Vec3::zero;
                 net_state.angular_acceleration = Vec3::zero;
             }
 
             // Apply new state.
+            net_state.time = time_;
             net_state.position = transform.node->transform().position;
             net_state.orientation = transform.node->transform().orientation;
-        } else {
-            /*
-    // Update transform and integrate velocities.
-    transform.position() = net_state.position + net_state.velocity * dt + 0.5f *
-    net_state.acceleration
-    * dt * dt;
-    // TODO: Combine the next 6 lines into one line once operator+ is implemented properly.
-    Quat new_orientation = net_state.orientation;
-    Vec3 integrated_angular_velocity = net_state.angular_velocity + net_state.angular_acceleration *
-    dt; Quat integrated_delta_rotation = Quat(integrated_angular_velocity.x,
-    integrated_angular_velocity.y, integrated_angular_velocity.z, 0.0f) * net_state.orientation;
-    new_orientation.x += dt * 0.5f * integrated_delta_rotation.x; new_orientation.y += dt * 0.5f *
-    integrated_delta_rotation.y; new_orientation.z += dt * 0.5f * integrated_delta_rotation.z;
-    new_orientation.w += dt * 0.5f * integrated_delta_rotation.w;
-    new_orientation.Normalize();
-    transform.orientation() = new_orientation;
-            */
+        } else if (role == NetRole::Proxy) {
+            // Sample the received snapshots in the past.
+            auto sample = net_transform.snapshots.sample(render_time, max_extrapolation_);
+            if (sample) {
+                auto& xform = transform.node->transform();
+                xform.position = sample->position;
+                xform.orientation = sample->orientation;
+            }
+        } else if (!net_transform.locally_predicted) {
+            // Authoritative proxies are controlled locally, so always use the latest state.
             auto& xform = transform.node->transform();
             xform.position = net_state.position;
             xform.orientation = net_state.orientation;
@@ -11,9 +11,12 @@
 #include "scene/SceneManager.h"
 #include "renderer/SystemPosition.h"
 #include "net/CNetData.h"
+#include "net/PredictionBuffer.h"
+#include "net/TransformSnapshotBuffer.h"
 
 namespace dw {
 struct NetTransformState {
+    double time;  // Server time when this state was captured.
     Vec3 position;
     Vec3 velocity;
     Vec3 acceleration;
@@ -21,13 +24,18 @@ struct NetTransformState {
     Vec3 angular_velocity;
     Vec3 angular_acceleration;
 
+    // The last input from the controlling client which was applied before this state was captured.
+    InputSequence input_sequence;
+
     NetTransformState()
-        : position(Vec3::zero),
+        : time(0.0),
+          position(Vec3::zero),
           velocity(Vec3::zero),
           acceleration(Vec3::zero),
           orientation(Quat::identity),
           angular_velocity(Vec3::zero),
-          angular_acceleration(Vec3::zero) {
+          angular_acceleration(Vec3::zero),
+          input_sequence(0) {
     }
 
     bool operator==(const NetTransformState& other) const {
@@ -49,22 +57,26 @@ struct NetTransformState {
 namespace stream {
 template <> inline NetTransformState read<NetTransformState>(InputStream& s) {
     NetTransformState output;
+    s.read(output.time);
     s.read(output.position);
     s.read(output.velocity);
     s.read(output.acceleration);
     s.read(output.orientation);
     s.read(output.angular_velocity);
     s.read(output.angular_acceleration);
+    s.read(output.input_sequence);
     return output;
 }
 
 template <> inline void write<NetTransformState>(OutputStream& s, const NetTransformState& state) {
+    s.write(state.time);
     s.write(state.position);
     s.write(state.velocity);
     s.write(state.acceleration);
     s.write(state.orientation);
     s.write(state.angular_velocity);
     s.write(state.angular_acceleration);
+    s.write(state.input_sequence);
 }
 }  // namespace stream
 
@@ -72,15 +84,47 @@ class CNetTransform : public Component {
 public:
     NetTransformState transform_state;
 
+    // Recently received states, used to smooth the motion of proxies.
+    TransformSnapshotBuffer snapshots;
+
+    // Set on authoritative proxies which predict their own transform. The received state is then
+    // left for the prediction to reconcile against, instead of being applied directly.
+    bool locally_predicted = false;
+
+    NetTransformState transformState();
+    void setTransformState(const NetTransformState& state);
+
     static RepLayout repLayout() {
-        return {{RepProperty::bind<CNetTransform>(&CNetTransform::transform_state)}, {}};
+        return {{RepProperty::bind<CNetTransform>(&CNetTransform::transformState,
+                                                  &CNetTransform::setTransformState)},
+                {}};
     }
 };
 
+// Captures the transform of authoritative entities, and applies received transforms to proxies.
+//
+// Proxies are rendered slightly in the past (by the interpolation delay) so that there's usually a
+// pair of snapshots either side of the render time to interpolate between. This means the server
+// can send updates less frequently whilst motion stays smooth. If snapshots stop arriving, the
+// transform is extrapolated for up to max extrapolation seconds, then held still.
 class SNetTransformSync : public EntitySystem<CSceneNode, CNetTransform, CNetData> {
 public:
+    SNetTransformSync();
     ~SNetTransformSync() = default;
 
+    void setInterpolationDelay(float delay);
+    float interpolationDelay() const;
+
+    void setMaxExtrapolation(float time);
+    float maxExtrapolation() const;
+
     void process(float dt) override;
+
+private:
+    float interpolation_delay_;
+    float max_extrapolation_;
+
+    // On the server, the current time. On clients, an estimate of the current server time.
+    double time_;
 };
 }  // namespace dw
@@ -0,0 +1,50 @@
+/*
+ * Dawn Engine
+ * Written by David Avedissian (c) 2012-2019 (git@dga.dev)
+ */
+#include "Base.h"
+#include "net/FlatBufferBuilderPool.h"
+
+namespace dw {
+FlatBufferBuilderPool::Handle::Handle(FlatBufferBuilderPool* pool,
+                                      UniquePtr<flatbuffers::FlatBufferBuilder> builder)
+    : pool_(pool), builder_(std::move(builder)) {
+}
+
+FlatBufferBuilderPool::Handle::~Handle() {
+    if (builder_) {
+        pool_->release(std::move(builder_));
+    }
+}
+
+flatbuffers::FlatBufferBuilder& FlatBufferBuilderPool::Handle::operator*() const {
+    return *builder_;
+}
+
+flatbuffers::FlatBufferBuilder* FlatBufferBuilderPool::Handle::operator->() const {
+    return builder_.get();
+}
+
+FlatBufferBuilderPool::FlatBufferBuilderPool(usize initial_builder_size)
+    : initial_builder_size_(initial_builder_size) {
+}
+
+FlatBufferBuilderPool::Handle FlatBufferBuilderPool::acquire() {
+    if (free_builders_.empty()) {
+        return {this, makeUnique<flatbuffers::FlatBufferBuilder>(initial_builder_size_)};
+    }
+    auto builder = std::move(free_builders_.back());
+    free_builders_.pop_back();
+    return {this, std::move(builder)};
+}
+
+usize FlatBufferBuilderPool::size() const {
+    return free_builders_.size();
+}
+
+void FlatBufferBuilderPool::release(UniquePtr<flatbuffers::FlatBufferBuilder> builder) {
+    // Clear() resets the builder but keeps its buffer allocated.
+    builder->Clear();
+    free_builders_.emplace_back(std::move(builder));
+}
+}  // namespace dw
@@ -0,0 +1,49 @@
+/*
+ * Dawn Engine
+ * Written by David Avedissian (c) 2012-2019 (git@dga.dev)
+ */
+#pragma once
+
+#include <flatbuffers/flatbuffers.h>
+
+namespace dw {
+// A pool of FlatBufferBuilders. Builders are cleared when they are returned to the pool, which
+// keeps their buffers allocated so building the next message doesn't need to allocate.
+class DW_API FlatBufferBuilderPool {
+public:
+    // A builder borrowed from the pool. The builder is returned to the pool when this handle is
+    // destroyed.
+    class DW_API Handle {
+    public:
+        Handle(FlatBufferBuilderPool* pool, UniquePtr<flatbuffers::FlatBufferBuilder> builder);
+        Handle(const Handle&) = delete;
+        Handle(Handle&& other) = default;
+        ~Handle();
+
+        Handle& operator=(const Handle&) = delete;
+        Handle& operator=(Handle&&) = delete;
+
+        flatbuffers::FlatBufferBuilder& operator*() const;
+        flatbuffers::FlatBufferBuilder* operator->() const;
+
+    private:
+        FlatBufferBuilderPool* pool_;
+        UniquePtr<flatbuffers::FlatBufferBuilder> builder_;
+    };
+
+    explicit FlatBufferBuilderPool(usize initial_builder_size = 1024);
+    ~FlatBufferBuilderPool() = default;
+
+    // Borrow a builder from the pool, creating a new one if the pool is empty.
+    Handle acquire();
+
+    // Number of builders waiting in the pool.
+    usize size() const;
+
+private:
+    usize initial_builder_size_;
+    Vector<UniquePtr<flatbuffers::FlatBufferBuilder>> free_builders_;
+
+    void release(UniquePtr<flatbuffers::FlatBufferBuilder> builder);
+};
+}  // namespace dw
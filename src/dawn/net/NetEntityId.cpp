@@ -0,0 +1,118 @@
+/*
+ * Dawn Engine
+ * Written by David Avedissian (c) 2012-2019 (git@dga.dev)
+ */
+#include "Base.h"
+#include "net/NetEntityId.h"
+
+namespace dw {
+NetEntityId::NetEntityId() : value_(0) {
+}
+
+NetEntityId::NetEntityId(u32 index, u32 generation)
+    : value_((generation << index_bits) | (index & max_index)) {
+    assert(index <= max_index);
+    assert(generation > 0 && generation <= max_generation);
+}
+
+NetEntityId NetEntityId::fromValue(u32 value) {
+    NetEntityId id;
+    id.value_ = value;
+    return id;
+}
+
+u32 NetEntityId::index() const {
+    return value_ & max_index;
+}
+
+u32 NetEntityId::generation() const {
+    return value_ >> index_bits;
+}
+
+u32 NetEntityId::value() const {
+    return value_;
+}
+
+bool NetEntityId::isValid() const {
+    return generation() != 0;
+}
+
+bool NetEntityId::operator==(const NetEntityId& other) const {
+    return value_ == other.value_;
+}
+
+bool NetEntityId::operator!=(const NetEntityId& other) const {
+    return value_ != other.value_;
+}
+
+NetEntityTable::NetEntityTable(u32 capacity)
+    : capacity_(capacity), allocates_ids_(false), size_(0) {
+    assert(capacity_ > 0 && capacity_ - 1 <= NetEntityId::max_index);
+}
+
+NetEntityId NetEntityTable::allocate(Entity* entity) {
+    allocates_ids_ = true;
+    u32 index;
+    if (!free_slots_.empty()) {
+        index = free_slots_.front();
+        free_slots_.pop_front();
+    } else {
+        if (slots_.size() >= capacity_) {
+            return {};
+        }
+        index = static_cast<u32>(slots_.size());
+        slots_.emplace_back();
+    }
+    auto& slot = slots_[index];
+    slot.generation = slot.generation == NetEntityId::max_generation ? 1 : slot.generation + 1;
+    slot.entity = entity;
+    size_++;
+    return {index, slot.generation};
+}
+
+bool NetEntityTable::insert(NetEntityId id, Entity* entity) {
+    if (!id.isValid() || id.index() >= capacity_) {
+        return false;
+    }
+    if (id.index() >= slots_.size()) {
+        slots_.resize(id.index() + 1);
+    }
+    auto& slot = slots_[id.index()];
+    if (!slot.entity) {
+        size_++;
+    }
+    slot.generation = id.generation();
+    slot.entity = entity;
+    return true;
+}
+
+void NetEntityTable::remove(NetEntityId id) {
+    if (!find(id)) {
+        return;
+    }
+    slots_[id.index()].entity = nullptr;
+    if (allocates_ids_) {
+        free_slots_.emplace_back(id.index());
+    }
+    size_--;
+}
+
+Entity* NetEntityTable::find(NetEntityId id) const {
+    if (id.index() >= slots_.size()) {
+        return nullptr;
+    }
+    auto& slot = slots_[id.index()];
+    return slot.generation == id.generation() ? slot.entity : nullptr;
+}
+
+usize NetEntityTable::size() const {
+    return size_;
+}
+
+void NetEntityTable::clear() {
+    slots_.clear();
+    free_slots_.clear();
+    allocates_ids_ = false;
+    size_ = 0;
+}
+}  // namespace dw
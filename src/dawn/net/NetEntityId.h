@@ -0,0 +1,92 @@
+/*
+ * Dawn Engine
+ * Written by David Avedissian (c) 2012-2019 (git@dga.dev)
+ */
+#pragma once
+
+#include "core/Collections.h"
+
+#include <ostream>
+
+namespace dw {
+class Entity;
+
+// Compact ID of a replicated entity, allocated by the server and sent in place of its EntityId.
+// The low bits index a slot in a NetEntityTable, and the high bits hold the generation of the
+// slot, so that IDs of entities which have been removed are never mistaken for the entity which
+// reuses their slot. Generations start at 1, so a valid ID is never 0.
+class DW_API NetEntityId {
+public:
+    static const u32 index_bits = 20;
+    static const u32 generation_bits = 32 - index_bits;
+    static const u32 max_index = (1u << index_bits) - 1;
+    static const u32 max_generation = (1u << generation_bits) - 1;
+
+    // Creates an invalid ID.
+    NetEntityId();
+    NetEntityId(u32 index, u32 generation);
+
+    // Creates an ID from its wire representation.
+    static NetEntityId fromValue(u32 value);
+
+    u32 index() const;
+    u32 generation() const;
+    u32 value() const;
+    bool isValid() const;
+
+    bool operator==(const NetEntityId& other) const;
+    bool operator!=(const NetEntityId& other) const;
+
+private:
+    u32 value_;
+};
+
+inline std::ostream& operator<<(std::ostream& stream, NetEntityId id) {
+    return stream << id.index() << ":" << id.generation();
+}
+
+// Maps NetEntityIds to local entities through a flat array indexed by the ID's index. On the
+// server, IDs are allocated by the table. On a client, IDs received from the server are inserted.
+// Entities must be removed from the table before they're destroyed.
+//
+// The server and its clients must use the same capacity, which bounds the memory a client
+// allocates for IDs sent by the server.
+class DW_API NetEntityTable {
+public:
+    static const u32 default_capacity = 1u << 16;
+
+    explicit NetEntityTable(u32 capacity = default_capacity);
+
+    // Allocates an ID for an entity, reusing the slot of the entity which was removed the longest
+    // time ago if possible, so that each slot's generation increases as slowly as possible.
+    // Returns an invalid ID if the table is full.
+    NetEntityId allocate(Entity* entity);
+
+    // Adds an entity with an ID allocated elsewhere, replacing any entity in the same slot.
+    // Returns false if the ID is invalid, or its index is outside of the table's capacity.
+    bool insert(NetEntityId id, Entity* entity);
+
+    // Removes an entity. Does nothing if the ID is stale.
+    void remove(NetEntityId id);
+
+    // Returns the entity with an ID, or nullptr if there's no such entity.
+    Entity* find(NetEntityId id) const;
+
+    // Number of entities in the table.
+    usize size() const;
+
+    void clear();
+
+private:
+    struct Slot {
+        u32 generation = 0;  // Generation of the last ID which used this slot.
+        Entity* entity = nullptr;
+    };
+
+    u32 capacity_;
+    Vector<Slot> slots_;
+    Deque<u32> free_slots_;  // Oldest first. Only tracked by tables which allocate IDs.
+    bool allocates_ids_;
+    usize size_;
+};
+}  // namespace dw
@@ -0,0 +1,92 @@
+/*
+ * Dawn Engine
+ * Written by David Avedissian (c) 2012-2019 (git@dga.dev)
+ */
+#include "Testing.h"
+#include "net/NetEntityId.h"
+
+namespace {
+dw::Entity* fakeEntity(dw::usize n) {
+    return reinterpret_cast<dw::Entity*>(n * 16);
+}
+}  // namespace
+
+TEST(NetEntityIdTest, PacksIndexAndGeneration) {
+    dw::NetEntityId id(12345, 7);
+    EXPECT_EQ(12345u, id.index());
+    EXPECT_EQ(7u, id.generation());
+    EXPECT_TRUE(id.isValid());
+    EXPECT_EQ(id, dw::NetEntityId::fromValue(id.value()));
+    EXPECT_FALSE(dw::NetEntityId().isValid());
+    EXPECT_EQ(0u, dw::NetEntityId().value());
+}
+
+TEST(NetEntityTableTest, AllocatesDenseIndices) {
+    dw::NetEntityTable table;
+    auto a = table.allocate(fakeEntity(1));
+    auto b = table.allocate(fakeEntity(2));
+    EXPECT_EQ(0u, a.index());
+    EXPECT_EQ(1u, b.index());
+    EXPECT_EQ(fakeEntity(1), table.find(a));
+    EXPECT_EQ(fakeEntity(2), table.find(b));
+    EXPECT_EQ(2u, table.size());
+    EXPECT_EQ(nullptr, table.find(dw::NetEntityId()));
+}
+
+TEST(NetEntityTableTest, ReusedSlotsHaveNewGeneration) {
+    dw::NetEntityTable table;
+    auto a = table.allocate(fakeEntity(1));
+    table.remove(a);
+    EXPECT_EQ(nullptr, table.find(a));
+    EXPECT_EQ(0u, table.size());
+
+    auto b = table.allocate(fakeEntity(2));
+    EXPECT_EQ(a.index(), b.index());
+    EXPECT_NE(a.generation(), b.generation());
+    EXPECT_EQ(nullptr, table.find(a));
+    EXPECT_EQ(fakeEntity(2), table.find(b));
+
+    // Removing a stale ID doesn't affect the new entity.
+    table.remove(a);
+    EXPECT_EQ(fakeEntity(2), table.find(b));
+}
+
+TEST(NetEntityTableTest, InsertsIdsFromServer) {
+    dw::NetEntityTable server, client;
+    auto a = server.allocate(fakeEntity(1));
+    auto b = server.allocate(fakeEntity(2));
+    server.remove(a);
+    auto c = server.allocate(fakeEntity(3));
+
+    client.insert(b, fakeEntity(4));
+    client.insert(c, fakeEntity(5));
+    EXPECT_EQ(fakeEntity(4), client.find(b));
+    EXPECT_EQ(fakeEntity(5), client.find(c));
+    EXPECT_EQ(nullptr, client.find(a));
+    EXPECT_EQ(2u, client.size());
+}
+
+TEST(NetEntityTableTest, ReusesOldestFreeSlotFirst) {
+    dw::NetEntityTable table;
+    auto a = table.allocate(fakeEntity(1));
+    auto b = table.allocate(fakeEntity(2));
+    table.remove(a);
+    table.remove(b);
+    EXPECT_EQ(a.index(), table.allocate(fakeEntity(3)).index());
+    EXPECT_EQ(b.index(), table.allocate(fakeEntity(4)).index());
+}
+
+TEST(NetEntityTableTest, RejectsInvalidInsertedIds) {
+    dw::NetEntityTable client(4);
+    EXPECT_FALSE(client.insert(dw::NetEntityId(), fakeEntity(1)));
+    EXPECT_FALSE(client.insert(dw::NetEntityId(4, 1), fakeEntity(1)));
+    EXPECT_TRUE(client.insert(dw::NetEntityId(3, 1), fakeEntity(1)));
+    EXPECT_EQ(1u, client.size());
+}
+
+TEST(NetEntityTableTest, AllocationFailsWhenFull) {
+    dw::NetEntityTable table(2);
+    EXPECT_TRUE(table.allocate(fakeEntity(1)).isValid());
+    EXPECT_TRUE(table.allocate(fakeEntity(2)).isValid());
+    EXPECT_FALSE(table.allocate(fakeEntity(3)).isValid());
+}
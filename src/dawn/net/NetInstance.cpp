@@ -10,19 +10,23 @@
 #include "net/BitStream.h"
 #include "net/CNetData.h"
 #include "net/CNetTransform.h"
+#include "net/NetMessages.h"
+#include "net/PropertyUpdateBatcher.h"
+#include "net/RpcBatcher.h"
 #include "core/GameSession.h"
 #include "net/transport/InProcessTransport.h"
 #include "net/transport/ReliableUDPTransport.h"
-
-#include "protocol_generated.h"
-#include "to_server_generated.h"
-#include "to_client_generated.h"
-#include "NetInstance.h"
+#include "net/transport/ThreadedTransport.h"
 
 namespace dw {
 namespace {
-Vector<byte> toVector(const flatbuffers::Vector<uint8_t>& v) {
-    return Vector<byte>(v.data(), v.data() + v.size());
+// Default replication budget per client per tick, in bytes.
+const u32 default_replication_budget = 4096;
+
+// Checks that a message received by the server is a well formed ServerMessage.
+bool verifyServerMessage(const byte* data, u32 length) {
+    flatbuffers::Verifier verifier(data, length);
+    return verifier.VerifyBuffer<ServerMessage>(nullptr);
 }
 }  // namespace
 
@@ -35,23 +39,43 @@ UniquePtr<NetInstance> NetInstance::connect(Context* context, GameSession* sessi
 
 UniquePtr<NetInstance> NetInstance::listen(Context* context, GameSession* session,
                                            const String& host, u16 port, u16 max_clients,
-                                           NetTransport transport) {
+                                           NetTransport transport, bool network_thread) {
     auto instance = makeUnique<NetInstance>(context, session, transport);
+    instance->setNetworkThreadEnabled(network_thread);
     instance->listen(host, port, max_clients);
     return instance;
 }
 
+UniquePtr<NetInstance> NetInstance::playback(Context* context, GameSession* session,
+                                             const Path& replay_path, ClientId client) {
+    auto instance = makeUnique<NetInstance>(context, session, NetTransport::Replay);
+    instance->replay_path_ = replay_path;
+    instance->replay_client_ = client;
+    instance->connect("", 0);
+    return instance;
+}
+
 NetInstance::NetInstance(Context* ctx, GameSession* session, NetTransport transport)
     : Object{ctx},
       session_(session),
       transport_(transport),
       is_server_(false),
+      network_thread_enabled_(false),
       client_(nullptr),
       server_(nullptr),
-      spawn_request_id_(0) {
+      simulated_client_(nullptr),
+      simulated_server_(nullptr),
+      recording_server_(nullptr),
+      replay_client_(0),
+      spawn_request_id_(0),
+      rpc_batcher_(makeUnique<RpcBatcher>(&stats_)),
+      property_update_batcher_(makeUnique<PropertyUpdateBatcher>()),
+      replication_budget_(default_replication_budget),
+      stats_overlay_(0) {
 }
 
 NetInstance::~NetInstance() {
+    setStatsOverlayVisible(false);
     disconnect();
 }
 
@@ -68,28 +92,63 @@ void NetInstance::connect(const String& host, u16 port) {
             client_ =
                 makeUnique<InProcessClient>(context(), connected, connection_failed, disconnected);
             break;
+        case NetTransport::Replay:
+            client_ = makeUnique<ReplayClient>(context(), replay_path_, replay_client_, connected,
+                                               connection_failed, disconnected);
+            break;
         default:
             break;
     }
+    simulated_client_ = nullptr;
+    rpc_batcher_->clear();
+    net_entities_.clear();
+    pending_entity_spawns_.clear();
+    if (network_conditions_) {
+        setNetworkConditions(*network_conditions_);
+    }
     client_->connect(host, port);
     is_server_ = false;
 }
 
 void NetInstance::listen(const String& host, u16 port, u16 max_clients) {
+    if (transport_ == NetTransport::Replay) {
+        log().error("The replay transport can only be used to play back a replay.");
+        return;
+    }
     auto client_connected = [this](ClientId client_id) { onServerClientConnected(client_id); };
     auto client_disconnected = [this](ClientId client_id) {
         onServerClientDisconnected(client_id);
     };
-    switch (transport_) {
-        case NetTransport::ReliableUDP:
-            server_ =
-                makeUnique<ReliableUDPServer>(context(), client_connected, client_disconnected);
-            break;
-        case NetTransport::InProcess:
-            server_ = makeUnique<InProcessServer>(context(), client_connected, client_disconnected);
-            break;
-        default:
-            break;
+    auto create_server = [this](Function<void(ClientId)> client_connected,
+                                Function<void(ClientId)> client_disconnected)
+        -> UniquePtr<TransportServer> {
+        switch (transport_) {
+            case NetTransport::ReliableUDP:
+                return makeUnique<ReliableUDPServer>(context(), client_connected,
+                                                     client_disconnected);
+            case NetTransport::InProcess:
+                return makeUnique<InProcessServer>(context(), client_connected,
+                                                   client_disconnected);
+            default:
+                return nullptr;
+        }
+    };
+    if (network_thread_enabled_ && transport_ != NetTransport::InProcess) {
+        server_ = makeUnique<ThreadedServer>(context(), create_server, client_connected,
+                                             client_disconnected, verifyServerMessage);
+    } else {
+        server_ = create_server(client_connected, client_disconnected);
+    }
+    simulated_server_ = nullptr;
+    recording_server_ = nullptr;
+    if (network_conditions_) {
+        setNetworkConditions(*network_conditions_);
+    }
+    if (record_path_) {
+        auto result = startRecording(*record_path_);
+        if (!result) {
+            log().error("Unable to record replay: {}", result.error());
+        }
     }
     server_->listen(host, port, max_clients);
     is_server_ = true;
@@ -98,12 +157,68 @@ void NetInstance::listen(const String& host, u16 port, u16 max_clients) {
 void NetInstance::disconnect() {
     if (server_ != nullptr) {
         server_.reset();
+        simulated_server_ = nullptr;
+        recording_server_ = nullptr;
     } else if (client_ != nullptr) {
         client_.reset();
+        simulated_client_ = nullptr;
     }
 }
 
+void NetInstance::setNetworkThreadEnabled(bool enabled) {
+    if (enabled && transport_ == NetTransport::InProcess) {
+        log().warn("The in process transport can't run on a network thread. Ignoring.");
+        return;
+    }
+    network_thread_enabled_ = enabled;
+}
+
+void NetInstance::setNetworkConditions(const NetworkConditions& conditions) {
+    network_conditions_ = conditions;
+    if (server_) {
+        if (simulated_server_) {
+            simulated_server_->setConditions(conditions);
+        } else {
+            auto simulated_server =
+                makeUnique<SimulatedServer>(context(), std::move(server_), conditions);
+            simulated_server_ = simulated_server.get();
+            server_ = std::move(simulated_server);
+        }
+    } else if (client_) {
+        if (simulated_client_) {
+            simulated_client_->setConditions(conditions);
+        } else {
+            auto simulated_client =
+                makeUnique<SimulatedClient>(context(), std::move(client_), conditions);
+            simulated_client_ = simulated_client.get();
+            client_ = std::move(simulated_client);
+        }
+    }
+}
+
+Result<void> NetInstance::startRecording(const Path& path) {
+    if (!server_) {
+        return makeError("Only a server can record a replay.");
+    }
+    if (recording_server_) {
+        return makeError("A replay is already being recorded.");
+    }
+    auto writer = makeUnique<ReplayWriter>(context());
+    auto result = writer->open(path);
+    if (!result) {
+        return result;
+    }
+    record_path_ = path;
+    auto recording_server =
+        makeUnique<RecordingServer>(context(), std::move(server_), std::move(writer));
+    recording_server_ = recording_server.get();
+    server_ = std::move(recording_server);
+    log().info("Recording replay to {}", path);
+    return Result<void>();
+}
+
 void NetInstance::update(float dt) {
+    stats_.update(dt);
     if (server_) {
         serverUpdate(dt);
     } else if (client_) {
@@ -123,7 +238,10 @@ void NetInstance::serverUpdate(float dt) {
         // Process all messages from this client.
         Option<ServerPacket> message = {};
         while (message = server_->receive(client_id), message.has_value()) {
-            auto server_message = GetServerMessage(message->data.data());
+            auto server_message = GetServerMessage(message->data);
+            auto type = server_message->to_server_type();
+            stats_.recordReceived(client_id, static_cast<u8>(type),
+                                  EnumNameServerMessageData(type), message->length);
             switch (server_message->to_server_type()) {
                 case ServerMessageData_ServerSpawnRequest: {
                     auto spawn_message = server_message->to_server_as_ServerSpawnRequest();
@@ -139,29 +257,38 @@ void NetInstance::serverUpdate(float dt) {
                     }
 
                     // Send response.
-                    flatbuffers::FlatBufferBuilder builder(1024);
-                    auto response = CreateClientSpawnResponse(builder, spawn_message->request_id(),
-                                                              entity ? u64(entity->id()) : 0);
+                    auto builder = builder_pool_.acquire();
+                    auto response = CreateClientSpawnResponse(
+                        *builder, spawn_message->request_id(),
+                        entity ? entity->component<CNetData>()->netId().value() : 0);
                     auto response_message = CreateClientMessage(
-                        builder, ClientMessageData_ClientSpawnResponse, response.Union());
-                    builder.Finish(response_message);
-                    server_->send(client_id, builder.GetBufferPointer(), builder.GetSize());
+                        *builder, ClientMessageData_ClientSpawnResponse, response.Union());
+                    builder->Finish(response_message);
+                    sendToClient(*server_, stats_, client_id, ClientMessageData_ClientSpawnResponse,
+                                 *builder);
                     break;
                 }
                 case ServerMessageData_ServerRpc: {
                     auto rpc_message = server_message->to_server_as_ServerRpc();
-                    EntityId entity_id{rpc_message->entity_id()};
-                    Entity* entity = session_->sceneManager()->findEntity(entity_id);
-                    if (!entity) {
-                        log().error("Client RPC: Received from non-existent entity {}", entity_id);
+                    stats_.recordRpcsReceived(client_id, 1);
+                    receiveClientRpc(NetEntityId::fromValue(rpc_message->entity_id()),
+                                     rpc_message->rpc_id(), rpc_message->payload()->data(),
+                                     rpc_message->payload()->size());
+                    break;
+                }
+                case ServerMessageData_ServerRpcBatch: {
+                    auto batch_message = server_message->to_server_as_ServerRpcBatch();
+                    // Drop sequenced batches which arrived after a newer batch.
+                    if (!acceptRpcBatch(batch_message->sequence(),
+                                        client_replication_state_[client_id].last_rpc_sequence)) {
                         break;
                     }
-                    auto net_data = entity->component<CNetData>();
-                    if (!net_data) {
-                        log().error("Client RPC: Entity {} has no CNetData component.", entity_id);
-                        break;
+                    stats_.recordRpcsReceived(client_id, batch_message->rpcs()->size());
+                    for (auto* rpc_message : *batch_message->rpcs()) {
+                        receiveClientRpc(NetEntityId::fromValue(rpc_message->entity_id()),
+                                         rpc_message->rpc_id(), rpc_message->payload()->data(),
+                                         rpc_message->payload()->size());
                     }
-                    net_data->receiveRpc(rpc_message->rpc_id(), toVector(*rpc_message->payload()));
                     break;
                 }
                 default:
@@ -171,36 +298,112 @@ void NetInstance::serverUpdate(float dt) {
         }
     }
 
-    // Send replicated updates.
+    // Gather replicated entity state. Each entity is serialised once and shared between clients.
+    auto& entity_info = replicated_entity_state_;
     for (auto id : replicated_entities_) {
         Entity& entity = *session_->sceneManager()->findEntity(id);
-        OutputBitStream properties;
-        entity.component<CNetData>()->serialise(properties);
-        for (ClientId i = 0; i < server_->numConnections(); ++i) {
-            sendServerPropertyReplication(i, entity, properties);
+        auto& info = entity_info[id];
+        info.entity = &entity;
+        info.net_id = entity.component<CNetData>()->netId();
+        info.properties.clear();
+        entity.component<CNetData>()->serialise(info.properties);
+        info.position.reset();
+        if (entity.transform()) {
+            info.position = entity.transform()->position;
         }
+        auto* net_transform = entity.component<CNetTransform>();
+        info.speed = net_transform ? net_transform->transform_state.velocity.Length() : 0.0f;
+    }
+
+    // Send replicated updates to each client, highest accumulated priority first, until the
+    // clients budget has been spent.
+    for (ClientId client_id = 0; client_id < server_->maxConnections(); ++client_id) {
+        if (!server_->isClientConnected(client_id)) {
+            continue;
+        }
+        auto& client_state = client_replication_state_[client_id];
+
+        // Determine where this client is viewing the world from.
+        Option<Vec3> viewpoint_position;
+        if (client_state.viewpoint.has_value()) {
+            auto viewpoint_info = entity_info.find(*client_state.viewpoint);
+            if (viewpoint_info != entity_info.end()) {
+                viewpoint_position = viewpoint_info->second.position;
+            }
+        }
+
+        // Accumulate priority.
+        for (auto& entry : entity_info) {
+            auto& info = entry.second;
+            float distance = -1.0f;
+            if (viewpoint_position.has_value() && info.position.has_value()) {
+                distance = info.position->Distance(*viewpoint_position);
+            }
+            client_state.priority_accumulator.accumulate(
+                entry.first,
+                replication_priority_.calculate(info.entity->typeId(), distance, info.speed), dt);
+        }
+
+        // Fill the budget. The highest priority entity is always sent, even if it doesn't fit on
+        // its own, to ensure that large entities are not starved forever.
+        auto& batcher = *property_update_batcher_;
+        batcher.begin(server_.get(), &stats_, client_id);
+        u32 bytes_sent = 0;
+        usize entities_queued = 0;
+        for (auto id : client_state.priority_accumulator.sortedByPriority()) {
+            auto info = entity_info.find(id);
+            if (info == entity_info.end()) {
+                client_state.priority_accumulator.remove(id);
+                continue;
+            }
+            u32 estimated_size =
+                static_cast<u32>(info->second.properties.length()) + property_update_overhead;
+            if (bytes_sent > 0 && bytes_sent + estimated_size > replication_budget_) {
+                entities_queued++;
+                continue;
+            }
+            bytes_sent += batcher.add(info->second.net_id, info->second.properties);
+            stats_.recordReplication(client_id, info->second.entity->typeId(),
+                                     static_cast<u32>(info->second.properties.length()));
+            client_state.priority_accumulator.reset(id);
+        }
+        batcher.flush();
+        stats_.setReplicationQueueDepth(client_id, entities_queued);
+        stats_.setTransportStats(client_id, server_->connectionStats(client_id));
     }
 }
 
 void NetInstance::clientUpdate(float dt) {
     client_->update(dt);
+    if (isConnected()) {
+        stats_.setTransportStats(server_connection_id, client_->connectionStats());
+    }
 
     Option<ClientPacket> message = {};
     while (message = client_->receive(), message.has_value()) {
-        auto client_message = GetClientMessage(message->data.data());
+        auto client_message = GetClientMessage(message->data);
+        auto type = client_message->to_client_type();
+        stats_.recordReceived(server_connection_id, static_cast<u8>(type),
+                              EnumNameClientMessageData(type), message->length);
         switch (client_message->to_client_type()) {
             case ClientMessageData_ClientCreateEntity: {
                 // TODO: Create EntitySpawnPipeline and move this code to there.
                 auto* create_entity_message = client_message->to_client_as_ClientCreateEntity();
                 InputBitStream bs(create_entity_message->payload()->data(),
                                   create_entity_message->payload()->size());
-                EntityId remote_entity_id{create_entity_message->entity_id()};
+                auto net_id = NetEntityId::fromValue(create_entity_message->entity_id());
                 EntityType entity_type = create_entity_message->entity_type();
                 auto role = static_cast<NetRole>(create_entity_message->role());
                 if (entity_pipeline_) {
                     Entity* entity = entity_pipeline_->createEntityFromType(entity_type, role);
-                    EntityId local_entity_id = entity->id();
                     if (entity) {
+                        EntityId local_entity_id = entity->id();
+                        if (!net_entities_.insert(net_id, entity)) {
+                            log().error("Received an entity with an invalid ID {}. Ignoring.",
+                                        net_id);
+                            session_->sceneManager()->removeEntity(entity);
+                            break;
+                        }
                         assert(entity->hasComponent<CNetData>());
                         entity->component<CNetData>()->deserialise(bs);
                         entity->component<CNetData>()->role_ = role;
@@ -209,35 +412,32 @@ void NetInstance::clientUpdate(float dt) {
                             log().info(
                                 "Created replicated entity {} corresponding to remote entity {} at "
                                 "{} {} {}.",
-                                local_entity_id, remote_entity_id, entity->transform()->position.x,
+                                local_entity_id, net_id, entity->transform()->position.x,
                                 entity->transform()->position.y, entity->transform()->position.z);
                         } else {
                             log().info(
                                 "Created replicated entity {} corresponding to remote entity {} "
                                 "with no transform.",
-                                local_entity_id, remote_entity_id);
+                                local_entity_id, net_id);
                         }
 
-                        // TODO(David): Handle when an entity is destroyed.
-                        local_to_remote_entity_id_[local_entity_id] = remote_entity_id;
-                        remote_to_local_entity_id_[remote_entity_id] = local_entity_id;
+                        entity->component<CNetData>()->net_id_ = net_id;
 
                         // If any spawn requests are waiting for an entity to be created,
                         // trigger the callback and clear.
-                        if (pending_entity_spawns_.count(remote_entity_id) > 0) {
-                            auto it = outgoing_spawn_requests_.find(
-                                pending_entity_spawns_.at(remote_entity_id));
+                        auto pending_spawn = pending_entity_spawns_.find(net_id.value());
+                        if (pending_spawn != pending_entity_spawns_.end()) {
+                            auto it = outgoing_spawn_requests_.find(pending_spawn->second);
                             if (it != outgoing_spawn_requests_.end()) {
                                 it->second(*entity);
                                 outgoing_spawn_requests_.erase(it);
-                                pending_entity_spawns_.erase(remote_entity_id);
                             } else {
                                 log().error(
                                     "Attempting to trigger an spawn request callback which no "
                                     "longer exists. Entity ID: {}, Request ID: {}",
-                                    entity->id(), pending_entity_spawns_.at(remote_entity_id));
-                                pending_entity_spawns_.erase(remote_entity_id);
+                                    entity->id(), pending_spawn->second);
                             }
+                            pending_entity_spawns_.erase(pending_spawn);
                         }
                     } else {
                         log().error("Failed to spawn an entity of type {}. {} returned nullptr.",
@@ -252,23 +452,32 @@ void NetInstance::clientUpdate(float dt) {
             case ClientMessageData_ClientPropertyUpdateMessage: {
                 auto* replication_message =
                     client_message->to_client_as_ClientPropertyUpdateMessage();
-                InputBitStream bs(replication_message->payload()->data(),
-                                  replication_message->payload()->size());
-                EntityId remote_entity_id{replication_message->entity_id()};
-                auto entity_id_pair = remote_to_local_entity_id_.find(remote_entity_id);
-                if (entity_id_pair != remote_to_local_entity_id_.end()) {
-                    Entity* entity = session_->sceneManager()->findEntity(entity_id_pair->second);
-                    assert(entity);
-                    entity->component<CNetData>()->deserialise(bs);
-                } else {
-                    log().warn(
-                        "Received replication update for entity {} (remote ID: {}) which does not "
-                        "exist on this client. Ignoring.",
-                        entity_id_pair->second, entity_id_pair->first);
+                applyPropertyUpdate(NetEntityId::fromValue(replication_message->entity_id()),
+                                    replication_message->payload()->data(),
+                                    replication_message->payload()->size());
+                break;
+            }
+            case ClientMessageData_ClientPropertyUpdateBatch: {
+                auto* batch_message = client_message->to_client_as_ClientPropertyUpdateBatch();
+                for (auto* update : *batch_message->updates()) {
+                    applyPropertyUpdate(NetEntityId::fromValue(update->entity_id()),
+                                        update->payload()->data(), update->payload()->size());
                 }
                 break;
             }
             case ClientMessageData_ClientDestroyEntity: {
+                auto* destroy_message = client_message->to_client_as_ClientDestroyEntity();
+                auto net_id = NetEntityId::fromValue(destroy_message->entity_id());
+                Entity* entity = net_entities_.find(net_id);
+                if (!entity) {
+                    log().warn("Received destroy for unknown entity {}.", net_id);
+                    break;
+                }
+                log().info("Destroying replicated entity {} corresponding to remote entity {}.",
+                           entity->id(), net_id);
+                net_entities_.remove(net_id);
+                pending_entity_spawns_.erase(net_id.value());
+                session_->sceneManager()->removeEntity(entity);
                 break;
             }
             case ClientMessageData_ClientSpawnResponse: {
@@ -279,15 +488,9 @@ void NetInstance::clientUpdate(float dt) {
                     log().warn("Failed to spawn entity on the server. Request ID: {}",
                                spawn_message->request_id());
                 } else {
-                    EntityId remote_entity_id{spawn_message->entity_id()};
-                    auto entity_id_pair = remote_to_local_entity_id_.find(remote_entity_id);
-                    if (entity_id_pair != remote_to_local_entity_id_.end()) {
-                        // first: remote ID
-                        // second: local ID
-                        Entity* entity =
-                            session_->sceneManager()->findEntity(entity_id_pair->second);
-                        assert(entity);
-
+                    auto net_id = NetEntityId::fromValue(spawn_message->entity_id());
+                    Entity* entity = net_entities_.find(net_id);
+                    if (entity) {
                         auto it = outgoing_spawn_requests_.find(spawn_message->request_id());
                         if (it != outgoing_spawn_requests_.end()) {
                             it->second(*entity);
@@ -296,12 +499,11 @@ void NetInstance::clientUpdate(float dt) {
                             log().warn(
                                 "Received spawn response for an unknown spawn request. Local "
                                 "entity ID: {}, Remote entity ID: {}, Request ID: {}",
-                                entity_id_pair->second, entity_id_pair->first,
-                                spawn_message->request_id());
+                                entity->id(), net_id, spawn_message->request_id());
                         }
                     } else {
                         // Wait for the entity to be created.
-                        pending_entity_spawns_[remote_entity_id] = spawn_message->request_id();
+                        pending_entity_spawns_[net_id.value()] = spawn_message->request_id();
                     }
                 }
                 break;
@@ -313,6 +515,37 @@ void NetInstance::clientUpdate(float dt) {
     }
 }
 
+void NetInstance::applyPropertyUpdate(NetEntityId entity_id, const byte* payload,
+                                      usize length) {
+    Entity* entity = net_entities_.find(entity_id);
+    if (!entity) {
+        log().warn(
+            "Received replication update for remote entity {} which does not exist on this "
+            "client. Ignoring.",
+            entity_id);
+        return;
+    }
+    InputBitStream bs(payload, length);
+    entity->component<CNetData>()->deserialise(bs);
+}
+
+void NetInstance::receiveClientRpc(NetEntityId entity_id, RpcId rpc_id, const byte* payload,
+                                   usize length) {
+    Entity* entity = net_entities_.find(entity_id);
+    if (!entity) {
+        log().error("Client RPC: Received from non-existent entity {}", entity_id);
+        return;
+    }
+    auto net_data = entity->component<CNetData>();
+    if (!net_data) {
+        log().error("Client RPC: Entity {} has no CNetData component.", entity_id);
+        return;
+    }
+    // Read the payload directly from the message.
+    InputBitStream payload_stream(payload, length);
+    net_data->receiveRpc(rpc_id, payload_stream);
+}
+
 NetMode NetInstance::netMode() const {
     if (client_ != nullptr) {
         return NetMode::Client;
@@ -341,8 +574,22 @@ void NetInstance::replicateEntity(const Entity& entity, int authoritative_proxy_
     entity.component<CNetData>()->role_ = NetRole::Authority;
     entity.component<CNetData>()->remote_role_ = NetRole::Proxy;
 
+    // The authoritative proxy client views the world from this entity.
+    if (authoritative_proxy_client >= 0) {
+        client_replication_state_[static_cast<ClientId>(authoritative_proxy_client)].viewpoint =
+            entity.id();
+    }
+
     // Add to replicated entities list.
     if (replicated_entities_.find(entity.id()) == replicated_entities_.end()) {
+        auto net_id =
+            net_entities_.allocate(session_->sceneManager()->findEntity(entity.id()));
+        if (!net_id.isValid()) {
+            log().error("Unable to replicate entity {}. Too many replicated entities.",
+                        entity.id());
+            return;
+        }
+        entity.component<CNetData>()->net_id_ = net_id;
         replicated_entities_.insert(entity.id());
 
         // Serialise replicated properties.
@@ -360,44 +607,98 @@ void NetInstance::replicateEntity(const Entity& entity, int authoritative_proxy_
     }
 }
 
+void NetInstance::unreplicateEntity(const Entity& entity) {
+    if (!server_ || replicated_entities_.erase(entity.id()) == 0) {
+        return;
+    }
+    auto net_id = entity.component<CNetData>()->netId();
+    net_entities_.remove(net_id);
+    replicated_entity_state_.erase(entity.id());
+    for (auto& client_state : client_replication_state_) {
+        client_state.second.priority_accumulator.remove(entity.id());
+        if (client_state.second.viewpoint == entity.id()) {
+            client_state.second.viewpoint.reset();
+        }
+    }
+
+    // Send destroy entity message to clients.
+    for (ClientId client_id = 0; client_id < server_->maxConnections(); ++client_id) {
+        if (!server_->isClientConnected(client_id)) {
+            continue;
+        }
+        auto builder = builder_pool_.acquire();
+        auto destroy_entity_message = CreateClientDestroyEntity(*builder, net_id.value());
+        auto message = CreateClientMessage(*builder, ClientMessageData_ClientDestroyEntity,
+                                           destroy_entity_message.Union());
+        builder->Finish(message);
+        sendToClient(*server_, stats_, client_id, ClientMessageData_ClientDestroyEntity,
+                     *builder);
+    }
+}
+
 void NetInstance::setEntityPipeline(SharedPtr<NetEntityPipeline> entity_pipeline) {
     entity_pipeline_ = entity_pipeline;
 }
 
+void NetInstance::setReplicationBudget(u32 bytes_per_tick) {
+    replication_budget_ = bytes_per_tick;
+}
+
+u32 NetInstance::replicationBudget() const {
+    return replication_budget_;
+}
+
+ReplicationPriority& NetInstance::replicationPriority() {
+    return replication_priority_;
+}
+
+const NetStats& NetInstance::stats() const {
+    return stats_;
+}
+
+void NetInstance::setStatsOverlayVisible(bool visible) {
+    if (visible && stats_overlay_ == 0) {
+        stats_overlay_ = session_->ui()->addOverlay([this]() {
+            stats_.drawOverlay(is_server_ ? "Server Network Stats" : "Client Network Stats");
+        });
+    } else if (!visible && stats_overlay_ != 0) {
+        session_->ui()->removeOverlay(stats_overlay_);
+        stats_overlay_ = 0;
+    }
+}
+
 void NetInstance::sendSpawnRequest(EntityType type, std::function<void(Entity&)> callback,
                                    bool authoritative_proxy) {
     assert(netMode() == NetMode::Client);
     assert(isConnected());
     outgoing_spawn_requests_[spawn_request_id_] = std::move(callback);
 
-    flatbuffers::FlatBufferBuilder builder(1024);
+    auto builder = builder_pool_.acquire();
     auto request_message =
-        CreateServerSpawnRequest(builder, spawn_request_id_++, type, authoritative_proxy);
-    auto message =
-        CreateServerMessage(builder, ServerMessageData_ServerSpawnRequest, request_message.Union());
-    builder.Finish(message);
-    client_->send(builder.GetBufferPointer(), builder.GetSize());
+        CreateServerSpawnRequest(*builder, spawn_request_id_++, type, authoritative_proxy);
+    auto message = CreateServerMessage(*builder, ServerMessageData_ServerSpawnRequest,
+                                       request_message.Union());
+    builder->Finish(message);
+    sendToServer(*client_, stats_, ServerMessageData_ServerSpawnRequest, *builder);
 }
 
-void NetInstance::sendRpc(EntityId entity_id, RpcId rpc_id, RpcType type,
-                          const Vector<byte>& payload) {
+void NetInstance::flush() {
+    if (client_ && isConnected()) {
+        rpc_batcher_->flush(client_.get());
+    }
+}
+
+void NetInstance::sendRpc(NetEntityId entity_id, RpcId rpc_id, RpcType type,
+                          RpcChannel channel, const Vector<byte>& payload) {
     assert(isConnected());
     if (type == RpcType::Client) {
         assert(netMode() == NetMode::Client);
 
-        flatbuffers::FlatBufferBuilder builder(1024);
-        auto entity_id_pair = local_to_remote_entity_id_.find(entity_id);
-        if (entity_id_pair != local_to_remote_entity_id_.end()) {
-            auto rpc_message = CreateServerRpc(builder, u64(entity_id_pair->second), rpc_id,
-                                               builder.CreateVector(payload));
-            auto message =
-                CreateServerMessage(builder, ServerMessageData_ServerRpc, rpc_message.Union());
-            builder.Finish(message);
-            client_->send(builder.GetBufferPointer(), builder.GetSize());
+        if (net_entities_.find(entity_id)) {
+            rpc_batcher_->add(client_.get(), channel, entity_id, rpc_id, payload);
         } else {
             log().warn(
-                "Tried to send an RPC to entity {} which has no remote counterpart. Ignoring.",
-                entity_id);
+                "Tried to send an RPC from an entity which has no remote counterpart. Ignoring.");
         }
     } else {
         assert(netMode() == NetMode::Server);
@@ -409,31 +710,21 @@ void NetInstance::sendServerCreateEntity(ClientId client_id, const Entity& entit
                                          const OutputBitStream& properties, NetRole role) {
     assert(netMode() == NetMode::Server);
 
-    flatbuffers::FlatBufferBuilder builder(1024);
+    auto builder = builder_pool_.acquire();
     auto create_entity_message = CreateClientCreateEntity(
-        builder, u64(entity.id()), entity.typeId(), static_cast<::NetRole>(role),
-        builder.CreateVector(properties.data(), properties.length()));
-    auto message = CreateClientMessage(builder, ClientMessageData_ClientCreateEntity,
+        *builder, entity.component<CNetData>()->netId().value(), entity.typeId(),
+        static_cast<::NetRole>(role),
+        builder->CreateVector(properties.data(), properties.length()));
+    auto message = CreateClientMessage(*builder, ClientMessageData_ClientCreateEntity,
                                        create_entity_message.Union());
-    builder.Finish(message);
-    server_->send(client_id, builder.GetBufferPointer(), builder.GetSize());
-}
-
-void NetInstance::sendServerPropertyReplication(ClientId client_id, const Entity& entity,
-                                                const OutputBitStream& properties) {
-    assert(netMode() == NetMode::Server);
-
-    flatbuffers::FlatBufferBuilder builder(1024);
-    auto property_update_message = CreateClientPropertyUpdateMessage(
-        builder, u64(entity.id()), builder.CreateVector(properties.data(), properties.length()));
-    auto message = CreateClientMessage(builder, ClientMessageData_ClientPropertyUpdateMessage,
-                                       property_update_message.Union());
-    builder.Finish(message);
-    server_->send(client_id, builder.GetBufferPointer(), builder.GetSize());
+    builder->Finish(message);
+    sendToClient(*server_, stats_, client_id, ClientMessageData_ClientCreateEntity, *builder);
 }
 
 void NetInstance::onServerClientConnected(ClientId client_id) {
     log().info("Client ID {} connected.", client_id);
+    client_replication_state_[client_id] = {};
+    stats_.resetConnection(client_id);
 
     // Send replicated entities to client.
     for (auto entity_id : replicated_entities_) {
@@ -453,6 +744,8 @@ void NetInstance::onServerClientConnected(ClientId client_id) {
 
 void NetInstance::onServerClientDisconnected(ClientId client_id) {
     log().info("Client ID {} disconnected.", client_id);
+    client_replication_state_.erase(client_id);
+    stats_.removeConnection(client_id);
 
     // Trigger event.
     session_->eventSystem()->triggerEvent<ServerClientDisconnectedEvent>(client_id);
@@ -7,14 +7,23 @@
 #include "scene/Entity.h"
 #include "net/NetMode.h"
 #include "net/CNetData.h"
+#include "net/FlatBufferBuilderPool.h"
+#include "net/NetEntityId.h"
 #include "net/NetEntityPipeline.h"
+#include "net/NetStats.h"
+#include "net/PriorityAccumulator.h"
 #include "scene/SceneManager.h"
+#include "ui/UserInterface.h"
 
 #include "net/transport/Transport.h"
+#include "net/transport/ReplayTransport.h"
+#include "net/transport/SimulatedTransport.h"
 
 namespace dw {
 class GameSession;
-enum class NetTransport { ReliableUDP, InProcess };
+class PropertyUpdateBatcher;
+class RpcBatcher;
+enum class NetTransport { ReliableUDP, InProcess, Replay };
 
 using RequestId = u64;
 
@@ -25,7 +34,11 @@ public:
     static UniquePtr<NetInstance> connect(Context* context, GameSession* session,
                                           const String& host, u16 port, NetTransport transport = NetTransport::ReliableUDP);
     static UniquePtr<NetInstance> listen(Context* context, GameSession* session, const String& host,
-                                         u16 port, u16 max_clients, NetTransport transport = NetTransport::ReliableUDP);
+                                         u16 port, u16 max_clients, NetTransport transport = NetTransport::ReliableUDP,
+                                         bool network_thread = false);
+    // Plays back the messages sent to a client in a replay recorded by a server.
+    static UniquePtr<NetInstance> playback(Context* context, GameSession* session,
+                                           const Path& replay_path, ClientId client = 0);
 
     NetInstance(Context* context, GameSession* session, NetTransport transport);
     virtual ~NetInstance();
@@ -42,6 +55,23 @@ public:
     // Send/receive messages.
     void update(float dt);
 
+    // Send any RPCs queued since the last flush. Called once per tick after the game has updated.
+    void flush();
+
+    // Runs the server transport on a dedicated network thread, so that socket I/O and validating
+    // received messages happen off the game thread. Takes effect from the next call to listen().
+    // Not supported by the in process transport, which is always driven by the game thread.
+    void setNetworkThreadEnabled(bool enabled);
+
+    // Simulates network conditions by routing all packets through a SimulatedServer or
+    // SimulatedClient. Applies to the current connection, and any later connections.
+    void setNetworkConditions(const NetworkConditions& conditions);
+
+    // Records every message sent and received by the server into a replay, which can be played
+    // back with playback(). Applies to the current server, and any later calls to listen(). The
+    // replay is finished when the server disconnects.
+    Result<void> startRecording(const Path& path);
+
 private:
     // Server update.
     void serverUpdate(float dt);
@@ -49,6 +79,12 @@ private:
     // Client update.
     void clientUpdate(float dt);
 
+    // Applies a replicated property update to the local counterpart of a remote entity.
+    void applyPropertyUpdate(NetEntityId entity_id, const byte* payload, usize length);
+
+    // Invokes an RPC received from a client on the server.
+    void receiveClientRpc(NetEntityId entity_id, RpcId rpc_id, const byte* payload, usize length);
+
 public:
     // Return current net mode.
     NetMode netMode() const;
@@ -60,40 +96,96 @@ public:
     // authoritative_proxy_client indicates a client which should receive the entity with Role =
     // AuthoritativeProxy. -1 for none.
     void replicateEntity(const Entity& entity, int authoritative_proxy_client = -1);
+    // Stops replicating an entity, and destroys it on every client. Must be called before a
+    // replicated entity is removed from the scene.
+    void unreplicateEntity(const Entity& entity);
     void setEntityPipeline(SharedPtr<NetEntityPipeline> entity_pipeline);
 
+    // Replication bandwidth.
+    // Sets the maximum number of bytes of replicated property updates sent to each client per
+    // tick. Entities which don't fit are sent in a later tick, in order of accumulated priority.
+    void setReplicationBudget(u32 bytes_per_tick);
+    u32 replicationBudget() const;
+    ReplicationPriority& replicationPriority();
+
+    // Network statistics of each connection.
+    const NetStats& stats() const;
+
+    // Shows a window with the network statistics of each connection, drawn as an overlay of the
+    // session's user interface.
+    void setStatsOverlayVisible(bool visible);
+
     // RPCs.
     void sendSpawnRequest(EntityType type, std::function<void(Entity&)> callback,
                           bool authoritative_proxy = false);
-    void sendRpc(EntityId entity_id, RpcId rpc_id, RpcType type, const Vector<byte>& payload);
+    // Queues an RPC to be sent in the next flush().
+    void sendRpc(NetEntityId entity_id, RpcId rpc_id, RpcType type, RpcChannel channel,
+                 const Vector<byte>& payload);
 
 private:
     GameSession* session_;
     const NetTransport transport_;
 
     bool is_server_;
+    bool network_thread_enabled_;
     UniquePtr<TransportClient> client_;
     UniquePtr<TransportServer> server_;
 
+    Option<NetworkConditions> network_conditions_;
+    SimulatedClient* simulated_client_;
+    SimulatedServer* simulated_server_;
+
+    Option<Path> record_path_;
+    RecordingServer* recording_server_;
+
+    // Replay played back by the Replay transport.
+    Path replay_path_;
+    ClientId replay_client_;
+
     SharedPtr<NetEntityPipeline> entity_pipeline_;
     HashSet<EntityId> replicated_entities_;
 
-    // Entity ID mapper
-    HashMap<EntityId, EntityId> remote_to_local_entity_id_; // mapping from remote -> local
-    HashMap<EntityId, EntityId> local_to_remote_entity_id_; // mapping from local -> remote
+    // Builders used to construct outgoing messages.
+    FlatBufferBuilderPool builder_pool_;
+
+    // Replicated entities by network ID. On the server, IDs are allocated from this table. On a
+    // client, this maps IDs received from the server to local entities.
+    NetEntityTable net_entities_;
 
     // Client only.
     RequestId spawn_request_id_;
     HashMap<RequestId, std::function<void(Entity&)>> outgoing_spawn_requests_;
-    HashMap<EntityId, RequestId> pending_entity_spawns_; // mapping from remote entity ID -> request ID
+    HashMap<u32, RequestId> pending_entity_spawns_; // mapping from NetEntityId value -> request ID
+    UniquePtr<RpcBatcher> rpc_batcher_;
 
     // Server only.
+    // Per tick replication data for a single entity, shared between all clients. Kept between
+    // ticks so that the serialisation buffers are reused.
+    struct ReplicatedEntityState {
+        Entity* entity;
+        NetEntityId net_id;
+        OutputBitStream properties;
+        Option<Vec3> position;
+        float speed;
+    };
+    HashMap<EntityId, ReplicatedEntityState> replicated_entity_state_;
+    UniquePtr<PropertyUpdateBatcher> property_update_batcher_;
+
+    struct ClientReplicationState {
+        PriorityAccumulator priority_accumulator;
+        Option<EntityId> viewpoint;  // Entity used to calculate distance based priority.
+        u32 last_rpc_sequence = 0;   // Sequence of the last unreliable sequenced RPC batch.
+    };
+    HashMap<ClientId, ClientReplicationState> client_replication_state_;
+    ReplicationPriority replication_priority_;
+    u32 replication_budget_;
+
+    NetStats stats_;
+    UserInterface::OverlayId stats_overlay_;  // 0 if the overlay is hidden.
 
 private:
     void sendServerCreateEntity(ClientId client_id, const Entity& entity,
                                 const OutputBitStream& properties, NetRole role);
-    void sendServerPropertyReplication(ClientId client_id, const Entity& entity,
-                                       const OutputBitStream& properties);
 
     void onServerClientConnected(ClientId client_id);
     void onServerClientDisconnected(ClientId client_id);
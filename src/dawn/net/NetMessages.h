@@ -0,0 +1,37 @@
+/*
+ * Dawn Engine
+ * Written by David Avedissian (c) 2012-2019 (git@dga.dev)
+ */
+#pragma once
+
+#include "net/NetStats.h"
+#include "net/transport/Transport.h"
+
+// The generated protocol headers are private to the engine, so this header is only included by
+// the networking implementation and its tests.
+#include "protocol_generated.h"
+#include "to_client_generated.h"
+#include "to_server_generated.h"
+
+namespace dw {
+// On a client, the ID of the connection to the server in the stats.
+const ClientId server_connection_id = 0;
+
+// Sends a finished ClientMessage of the given type to a client, and records it in the stats.
+inline void sendToClient(TransportServer& server, NetStats& stats, ClientId client_id,
+                         ClientMessageData type, const flatbuffers::FlatBufferBuilder& builder,
+                         TransportChannel channel = TransportChannel::Reliable) {
+    stats.recordSent(client_id, static_cast<u8>(type), EnumNameClientMessageData(type),
+                     builder.GetSize());
+    server.send(client_id, builder.GetBufferPointer(), builder.GetSize(), channel);
+}
+
+// Sends a finished ServerMessage of the given type to the server, and records it in the stats.
+inline void sendToServer(TransportClient& client, NetStats& stats, ServerMessageData type,
+                         const flatbuffers::FlatBufferBuilder& builder,
+                         TransportChannel channel = TransportChannel::Reliable) {
+    stats.recordSent(server_connection_id, static_cast<u8>(type), EnumNameServerMessageData(type),
+                     builder.GetSize());
+    client.send(builder.GetBufferPointer(), builder.GetSize(), channel);
+}
+}  // namespace dw
@@ -0,0 +1,289 @@
+/*
+ * Dawn Engine
+ * Written by David Avedissian (c) 2012-2019 (git@dga.dev)
+ */
+#include <benchmark/benchmark.h>
+
+#include "Base.h"
+#include "core/GameSession.h"
+#include "core/io/FileSystem.h"
+#include "core/Timer.h"
+#include "net/CNetTransform.h"
+#include "renderer/Renderer.h"
+#include "resource/ResourceCache.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+// Count every heap allocation made by the process, so that benchmarks can report allocations per
+// tick.
+namespace {
+std::atomic<std::size_t> allocation_count{0};
+}  // namespace
+
+void* operator new(std::size_t size) {
+    allocation_count.fetch_add(1, std::memory_order_relaxed);
+    void* ptr = std::malloc(size == 0 ? 1 : size);
+    if (!ptr) {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+void operator delete(void* ptr) noexcept {
+    std::free(ptr);
+}
+
+namespace {
+const dw::u16 benchmark_port = 20000;
+const float time_per_update = 1.0f / 60.0f;
+const dw::EntityType projectile_type = dw::Hash("Projectile");
+
+// A projectile with the same replicated properties as the shooters CProjectile.
+struct CBenchmarkProjectile : public dw::Component {
+    int type = 0;
+    dw::Vec3 position = dw::Vec3::zero;
+    dw::Vec3 direction = dw::Vec3::unitZ;
+    dw::Vec3 velocity = dw::Vec3::zero;
+    dw::Colour colour;
+
+    static dw::RepLayout repLayout() {
+        return {{dw::RepProperty::bind<CBenchmarkProjectile>(&CBenchmarkProjectile::type),
+                 dw::RepProperty::bind<CBenchmarkProjectile>(&CBenchmarkProjectile::position),
+                 dw::RepProperty::bind<CBenchmarkProjectile>(&CBenchmarkProjectile::direction),
+                 dw::RepProperty::bind<CBenchmarkProjectile>(&CBenchmarkProjectile::velocity),
+                 dw::RepProperty::bind<CBenchmarkProjectile>(&CBenchmarkProjectile::colour)},
+                {}};
+    }
+};
+
+dw::Entity& createProjectile(dw::GameSession& session) {
+    return session.sceneManager()
+        ->createEntity(projectile_type)
+        .addComponent<dw::CNetTransform>()
+        .addComponent<CBenchmarkProjectile>()
+        .addComponent<dw::CNetData>(
+            session.net(), dw::RepLayout::build<dw::CNetTransform, CBenchmarkProjectile>());
+}
+
+class BenchmarkEntityPipeline : public dw::NetEntityPipeline {
+public:
+    BenchmarkEntityPipeline(dw::Context* ctx, dw::GameSession* session)
+        : dw::NetEntityPipeline(ctx), session_(session) {
+    }
+
+    dw::Entity* createEntityFromType(dw::EntityType type, dw::NetRole) override {
+        if (type != projectile_type) {
+            return nullptr;
+        }
+        return &createProjectile(*session_);
+    }
+
+private:
+    dw::GameSession* session_;
+};
+
+// A server session replicating a number of moving projectiles to a number of client sessions,
+// all connected with the in process transport.
+class ReplicationWorld {
+public:
+    ReplicationWorld(int num_clients, int num_entities)
+        : num_clients_(num_clients), num_entities_(num_entities) {
+        context_ = dw::makeUnique<dw::Context>("", "");
+        context_->addModule<dw::FileSystem>();
+        context_->addModule<dw::Logger>();
+        auto* renderer = context_->addModule<dw::Renderer>();
+        auto renderer_result = renderer->rhi()->init(dw::gfx::RendererType::Null, 1280, 800, "",
+                                                     dw::gfx::InputCallbacks{}, false);
+        if (!renderer_result) {
+            context_->module<dw::Logger>()->error("Renderer failed to initialise: {}",
+                                                  renderer_result.error());
+            std::abort();
+        }
+        context_->addModule<dw::ResourceCache>();
+
+        // Start the server and spawn the entities.
+        dw::GameSessionInfo server_info;
+        dw::GameSessionInfo::CreateNetGame create_info;
+        create_info.port = benchmark_port;
+        create_info.max_clients = static_cast<dw::u16>(num_clients);
+        create_info.transport = dw::NetTransport::InProcess;
+        server_info.start_info = create_info;
+        server_info.headless = true;
+        server_ = dw::makeUnique<dw::GameSession>(context_.get(), server_info);
+        server_->net()->setEntityPipeline(
+            dw::makeShared<BenchmarkEntityPipeline>(context_.get(), server_.get()));
+        for (int i = 0; i < num_entities; ++i) {
+            auto& entity = createProjectile(*server_);
+            auto& transform = entity.component<dw::CNetTransform>()->transform_state;
+            transform.position = {static_cast<float>(i % 100), static_cast<float>(i / 100), 0.0f};
+            transform.velocity = {0.0f, 0.0f, 10.0f + static_cast<float>(i % 10)};
+            server_->net()->replicateEntity(entity);
+            entities_.emplace_back(&entity);
+        }
+
+        // Connect the clients.
+        for (int i = 0; i < num_clients; ++i) {
+            dw::GameSessionInfo client_info;
+            dw::GameSessionInfo::JoinNetGame join_info;
+            join_info.port = benchmark_port;
+            join_info.transport = dw::NetTransport::InProcess;
+            client_info.start_info = join_info;
+            client_info.headless = true;
+            auto client = dw::makeUnique<dw::GameSession>(context_.get(), client_info);
+            client->net()->setEntityPipeline(
+                dw::makeShared<BenchmarkEntityPipeline>(context_.get(), client.get()));
+            clients_.emplace_back(std::move(client));
+        }
+        for (int i = 0; i < 100 && !allClientsConnected(); ++i) {
+            tick();
+        }
+        if (!allClientsConnected()) {
+            context_->module<dw::Logger>()->error(
+                "Clients failed to connect to the benchmark server.");
+            std::abort();
+        }
+
+        // Give the clients a chance to receive every entity.
+        tick();
+        tick();
+    }
+
+    ~ReplicationWorld() {
+        clients_.clear();
+        server_.reset();
+        context_.reset();
+    }
+
+    int numClients() const {
+        return num_clients_;
+    }
+
+    int numEntities() const {
+        return num_entities_;
+    }
+
+    // Moves every entity on the server.
+    void moveEntities() {
+        for (auto* entity : entities_) {
+            auto& transform = entity->component<dw::CNetTransform>()->transform_state;
+            transform.time += time_per_update;
+            transform.position += transform.velocity * time_per_update;
+            auto& projectile = *entity->component<CBenchmarkProjectile>();
+            projectile.position = transform.position;
+            projectile.velocity = transform.velocity;
+        }
+    }
+
+    void updateServer() {
+        updateSession(*server_);
+    }
+
+    void updateClients() {
+        for (auto& client : clients_) {
+            updateSession(*client);
+        }
+    }
+
+    void tick() {
+        moveEntities();
+        updateServer();
+        updateClients();
+    }
+
+    // Total bytes received by all clients.
+    dw::u64 clientBytesReceived() const {
+        dw::u64 bytes = 0;
+        for (auto& client : clients_) {
+            bytes += client->net()->stats().totalReceived().bytes;
+        }
+        return bytes;
+    }
+
+private:
+    int num_clients_;
+    int num_entities_;
+    dw::UniquePtr<dw::Context> context_;
+    dw::UniquePtr<dw::GameSession> server_;
+    dw::Vector<dw::UniquePtr<dw::GameSession>> clients_;
+    dw::Vector<dw::Entity*> entities_;
+
+    static void updateSession(dw::GameSession& session) {
+        session.preUpdate();
+        session.update(time_per_update);
+        session.postUpdate();
+    }
+
+    bool allClientsConnected() const {
+        for (auto& client : clients_) {
+            if (!client->net()->isConnected()) {
+                return false;
+            }
+        }
+        return true;
+    }
+};
+
+// Benchmarks are run several times to pick an iteration count, so the world is kept between runs
+// with the same arguments instead of being set up again.
+ReplicationWorld& replicationWorld(int num_clients, int num_entities) {
+    static dw::UniquePtr<ReplicationWorld> world;
+    if (!world || world->numClients() != num_clients || world->numEntities() != num_entities) {
+        world.reset();
+        world = dw::makeUnique<ReplicationWorld>(num_clients, num_entities);
+    }
+    return *world;
+}
+}  // namespace
+
+// Measures a full tick of the server and every client. Reports:
+//   server_tick_us: Time spent updating the server per tick.
+//   client_apply_us: Time spent updating each client per tick, which is dominated by applying
+//     received updates.
+//   bytes_per_client_per_s: Bytes received by each client per second of game time.
+//   allocs_per_tick: Heap allocations made by the server per tick.
+static void BM_ReplicationTick(benchmark::State& state) {
+    int num_clients = static_cast<int>(state.range(0));
+    int num_entities = static_cast<int>(state.range(1));
+    auto& world = replicationWorld(num_clients, num_entities);
+
+    double server_time = 0.0;
+    double client_time = 0.0;
+    std::size_t server_allocations = 0;
+    dw::u64 bytes_received_start = world.clientBytesReceived();
+    for (auto _ : state) {
+        world.moveEntities();
+
+        auto server_start = dw::time::beginTiming();
+        std::size_t allocations_start = allocation_count.load(std::memory_order_relaxed);
+        world.updateServer();
+        server_allocations += allocation_count.load(std::memory_order_relaxed) - allocations_start;
+        server_time += dw::time::elapsed(server_start);
+
+        auto client_start = dw::time::beginTiming();
+        world.updateClients();
+        client_time += dw::time::elapsed(client_start);
+    }
+
+    auto ticks = static_cast<double>(state.iterations());
+    if (ticks == 0.0) {
+        return;
+    }
+    double bytes_received = static_cast<double>(world.clientBytesReceived() - bytes_received_start);
+    state.counters["server_tick_us"] = server_time * 1e6 / ticks;
+    state.counters["client_apply_us"] = client_time * 1e6 / (ticks * num_clients);
+    state.counters["bytes_per_client_per_s"] =
+        bytes_received / (num_clients * ticks * time_per_update);
+    state.counters["allocs_per_tick"] = static_cast<double>(server_allocations) / ticks;
+}
+BENCHMARK(BM_ReplicationTick)
+    ->ArgNames({"clients", "entities"})
+    ->Args({1, 100})
+    ->Args({1, 1000})
+    ->Args({4, 100})
+    ->Args({4, 1000})
+    ->Args({16, 100})
+    ->Args({16, 1000})
+    ->Args({16, 5000})
+    ->Unit(benchmark::kMicrosecond);
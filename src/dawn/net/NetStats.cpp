@@ -0,0 +1,240 @@
+/*
+ * Dawn Engine
+ * Written by David Avedissian (c) 2012-2019 (git@dga.dev)
+ */
+#include "Base.h"
+#include "net/NetStats.h"
+#include "ui/Imgui.h"
+
+#include <cmath>
+#include <limits>
+
+namespace dw {
+namespace {
+Json messageStatsToJson(const MessageStats& stats) {
+    return Json{{"messages", stats.messages}, {"bytes", stats.bytes}};
+}
+
+Json messageTypesToJson(const Map<u8, MessageTypeStats>& types) {
+    Json json = Json::object();
+    for (auto& type : types) {
+        json[type.second.name] = messageStatsToJson(type.second.total);
+    }
+    return json;
+}
+
+void recordMessage(Map<u8, MessageTypeStats>& types, u8 type, const char* type_name, u32 bytes) {
+    auto& type_stats = types[type];
+    type_stats.name = type_name;
+    type_stats.total.messages++;
+    type_stats.total.bytes += bytes;
+}
+}  // namespace
+
+RollingCounter::RollingCounter(double window_length)
+    : bucket_length_(window_length / bucket_count) {
+    buckets_.fill(0);
+    bucket_index_.fill(std::numeric_limits<i64>::min());
+}
+
+void RollingCounter::add(double time, u64 value) {
+    i64 index = bucketIndex(time);
+    usize slot = static_cast<usize>(index % static_cast<i64>(bucket_count));
+    if (bucket_index_[slot] != index) {
+        bucket_index_[slot] = index;
+        buckets_[slot] = 0;
+    }
+    buckets_[slot] += value;
+}
+
+u64 RollingCounter::total(double time) const {
+    i64 current = bucketIndex(time);
+    u64 total = 0;
+    for (usize slot = 0; slot < bucket_count; ++slot) {
+        if (bucket_index_[slot] <= current &&
+            bucket_index_[slot] > current - static_cast<i64>(bucket_count)) {
+            total += buckets_[slot];
+        }
+    }
+    return total;
+}
+
+double RollingCounter::ratePerSecond(double time) const {
+    return static_cast<double>(total(time)) / windowLength();
+}
+
+double RollingCounter::windowLength() const {
+    return bucket_length_ * bucket_count;
+}
+
+i64 RollingCounter::bucketIndex(double time) const {
+    return static_cast<i64>(std::floor(std::max(time, 0.0) / bucket_length_));
+}
+
+NetStats::NetStats(double window_length) : window_length_(window_length), time_(0.0) {
+}
+
+void NetStats::update(float dt) {
+    time_ += dt;
+}
+
+double NetStats::time() const {
+    return time_;
+}
+
+void NetStats::resetConnection(ClientId connection) {
+    removeConnection(connection);
+    mutableConnection(connection);
+}
+
+void NetStats::removeConnection(ClientId connection) {
+    connections_.erase(connection);
+}
+
+const ConnectionStats* NetStats::connection(ClientId connection) const {
+    auto it = connections_.find(connection);
+    return it != connections_.end() ? &it->second : nullptr;
+}
+
+const Map<ClientId, ConnectionStats>& NetStats::connections() const {
+    return connections_;
+}
+
+MessageStats NetStats::totalSent() const {
+    MessageStats total;
+    for (auto& connection : connections_) {
+        total.messages += connection.second.sent.messages;
+        total.bytes += connection.second.sent.bytes;
+    }
+    return total;
+}
+
+MessageStats NetStats::totalReceived() const {
+    MessageStats total;
+    for (auto& connection : connections_) {
+        total.messages += connection.second.received.messages;
+        total.bytes += connection.second.received.bytes;
+    }
+    return total;
+}
+
+void NetStats::recordSent(ClientId connection, u8 type, const char* type_name, u32 bytes) {
+    auto& stats = mutableConnection(connection);
+    stats.sent.messages++;
+    stats.sent.bytes += bytes;
+    stats.bytes_sent_window.add(time_, bytes);
+    recordMessage(stats.sent_by_type, type, type_name, bytes);
+}
+
+void NetStats::recordReceived(ClientId connection, u8 type, const char* type_name, u32 bytes) {
+    auto& stats = mutableConnection(connection);
+    stats.received.messages++;
+    stats.received.bytes += bytes;
+    stats.bytes_received_window.add(time_, bytes);
+    recordMessage(stats.received_by_type, type, type_name, bytes);
+}
+
+void NetStats::recordReplication(ClientId connection, EntityType entity_type, u32 bytes) {
+    auto& stats = mutableConnection(connection);
+    auto it = stats.replication_by_type.find(entity_type);
+    if (it == stats.replication_by_type.end()) {
+        EntityTypeReplicationStats type_stats;
+        type_stats.bytes_window = RollingCounter(window_length_);
+        it = stats.replication_by_type.emplace(entity_type, type_stats).first;
+    }
+    it->second.updates++;
+    it->second.bytes += bytes;
+    it->second.bytes_window.add(time_, bytes);
+}
+
+void NetStats::recordRpcsSent(ClientId connection, usize count) {
+    mutableConnection(connection).rpcs_sent += count;
+}
+
+void NetStats::recordRpcsReceived(ClientId connection, usize count) {
+    mutableConnection(connection).rpcs_received += count;
+}
+
+void NetStats::setTransportStats(ClientId connection, const TransportConnectionStats& stats) {
+    mutableConnection(connection).transport = stats;
+}
+
+void NetStats::setReplicationQueueDepth(ClientId connection, usize depth) {
+    mutableConnection(connection).replication_queue_depth = depth;
+}
+
+Json NetStats::toJson() const {
+    Json connections = Json::array();
+    for (auto& entry : connections_) {
+        auto& stats = entry.second;
+        Json replication = Json::object();
+        for (auto& type : stats.replication_by_type) {
+            replication[std::to_string(type.first)] = {
+                {"updates", type.second.updates},
+                {"bytes", type.second.bytes},
+                {"bytes_per_second", type.second.bytes_window.ratePerSecond(time_)}};
+        }
+        connections.push_back(
+            {{"id", entry.first},
+             {"sent", messageStatsToJson(stats.sent)},
+             {"received", messageStatsToJson(stats.received)},
+             {"bytes_sent_per_second", stats.bytes_sent_window.ratePerSecond(time_)},
+             {"bytes_received_per_second", stats.bytes_received_window.ratePerSecond(time_)},
+             {"sent_by_type", messageTypesToJson(stats.sent_by_type)},
+             {"received_by_type", messageTypesToJson(stats.received_by_type)},
+             {"replication_by_entity_type", replication},
+             {"rpcs_sent", stats.rpcs_sent},
+             {"rpcs_received", stats.rpcs_received},
+             {"rtt", stats.transport.rtt},
+             {"packet_loss", stats.transport.packet_loss},
+             {"transport_queue_depth", stats.transport.queued_packets},
+             {"replication_queue_depth", stats.replication_queue_depth}});
+    }
+    return Json{{"time", time_}, {"window_length", window_length_}, {"connections", connections}};
+}
+
+void NetStats::drawOverlay(const String& title) const {
+    ImGui::SetNextWindowSize({360, 240}, ImGuiCond_FirstUseEver);
+    if (!ImGui::Begin(title.c_str())) {
+        ImGui::End();
+        return;
+    }
+    for (auto& entry : connections_) {
+        auto& stats = entry.second;
+        String label = str::format("Connection {}", entry.first);
+        if (!ImGui::CollapsingHeader(label.c_str(), ImGuiTreeNodeFlags_DefaultOpen)) {
+            continue;
+        }
+        ImGui::Text("RTT: %.1f ms  Loss: %.1f%%", stats.transport.rtt * 1000.0f,
+                    stats.transport.packet_loss * 100.0f);
+        ImGui::Text("Sent: %.0f B/s  Received: %.0f B/s",
+                    stats.bytes_sent_window.ratePerSecond(time_),
+                    stats.bytes_received_window.ratePerSecond(time_));
+        ImGui::Text("Messages sent: %llu  received: %llu",
+                    static_cast<unsigned long long>(stats.sent.messages),
+                    static_cast<unsigned long long>(stats.received.messages));
+        ImGui::Text("RPCs sent: %llu  received: %llu",
+                    static_cast<unsigned long long>(stats.rpcs_sent),
+                    static_cast<unsigned long long>(stats.rpcs_received));
+        ImGui::Text("Queued packets: %u  Queued entities: %u",
+                    static_cast<unsigned>(stats.transport.queued_packets),
+                    static_cast<unsigned>(stats.replication_queue_depth));
+        for (auto& type : stats.replication_by_type) {
+            ImGui::BulletText("Entity type %u: %.0f B/s", static_cast<unsigned>(type.first),
+                              type.second.bytes_window.ratePerSecond(time_));
+        }
+    }
+    ImGui::End();
+}
+
+ConnectionStats& NetStats::mutableConnection(ClientId connection) {
+    auto it = connections_.find(connection);
+    if (it == connections_.end()) {
+        ConnectionStats stats;
+        stats.bytes_sent_window = RollingCounter(window_length_);
+        stats.bytes_received_window = RollingCounter(window_length_);
+        it = connections_.emplace(connection, stats).first;
+    }
+    return it->second;
+}
+}  // namespace dw
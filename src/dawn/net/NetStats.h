@@ -0,0 +1,127 @@
+/*
+ * Dawn Engine
+ * Written by David Avedissian (c) 2012-2019 (git@dga.dev)
+ */
+#pragma once
+
+#include "core/Context.h"
+#include "scene/Entity.h"
+#include "net/transport/Transport.h"
+
+namespace dw {
+// Sums values added over a sliding window of time. The window is split into a fixed number of
+// buckets, so values leave the window one bucket at a time.
+class DW_API RollingCounter {
+public:
+    static const usize bucket_count = 10;
+
+    // Creates a counter over a window length, in seconds.
+    explicit RollingCounter(double window_length = 1.0);
+
+    // Adds a value at a point in time. Times must not go backwards.
+    void add(double time, u64 value);
+
+    // Total of the values added within the window ending at a point in time.
+    u64 total(double time) const;
+
+    // Total of the values added within the window, per second.
+    double ratePerSecond(double time) const;
+
+    double windowLength() const;
+
+private:
+    double bucket_length_;
+    Array<u64, bucket_count> buckets_;
+    Array<i64, bucket_count> bucket_index_;  // Index of the time slice held by each bucket.
+
+    i64 bucketIndex(double time) const;
+};
+
+struct DW_API MessageStats {
+    u64 messages = 0;
+    u64 bytes = 0;
+};
+
+struct DW_API MessageTypeStats {
+    const char* name = "";  // Name of the message type. Points to static storage.
+    MessageStats total;
+};
+
+struct DW_API EntityTypeReplicationStats {
+    u64 updates = 0;  // Property updates sent.
+    u64 bytes = 0;    // Size of the property updates sent, in bytes.
+    RollingCounter bytes_window;
+};
+
+// Traffic on a single connection, from the point of view of the local side.
+struct DW_API ConnectionStats {
+    MessageStats sent;
+    MessageStats received;
+    RollingCounter bytes_sent_window;
+    RollingCounter bytes_received_window;
+
+    // Messages keyed by message type. Sent and received messages have different type enums.
+    Map<u8, MessageTypeStats> sent_by_type;
+    Map<u8, MessageTypeStats> received_by_type;
+
+    // Replicated property updates sent, keyed by entity type. Only recorded on the server.
+    Map<EntityType, EntityTypeReplicationStats> replication_by_type;
+
+    u64 rpcs_sent = 0;
+    u64 rpcs_received = 0;
+
+    // Measured by the transport.
+    TransportConnectionStats transport;
+
+    // Entities which didn't fit into the replication budget in the last tick. Only recorded on
+    // the server.
+    usize replication_queue_depth = 0;
+};
+
+// Per connection network statistics of a NetInstance. On a server, there's one connection per
+// client. On a client, there's a single connection to the server, with the ID 0.
+class DW_API NetStats {
+public:
+    // Rates are measured over a window length, in seconds.
+    explicit NetStats(double window_length = 1.0);
+
+    // Advances the clock used for rolling windows.
+    void update(float dt);
+    double time() const;
+
+    // Resets the stats of a connection, for example when a new client takes its ID.
+    void resetConnection(ClientId connection);
+    void removeConnection(ClientId connection);
+
+    // Returns the stats of a connection, or nullptr if nothing has been recorded for it.
+    const ConnectionStats* connection(ClientId connection) const;
+    const Map<ClientId, ConnectionStats>& connections() const;
+
+    // Totals across all connections.
+    MessageStats totalSent() const;
+    MessageStats totalReceived() const;
+
+    // Recording.
+    void recordSent(ClientId connection, u8 type, const char* type_name, u32 bytes);
+    void recordReceived(ClientId connection, u8 type, const char* type_name, u32 bytes);
+    void recordReplication(ClientId connection, EntityType entity_type, u32 bytes);
+    void recordRpcsSent(ClientId connection, usize count);
+    void recordRpcsReceived(ClientId connection, usize count);
+    void setTransportStats(ClientId connection, const TransportConnectionStats& stats);
+    void setReplicationQueueDepth(ClientId connection, usize depth);
+
+    // Machine readable dump of every connection.
+    Json toJson() const;
+
+    // Draws an ImGui window showing every connection. Must be called from a UserInterface overlay,
+    // or otherwise between the UI's preUpdate and postUpdate.
+    void drawOverlay(const String& title) const;
+
+private:
+    double window_length_;
+    double time_;
+    Map<ClientId, ConnectionStats> connections_;
+
+    ConnectionStats& mutableConnection(ClientId connection);
+};
+}  // namespace dw
@@ -0,0 +1,101 @@
+/*
+ * Dawn Engine
+ * Written by David Avedissian (c) 2012-2019 (git@dga.dev)
+ */
+#include "Testing.h"
+#include "net/NetStats.h"
+
+TEST(RollingCounterTest, SumsValuesWithinWindow) {
+    dw::RollingCounter counter(1.0);
+    counter.add(0.0, 10);
+    counter.add(0.5, 20);
+    counter.add(0.95, 30);
+    EXPECT_EQ(60u, counter.total(0.95));
+    EXPECT_DOUBLE_EQ(60.0, counter.ratePerSecond(0.95));
+}
+
+TEST(RollingCounterTest, ValuesLeaveWindow) {
+    dw::RollingCounter counter(1.0);
+    counter.add(0.0, 10);
+    counter.add(0.55, 20);
+    EXPECT_EQ(30u, counter.total(0.95));
+    EXPECT_EQ(20u, counter.total(1.05));
+    EXPECT_EQ(0u, counter.total(1.6));
+}
+
+TEST(RollingCounterTest, ReusedBucketsAreCleared) {
+    dw::RollingCounter counter(1.0);
+    counter.add(0.05, 10);
+    counter.add(1.05, 5);
+    EXPECT_EQ(5u, counter.total(1.05));
+}
+
+TEST(RollingCounterTest, WindowLengthIsRespected) {
+    dw::RollingCounter counter(2.0);
+    counter.add(0.0, 100);
+    EXPECT_EQ(100u, counter.total(1.9));
+    EXPECT_DOUBLE_EQ(50.0, counter.ratePerSecond(1.9));
+    EXPECT_EQ(0u, counter.total(2.1));
+}
+
+TEST(NetStatsTest, RecordsMessagesPerConnectionAndType) {
+    dw::NetStats stats;
+    stats.recordSent(0, 1, "A", 100);
+    stats.recordSent(0, 1, "A", 50);
+    stats.recordSent(0, 2, "B", 10);
+    stats.recordSent(1, 1, "A", 20);
+    stats.recordReceived(1, 3, "C", 7);
+
+    auto* connection = stats.connection(0);
+    ASSERT_NE(nullptr, connection);
+    EXPECT_EQ(3u, connection->sent.messages);
+    EXPECT_EQ(160u, connection->sent.bytes);
+    EXPECT_EQ(2u, connection->sent_by_type.at(1).total.messages);
+    EXPECT_EQ(150u, connection->sent_by_type.at(1).total.bytes);
+    EXPECT_STREQ("B", connection->sent_by_type.at(2).name);
+    EXPECT_EQ(180u, stats.totalSent().bytes);
+    EXPECT_EQ(7u, stats.totalReceived().bytes);
+    EXPECT_EQ(nullptr, stats.connection(2));
+}
+
+TEST(NetStatsTest, RecordsReplicationPerEntityType) {
+    dw::NetStats stats(1.0);
+    stats.recordReplication(0, 1, 40);
+    stats.recordReplication(0, 1, 60);
+    stats.recordReplication(0, 2, 8);
+    stats.update(0.5f);
+
+    auto& replication = stats.connection(0)->replication_by_type;
+    EXPECT_EQ(2u, replication.at(1).updates);
+    EXPECT_EQ(100u, replication.at(1).bytes);
+    EXPECT_EQ(100u, replication.at(1).bytes_window.total(stats.time()));
+    EXPECT_EQ(8u, replication.at(2).bytes);
+}
+
+TEST(NetStatsTest, ResetConnectionClearsStats) {
+    dw::NetStats stats;
+    stats.recordSent(0, 1, "A", 100);
+    stats.recordRpcsSent(0, 3);
+    stats.resetConnection(0);
+    ASSERT_NE(nullptr, stats.connection(0));
+    EXPECT_EQ(0u, stats.connection(0)->sent.bytes);
+    EXPECT_EQ(0u, stats.connection(0)->rpcs_sent);
+}
+
+TEST(NetStatsTest, DumpsToJson) {
+    dw::NetStats stats;
+    stats.recordSent(3, 1, "ClientCreateEntity", 100);
+    stats.recordRpcsReceived(3, 2);
+    dw::TransportConnectionStats transport;
+    transport.rtt = 0.05f;
+    stats.setTransportStats(3, transport);
+
+    auto json = stats.toJson();
+    ASSERT_EQ(1u, json["connections"].size());
+    auto& connection = json["connections"][0];
+    EXPECT_EQ(3, connection["id"].get<int>());
+    EXPECT_EQ(100u, connection["sent"]["bytes"].get<dw::u64>());
+    EXPECT_EQ(1u, connection["sent_by_type"]["ClientCreateEntity"]["messages"].get<dw::u64>());
+    EXPECT_EQ(2u, connection["rpcs_received"].get<dw::u64>());
+    EXPECT_FLOAT_EQ(0.05f, connection["rtt"].get<float>());
+}
@@ -0,0 +1,63 @@
+/*
+ * Dawn Engine
+ * Written by David Avedissian (c) 2012-2019 (git@dga.dev)
+ */
+#pragma once
+
+#include "net/Sequence.h"
+
+namespace dw {
+using InputSequence = SequenceNumber;
+
+// Client side prediction history of an entity controlled by the local client.
+//
+// Each tick, the client applies its input locally to predict the entity's next state, sends the
+// input to the server tagged with a sequence number, and records both here. When an authoritative
+// state arrives for a sequence number, every input up to it is discarded. If the state the client
+// predicted for that input differs from the authoritative state, the client rewinds to the
+// authoritative state and replays the remaining inputs on top of it.
+template <typename Input, typename State> class PredictionBuffer {
+public:
+    struct Entry {
+        InputSequence sequence;
+        float dt;
+        Input input;
+        State state;  // Predicted state after applying the input.
+    };
+
+    explicit PredictionBuffer(usize capacity = 128);
+
+    // Sequence number which will be assigned to the next input.
+    InputSequence nextSequence() const;
+
+    // Records an input which has been applied locally, and the state predicted after applying it.
+    // If the buffer is full, the oldest input is discarded. Returns the inputs sequence number.
+    InputSequence push(float dt, const Input& input, const State& predicted_state);
+
+    // Discards all inputs up to and including a sequence number which the server has applied.
+    // Returns the state predicted after that input, or nothing if it's no longer in the buffer.
+    Option<State> acknowledge(InputSequence sequence);
+
+    // Replays all unacknowledged inputs starting from an authoritative state, using
+    // step(const State&, const Input&, float dt) -> State. The recorded predictions are updated,
+    // and the state after the last input is returned.
+    template <typename StepFunc> State replay(const State& state, StepFunc step);
+
+    // Discards all inputs.
+    void clear();
+
+    usize size() const;
+    const Entry& operator[](usize i) const;
+
+private:
+    Vector<Entry> entries_;
+    usize first_;
+    usize size_;
+    InputSequence next_sequence_;
+
+    Entry& at(usize i);
+};
+}  // namespace dw
+
+// Implementation.
+#include "PredictionBuffer.i.h"
@@ -0,0 +1,76 @@
+/*
+ * Dawn Engine
+ * Written by David Avedissian (c) 2012-2019 (git@dga.dev)
+ */
+
+namespace dw {
+template <typename Input, typename State>
+PredictionBuffer<Input, State>::PredictionBuffer(usize capacity)
+    : entries_(capacity), first_(0), size_(0), next_sequence_(1) {
+    assert(capacity > 0);
+}
+
+template <typename Input, typename State>
+InputSequence PredictionBuffer<Input, State>::nextSequence() const {
+    return next_sequence_;
+}
+
+template <typename Input, typename State>
+InputSequence PredictionBuffer<Input, State>::push(float dt, const Input& input,
+                                                   const State& predicted_state) {
+    if (size_ == entries_.size()) {
+        first_ = (first_ + 1) % entries_.size();
+        size_--;
+    }
+    InputSequence sequence = next_sequence_++;
+    at(size_) = Entry{sequence, dt, input, predicted_state};
+    size_++;
+    return sequence;
+}
+
+template <typename Input, typename State>
+Option<State> PredictionBuffer<Input, State>::acknowledge(InputSequence sequence) {
+    Option<State> predicted_state;
+    while (size_ > 0 && !isNewerSequence(at(0).sequence, sequence)) {
+        if (at(0).sequence == sequence) {
+            predicted_state = at(0).state;
+        }
+        first_ = (first_ + 1) % entries_.size();
+        size_--;
+    }
+    return predicted_state;
+}
+
+template <typename Input, typename State>
+template <typename StepFunc>
+State PredictionBuffer<Input, State>::replay(const State& state, StepFunc step) {
+    State current = state;
+    for (usize i = 0; i < size_; ++i) {
+        Entry& entry = at(i);
+        current = step(current, entry.input, entry.dt);
+        entry.state = current;
+    }
+    return current;
+}
+
+template <typename Input, typename State> void PredictionBuffer<Input, State>::clear() {
+    first_ = 0;
+    size_ = 0;
+}
+
+template <typename Input, typename State> usize PredictionBuffer<Input, State>::size() const {
+    return size_;
+}
+
+template <typename Input, typename State>
+const typename PredictionBuffer<Input, State>::Entry& PredictionBuffer<Input, State>::operator[](
+    usize i) const {
+    assert(i < size_);
+    return entries_[(first_ + i) % entries_.size()];
+}
+
+template <typename Input, typename State>
+typename PredictionBuffer<Input, State>::Entry& PredictionBuffer<Input, State>::at(usize i) {
+    return entries_[(first_ + i) % entries_.size()];
+}
+}  // namespace dw
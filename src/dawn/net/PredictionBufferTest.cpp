@@ -0,0 +1,66 @@
+/*
+ * Dawn Engine
+ * Written by David Avedissian (c) 2012-2019 (git@dga.dev)
+ */
+#include "Testing.h"
+#include "net/PredictionBuffer.h"
+
+namespace {
+// A trivial simulation where the input is a velocity and the state is a position.
+float step(float position, float velocity, float dt) {
+    return position + velocity * dt;
+}
+}  // namespace
+
+TEST(PredictionBufferTest, AssignsSequenceNumbers) {
+    dw::PredictionBuffer<float, float> buffer;
+    dw::InputSequence first = buffer.push(1.0f, 1.0f, 1.0f);
+    dw::InputSequence second = buffer.push(1.0f, 1.0f, 2.0f);
+    EXPECT_TRUE(dw::isNewerSequence(second, first));
+    EXPECT_EQ(second + 1, buffer.nextSequence());
+    EXPECT_EQ(2u, buffer.size());
+}
+
+TEST(PredictionBufferTest, AcknowledgeDiscardsAppliedInputs) {
+    dw::PredictionBuffer<float, float> buffer;
+    dw::InputSequence first = buffer.push(1.0f, 1.0f, 1.0f);
+    dw::InputSequence second = buffer.push(1.0f, 1.0f, 2.0f);
+    buffer.push(1.0f, 1.0f, 3.0f);
+
+    auto predicted = buffer.acknowledge(second);
+    ASSERT_TRUE(predicted.has_value());
+    EXPECT_FLOAT_EQ(2.0f, *predicted);
+    EXPECT_EQ(1u, buffer.size());
+
+    // Inputs which were already discarded have no prediction.
+    EXPECT_FALSE(buffer.acknowledge(first).has_value());
+    EXPECT_EQ(1u, buffer.size());
+}
+
+TEST(PredictionBufferTest, ReplayFromAuthoritativeState) {
+    dw::PredictionBuffer<float, float> buffer;
+    float state = 0.0f;
+    dw::Vector<dw::InputSequence> sequences;
+    for (int i = 0; i < 4; ++i) {
+        state = step(state, 1.0f, 1.0f);
+        sequences.push_back(buffer.push(1.0f, 1.0f, state));
+    }
+
+    // The server applied the first two inputs, but ended up 10 units further along.
+    auto predicted = buffer.acknowledge(sequences[1]);
+    ASSERT_TRUE(predicted.has_value());
+    EXPECT_FLOAT_EQ(2.0f, *predicted);
+    float corrected = buffer.replay(12.0f, step);
+    EXPECT_FLOAT_EQ(14.0f, corrected);
+    EXPECT_FLOAT_EQ(13.0f, buffer[0].state);
+    EXPECT_FLOAT_EQ(14.0f, buffer[1].state);
+}
+
+TEST(PredictionBufferTest, DiscardsOldestWhenFull) {
+    dw::PredictionBuffer<float, float> buffer(2);
+    buffer.push(1.0f, 1.0f, 1.0f);
+    buffer.push(1.0f, 1.0f, 2.0f);
+    buffer.push(1.0f, 1.0f, 3.0f);
+    EXPECT_EQ(2u, buffer.size());
+    EXPECT_FLOAT_EQ(2.0f, buffer[0].state);
+}
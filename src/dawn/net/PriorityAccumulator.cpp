@@ -0,0 +1,92 @@
+/*
+ * Dawn Engine
+ * Written by David Avedissian (c) 2012-2019 (git@dga.dev)
+ */
+#include "Base.h"
+#include "net/PriorityAccumulator.h"
+
+#include <algorithm>
+
+namespace dw {
+ReplicationPriority::ReplicationPriority() : distance_falloff_(2000.0f), velocity_scale_(100.0f) {
+}
+
+void ReplicationPriority::setTypeWeight(EntityType type, float weight) {
+    type_weights_[type] = weight;
+}
+
+float ReplicationPriority::typeWeight(EntityType type) const {
+    auto it = type_weights_.find(type);
+    return it != type_weights_.end() ? it->second : 1.0f;
+}
+
+void ReplicationPriority::setDistanceFalloff(float distance) {
+    assert(distance > 0.0f);
+    distance_falloff_ = distance;
+}
+
+void ReplicationPriority::setVelocityScale(float speed) {
+    assert(speed > 0.0f);
+    velocity_scale_ = speed;
+}
+
+float ReplicationPriority::calculate(EntityType type, float distance, float speed) const {
+    float priority = typeWeight(type);
+
+    // Nearby entities are more important than distant ones.
+    if (distance >= 0.0f) {
+        priority /= 1.0f + distance / distance_falloff_;
+    }
+
+    // Fast moving entities become inaccurate quicker than slow moving ones.
+    priority *= 1.0f + speed / velocity_scale_;
+
+    return priority;
+}
+
+PriorityAccumulator::PriorityAccumulator() {
+}
+
+void PriorityAccumulator::accumulate(EntityId entity_id, float priority, float dt) {
+    accumulated_priority_[entity_id] += priority * dt;
+}
+
+void PriorityAccumulator::reset(EntityId entity_id) {
+    auto it = accumulated_priority_.find(entity_id);
+    if (it != accumulated_priority_.end()) {
+        it->second = 0.0f;
+    }
+}
+
+void PriorityAccumulator::remove(EntityId entity_id) {
+    accumulated_priority_.erase(entity_id);
+}
+
+void PriorityAccumulator::clear() {
+    accumulated_priority_.clear();
+    sort_scratch_.clear();
+    sorted_entities_.clear();
+}
+
+float PriorityAccumulator::priority(EntityId entity_id) const {
+    auto it = accumulated_priority_.find(entity_id);
+    return it != accumulated_priority_.end() ? it->second : 0.0f;
+}
+
+const Vector<EntityId>& PriorityAccumulator::sortedByPriority() {
+    sort_scratch_.clear();
+    sort_scratch_.reserve(accumulated_priority_.size());
+    for (auto& entry : accumulated_priority_) {
+        sort_scratch_.emplace_back(entry.second, entry.first);
+    }
+    std::sort(sort_scratch_.begin(), sort_scratch_.end(),
+              [](const Pair<float, EntityId>& a, const Pair<float, EntityId>& b) {
+                  return a.first > b.first;
+              });
+    sorted_entities_.clear();
+    for (auto& entry : sort_scratch_) {
+        sorted_entities_.emplace_back(entry.second);
+    }
+    return sorted_entities_;
+}
+}  // namespace dw
@@ -0,0 +1,68 @@
+/*
+ * Dawn Engine
+ * Written by David Avedissian (c) 2012-2019 (git@dga.dev)
+ */
+#pragma once
+
+#include "scene/Entity.h"
+
+namespace dw {
+// Computes how important it is to replicate an entity to a particular client right now.
+class DW_API ReplicationPriority {
+public:
+    ReplicationPriority();
+
+    // Sets the weight of an entity type. Types without a weight default to 1.
+    void setTypeWeight(EntityType type, float weight);
+    float typeWeight(EntityType type) const;
+
+    // Distance from the clients viewpoint at which an entity's priority is halved.
+    void setDistanceFalloff(float distance);
+
+    // Speed at which an entity's priority is doubled.
+    void setVelocityScale(float speed);
+
+    // Returns the priority of an entity per second. distance is the distance from the clients
+    // viewpoint, or a negative value if the client has no viewpoint.
+    float calculate(EntityType type, float distance, float speed) const;
+
+private:
+    HashMap<EntityType, float> type_weights_;
+    float distance_falloff_;
+    float velocity_scale_;
+};
+
+// Accumulates replication priority for each entity relative to a single client. Every tick, each
+// entity's accumulator grows by its priority multiplied by the time step, so the accumulated value
+// is proportional to the time since the entity was last sent. Entities are sent highest first, and
+// are reset once they've been sent. Entities which don't fit into a packet keep accumulating
+// priority until they do.
+class DW_API PriorityAccumulator {
+public:
+    PriorityAccumulator();
+
+    // Add priority to an entity, tracking it if it's not already tracked.
+    void accumulate(EntityId entity_id, float priority, float dt);
+
+    // Reset the accumulated priority of an entity (after it's been sent).
+    void reset(EntityId entity_id);
+
+    // Stop tracking an entity.
+    void remove(EntityId entity_id);
+
+    // Stop tracking all entities.
+    void clear();
+
+    // Returns the accumulated priority of an entity, or 0 if it's not tracked.
+    float priority(EntityId entity_id) const;
+
+    // Returns all tracked entities ordered by accumulated priority, highest first. The returned
+    // list is valid until the next call to this function.
+    const Vector<EntityId>& sortedByPriority();
+
+private:
+    HashMap<EntityId, float> accumulated_priority_;
+    Vector<Pair<float, EntityId>> sort_scratch_;
+    Vector<EntityId> sorted_entities_;
+};
+}  // namespace dw
@@ -0,0 +1,55 @@
+/*
+ * Dawn Engine
+ * Written by David Avedissian (c) 2012-2019 (git@dga.dev)
+ */
+#include "Testing.h"
+#include "net/PriorityAccumulator.h"
+
+TEST(ReplicationPriorityTest, TypeWeight) {
+    dw::ReplicationPriority priority;
+    priority.setTypeWeight(1, 4.0f);
+    EXPECT_FLOAT_EQ(4.0f, priority.typeWeight(1));
+    EXPECT_FLOAT_EQ(1.0f, priority.typeWeight(2));
+    EXPECT_FLOAT_EQ(4.0f, priority.calculate(1, -1.0f, 0.0f));
+}
+
+TEST(ReplicationPriorityTest, DistanceAndVelocity) {
+    dw::ReplicationPriority priority;
+    priority.setDistanceFalloff(100.0f);
+    priority.setVelocityScale(10.0f);
+    EXPECT_FLOAT_EQ(0.5f, priority.calculate(0, 100.0f, 0.0f));
+    EXPECT_FLOAT_EQ(2.0f, priority.calculate(0, 0.0f, 10.0f));
+    EXPECT_GT(priority.calculate(0, 10.0f, 0.0f), priority.calculate(0, 1000.0f, 0.0f));
+}
+
+TEST(PriorityAccumulatorTest, SortsHighestFirst) {
+    dw::PriorityAccumulator accumulator;
+    accumulator.accumulate(dw::EntityId{1}, 1.0f, 1.0f);
+    accumulator.accumulate(dw::EntityId{2}, 3.0f, 1.0f);
+    accumulator.accumulate(dw::EntityId{3}, 2.0f, 1.0f);
+    const auto& sorted = accumulator.sortedByPriority();
+    ASSERT_EQ(3u, sorted.size());
+    EXPECT_EQ(dw::EntityId{2}, sorted[0]);
+    EXPECT_EQ(dw::EntityId{3}, sorted[1]);
+    EXPECT_EQ(dw::EntityId{1}, sorted[2]);
+}
+
+TEST(PriorityAccumulatorTest, UnsentEntitiesKeepAccumulating) {
+    dw::PriorityAccumulator accumulator;
+    dw::EntityId low{1}, high{2};
+    accumulator.accumulate(low, 1.0f, 1.0f);
+    accumulator.accumulate(high, 2.0f, 1.0f);
+
+    // Send the high priority entity in the first tick, then the low priority entity should
+    // overtake it in the next tick.
+    accumulator.reset(high);
+    accumulator.accumulate(low, 1.0f, 1.0f);
+    accumulator.accumulate(high, 2.0f, 0.5f);
+    EXPECT_FLOAT_EQ(2.0f, accumulator.priority(low));
+    EXPECT_FLOAT_EQ(1.0f, accumulator.priority(high));
+    EXPECT_EQ(low, accumulator.sortedByPriority()[0]);
+
+    accumulator.remove(low);
+    EXPECT_FLOAT_EQ(0.0f, accumulator.priority(low));
+    EXPECT_EQ(1u, accumulator.sortedByPriority().size());
+}
@@ -0,0 +1,46 @@
+/*
+ * Dawn Engine
+ * Written by David Avedissian (c) 2012-2019 (git@dga.dev)
+ */
+#include "Base.h"
+#include "net/NetMessages.h"
+#include "net/PropertyUpdateBatcher.h"
+
+namespace dw {
+PropertyUpdateBatcher::PropertyUpdateBatcher()
+    : server_(nullptr), stats_(nullptr), client_id_(0), builder_(max_property_update_batch_size) {
+}
+
+void PropertyUpdateBatcher::begin(TransportServer* server, NetStats* stats, ClientId client_id) {
+    assert(updates_.empty());
+    server_ = server;
+    stats_ = stats;
+    client_id_ = client_id;
+}
+
+u32 PropertyUpdateBatcher::add(NetEntityId entity_id, const OutputBitStream& properties) {
+    u32 estimated_size = static_cast<u32>(properties.length()) + property_update_overhead;
+    usize pending_size =
+        builder_.GetSize() + updates_.size() * sizeof(flatbuffers::uoffset_t) + estimated_size;
+    if (!updates_.empty() && pending_size > max_property_update_batch_size) {
+        flush();
+    }
+    auto payload = builder_.CreateVector(properties.data(), properties.length());
+    updates_.emplace_back(CreateClientPropertyUpdateMessage(builder_, entity_id.value(), payload));
+    return estimated_size;
+}
+
+void PropertyUpdateBatcher::flush() {
+    if (updates_.empty()) {
+        return;
+    }
+    auto batch = CreateClientPropertyUpdateBatch(builder_, builder_.CreateVector(updates_));
+    auto message =
+        CreateClientMessage(builder_, ClientMessageData_ClientPropertyUpdateBatch, batch.Union());
+    builder_.Finish(message);
+    sendToClient(*server_, *stats_, client_id_, ClientMessageData_ClientPropertyUpdateBatch,
+                 builder_);
+    builder_.Clear();
+    updates_.clear();
+}
+}  // namespace dw
@@ -0,0 +1,48 @@
+/*
+ * Dawn Engine
+ * Written by David Avedissian (c) 2012-2019 (git@dga.dev)
+ */
+#pragma once
+
+#include "net/BitStream.h"
+#include "net/NetEntityId.h"
+#include "net/NetStats.h"
+#include "net/transport/Transport.h"
+
+#include <flatbuffers/flatbuffers.h>
+
+struct ClientPropertyUpdateMessage;
+
+namespace dw {
+// Maximum size of a single batch of property updates, in bytes. Chosen so that a batch fits in a
+// typical MTU once the transport headers have been added.
+const u32 max_property_update_batch_size = 1200;
+
+// Approximate size of a property update within a batch excluding its payload, in bytes.
+const u32 property_update_overhead = 24;
+
+// Aggregates property updates destined for a single client into ClientPropertyUpdateBatch
+// messages, sending the current batch whenever the next update would push it over
+// max_property_update_batch_size. The batcher is reused for every client, so its builder and
+// update list stay allocated between ticks.
+class DW_API PropertyUpdateBatcher {
+public:
+    PropertyUpdateBatcher();
+
+    // Starts batching updates for a client.
+    void begin(TransportServer* server, NetStats* stats, ClientId client_id);
+
+    // Adds an update to the batch. Returns the estimated number of bytes the update occupies.
+    u32 add(NetEntityId entity_id, const OutputBitStream& properties);
+
+    // Sends any pending updates.
+    void flush();
+
+private:
+    TransportServer* server_;
+    NetStats* stats_;
+    ClientId client_id_;
+    flatbuffers::FlatBufferBuilder builder_;
+    Vector<flatbuffers::Offset<ClientPropertyUpdateMessage>> updates_;
+};
+}  // namespace dw
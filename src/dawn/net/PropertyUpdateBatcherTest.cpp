@@ -0,0 +1,110 @@
+/*
+ * Dawn Engine
+ * Written by David Avedissian (c) 2012-2019 (git@dga.dev)
+ */
+#include "Testing.h"
+#include "net/NetMessages.h"
+#include "net/PropertyUpdateBatcher.h"
+
+namespace {
+// Records every message sent to a client.
+class CapturingServer : public dw::TransportServer {
+public:
+    struct SentMessage {
+        dw::ClientId client;
+        dw::Vector<dw::byte> data;
+    };
+    dw::Vector<SentMessage> sent;
+
+    void listen(const dw::String&, dw::u16, dw::u16) override {
+    }
+    void disconnect() override {
+    }
+    void update(float) override {
+    }
+    void send(dw::ClientId client, const dw::byte* data, dw::u32 length,
+              dw::TransportChannel) override {
+        sent.emplace_back(SentMessage{client, dw::Vector<dw::byte>(data, data + length)});
+    }
+    dw::Option<dw::ServerPacket> receive(dw::ClientId) override {
+        return {};
+    }
+    bool isClientConnected(dw::ClientId) const override {
+        return true;
+    }
+    dw::usize numConnections() const override {
+        return 1;
+    }
+    dw::usize maxConnections() const override {
+        return 1;
+    }
+    dw::ServerConnectionState connectionState() const override {
+        return dw::ServerConnectionState::Listening;
+    }
+};
+}  // namespace
+
+TEST(PropertyUpdateBatcherTest, SmallUpdatesShareABatch) {
+    CapturingServer server;
+    dw::NetStats stats;
+    dw::PropertyUpdateBatcher batcher;
+    batcher.begin(&server, &stats, 2);
+    for (dw::u32 i = 1; i <= 10; ++i) {
+        dw::OutputBitStream properties;
+        properties.write(i);
+        batcher.add(dw::NetEntityId{i, 1}, properties);
+    }
+    batcher.flush();
+    ASSERT_EQ(1u, server.sent.size());
+    EXPECT_EQ(2, server.sent[0].client);
+    auto* message = GetClientMessage(server.sent[0].data.data());
+    ASSERT_EQ(ClientMessageData_ClientPropertyUpdateBatch, message->to_client_type());
+    EXPECT_EQ(10u, message->to_client_as_ClientPropertyUpdateBatch()->updates()->size());
+
+    // Nothing is sent if there are no updates.
+    batcher.begin(&server, &stats, 2);
+    batcher.flush();
+    EXPECT_EQ(1u, server.sent.size());
+}
+
+TEST(PropertyUpdateBatcherTest, SplitsLargeBatches) {
+    CapturingServer server;
+    dw::NetStats stats;
+    dw::PropertyUpdateBatcher batcher;
+    batcher.begin(&server, &stats, 0);
+
+    // Each update is large enough that only a handful fit in a single batch.
+    const dw::u32 update_count = 50;
+    const dw::usize payload_size = 200;
+    for (dw::u32 i = 1; i <= update_count; ++i) {
+        dw::OutputBitStream properties;
+        for (dw::usize b = 0; b < payload_size; ++b) {
+            properties.write(static_cast<dw::u8>(i));
+        }
+        batcher.add(dw::NetEntityId{i, 1}, properties);
+    }
+    batcher.flush();
+    EXPECT_GT(server.sent.size(), 1u);
+
+    // Every update arrives exactly once, intact.
+    dw::Map<dw::u32, int> received;
+    for (auto& sent : server.sent) {
+        flatbuffers::Verifier verifier(sent.data.data(), sent.data.size());
+        ASSERT_TRUE(VerifyClientMessageBuffer(verifier));
+        auto* message = GetClientMessage(sent.data.data());
+        ASSERT_EQ(ClientMessageData_ClientPropertyUpdateBatch, message->to_client_type());
+        auto* updates = message->to_client_as_ClientPropertyUpdateBatch()->updates();
+        EXPECT_LT(updates->size(), update_count);
+        for (auto* update : *updates) {
+            auto id = dw::NetEntityId::fromValue(update->entity_id());
+            received[id.index()]++;
+            ASSERT_EQ(payload_size, update->payload()->size());
+            EXPECT_EQ(static_cast<dw::u8>(id.index()), update->payload()->Get(0));
+        }
+    }
+    ASSERT_EQ(update_count, received.size());
+    for (auto& entry : received) {
+        EXPECT_EQ(1, entry.second) << "Entity " << entry.first;
+    }
+    EXPECT_EQ(server.sent.size(), stats.connection(0)->sent.messages);
+}
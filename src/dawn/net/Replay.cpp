@@ -0,0 +1,224 @@
+/*
+ * Dawn Engine
+ * Written by David Avedissian (c) 2012-2019 (git@dga.dev)
+ */
+#include "Base.h"
+#include "net/Replay.h"
+
+#include <algorithm>
+
+namespace dw {
+namespace {
+const u32 replay_magic = 0x50525744;         // "DWRP"
+const u32 replay_footer_magic = 0x58445257;  // "WRDX"
+const u32 replay_version = 1;
+const usize replay_header_size = sizeof(u32) * 2;
+const usize replay_record_header_size = sizeof(u8) * 2 + sizeof(u16) + sizeof(double) + sizeof(u32);
+const usize replay_index_entry_size = sizeof(double) + sizeof(u64);
+const usize replay_footer_size = sizeof(u64) + sizeof(double) + sizeof(u32) * 2;
+
+// Minimum time between index entries, in seconds.
+const double replay_index_interval = 1.0;
+
+bool shouldIndex(const Vector<Pair<double, u64>>& index, double time) {
+    return index.empty() || time >= index.back().first + replay_index_interval;
+}
+}  // namespace
+
+ReplayWriter::ReplayWriter(Context* ctx) : Object(ctx), last_time_(0.0) {
+}
+
+ReplayWriter::~ReplayWriter() {
+    close();
+}
+
+Result<void> ReplayWriter::open(const Path& path) {
+    close();
+    file_ = makeUnique<File>(context());
+    if (!file_->open(path, FileMode::Write)) {
+        file_.reset();
+        return makeError(str::format("Unable to create replay {}.", path));
+    }
+    file_->write(replay_magic);
+    file_->write(replay_version);
+    index_.clear();
+    last_time_ = 0.0;
+    return Result<void>();
+}
+
+void ReplayWriter::record(double time, ReplayDirection direction, ClientId client,
+                          TransportChannel channel, const byte* data, u32 length) {
+    if (!file_) {
+        return;
+    }
+    if (shouldIndex(index_, time)) {
+        index_.emplace_back(time, static_cast<u64>(file_->position()));
+    }
+    last_time_ = time;
+    file_->write(static_cast<u8>(direction));
+    file_->write(static_cast<u8>(channel));
+    file_->write(static_cast<u16>(client));
+    file_->write(time);
+    file_->write(length);
+    file_->writeData(data, length);
+}
+
+void ReplayWriter::close() {
+    if (!file_) {
+        return;
+    }
+    auto index_offset = static_cast<u64>(file_->position());
+    for (auto& entry : index_) {
+        file_->write(entry.first);
+        file_->write(entry.second);
+    }
+    file_->write(index_offset);
+    file_->write(last_time_);
+    file_->write(static_cast<u32>(index_.size()));
+    file_->write(replay_footer_magic);
+    file_.reset();
+}
+
+bool ReplayWriter::isOpen() const {
+    return file_ != nullptr;
+}
+
+ReplayReader::ReplayReader(Context* ctx) : Object(ctx), records_end_(0), duration_(0.0) {
+}
+
+Result<void> ReplayReader::open(const Path& path) {
+    file_ = makeUnique<File>(context());
+    if (!file_->open(path, FileMode::Read)) {
+        file_.reset();
+        return makeError(str::format("Unable to open replay {}.", path));
+    }
+    u32 magic = 0, version = 0;
+    if (file_->size() >= replay_header_size) {
+        file_->read(magic);
+        file_->read(version);
+    }
+    if (magic != replay_magic || version != replay_version) {
+        file_.reset();
+        return makeError(str::format("{} is not a replay, or has an unsupported version.", path));
+    }
+    if (!readIndex()) {
+        log().warn("Replay {} has no index. Rebuilding it.", path);
+        rebuildIndex();
+    }
+    file_->seek(replay_header_size);
+    return Result<void>();
+}
+
+const ReplayRecord* ReplayReader::next() {
+    if (!file_) {
+        return nullptr;
+    }
+    u32 length;
+    if (!readRecordHeader(record_, length)) {
+        return nullptr;
+    }
+    record_.data.resize(length);
+    if (length > 0) {
+        file_->readData(record_.data.data(), length);
+    }
+    return &record_;
+}
+
+void ReplayReader::seek(double time) {
+    if (!file_) {
+        return;
+    }
+
+    // Start from the last indexed record before the requested time, then skip forward.
+    auto it = std::lower_bound(
+        index_.begin(), index_.end(), time,
+        [](const Pair<double, u64>& entry, double t) { return entry.first < t; });
+    usize offset = it == index_.begin() ? replay_header_size : static_cast<usize>((it - 1)->second);
+    file_->seek(offset);
+    ReplayRecord record;
+    u32 length;
+    while (readRecordHeader(record, length)) {
+        if (record.time >= time) {
+            break;
+        }
+        offset = file_->position() + length;
+        file_->seek(offset);
+    }
+    file_->seek(offset);
+}
+
+double ReplayReader::duration() const {
+    return duration_;
+}
+
+bool ReplayReader::readIndex() {
+    usize size = file_->size();
+    if (size < replay_header_size + replay_footer_size) {
+        return false;
+    }
+    file_->seek(size - replay_footer_size);
+    u64 index_offset;
+    double duration;
+    u32 count, magic;
+    file_->read(index_offset);
+    file_->read(duration);
+    file_->read(count);
+    file_->read(magic);
+    if (magic != replay_footer_magic || index_offset < replay_header_size ||
+        index_offset + count * replay_index_entry_size + replay_footer_size != size) {
+        return false;
+    }
+    file_->seek(static_cast<usize>(index_offset));
+    index_.resize(count);
+    for (auto& entry : index_) {
+        file_->read(entry.first);
+        file_->read(entry.second);
+    }
+    records_end_ = static_cast<usize>(index_offset);
+    duration_ = duration;
+    return true;
+}
+
+void ReplayReader::rebuildIndex() {
+    index_.clear();
+    duration_ = 0.0;
+    records_end_ = file_->size();
+    usize offset = replay_header_size;
+    file_->seek(offset);
+    ReplayRecord record;
+    u32 length;
+    while (readRecordHeader(record, length)) {
+        if (shouldIndex(index_, record.time)) {
+            index_.emplace_back(record.time, static_cast<u64>(offset));
+        }
+        duration_ = record.time;
+        offset = file_->position() + length;
+        file_->seek(offset);
+    }
+
+    // Anything after the last complete record was cut off mid-write.
+    records_end_ = offset;
+}
+
+bool ReplayReader::readRecordHeader(ReplayRecord& record, u32& length) {
+    usize start = file_->position();
+    if (start + replay_record_header_size > records_end_) {
+        return false;
+    }
+    u8 direction, channel;
+    u16 client;
+    file_->read(direction);
+    file_->read(channel);
+    file_->read(client);
+    file_->read(record.time);
+    file_->read(length);
+    if (file_->position() + length > records_end_) {
+        file_->seek(start);
+        return false;
+    }
+    record.direction = static_cast<ReplayDirection>(direction);
+    record.channel = static_cast<TransportChannel>(channel);
+    record.client = static_cast<ClientId>(client);
+    return true;
+}
+}  // namespace dw
@@ -0,0 +1,87 @@
+/*
+ * Dawn Engine
+ * Written by David Avedissian (c) 2012-2019 (git@dga.dev)
+ */
+#pragma once
+
+#include "core/io/File.h"
+#include "net/transport/Transport.h"
+
+namespace dw {
+// A replay is an append-only recording of the messages exchanged between a server and its
+// clients. The file starts with a header, followed by one record per message:
+//
+//   u8 direction | u8 channel | u16 client | f64 time | u32 length | length bytes of data
+//
+// When the recording is closed, an index of (time, offset) pairs is appended, followed by a
+// footer which locates it. The index is used to seek without reading every record. If the
+// recording was never closed (for example, if the server crashed), there's no footer and the
+// index is rebuilt by scanning the records.
+enum class ReplayDirection : u8 {
+    ToClient,  // ClientMessage sent by the server.
+    ToServer   // ServerMessage received by the server.
+};
+
+struct DW_API ReplayRecord {
+    double time;  // Seconds since the start of the recording.
+    ReplayDirection direction;
+    ClientId client;
+    TransportChannel channel;
+    Vector<byte> data;
+};
+
+class DW_API ReplayWriter : public Object {
+public:
+    DW_OBJECT(ReplayWriter);
+
+    ReplayWriter(Context* ctx);
+    ~ReplayWriter();
+
+    // Creates a new recording, replacing any existing file.
+    Result<void> open(const Path& path);
+
+    // Appends a record. Times must not go backwards.
+    void record(double time, ReplayDirection direction, ClientId client, TransportChannel channel,
+                const byte* data, u32 length);
+
+    // Writes the index and closes the file.
+    void close();
+
+    bool isOpen() const;
+
+private:
+    UniquePtr<File> file_;
+    Vector<Pair<double, u64>> index_;  // Offset of the first record of each second.
+    double last_time_;
+};
+
+class DW_API ReplayReader : public Object {
+public:
+    DW_OBJECT(ReplayReader);
+
+    ReplayReader(Context* ctx);
+
+    Result<void> open(const Path& path);
+
+    // Reads the next record. The returned record is valid until the next call to next() or
+    // seek(). Returns nullptr at the end of the recording.
+    const ReplayRecord* next();
+
+    // Moves to the first record at or after a point in time.
+    void seek(double time);
+
+    // Time of the last record.
+    double duration() const;
+
+private:
+    UniquePtr<File> file_;
+    usize records_end_;  // Offset of the end of the last record.
+    Vector<Pair<double, u64>> index_;
+    double duration_;
+    ReplayRecord record_;
+
+    bool readIndex();
+    void rebuildIndex();
+    bool readRecordHeader(ReplayRecord& record, u32& length);
+};
+}  // namespace dw
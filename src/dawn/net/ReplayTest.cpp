@@ -0,0 +1,175 @@
+/*
+ * Dawn Engine
+ * Written by David Avedissian (c) 2012-2019 (git@dga.dev)
+ */
+#include "Testing.h"
+#include "core/io/FileSystem.h"
+#include "net/Replay.h"
+#include "net/transport/ReplayTransport.h"
+
+#include <cstdio>
+
+class ReplayTest : public ::testing::Test {
+public:
+    void SetUp() override {
+        context_ = dw::makeUnique<dw::Context>("", "");
+        context_->addModule<dw::Logger>();
+        path_ = context_->addModule<dw::FileSystem>()->tempDir() + "/dw_replay_test.dwr";
+    }
+
+    void TearDown() override {
+        std::remove(path_.c_str());
+        context_.reset();
+    }
+
+    // Records a message to each of two clients every 0.25 seconds, and a message from
+    // client 1 every second. Each message contains its index.
+    void writeReplay(int messages) {
+        dw::ReplayWriter writer(context_.get());
+        ASSERT_TRUE(writer.open(path_));
+        for (int i = 0; i < messages; ++i) {
+            double time = i * 0.25;
+            dw::byte data = static_cast<dw::byte>(i);
+            writer.record(time, dw::ReplayDirection::ToClient, 0, dw::TransportChannel::Reliable,
+                          &data, 1);
+            writer.record(time, dw::ReplayDirection::ToClient, 1,
+                          dw::TransportChannel::Unreliable, &data, 1);
+            if (i % 4 == 0) {
+                writer.record(time, dw::ReplayDirection::ToServer, 1,
+                              dw::TransportChannel::Reliable, &data, 1);
+            }
+        }
+    }
+
+protected:
+    dw::UniquePtr<dw::Context> context_;
+    dw::Path path_;
+};
+
+TEST_F(ReplayTest, RoundTrip) {
+    writeReplay(8);
+
+    dw::ReplayReader reader(context_.get());
+    ASSERT_TRUE(reader.open(path_));
+    EXPECT_DOUBLE_EQ(1.75, reader.duration());
+
+    auto* record = reader.next();
+    ASSERT_NE(nullptr, record);
+    EXPECT_EQ(dw::ReplayDirection::ToClient, record->direction);
+    EXPECT_EQ(0, record->client);
+    EXPECT_EQ(dw::TransportChannel::Reliable, record->channel);
+    EXPECT_DOUBLE_EQ(0.0, record->time);
+    ASSERT_EQ(1u, record->data.size());
+    EXPECT_EQ(0, record->data[0]);
+
+    int count = 1;
+    while ((record = reader.next()) != nullptr) {
+        count++;
+    }
+    EXPECT_EQ(8 * 2 + 2, count);
+}
+
+TEST_F(ReplayTest, SeekFindsFirstRecordAtTime) {
+    writeReplay(40);
+
+    dw::ReplayReader reader(context_.get());
+    ASSERT_TRUE(reader.open(path_));
+    reader.seek(5.0);
+    auto* record = reader.next();
+    ASSERT_NE(nullptr, record);
+    EXPECT_DOUBLE_EQ(5.0, record->time);
+    EXPECT_EQ(0, record->client);
+    EXPECT_EQ(20, record->data[0]);
+
+    // Seeking backwards and between records.
+    reader.seek(1.1);
+    record = reader.next();
+    ASSERT_NE(nullptr, record);
+    EXPECT_DOUBLE_EQ(1.25, record->time);
+    EXPECT_EQ(0, record->client);
+
+    reader.seek(100.0);
+    EXPECT_EQ(nullptr, reader.next());
+}
+
+TEST_F(ReplayTest, ReadsReplayWithoutIndex) {
+    writeReplay(8);
+
+    // Cut off the index, footer and half of the last record, as if the server crashed while
+    // recording.
+    dw::Vector<dw::byte> contents;
+    {
+        dw::File file(context_.get(), path_, dw::FileMode::Read);
+        contents = file.readAll().value();
+    }
+    const dw::usize header_size = 8, record_size = 16 + 1;
+    contents.resize(header_size + record_size * (8 * 2 + 2) - 5);
+    {
+        dw::File file(context_.get(), path_, dw::FileMode::Write);
+        file.writeData(contents.data(), contents.size());
+    }
+
+    dw::ReplayReader reader(context_.get());
+    ASSERT_TRUE(reader.open(path_));
+    EXPECT_DOUBLE_EQ(1.75, reader.duration());
+    int count = 0;
+    while (reader.next() != nullptr) {
+        count++;
+    }
+    EXPECT_EQ(8 * 2 + 1, count);
+
+    reader.seek(1.0);
+    auto* record = reader.next();
+    ASSERT_NE(nullptr, record);
+    EXPECT_DOUBLE_EQ(1.0, record->time);
+}
+
+TEST_F(ReplayTest, RejectsInvalidFile) {
+    {
+        dw::File file(context_.get(), path_, dw::FileMode::Write);
+        file.write(dw::u32(1234));
+    }
+    dw::ReplayReader reader(context_.get());
+    EXPECT_FALSE(reader.open(path_));
+}
+
+TEST_F(ReplayTest, ClientPlaysBackMessagesAtRecordedTimes) {
+    writeReplay(8);
+
+    bool connected = false, disconnected = false;
+    dw::ReplayClient client(
+        context_.get(), path_, 1, [&connected]() { connected = true; }, []() {},
+        [&disconnected]() { disconnected = true; });
+    client.connect("", 0);
+    EXPECT_EQ(dw::ClientConnectionState::Connecting, client.connectionState());
+
+    // The first message arrives as soon as the client connects.
+    client.update(0.1f);
+    EXPECT_TRUE(connected);
+    auto packet = client.receive();
+    ASSERT_TRUE(packet);
+    EXPECT_EQ(dw::TransportChannel::Unreliable, packet->channel);
+    EXPECT_EQ(0, packet->data[0]);
+    EXPECT_FALSE(client.receive());
+
+    // Messages from the client to the server aren't played back.
+    client.update(0.2f);
+    EXPECT_FALSE(client.receive());
+    client.update(0.1f);
+    packet = client.receive();
+    ASSERT_TRUE(packet);
+    EXPECT_EQ(1, packet->data[0]);
+
+    // Catch up with the rest of the messages in one tick.
+    client.update(10.0f);
+    int count = 0;
+    while (client.receive()) {
+        count++;
+    }
+    EXPECT_EQ(6, count);
+    EXPECT_FALSE(disconnected);
+
+    client.update(0.1f);
+    EXPECT_TRUE(disconnected);
+    EXPECT_EQ(dw::ClientConnectionState::Disconnected, client.connectionState());
+}
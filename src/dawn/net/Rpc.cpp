@@ -9,7 +9,8 @@
 #include "net/NetInstance.h"
 
 namespace dw {
-RpcSender::RpcSender() : entity_(nullptr), logger_(nullptr), rpc_id_(0) {
+RpcSender::RpcSender(RpcChannel channel)
+    : entity_(nullptr), logger_(nullptr), rpc_id_(0), channel_(channel) {
 }
 
 void RpcSender::onAddToEntity(Entity& entity, RpcId rpc_id) {
@@ -18,6 +19,10 @@ void RpcSender::onAddToEntity(Entity& entity, RpcId rpc_id) {
     rpc_id_ = rpc_id;
 }
 
+RpcChannel RpcSender::channel() const {
+    return channel_;
+}
+
 bool RpcSender::shouldShortCircuit(RpcType type) const {
     auto net_data = entity_->component<CNetData>();
     assert(net_data);
@@ -39,6 +44,6 @@ void RpcSender::sendRpcPayload(RpcType type, const OutputBitStream& payload) con
         logger_->warn("Trying to send a client RPC from a non-authoritative proxy.");
         return;
     }
-    net_data->sendRpc(rpc_id_, type, payload.vec_data());
+    net_data->sendRpc(rpc_id_, type, channel_, payload.vec_data());
 }
 }  // namespace dw
@@ -16,6 +16,11 @@ enum class RpcType {
     Client,    // RPCs sent from the authoritative client to the server.
     Multicast  // RPCs sent from the server to all clients.
 };
+enum class RpcChannel {
+    ReliableOrdered,     // Always delivered, in the order they were sent.
+    Unreliable,          // May be lost, duplicated or arrive out of order.
+    UnreliableSequenced  // May be lost, but RPCs older than the last one received are dropped.
+};
 
 // An RPC receiver member function pointer.
 template <typename Component, typename... Args>
@@ -24,7 +29,7 @@ using RpcReceiverFuncPtr = void (Component::*)(const Args&...);
 // Type erased RPC sender object.
 class DW_API RpcSender {
 public:
-    RpcSender();
+    explicit RpcSender(RpcChannel channel = RpcChannel::ReliableOrdered);
     RpcSender(const RpcSender&) = delete;
     RpcSender(RpcSender&&) = default;
     RpcSender& operator=(const RpcSender&) = delete;
@@ -37,7 +42,10 @@ public:
 
     // Implemented when type information about the component and args types are known in the
     // RpcSenderImpl template.
-    virtual void receiveRpcPayload(const Entity& entity, const Vector<byte>& payload) = 0;
+    virtual void receiveRpcPayload(const Entity& entity, InputStream& payload) = 0;
+
+    // Channel which this RPC is sent on.
+    RpcChannel channel() const;
 
 protected:
     bool shouldShortCircuit(RpcType type) const;
@@ -52,23 +60,27 @@ protected:
 private:
     Logger* logger_;
     RpcId rpc_id_;
+    RpcChannel channel_;
 };
 
 // An RPC binding is a closure which returns a reference to an RPC sender instance inside an entity.
 using RpcBinding = Function<RpcSender&(const Entity&)>;
 using RpcBindingList = Vector<RpcBinding>;
 
-// RPC functor object. Used to send RPCs from the client using operator().
+// RPC functor object. Used to send RPCs from the client using operator(). RPCs are queued by the
+// NetInstance and sent in a single batch per channel each tick.
 template <RpcType Type, typename... Args> class DW_API RpcSenderImpl : public RpcSender {
 public:
-    template <typename Component> RpcSenderImpl(RpcReceiverFuncPtr<Component, Args...> receiver);
+    template <typename Component>
+    RpcSenderImpl(RpcReceiverFuncPtr<Component, Args...> receiver,
+                  RpcChannel channel = RpcChannel::ReliableOrdered);
 
     // Send an RPC.
     void send(const Args&... args);
     void operator()(const Args&... args);
 
     // Receive an RPC.
-    void receiveRpcPayload(const Entity& entity, const Vector<byte>& payload) override;
+    void receiveRpcPayload(const Entity& entity, InputStream& payload) override;
 
 private:
     Function<void(const Entity&, const Args&...)> receiver_;
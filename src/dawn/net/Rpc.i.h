@@ -8,7 +8,9 @@
 namespace dw {
 template <RpcType Type, typename... Args>
 template <typename Component>
-RpcSenderImpl<Type, Args...>::RpcSenderImpl(RpcReceiverFuncPtr<Component, Args...> receiver) {
+RpcSenderImpl<Type, Args...>::RpcSenderImpl(RpcReceiverFuncPtr<Component, Args...> receiver,
+                                            RpcChannel channel)
+    : RpcSender(channel) {
     receiver_ = [receiver](const Entity& entity, const Args&... args) {
         (entity.component<Component>()->*receiver)(args...);
     };
@@ -42,9 +44,8 @@ void RpcSenderImpl<Type, Args...>::send(const Args&... args) {
 
 template <RpcType Type, typename... Args>
 void RpcSenderImpl<Type, Args...>::receiveRpcPayload(const Entity& entity,
-                                                     const Vector<byte>& payload) {
-    InputBitStream bs(payload);
-    receiver_(entity, stream::read<Args>(bs)...);
+                                                     InputStream& payload) {
+    receiver_(entity, stream::read<Args>(payload)...);
 }
 
 template <typename Component, RpcType Type, typename... Args>
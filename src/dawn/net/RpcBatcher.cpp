@@ -0,0 +1,78 @@
+/*
+ * Dawn Engine
+ * Written by David Avedissian (c) 2012-2019 (git@dga.dev)
+ */
+#include "Base.h"
+#include "net/NetMessages.h"
+#include "net/RpcBatcher.h"
+
+namespace dw {
+RpcBatcher::RpcBatcher(NetStats* stats) : stats_(stats), next_sequence_(1) {
+    for (auto& batch : batches_) {
+        batch.builder = makeUnique<flatbuffers::FlatBufferBuilder>(max_rpc_batch_size);
+    }
+}
+
+void RpcBatcher::add(TransportClient* client, RpcChannel channel, NetEntityId entity_id,
+                     RpcId rpc_id, const Vector<byte>& payload) {
+    auto& batch = batches_[static_cast<usize>(channel)];
+    usize pending_size = batch.builder->GetSize() +
+                         batch.rpcs.size() * sizeof(flatbuffers::uoffset_t) + payload.size() +
+                         rpc_overhead;
+    if (!batch.rpcs.empty() && pending_size > max_rpc_batch_size) {
+        send(client, channel);
+    }
+    batch.rpcs.emplace_back(CreateServerRpc(*batch.builder, entity_id.value(), rpc_id,
+                                            batch.builder->CreateVector(payload)));
+}
+
+void RpcBatcher::flush(TransportClient* client) {
+    for (usize i = 0; i < num_rpc_channels; ++i) {
+        send(client, static_cast<RpcChannel>(i));
+    }
+}
+
+void RpcBatcher::clear() {
+    for (auto& batch : batches_) {
+        batch.builder->Clear();
+        batch.rpcs.clear();
+    }
+}
+
+void RpcBatcher::send(TransportClient* client, RpcChannel channel) {
+    auto& batch = batches_[static_cast<usize>(channel)];
+    if (batch.rpcs.empty()) {
+        return;
+    }
+    SequenceNumber sequence = 0;
+    if (channel == RpcChannel::UnreliableSequenced) {
+        sequence = next_sequence_++;
+        // 0 is reserved for batches which aren't sequenced.
+        if (next_sequence_ == 0) {
+            next_sequence_ = 1;
+        }
+    }
+    auto& builder = *batch.builder;
+    auto rpc_batch = CreateServerRpcBatch(builder, builder.CreateVector(batch.rpcs), sequence);
+    auto message =
+        CreateServerMessage(builder, ServerMessageData_ServerRpcBatch, rpc_batch.Union());
+    builder.Finish(message);
+    sendToServer(*client, *stats_, ServerMessageData_ServerRpcBatch, builder,
+                 channel == RpcChannel::ReliableOrdered ? TransportChannel::Reliable
+                                                        : TransportChannel::Unreliable);
+    stats_->recordRpcsSent(server_connection_id, batch.rpcs.size());
+    builder.Clear();
+    batch.rpcs.clear();
+}
+
+bool acceptRpcBatch(SequenceNumber sequence, SequenceNumber& last_sequence) {
+    if (sequence == 0) {
+        return true;
+    }
+    if (!isNewerSequence(sequence, last_sequence)) {
+        return false;
+    }
+    last_sequence = sequence;
+    return true;
+}
+}  // namespace dw
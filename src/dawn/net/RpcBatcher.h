@@ -0,0 +1,61 @@
+/*
+ * Dawn Engine
+ * Written by David Avedissian (c) 2012-2019 (git@dga.dev)
+ */
+#pragma once
+
+#include "net/NetEntityId.h"
+#include "net/NetStats.h"
+#include "net/Rpc.h"
+#include "net/Sequence.h"
+#include "net/transport/Transport.h"
+
+#include <flatbuffers/flatbuffers.h>
+
+struct ServerRpc;
+
+namespace dw {
+// Maximum size of a single batch of RPCs, in bytes.
+const u32 max_rpc_batch_size = 1200;
+
+// Approximate size of an RPC within a batch excluding its payload, in bytes.
+const u32 rpc_overhead = 24;
+
+const usize num_rpc_channels = 3;
+
+// Queues RPCs sent by a client during a tick, and sends them as one ServerRpcBatch message per
+// channel. Reliable ordered RPCs are sent on the transports reliable channel, and everything else
+// on the unreliable channel so that high frequency RPCs never wait for reliable messages to be
+// resent. Batches of unreliable sequenced RPCs are numbered, so the server can drop stale ones.
+class DW_API RpcBatcher {
+public:
+    explicit RpcBatcher(NetStats* stats);
+
+    // Queues an RPC, sending the current batch first if the RPC would push it over
+    // max_rpc_batch_size.
+    void add(TransportClient* client, RpcChannel channel, NetEntityId entity_id, RpcId rpc_id,
+             const Vector<byte>& payload);
+
+    // Sends all queued RPCs.
+    void flush(TransportClient* client);
+
+    // Drops all queued RPCs.
+    void clear();
+
+private:
+    struct Batch {
+        UniquePtr<flatbuffers::FlatBufferBuilder> builder;
+        Vector<flatbuffers::Offset<ServerRpc>> rpcs;
+    };
+    Array<Batch, num_rpc_channels> batches_;
+    NetStats* stats_;
+    SequenceNumber next_sequence_;
+
+    void send(TransportClient* client, RpcChannel channel);
+};
+
+// Decides whether the server should invoke a batch of RPCs with the given sequence number. Batches
+// which aren't sequenced (sequence 0) are always accepted. Sequenced batches are only accepted if
+// they're newer than last_sequence, which is then updated, so that stale batches are dropped.
+DW_API bool acceptRpcBatch(SequenceNumber sequence, SequenceNumber& last_sequence);
+}  // namespace dw
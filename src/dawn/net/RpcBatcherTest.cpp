@@ -0,0 +1,112 @@
+/*
+ * Dawn Engine
+ * Written by David Avedissian (c) 2012-2019 (git@dga.dev)
+ */
+#include "Testing.h"
+#include "net/NetMessages.h"
+#include "net/RpcBatcher.h"
+
+namespace {
+// Records every message sent to the server.
+class CapturingClient : public dw::TransportClient {
+public:
+    struct SentMessage {
+        dw::TransportChannel channel;
+        dw::Vector<dw::byte> data;
+
+        const ServerRpcBatch* batch() const {
+            auto* message = GetServerMessage(data.data());
+            return message->to_server_as_ServerRpcBatch();
+        }
+    };
+    dw::Vector<SentMessage> sent;
+
+    void connect(const dw::String&, dw::u16) override {
+    }
+    void disconnect() override {
+    }
+    void update(float) override {
+    }
+    void send(const dw::byte* data, dw::u32 length, dw::TransportChannel channel) override {
+        sent.emplace_back(SentMessage{channel, dw::Vector<dw::byte>(data, data + length)});
+    }
+    dw::Option<dw::ClientPacket> receive() override {
+        return {};
+    }
+    dw::ClientConnectionState connectionState() const override {
+        return dw::ClientConnectionState::Connected;
+    }
+};
+}  // namespace
+
+TEST(RpcBatcherTest, BatchesRpcsPerChannel) {
+    CapturingClient client;
+    dw::NetStats stats;
+    dw::RpcBatcher batcher(&stats);
+    for (dw::u32 i = 1; i <= 5; ++i) {
+        batcher.add(&client, dw::RpcChannel::ReliableOrdered, dw::NetEntityId{i, 1}, 1, {1, 2});
+        batcher.add(&client, dw::RpcChannel::UnreliableSequenced, dw::NetEntityId{i, 1}, 2, {3});
+    }
+    EXPECT_TRUE(client.sent.empty());
+    batcher.flush(&client);
+
+    // One batch per channel, in channel order.
+    ASSERT_EQ(2u, client.sent.size());
+    EXPECT_EQ(dw::TransportChannel::Reliable, client.sent[0].channel);
+    EXPECT_EQ(5u, client.sent[0].batch()->rpcs()->size());
+    EXPECT_EQ(0u, client.sent[0].batch()->sequence());
+    EXPECT_EQ(dw::TransportChannel::Unreliable, client.sent[1].channel);
+    EXPECT_EQ(5u, client.sent[1].batch()->rpcs()->size());
+    EXPECT_EQ(1u, client.sent[1].batch()->sequence());
+    EXPECT_EQ(10u, stats.connection(dw::server_connection_id)->rpcs_sent);
+
+    // Each flush of sequenced RPCs gets the next sequence number, and empty channels send nothing.
+    batcher.add(&client, dw::RpcChannel::UnreliableSequenced, dw::NetEntityId{1, 1}, 2, {3});
+    batcher.flush(&client);
+    ASSERT_EQ(3u, client.sent.size());
+    EXPECT_EQ(2u, client.sent[2].batch()->sequence());
+}
+
+TEST(RpcBatcherTest, SplitsLargeBatches) {
+    CapturingClient client;
+    dw::NetStats stats;
+    dw::RpcBatcher batcher(&stats);
+    const dw::u32 rpc_count = 40;
+    for (dw::u32 i = 1; i <= rpc_count; ++i) {
+        batcher.add(&client, dw::RpcChannel::Unreliable, dw::NetEntityId{i, 1}, 1,
+                    dw::Vector<dw::byte>(200, static_cast<dw::byte>(i)));
+    }
+    batcher.flush(&client);
+    ASSERT_GT(client.sent.size(), 1u);
+
+    // Every RPC arrives exactly once, and in order.
+    dw::u32 next_entity = 1;
+    for (auto& message : client.sent) {
+        for (auto* rpc : *message.batch()->rpcs()) {
+            EXPECT_EQ(next_entity, dw::NetEntityId::fromValue(rpc->entity_id()).index());
+            next_entity++;
+        }
+    }
+    EXPECT_EQ(rpc_count + 1, next_entity);
+}
+
+TEST(RpcBatcherTest, DropsStaleSequencedBatches) {
+    dw::SequenceNumber last_sequence = 0;
+    EXPECT_TRUE(dw::acceptRpcBatch(1, last_sequence));
+    EXPECT_TRUE(dw::acceptRpcBatch(3, last_sequence));
+    EXPECT_EQ(3u, last_sequence);
+
+    // Duplicated and out of order batches are dropped.
+    EXPECT_FALSE(dw::acceptRpcBatch(3, last_sequence));
+    EXPECT_FALSE(dw::acceptRpcBatch(2, last_sequence));
+    EXPECT_EQ(3u, last_sequence);
+
+    // Batches which aren't sequenced are always accepted.
+    EXPECT_TRUE(dw::acceptRpcBatch(0, last_sequence));
+    EXPECT_EQ(3u, last_sequence);
+
+    // Sequence numbers wrap around.
+    last_sequence = 0xfffffffe;
+    EXPECT_TRUE(dw::acceptRpcBatch(1, last_sequence));
+    EXPECT_FALSE(dw::acceptRpcBatch(0xffffffff, last_sequence));
+}
@@ -0,0 +1,16 @@
+/*
+ * Dawn Engine
+ * Written by David Avedissian (c) 2012-2019 (git@dga.dev)
+ */
+#pragma once
+
+namespace dw {
+// A sequence number which increments with every message of a particular kind, and is allowed to
+// wrap around.
+using SequenceNumber = u32;
+
+// Returns true if sequence a is newer than sequence b, allowing for wrap around.
+inline bool isNewerSequence(SequenceNumber a, SequenceNumber b) {
+    return static_cast<i32>(a - b) > 0;
+}
+}  // namespace dw
@@ -0,0 +1,113 @@
+/*
+ * Dawn Engine
+ * Written by David Avedissian (c) 2012-2019 (git@dga.dev)
+ */
+#include "Base.h"
+#include "net/TransformSnapshotBuffer.h"
+
+#include <algorithm>
+
+namespace dw {
+TransformSnapshotBuffer::TransformSnapshotBuffer(usize capacity)
+    : snapshots_(capacity), first_(0), size_(0) {
+    assert(capacity > 0);
+}
+
+void TransformSnapshotBuffer::push(const TransformSnapshot& snapshot) {
+    if (size_ > 0 && snapshot.time <= newest().time) {
+        return;
+    }
+    if (size_ < snapshots_.size()) {
+        snapshots_[(first_ + size_) % snapshots_.size()] = snapshot;
+        size_++;
+    } else {
+        snapshots_[first_] = snapshot;
+        first_ = (first_ + 1) % snapshots_.size();
+    }
+}
+
+Option<TransformSnapshot> TransformSnapshotBuffer::sample(double time,
+                                                         float max_extrapolation) const {
+    if (size_ == 0) {
+        return {};
+    }
+
+    // Before the first snapshot, hold the oldest known transform.
+    if (time <= oldest().time) {
+        TransformSnapshot result = oldest();
+        result.time = time;
+        return result;
+    }
+
+    // After the last snapshot, extrapolate for a limited time.
+    if (time >= newest().time) {
+        TransformSnapshot result = newest();
+        float t = static_cast<float>(std::min(time - result.time, double(max_extrapolation)));
+        result.position += result.velocity * t;
+        result.orientation = integrateOrientation(result.orientation, result.angular_velocity, t);
+        result.time = time;
+        return result;
+    }
+
+    // Find the pair of snapshots either side of this time.
+    usize low = 0;
+    usize high = size_ - 1;
+    while (high - low > 1) {
+        usize mid = (low + high) / 2;
+        if (at(mid).time <= time) {
+            low = mid;
+        } else {
+            high = mid;
+        }
+    }
+    const TransformSnapshot& a = at(low);
+    const TransformSnapshot& b = at(high);
+
+    // Cubic Hermite interpolation of position, using velocities as tangents.
+    float interval = static_cast<float>(b.time - a.time);
+    float s = static_cast<float>((time - a.time) / (b.time - a.time));
+    float s2 = s * s;
+    float s3 = s2 * s;
+    float h00 = 2.0f * s3 - 3.0f * s2 + 1.0f;
+    float h10 = s3 - 2.0f * s2 + s;
+    float h01 = -2.0f * s3 + 3.0f * s2;
+    float h11 = s3 - s2;
+    float dh00 = 6.0f * s2 - 6.0f * s;
+    float dh10 = 3.0f * s2 - 4.0f * s + 1.0f;
+    float dh01 = -6.0f * s2 + 6.0f * s;
+    float dh11 = 3.0f * s2 - 2.0f * s;
+
+    TransformSnapshot result;
+    result.time = time;
+    result.position = a.position * h00 + a.velocity * (h10 * interval) + b.position * h01 +
+                      b.velocity * (h11 * interval);
+    result.velocity = (a.position * dh00 + b.position * dh01) / interval + a.velocity * dh10 +
+                      b.velocity * dh11;
+    result.orientation = Quat::Slerp(a.orientation, b.orientation, s);
+    result.angular_velocity = a.angular_velocity * (1.0f - s) + b.angular_velocity * s;
+    return result;
+}
+
+void TransformSnapshotBuffer::clear() {
+    first_ = 0;
+    size_ = 0;
+}
+
+usize TransformSnapshotBuffer::size() const {
+    return size_;
+}
+
+const TransformSnapshot& TransformSnapshotBuffer::newest() const {
+    assert(size_ > 0);
+    return at(size_ - 1);
+}
+
+const TransformSnapshot& TransformSnapshotBuffer::oldest() const {
+    assert(size_ > 0);
+    return at(0);
+}
+
+const TransformSnapshot& TransformSnapshotBuffer::at(usize i) const {
+    return snapshots_[(first_ + i) % snapshots_.size()];
+}
+}  // namespace dw
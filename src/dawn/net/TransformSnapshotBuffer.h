@@ -0,0 +1,57 @@
+/*
+ * Dawn Engine
+ * Written by David Avedissian (c) 2012-2019 (git@dga.dev)
+ */
+#pragma once
+
+#include "core/math/Defs.h"
+
+namespace dw {
+// The transform of a replicated entity at a point in time on the server.
+struct DW_API TransformSnapshot {
+    double time;
+    Vec3 position;
+    Vec3 velocity;
+    Quat orientation;
+    Vec3 angular_velocity;
+
+    TransformSnapshot()
+        : time(0.0),
+          position(Vec3::zero),
+          velocity(Vec3::zero),
+          orientation(Quat::identity),
+          angular_velocity(Vec3::zero) {
+    }
+};
+
+// A ring buffer of the most recent snapshots received for an entity, which can be sampled at any
+// time. Between two snapshots, position is interpolated with a cubic Hermite spline using the
+// velocity at each end, and orientation is interpolated with slerp. After the last snapshot, the
+// transform is extrapolated using its velocities for a limited time, then held in place.
+class DW_API TransformSnapshotBuffer {
+public:
+    explicit TransformSnapshotBuffer(usize capacity = 32);
+
+    // Adds a snapshot. Snapshots older than the newest snapshot (which arrived out of order) are
+    // ignored. Once the buffer is full, the oldest snapshot is replaced.
+    void push(const TransformSnapshot& snapshot);
+
+    // Samples the transform at a time. Returns nothing if the buffer is empty.
+    Option<TransformSnapshot> sample(double time, float max_extrapolation) const;
+
+    // Removes all snapshots.
+    void clear();
+
+    usize size() const;
+    const TransformSnapshot& newest() const;
+    const TransformSnapshot& oldest() const;
+
+private:
+    Vector<TransformSnapshot> snapshots_;
+    usize first_;
+    usize size_;
+
+    // Returns the i-th oldest snapshot.
+    const TransformSnapshot& at(usize i) const;
+};
+}  // namespace dw
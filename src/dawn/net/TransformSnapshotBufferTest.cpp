@@ -0,0 +1,77 @@
+/*
+ * Dawn Engine
+ * Written by David Avedissian (c) 2012-2019 (git@dga.dev)
+ */
+#include "Testing.h"
+#include "net/TransformSnapshotBuffer.h"
+
+namespace {
+dw::TransformSnapshot makeSnapshot(double time, const dw::Vec3& position,
+                                   const dw::Vec3& velocity) {
+    dw::TransformSnapshot snapshot;
+    snapshot.time = time;
+    snapshot.position = position;
+    snapshot.velocity = velocity;
+    return snapshot;
+}
+}  // namespace
+
+TEST(TransformSnapshotBufferTest, EmptyBufferHasNoSample) {
+    dw::TransformSnapshotBuffer buffer;
+    EXPECT_FALSE(buffer.sample(1.0, 0.25f).has_value());
+}
+
+TEST(TransformSnapshotBufferTest, IgnoresOutOfOrderSnapshots) {
+    dw::TransformSnapshotBuffer buffer;
+    buffer.push(makeSnapshot(2.0, dw::Vec3::zero, dw::Vec3::zero));
+    buffer.push(makeSnapshot(1.0, dw::Vec3::zero, dw::Vec3::zero));
+    buffer.push(makeSnapshot(2.0, dw::Vec3::zero, dw::Vec3::zero));
+    EXPECT_EQ(1u, buffer.size());
+}
+
+TEST(TransformSnapshotBufferTest, ReplacesOldestWhenFull) {
+    dw::TransformSnapshotBuffer buffer(4);
+    for (int i = 0; i < 6; ++i) {
+        buffer.push(makeSnapshot(i, dw::Vec3::zero, dw::Vec3::zero));
+    }
+    EXPECT_EQ(4u, buffer.size());
+    EXPECT_DOUBLE_EQ(2.0, buffer.oldest().time);
+    EXPECT_DOUBLE_EQ(5.0, buffer.newest().time);
+}
+
+TEST(TransformSnapshotBufferTest, InterpolatesBetweenSnapshots) {
+    dw::TransformSnapshotBuffer buffer;
+    dw::Vec3 velocity{10.0f, 0.0f, 0.0f};
+    buffer.push(makeSnapshot(1.0, {0.0f, 0.0f, 0.0f}, velocity));
+    buffer.push(makeSnapshot(2.0, {10.0f, 0.0f, 0.0f}, velocity));
+    buffer.push(makeSnapshot(3.0, {20.0f, 0.0f, 0.0f}, velocity));
+
+    // Constant velocity motion is reproduced exactly.
+    auto sample = buffer.sample(2.25, 0.0f);
+    ASSERT_TRUE(sample.has_value());
+    EXPECT_NEAR(12.5f, sample->position.x, 0.001f);
+    EXPECT_NEAR(10.0f, sample->velocity.x, 0.001f);
+
+    // Endpoints match the snapshots.
+    EXPECT_NEAR(10.0f, buffer.sample(2.0, 0.0f)->position.x, 0.001f);
+    EXPECT_NEAR(0.0f, buffer.sample(0.5, 0.0f)->position.x, 0.001f);
+}
+
+TEST(TransformSnapshotBufferTest, HermiteUsesVelocity) {
+    dw::TransformSnapshotBuffer buffer;
+    buffer.push(makeSnapshot(0.0, {0.0f, 0.0f, 0.0f}, {0.0f, 0.0f, 0.0f}));
+    buffer.push(makeSnapshot(1.0, {1.0f, 0.0f, 0.0f}, {0.0f, 0.0f, 0.0f}));
+
+    // Starting and ending at rest gives an ease in/out curve rather than a straight line.
+    EXPECT_LT(buffer.sample(0.25, 0.0f)->position.x, 0.25f);
+    EXPECT_NEAR(0.5f, buffer.sample(0.5, 0.0f)->position.x, 0.001f);
+    EXPECT_GT(buffer.sample(0.75, 0.0f)->position.x, 0.75f);
+}
+
+TEST(TransformSnapshotBufferTest, ExtrapolationIsBounded) {
+    dw::TransformSnapshotBuffer buffer;
+    buffer.push(makeSnapshot(1.0, {0.0f, 0.0f, 0.0f}, {10.0f, 0.0f, 0.0f}));
+    EXPECT_NEAR(1.0f, buffer.sample(1.1, 0.25f)->position.x, 0.001f);
+    EXPECT_NEAR(2.5f, buffer.sample(1.25, 0.25f)->position.x, 0.001f);
+    EXPECT_NEAR(2.5f, buffer.sample(5.0, 0.25f)->position.x, 0.001f);
+}
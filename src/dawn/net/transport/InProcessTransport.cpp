@@ -11,6 +11,61 @@
 #include "InProcessTransport.h"
 
 namespace dw {
+namespace {
+// Size of the ring buffer in each direction of a connection. A single message can be up to
+// MessageRingBuffer::maxMessageLength(), just under half of this.
+const usize in_process_channel_capacity = 256 * 1024;
+}  // namespace
+
+InProcessChannel::InProcessChannel() : ring_buffer_(in_process_channel_capacity) {
+}
+
+void InProcessChannel::write(const byte* data, u32 length, TransportChannel channel) {
+    write(data, length, static_cast<u32>(channel));
+}
+
+void InProcessChannel::write(const byte* data, u32 length, u32 tag) {
+    // Preserve ordering by only writing directly if nothing is waiting.
+    if (overflow_.empty() && ring_buffer_.write(data, length, tag)) {
+        return;
+    }
+    // Larger messages might never fit, and would hold up every message after them.
+    assert(length <= ring_buffer_.maxMessageLength());
+    overflow_.emplace_back(tag, Vector<byte>(data, data + length));
+}
+
+void InProcessChannel::flush() {
+    while (!overflow_.empty()) {
+        auto& message = overflow_.front().second;
+        auto tag = overflow_.front().first;
+        if (!ring_buffer_.write(message.data(), static_cast<u32>(message.size()), tag)) {
+            break;
+        }
+        overflow_.pop_front();
+    }
+}
+
+usize InProcessChannel::pendingMessages() const {
+    return overflow_.size();
+}
+
+Option<MessageView> InProcessChannel::read() {
+    return ring_buffer_.read();
+}
+
+Option<MessageView> InProcessChannel::peek() {
+    return ring_buffer_.peek();
+}
+
+void InProcessChannel::release() {
+    ring_buffer_.release();
+}
+
+void InProcessChannel::reset() {
+    ring_buffer_.reset();
+    overflow_.clear();
+}
+
 Map<u16, InProcessServer*> InProcessServer::listening_connections;
 
 InProcessServer::InProcessServer(Context* ctx, Function<void(ClientId)> client_connected,
@@ -48,8 +103,8 @@ void InProcessServer::disconnect() {
     Vector<InProcessClient*> clients;
     clients.reserve(client_streams_.size());
     for (auto& client : client_streams_) {
-        if (client.client) {
-            clients.push_back(client.client);
+        if (client) {
+            clients.push_back(client->client);
         }
     }
     for (auto& client : clients) {
@@ -62,14 +117,25 @@ void InProcessServer::disconnect() {
 
 void InProcessServer::update(float dt) {
     time_ += dt;
+
+    // Packets returned by receive() in the previous tick are no longer in use.
+    for (auto& stream : client_streams_) {
+        if (stream) {
+            stream->incoming.release();
+            stream->outgoing.flush();
+        }
+    }
 }
 
-void InProcessServer::send(ClientId client, const byte* data, u32 length) {
+void InProcessServer::send(ClientId client, const byte* data, u32 length,
+                           TransportChannel channel) {
+    // Messages are never lost in process, so every channel is reliable. The channel is only kept
+    // so the receiver can tell how the message was sent.
     if (client >= client_streams_.size() || !isClientConnected(client)) {
         return;
     }
     // log().info("Sending packet of length {} to client {}.", length, client);
-    client_streams_[client].outgoing.enqueue(Vector<byte>(data, data + length));
+    client_streams_[client]->outgoing.write(data, length, channel);
 }
 
 Option<ServerPacket> InProcessServer::receive(ClientId client) {
@@ -77,18 +143,18 @@ Option<ServerPacket> InProcessServer::receive(ClientId client) {
         return {};
     }
 
-    Vector<byte> data;
-    bool has_packet = client_streams_[client].incoming.try_dequeue(data);
-    if (has_packet) {
-        // log().info("Received packet of length {} from client {}.", data.size(), client);
-        return {ServerPacket{client, std::move(data)}};
+    auto message = client_streams_[client]->incoming.read();
+    if (message) {
+        // log().info("Received packet of length {} from client {}.", message->length, client);
+        return {ServerPacket{client, message->data, message->length,
+                             static_cast<TransportChannel>(message->tag)}};
     } else {
         return {};
     }
 }
 
 bool InProcessServer::isClientConnected(ClientId client) const {
-    return client_streams_[client].client != nullptr;
+    return client < client_streams_.size() && client_streams_[client] != nullptr;
 }
 
 usize InProcessServer::numConnections() const {
@@ -99,6 +165,15 @@ ServerConnectionState InProcessServer::connectionState() const {
     return server_connection_state_;
 }
 
+TransportConnectionStats InProcessServer::connectionStats(ClientId client) const {
+    // Nothing is lost in process, and messages arrive in the next tick.
+    TransportConnectionStats stats;
+    if (isClientConnected(client)) {
+        stats.queued_packets = client_streams_[client]->outgoing.pendingMessages();
+    }
+    return stats;
+}
+
 usize InProcessServer::maxConnections() const {
     return client_streams_.size();
 }
@@ -108,7 +183,7 @@ ClientId InProcessServer::clientConnect(InProcessClient* client) {
     for (ClientId i = 0; i < client_streams_.size(); ++i) {
         if (!isClientConnected(i)) {
             log().info("Received a connection request from a client. Assigning ID {}.", i);
-            client_streams_[i].client = client;
+            client_streams_[i] = makeUnique<InProcessDataStream>(client);
             connected_clients_++;
             client_connected_(i);
             return i;
@@ -123,14 +198,15 @@ void InProcessServer::clientDisconnect(ClientId id) {
     assert(id < client_streams_.size());
     if (isClientConnected(id)) {
         client_disconnected_(id);
-        client_streams_[id] = InProcessDataStream();
+        client_streams_[id].reset();
         connected_clients_--;
     }
 }
 
 InProcessDataStream& InProcessServer::clientStream(ClientId id) {
     assert(id < client_streams_.size());
-    return client_streams_[id];
+    assert(client_streams_[id]);
+    return *client_streams_[id];
 }
 
 InProcessClient::InProcessClient(Context* ctx, Function<void()> connected,
@@ -187,15 +263,22 @@ void InProcessClient::disconnect() {
 void InProcessClient::update(float dt) {
     time_ += dt;
 
+    // Packets returned by receive() in the previous tick are no longer in use.
+    if (connected_server_) {
+        auto& stream = connected_server_->clientStream(client_id_);
+        stream.outgoing.release();
+        stream.incoming.flush();
+    }
+
     if (connect_function_.has_value()) {
         (*connect_function_)();
         connect_function_.reset();
     }
 }
 
-void InProcessClient::send(const byte* data, u32 length) {
+void InProcessClient::send(const byte* data, u32 length, TransportChannel channel) {
     // log().info("Sending packet of length {}.", length);
-    connected_server_->clientStream(client_id_).incoming.enqueue(Vector<byte>(data, data + length));
+    connected_server_->clientStream(client_id_).incoming.write(data, length, channel);
 }
 
 Option<ClientPacket> InProcessClient::receive() {
@@ -203,11 +286,11 @@ Option<ClientPacket> InProcessClient::receive() {
         return {};
     }
 
-    Vector<byte> data;
-    bool has_packet = connected_server_->clientStream(client_id_).outgoing.try_dequeue(data);
-    if (has_packet) {
-        // log().info("Received packet of length {} from server.", data.size());
-        return {ClientPacket{std::move(data)}};
+    auto message = connected_server_->clientStream(client_id_).outgoing.read();
+    if (message) {
+        // log().info("Received packet of length {} from server.", message->length);
+        return {ClientPacket{message->data, message->length,
+                             static_cast<TransportChannel>(message->tag)}};
     } else {
         return {};
     }
@@ -216,4 +299,13 @@ Option<ClientPacket> InProcessClient::receive() {
 ClientConnectionState InProcessClient::connectionState() const {
     return client_connection_state_;
 }
+
+TransportConnectionStats InProcessClient::connectionStats() const {
+    TransportConnectionStats stats;
+    if (connected_server_) {
+        stats.queued_packets =
+            connected_server_->clientStream(client_id_).incoming.pendingMessages();
+    }
+    return stats;
+}
 }  // namespace dw
@@ -5,17 +5,45 @@
 #pragma once
 
 #include "net/transport/Transport.h"
+#include "net/transport/MessageRingBuffer.h"
 
 namespace dw {
 class InProcessClient;
 
+// One direction of an in process connection. Messages are written straight into a ring buffer
+// which the receiver reads from in place. If the receiver hasn't released enough space yet, the
+// message is held by the sender and written to the ring buffer in a later tick.
+class InProcessChannel {
+public:
+    InProcessChannel();
+
+    // Sender side. Messages are tagged with their channel, or a user defined tag.
+    void write(const byte* data, u32 length, TransportChannel channel);
+    void write(const byte* data, u32 length, u32 tag);
+    void flush();
+
+    // Number of messages held by the sender until the receiver releases space.
+    usize pendingMessages() const;
+
+    // Receiver side.
+    Option<MessageView> read();
+    Option<MessageView> peek();
+    void release();
+
+    // Discards every message, including those held by the sender. Neither side may be using the
+    // channel.
+    void reset();
+
+private:
+    MessageRingBuffer ring_buffer_;
+    Deque<Pair<u32, Vector<byte>>> overflow_;
+};
+
 struct InProcessDataStream {
     InProcessClient* client;
-    ConcurrentQueue<Vector<byte>> incoming;
-    ConcurrentQueue<Vector<byte>> outgoing;
+    InProcessChannel incoming;  // Client to server.
+    InProcessChannel outgoing;  // Server to client.
 
-    InProcessDataStream() : client(nullptr), incoming(), outgoing() {
-    }
     InProcessDataStream(InProcessClient* client) : client(client), incoming(), outgoing() {
     }
 };
@@ -32,19 +60,21 @@ public:
     void disconnect() override;
 
     void update(float dt) override;
-    void send(ClientId client, const byte* data, u32 length) override;
+    void send(ClientId client, const byte* data, u32 length,
+              TransportChannel channel = TransportChannel::Reliable) override;
     Option<ServerPacket> receive(ClientId client) override;
     bool isClientConnected(ClientId client) const override;
     usize numConnections() const override;
     usize maxConnections() const override;
 
     ServerConnectionState connectionState() const override;
+    TransportConnectionStats connectionStats(ClientId client) const override;
 
 private:
     ServerConnectionState server_connection_state_;
     double time_;
     u16 port_;
-    Vector<InProcessDataStream> client_streams_;
+    Vector<UniquePtr<InProcessDataStream>> client_streams_;
     usize connected_clients_;
 
     Function<void(ClientId)> client_connected_;
@@ -72,10 +102,12 @@ public:
     void disconnect() override;
 
     void update(float dt) override;
-    void send(const byte* data, u32 length) override;
+    void send(const byte* data, u32 length,
+              TransportChannel channel = TransportChannel::Reliable) override;
     Option<ClientPacket> receive() override;
 
     ClientConnectionState connectionState() const override;
+    TransportConnectionStats connectionStats() const override;
 
 private:
     Option<Function<void()>> connect_function_; // Called in the next tick.
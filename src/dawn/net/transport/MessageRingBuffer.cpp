@@ -0,0 +1,110 @@
+/*
+ * Dawn Engine
+ * Written by David Avedissian (c) 2012-2019 (git@dga.dev)
+ */
+#include "Base.h"
+#include "net/transport/MessageRingBuffer.h"
+
+namespace dw {
+namespace {
+// Each message is prefixed with its length and tag, padded so that the payload (and therefore any
+// flatbuffer stored in it) is 8 byte aligned.
+const u32 header_size = 8;
+const u32 slot_alignment = 8;
+
+// Written in place of a header when the remainder of the buffer was skipped.
+const u32 wrap_marker = 0xFFFFFFFF;
+
+u64 slotSize(u32 length) {
+    return (static_cast<u64>(header_size) + length + slot_alignment - 1) & ~u64(slot_alignment - 1);
+}
+
+usize nextPowerOfTwo(usize value) {
+    usize result = slot_alignment;
+    while (result < value) {
+        result <<= 1;
+    }
+    return result;
+}
+}  // namespace
+
+MessageRingBuffer::MessageRingBuffer(usize capacity)
+    : buffer_(nextPowerOfTwo(capacity)), head_(0), tail_(0), read_position_(0) {
+    mask_ = buffer_.size() - 1;
+}
+
+bool MessageRingBuffer::write(const byte* data, u32 length, u32 tag) {
+    u64 slot_size = slotSize(length);
+    u64 head = head_.load(std::memory_order_relaxed);
+    u64 tail = tail_.load(std::memory_order_acquire);
+    u64 index = head & mask_;
+
+    // Messages must be contiguous, so skip to the start of the buffer if the message doesn't fit
+    // before the end.
+    u64 contiguous = buffer_.size() - index;
+    u64 skipped = slot_size > contiguous ? contiguous : 0;
+    if ((head - tail) + skipped + slot_size > buffer_.size()) {
+        return false;
+    }
+    if (skipped > 0) {
+        memcpy(&buffer_[index], &wrap_marker, sizeof(u32));
+        head += skipped;
+        index = 0;
+    }
+
+    memcpy(buffer_.data() + index, &length, sizeof(u32));
+    memcpy(buffer_.data() + index + sizeof(u32), &tag, sizeof(u32));
+    memcpy(buffer_.data() + index + header_size, data, length);
+    head_.store(head + slot_size, std::memory_order_release);
+    return true;
+}
+
+Option<MessageView> MessageRingBuffer::read() {
+    auto message = peek();
+    if (message) {
+        read_position_ += slotSize(message->length);
+    }
+    return message;
+}
+
+Option<MessageView> MessageRingBuffer::peek() {
+    u64 head = head_.load(std::memory_order_acquire);
+    if (read_position_ == head) {
+        return {};
+    }
+
+    u64 index = read_position_ & mask_;
+    u32 length;
+    memcpy(&length, &buffer_[index], sizeof(u32));
+    if (length == wrap_marker) {
+        read_position_ += buffer_.size() - index;
+        index = 0;
+        memcpy(&length, &buffer_[index], sizeof(u32));
+    }
+
+    u32 tag;
+    memcpy(&tag, buffer_.data() + index + sizeof(u32), sizeof(u32));
+    return MessageView{buffer_.data() + index + header_size, length, tag};
+}
+
+void MessageRingBuffer::release() {
+    tail_.store(read_position_, std::memory_order_release);
+}
+
+void MessageRingBuffer::reset() {
+    head_.store(0, std::memory_order_relaxed);
+    tail_.store(0, std::memory_order_relaxed);
+    read_position_ = 0;
+}
+
+usize MessageRingBuffer::capacity() const {
+    return buffer_.size();
+}
+
+u32 MessageRingBuffer::maxMessageLength() const {
+    // A slot of half the buffer fits either before the end of the buffer, or after skipping to
+    // the start.
+    usize half = buffer_.size() / 2;
+    return half > header_size ? static_cast<u32>(half - header_size) : 0;
+}
+}  // namespace dw
@@ -0,0 +1,65 @@
+/*
+ * Dawn Engine
+ * Written by David Avedissian (c) 2012-2019 (git@dga.dev)
+ */
+#pragma once
+
+#include "core/Concurrency.h"
+
+namespace dw {
+// A view of a message stored inside a MessageRingBuffer.
+struct MessageView {
+    const byte* data;
+    u32 length;
+    u32 tag;
+};
+
+// A single producer, single consumer ring buffer of variable sized messages. Messages are copied
+// into contiguous slots inside the buffer, and read back in place without copying. Slots are only
+// reused by the producer after the consumer calls release(), which means that every message read
+// since the last call to release() stays valid until the next one.
+class DW_API MessageRingBuffer {
+public:
+    // Capacity is rounded up to the next power of two.
+    explicit MessageRingBuffer(usize capacity);
+    ~MessageRingBuffer() = default;
+
+    MessageRingBuffer(const MessageRingBuffer&) = delete;
+    MessageRingBuffer& operator=(const MessageRingBuffer&) = delete;
+
+    // Producer: Copies a message into the buffer, along with a user defined tag. Returns false if
+    // there's not enough free space.
+    bool write(const byte* data, u32 length, u32 tag = 0);
+
+    // Consumer: Reads the next message, or returns nothing if the buffer is empty.
+    Option<MessageView> read();
+
+    // Consumer: Returns the message which the next call to read() will return, without reading it.
+    Option<MessageView> peek();
+
+    // Consumer: Releases all messages read so far back to the producer.
+    void release();
+
+    // Discards every message. Neither the producer nor the consumer may be using the buffer.
+    void reset();
+
+    // Size of the underlying buffer in bytes.
+    usize capacity() const;
+
+    // Largest message which can always be written once the consumer has released everything,
+    // wherever the producer is in the buffer. Each message is stored with a header, and must be
+    // contiguous, so larger messages may fit neither before the end of the buffer nor before the
+    // producer's position.
+    u32 maxMessageLength() const;
+
+private:
+    Vector<byte> buffer_;
+    usize mask_;
+
+    // Positions are monotonically increasing byte offsets. head_ is written by the producer, tail_
+    // is written by the consumer. read_position_ is only accessed by the consumer.
+    Atomic<u64> head_;
+    Atomic<u64> tail_;
+    u64 read_position_;
+};
+}  // namespace dw
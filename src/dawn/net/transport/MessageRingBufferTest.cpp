@@ -0,0 +1,133 @@
+/*
+ * Dawn Engine
+ * Written by David Avedissian (c) 2012-2019 (git@dga.dev)
+ */
+#include "Testing.h"
+#include "net/transport/MessageRingBuffer.h"
+
+namespace {
+dw::Vector<dw::byte> makeMessage(dw::u32 length, dw::byte seed) {
+    dw::Vector<dw::byte> message(length);
+    for (dw::u32 i = 0; i < length; ++i) {
+        message[i] = static_cast<dw::byte>(seed + i);
+    }
+    return message;
+}
+}  // namespace
+
+TEST(MessageRingBufferTest, CapacityIsPowerOfTwo) {
+    dw::MessageRingBuffer buffer(100);
+    EXPECT_EQ(128u, buffer.capacity());
+}
+
+TEST(MessageRingBufferTest, ReadsMessagesInOrder) {
+    dw::MessageRingBuffer buffer(256);
+    auto first = makeMessage(10, 0);
+    auto second = makeMessage(3, 100);
+    ASSERT_TRUE(buffer.write(first.data(), static_cast<dw::u32>(first.size())));
+    ASSERT_TRUE(buffer.write(second.data(), static_cast<dw::u32>(second.size())));
+
+    auto message = buffer.read();
+    ASSERT_TRUE(message.has_value());
+    EXPECT_EQ(first, dw::Vector<dw::byte>(message->data, message->data + message->length));
+    message = buffer.read();
+    ASSERT_TRUE(message.has_value());
+    EXPECT_EQ(second, dw::Vector<dw::byte>(message->data, message->data + message->length));
+    EXPECT_FALSE(buffer.read().has_value());
+}
+
+TEST(MessageRingBufferTest, MessagesStayValidUntilReleased) {
+    dw::MessageRingBuffer buffer(64);
+    auto first = makeMessage(48, 0);
+    ASSERT_TRUE(buffer.write(first.data(), static_cast<dw::u32>(first.size())));
+    auto message = buffer.read();
+    ASSERT_TRUE(message.has_value());
+
+    // The slot is still in use, so the producer can't overwrite it.
+    auto second = makeMessage(8, 50);
+    EXPECT_FALSE(buffer.write(second.data(), static_cast<dw::u32>(second.size())));
+    EXPECT_EQ(first, dw::Vector<dw::byte>(message->data, message->data + message->length));
+
+    buffer.release();
+    EXPECT_TRUE(buffer.write(second.data(), static_cast<dw::u32>(second.size())));
+}
+
+TEST(MessageRingBufferTest, WrapsAround) {
+    dw::MessageRingBuffer buffer(64);
+    for (dw::u32 i = 0; i < 100; ++i) {
+        auto written = makeMessage(i % 20 + 1, static_cast<dw::byte>(i));
+        ASSERT_TRUE(buffer.write(written.data(), static_cast<dw::u32>(written.size())));
+        auto message = buffer.read();
+        ASSERT_TRUE(message.has_value());
+        EXPECT_EQ(written, dw::Vector<dw::byte>(message->data, message->data + message->length));
+        buffer.release();
+    }
+}
+
+TEST(MessageRingBufferTest, RejectsOversizedMessages) {
+    dw::MessageRingBuffer buffer(64);
+    auto message = makeMessage(64, 0);
+    EXPECT_FALSE(buffer.write(message.data(), static_cast<dw::u32>(message.size())));
+}
+
+TEST(MessageRingBufferTest, MaxMessageLengthAlwaysFits) {
+    dw::MessageRingBuffer buffer(64);
+    EXPECT_EQ(24u, buffer.maxMessageLength());
+
+    // The payload is smaller than the buffer, but not once the header is added.
+    auto too_large = makeMessage(60, 0);
+    EXPECT_FALSE(buffer.write(too_large.data(), static_cast<dw::u32>(too_large.size())));
+
+    // Write the largest message with the producer at each position in the buffer.
+    auto largest = makeMessage(buffer.maxMessageLength(), 0);
+    auto small = makeMessage(1, 0);
+    for (int i = 0; i < 8; ++i) {
+        ASSERT_TRUE(buffer.write(largest.data(), static_cast<dw::u32>(largest.size())));
+        auto message = buffer.read();
+        ASSERT_TRUE(message.has_value());
+        EXPECT_EQ(largest, dw::Vector<dw::byte>(message->data, message->data + message->length));
+        buffer.release();
+
+        // Move the producer along by a slot.
+        ASSERT_TRUE(buffer.write(small.data(), static_cast<dw::u32>(small.size())));
+        ASSERT_TRUE(buffer.read().has_value());
+        buffer.release();
+    }
+}
+
+TEST(MessageRingBufferTest, PreservesTags) {
+    dw::MessageRingBuffer buffer(256);
+    auto message = makeMessage(10, 0);
+    ASSERT_TRUE(buffer.write(message.data(), static_cast<dw::u32>(message.size()), 7));
+    auto read = buffer.read();
+    ASSERT_TRUE(read.has_value());
+    EXPECT_EQ(7u, read->tag);
+}
+
+TEST(MessageRingBufferTest, PeekDoesNotRead) {
+    dw::MessageRingBuffer buffer(256);
+    EXPECT_FALSE(buffer.peek().has_value());
+    auto message = makeMessage(10, 3);
+    ASSERT_TRUE(buffer.write(message.data(), static_cast<dw::u32>(message.size()), 1));
+    ASSERT_TRUE(buffer.write(message.data(), static_cast<dw::u32>(message.size()), 2));
+    auto peeked = buffer.peek();
+    ASSERT_TRUE(peeked.has_value());
+    EXPECT_EQ(1u, peeked->tag);
+    EXPECT_EQ(1u, buffer.peek()->tag);
+    EXPECT_EQ(1u, buffer.read()->tag);
+    EXPECT_EQ(2u, buffer.peek()->tag);
+    EXPECT_EQ(2u, buffer.read()->tag);
+    EXPECT_FALSE(buffer.peek().has_value());
+}
+
+TEST(MessageRingBufferTest, ResetDiscardsMessages) {
+    dw::MessageRingBuffer buffer(64);
+    auto message = makeMessage(20, 0);
+    ASSERT_TRUE(buffer.write(message.data(), static_cast<dw::u32>(message.size())));
+    ASSERT_TRUE(buffer.write(message.data(), static_cast<dw::u32>(message.size())));
+    EXPECT_FALSE(buffer.write(message.data(), static_cast<dw::u32>(message.size())));
+    buffer.reset();
+    EXPECT_FALSE(buffer.read().has_value());
+    EXPECT_TRUE(buffer.write(message.data(), static_cast<dw::u32>(message.size())));
+    EXPECT_TRUE(buffer.read().has_value());
+}
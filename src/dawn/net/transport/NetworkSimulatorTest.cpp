@@ -0,0 +1,122 @@
+/*
+ * Dawn Engine
+ * Written by David Avedissian (c) 2012-2019 (git@dga.dev)
+ */
+#include "Testing.h"
+#include "net/transport/SimulatedTransport.h"
+
+namespace {
+// Sends packets numbered 0 to count - 1, one per millisecond, then returns the numbers of the
+// packets received in the order they arrived.
+dw::Vector<dw::byte> sendAndReceive(dw::NetworkSimulator& simulator, int count) {
+    for (int i = 0; i < count; ++i) {
+        auto packet = static_cast<dw::byte>(i);
+        simulator.send(i * 0.001, &packet, 1);
+    }
+    dw::Vector<dw::byte> received;
+    while (auto packet = simulator.receive(1000.0)) {
+        received.push_back(packet->data[0]);
+    }
+    return received;
+}
+}  // namespace
+
+TEST(NetworkSimulatorTest, IdealLinkDeliversImmediately) {
+    dw::NetworkSimulator simulator;
+    dw::byte data[] = {1, 2, 3};
+    simulator.send(1.0, data, 3);
+    auto packet = simulator.receive(1.0);
+    ASSERT_TRUE(packet.has_value());
+    EXPECT_EQ(dw::Vector<dw::byte>(data, data + 3), packet->data);
+    EXPECT_EQ(0u, simulator.packetsInFlight());
+}
+
+TEST(NetworkSimulatorTest, Latency) {
+    dw::NetworkConditions conditions;
+    conditions.latency = 0.1f;
+    dw::NetworkSimulator simulator(conditions);
+    dw::byte data = 0;
+    simulator.send(1.0, &data, 1);
+    EXPECT_FALSE(simulator.receive(1.05).has_value());
+    EXPECT_TRUE(simulator.receive(1.15).has_value());
+}
+
+TEST(NetworkSimulatorTest, JitterPreservesOrder) {
+    dw::NetworkConditions conditions;
+    conditions.latency = 0.05f;
+    conditions.jitter = 0.05f;
+    dw::NetworkSimulator simulator(conditions);
+    auto received = sendAndReceive(simulator, 100);
+    ASSERT_EQ(100u, received.size());
+    for (int i = 0; i < 100; ++i) {
+        EXPECT_EQ(i, received[i]);
+    }
+}
+
+TEST(NetworkSimulatorTest, Reordering) {
+    dw::NetworkConditions conditions;
+    conditions.latency = 0.05f;
+    conditions.reorder_chance = 0.5f;
+    dw::NetworkSimulator simulator(conditions);
+    auto received = sendAndReceive(simulator, 100);
+    ASSERT_EQ(100u, received.size());
+    EXPECT_FALSE(std::is_sorted(received.begin(), received.end()));
+}
+
+TEST(NetworkSimulatorTest, LossAndDuplication) {
+    dw::NetworkConditions conditions;
+    conditions.packet_loss = 1.0f;
+    dw::NetworkSimulator lossy(conditions);
+    EXPECT_TRUE(sendAndReceive(lossy, 100).empty());
+
+    conditions.packet_loss = 0.0f;
+    conditions.duplicate_chance = 1.0f;
+    dw::NetworkSimulator duplicating(conditions);
+    EXPECT_EQ(200u, sendAndReceive(duplicating, 100).size());
+}
+
+TEST(NetworkSimulatorTest, ReliablePacketsAreNeverLost) {
+    dw::NetworkConditions conditions;
+    conditions.packet_loss = 1.0f;
+    conditions.duplicate_chance = 1.0f;
+    conditions.reorder_chance = 1.0f;
+    dw::NetworkSimulator simulator(conditions);
+    dw::byte data = 0;
+    simulator.send(0.0, &data, 1, dw::TransportChannel::Reliable);
+    auto packet = simulator.receive(0.0);
+    ASSERT_TRUE(packet.has_value());
+    EXPECT_EQ(dw::TransportChannel::Reliable, packet->channel);
+    EXPECT_FALSE(simulator.receive(0.0).has_value());
+}
+
+TEST(NetworkSimulatorTest, Bandwidth) {
+    dw::NetworkConditions conditions;
+    conditions.bandwidth = 1000;
+    dw::NetworkSimulator simulator(conditions);
+    dw::Vector<dw::byte> data(500);
+    simulator.send(0.0, data.data(), 500);
+    simulator.send(0.0, data.data(), 500);
+    EXPECT_FALSE(simulator.receive(0.4).has_value());
+    EXPECT_TRUE(simulator.receive(0.5).has_value());
+    EXPECT_FALSE(simulator.receive(0.9).has_value());
+    EXPECT_TRUE(simulator.receive(1.0).has_value());
+
+    // Packets which would queue for too long are dropped.
+    dw::Vector<dw::byte> large(2000);
+    simulator.send(1.0, large.data(), 2000);
+    simulator.send(1.0, data.data(), 500);
+    EXPECT_EQ(1u, simulator.packetsInFlight());
+}
+
+TEST(NetworkSimulatorTest, DeterministicWithSeed) {
+    dw::NetworkConditions conditions;
+    conditions.latency = 0.05f;
+    conditions.jitter = 0.02f;
+    conditions.packet_loss = 0.2f;
+    conditions.duplicate_chance = 0.1f;
+    conditions.reorder_chance = 0.1f;
+    conditions.seed = 1234;
+    dw::NetworkSimulator a(conditions);
+    dw::NetworkSimulator b(conditions);
+    EXPECT_EQ(sendAndReceive(a, 100), sendAndReceive(b, 100));
+}
@@ -128,6 +128,20 @@ private:
 UniquePtr<YojimboContext> YojimboContext::context_ = nullptr;
 int YojimboContext::ref_count_ = 0;
 
+// Each TransportChannel maps to the yojimbo channel with the same index.
+const int num_channels = 2;
+
+yojimbo::ClientServerConfig createConfig() {
+    yojimbo::ClientServerConfig config;
+    config.timeout = -1;  // Disable timeout.
+    config.numChannels = num_channels;
+    config.channel[static_cast<int>(TransportChannel::Reliable)].type =
+        yojimbo::CHANNEL_TYPE_RELIABLE_ORDERED;
+    config.channel[static_cast<int>(TransportChannel::Unreliable)].type =
+        yojimbo::CHANNEL_TYPE_UNRELIABLE_UNORDERED;
+    return config;
+}
+
 #ifdef DW_MSVC
 #pragma warning(pop)
 #endif
@@ -178,8 +192,7 @@ void ReliableUDPServer::listen(const String& host, u16 port, u16 max_connections
         disconnect();
     }
 
-    yojimbo::ClientServerConfig config;
-    config.timeout = -1;  // Disable timeout.
+    yojimbo::ClientServerConfig config = createConfig();
 
     uint8_t privateKey[yojimbo::KeyBytes];
     memset(privateKey, 0, yojimbo::KeyBytes);
@@ -194,6 +207,7 @@ void ReliableUDPServer::listen(const String& host, u16 port, u16 max_connections
 void ReliableUDPServer::disconnect() {
     if (server_) {
         assert(server_connection_state_ == ServerConnectionState::Listening);
+        releaseReceivedMessages();
         server_->Stop();
         server_.reset();
         server_connection_state_ = ServerConnectionState::NotListening;
@@ -201,17 +215,19 @@ void ReliableUDPServer::disconnect() {
 }
 
 void ReliableUDPServer::update(float dt) {
+    releaseReceivedMessages();
     server_->AdvanceTime(time_);
     time_ += dt;
     server_->SendPackets();
     server_->ReceivePackets();
 }
 
-void ReliableUDPServer::send(ClientId client, const byte* data, u32 length) {
+void ReliableUDPServer::send(ClientId client, const byte* data, u32 length,
+                             TransportChannel channel) {
     auto* to_client_message =
         static_cast<ToClientMessage*>(server_->CreateMessage(client, MT_ToClient));
     to_client_message->payload.assign(data, data + length);
-    server_->SendMessage(client, 0, to_client_message);
+    server_->SendMessage(client, static_cast<int>(channel), to_client_message);
 }
 
 Option<ServerPacket> ReliableUDPServer::receive(ClientId client) {
@@ -219,19 +235,28 @@ Option<ServerPacket> ReliableUDPServer::receive(ClientId client) {
         return {};
     }
 
-    // Fetch a message from the next client.
-    yojimbo::Message* message = server_->ReceiveMessage(client, 0);
+    // Fetch a message from this client, from any channel.
+    yojimbo::Message* message = nullptr;
+    int channel = 0;
+    for (; channel < num_channels; ++channel) {
+        message = server_->ReceiveMessage(client, channel);
+        if (message) {
+            break;
+        }
+    }
     if (!message) {
         return {};
     }
     assert(message->GetType() == MT_ToServer);
     auto* to_server_message = static_cast<ToServerMessage*>(message);
+    received_messages_.emplace_back(client, message);
 
-    // Extract the data.
+    // Return a view of the payload, which stays alive until the message is released.
     ServerPacket packet;
     packet.client = client;
-    packet.data = std::move(to_server_message->payload);
-
+    packet.data = to_server_message->payload.data();
+    packet.length = static_cast<u32>(to_server_message->payload.size());
+    packet.channel = static_cast<TransportChannel>(channel);
     return {packet};
 }
 
@@ -251,6 +276,24 @@ usize ReliableUDPServer::maxConnections() const {
     return server_->GetMaxClients();
 }
 
+TransportConnectionStats ReliableUDPServer::connectionStats(ClientId client) const {
+    TransportConnectionStats stats;
+    if (server_ && server_->IsClientConnected(client)) {
+        yojimbo::NetworkInfo info;
+        server_->GetNetworkInfo(client, info);
+        stats.rtt = info.RTT / 1000.0f;
+        stats.packet_loss = info.packetLoss / 100.0f;
+    }
+    return stats;
+}
+
+void ReliableUDPServer::releaseReceivedMessages() {
+    for (auto& received : received_messages_) {
+        server_->ReleaseMessage(received.first, received.second);
+    }
+    received_messages_.clear();
+}
+
 ReliableUDPClient::ReliableUDPClient(Context* ctx, Function<void()> connected,
                                      Function<void()> connection_failed,
                                      Function<void()> disconnected)
@@ -267,12 +310,14 @@ ReliableUDPClient::ReliableUDPClient(Context* ctx, Function<void()> connected,
 }
 
 ReliableUDPClient::~ReliableUDPClient() {
+    if (client_) {
+        releaseReceivedMessages();
+    }
     YojimboContext::release();
 }
 
 void ReliableUDPClient::connect(const String& host, u16 port) {
-    yojimbo::ClientServerConfig config;
-    config.timeout = -1;  // Disable timeout.
+    yojimbo::ClientServerConfig config = createConfig();
 
     uint8_t privateKey[yojimbo::KeyBytes];
     memset(privateKey, 0, yojimbo::KeyBytes);
@@ -293,6 +338,7 @@ void ReliableUDPClient::connect(const String& host, u16 port) {
 void ReliableUDPClient::disconnect() {
     if (client_) {
         assert(client_connection_state_ > ClientConnectionState::Disconnected);
+        releaseReceivedMessages();
         client_->Disconnect();
         client_.reset();
         client_connection_state_ = ClientConnectionState::Disconnected;
@@ -300,6 +346,7 @@ void ReliableUDPClient::disconnect() {
 }
 
 void ReliableUDPClient::update(float dt) {
+    releaseReceivedMessages();
     client_->AdvanceTime(time_);
     time_ += dt;
     client_->SendPackets();
@@ -331,10 +378,10 @@ void ReliableUDPClient::update(float dt) {
     }
 }
 
-void ReliableUDPClient::send(const byte* data, u32 length) {
+void ReliableUDPClient::send(const byte* data, u32 length, TransportChannel channel) {
     auto* to_server_message = static_cast<ToServerMessage*>(client_->CreateMessage(MT_ToServer));
     to_server_message->payload.assign(data, data + length);
-    client_->SendMessage(0, to_server_message);
+    client_->SendMessage(static_cast<int>(channel), to_server_message);
 }
 
 Option<ClientPacket> ReliableUDPClient::receive() {
@@ -342,22 +389,49 @@ Option<ClientPacket> ReliableUDPClient::receive() {
         return {};
     }
 
-    // Fetch a message from the next client.
-    yojimbo::Message* message = client_->ReceiveMessage(0);
+    // Fetch a message from any channel.
+    yojimbo::Message* message = nullptr;
+    int channel = 0;
+    for (; channel < num_channels; ++channel) {
+        message = client_->ReceiveMessage(channel);
+        if (message) {
+            break;
+        }
+    }
     if (!message) {
         return {};
     }
     assert(message->GetType() == MT_ToClient);
     auto* to_client_message = static_cast<ToClientMessage*>(message);
+    received_messages_.emplace_back(message);
 
-    // Extract the data.
+    // Return a view of the payload, which stays alive until the message is released.
     ClientPacket packet;
-    packet.data = std::move(to_client_message->payload);
-
+    packet.data = to_client_message->payload.data();
+    packet.length = static_cast<u32>(to_client_message->payload.size());
+    packet.channel = static_cast<TransportChannel>(channel);
     return {packet};
 }
 
 ClientConnectionState ReliableUDPClient::connectionState() const {
     return client_connection_state_;
 }
+
+TransportConnectionStats ReliableUDPClient::connectionStats() const {
+    TransportConnectionStats stats;
+    if (client_ && client_->IsConnected()) {
+        yojimbo::NetworkInfo info;
+        client_->GetNetworkInfo(info);
+        stats.rtt = info.RTT / 1000.0f;
+        stats.packet_loss = info.packetLoss / 100.0f;
+    }
+    return stats;
+}
+
+void ReliableUDPClient::releaseReceivedMessages() {
+    for (auto* message : received_messages_) {
+        client_->ReleaseMessage(message);
+    }
+    received_messages_.clear();
+}
 }  // namespace dw
@@ -35,19 +35,26 @@ public:
     void disconnect() override;
 
     void update(float dt) override;
-    void send(ClientId client, const byte* data, u32 length) override;
+    void send(ClientId client, const byte* data, u32 length,
+              TransportChannel channel = TransportChannel::Reliable) override;
     Option<ServerPacket> receive(ClientId client) override;
     bool isClientConnected(ClientId client) const override;
     usize numConnections() const override;
     usize maxConnections() const override;
 
     ServerConnectionState connectionState() const override;
+    TransportConnectionStats connectionStats(ClientId client) const override;
 
 private:
     UniquePtr<YojimboAdapter> adapter_;
     UniquePtr<yojimbo::Server> server_;
     ServerConnectionState server_connection_state_;
     double time_;
+
+    // Messages returned by receive() are kept alive until the next update.
+    Vector<Pair<ClientId, yojimbo::Message*>> received_messages_;
+
+    void releaseReceivedMessages();
 };
 
 class ReliableUDPClient : public Object, public TransportClient {
@@ -62,10 +69,12 @@ public:
     void disconnect() override;
 
     void update(float dt) override;
-    void send(const byte* data, u32 length) override;
+    void send(const byte* data, u32 length,
+              TransportChannel channel = TransportChannel::Reliable) override;
     Option<ClientPacket> receive() override;
 
     ClientConnectionState connectionState() const override;
+    TransportConnectionStats connectionStats() const override;
 
 private:
     UniquePtr<YojimboAdapter> adapter_;
@@ -73,8 +82,13 @@ private:
     ClientConnectionState client_connection_state_;
     double time_;
 
+    // Messages returned by receive() are kept alive until the next update.
+    Vector<yojimbo::Message*> received_messages_;
+
     Function<void()> connected_;
     Function<void()> connection_failed_;
     Function<void()> disconnected_;
+
+    void releaseReceivedMessages();
 };
 }  // namespace dw
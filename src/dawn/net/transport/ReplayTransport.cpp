@@ -0,0 +1,168 @@
+/*
+ * Dawn Engine
+ * Written by David Avedissian (c) 2012-2019 (git@dga.dev)
+ */
+#include "Base.h"
+#include "net/transport/ReplayTransport.h"
+
+namespace dw {
+RecordingServer::RecordingServer(Context* ctx, UniquePtr<TransportServer> server,
+                                 UniquePtr<ReplayWriter> writer)
+    : Object(ctx), server_(std::move(server)), writer_(std::move(writer)), time_(0.0) {
+}
+
+void RecordingServer::listen(const String& host, u16 port, u16 max_connections) {
+    server_->listen(host, port, max_connections);
+}
+
+void RecordingServer::disconnect() {
+    server_->disconnect();
+    writer_->close();
+}
+
+void RecordingServer::update(float dt) {
+    time_ += dt;
+    server_->update(dt);
+}
+
+void RecordingServer::send(ClientId client, const byte* data, u32 length,
+                           TransportChannel channel) {
+    if (!server_->isClientConnected(client)) {
+        return;
+    }
+    writer_->record(time_, ReplayDirection::ToClient, client, channel, data, length);
+    server_->send(client, data, length, channel);
+}
+
+Option<ServerPacket> RecordingServer::receive(ClientId client) {
+    auto packet = server_->receive(client);
+    if (packet) {
+        writer_->record(time_, ReplayDirection::ToServer, packet->client, packet->channel,
+                        packet->data, packet->length);
+    }
+    return packet;
+}
+
+bool RecordingServer::isClientConnected(ClientId client) const {
+    return server_->isClientConnected(client);
+}
+
+usize RecordingServer::numConnections() const {
+    return server_->numConnections();
+}
+
+usize RecordingServer::maxConnections() const {
+    return server_->maxConnections();
+}
+
+ServerConnectionState RecordingServer::connectionState() const {
+    return server_->connectionState();
+}
+
+TransportConnectionStats RecordingServer::connectionStats(ClientId client) const {
+    return server_->connectionStats(client);
+}
+
+ReplayClient::ReplayClient(Context* ctx, const Path& path, ClientId client,
+                           Function<void()> connected, Function<void()> connection_failed,
+                           Function<void()> disconnected)
+    : Object(ctx),
+      path_(path),
+      client_(client),
+      reader_(ctx),
+      connection_state_(ClientConnectionState::Disconnected),
+      time_(0.0),
+      next_received_(0),
+      connected_(connected),
+      connection_failed_(connection_failed),
+      disconnected_(disconnected) {
+}
+
+void ReplayClient::connect(const String&, u16) {
+    received_.clear();
+    next_received_ = 0;
+    next_record_.reset();
+    auto result = reader_.open(path_);
+    if (!result) {
+        log().error("Unable to play back replay: {}", result.error());
+        connection_failed_();
+        return;
+    }
+    connection_state_ = ClientConnectionState::Connecting;
+}
+
+void ReplayClient::disconnect() {
+    if (connection_state_ == ClientConnectionState::Disconnected) {
+        return;
+    }
+    connection_state_ = ClientConnectionState::Disconnected;
+    received_.clear();
+    next_received_ = 0;
+    next_record_.reset();
+    disconnected_();
+}
+
+void ReplayClient::update(float dt) {
+    // Packets returned by receive() in the previous tick are no longer in use.
+    received_.erase(received_.begin(), received_.begin() + next_received_);
+    next_received_ = 0;
+
+    if (connection_state_ == ClientConnectionState::Connecting) {
+        // Start playing back from the first message sent to the client.
+        if (!readNextRecord()) {
+            connection_state_ = ClientConnectionState::Disconnected;
+            log().error("Replay {} contains no messages for client {}.", path_, client_);
+            connection_failed_();
+            return;
+        }
+        time_ = next_record_->time;
+        connection_state_ = ClientConnectionState::Connected;
+        connected_();
+    } else if (connection_state_ == ClientConnectionState::Connected) {
+        time_ += dt;
+    } else {
+        return;
+    }
+
+    while (next_record_ && next_record_->time <= time_) {
+        received_.emplace_back(std::move(*next_record_));
+        next_record_.reset();
+        readNextRecord();
+    }
+
+    // Disconnect once the client has received everything.
+    if (!next_record_ && received_.empty()) {
+        disconnect();
+    }
+}
+
+void ReplayClient::send(const byte*, u32, TransportChannel) {
+}
+
+Option<ClientPacket> ReplayClient::receive() {
+    if (next_received_ >= received_.size()) {
+        return {};
+    }
+    auto& record = received_[next_received_++];
+    return {ClientPacket{record.data.data(), static_cast<u32>(record.data.size()),
+                         record.channel}};
+}
+
+ClientConnectionState ReplayClient::connectionState() const {
+    return connection_state_;
+}
+
+double ReplayClient::time() const {
+    return time_;
+}
+
+bool ReplayClient::readNextRecord() {
+    while (auto* record = reader_.next()) {
+        if (record->direction == ReplayDirection::ToClient && record->client == client_) {
+            next_record_ = *record;
+            return true;
+        }
+    }
+    return false;
+}
+}  // namespace dw
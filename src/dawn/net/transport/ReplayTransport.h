@@ -0,0 +1,86 @@
+/*
+ * Dawn Engine
+ * Written by David Avedissian (c) 2012-2019 (git@dga.dev)
+ */
+#pragma once
+
+#include "net/Replay.h"
+#include "net/transport/Transport.h"
+
+namespace dw {
+// A transport server which records every message sent to and received from clients into a
+// replay, before passing them to another transport.
+class DW_API RecordingServer : public Object, public TransportServer {
+public:
+    DW_OBJECT(RecordingServer);
+
+    RecordingServer(Context* ctx, UniquePtr<TransportServer> server,
+                    UniquePtr<ReplayWriter> writer);
+    ~RecordingServer() = default;
+
+    void listen(const String& host, u16 port, u16 max_connections) override;
+    void disconnect() override;
+
+    void update(float dt) override;
+    void send(ClientId client, const byte* data, u32 length,
+              TransportChannel channel = TransportChannel::Reliable) override;
+    Option<ServerPacket> receive(ClientId client) override;
+    bool isClientConnected(ClientId client) const override;
+    usize numConnections() const override;
+    usize maxConnections() const override;
+
+    ServerConnectionState connectionState() const override;
+    TransportConnectionStats connectionStats(ClientId client) const override;
+
+private:
+    UniquePtr<TransportServer> server_;
+    UniquePtr<ReplayWriter> writer_;
+    double time_;
+};
+
+// A transport client which plays back the messages a server sent to one of its clients in a
+// replay, at the rate they were recorded. The client "connects" in the tick after connect() is
+// called, and disconnects when the end of the replay is reached. Messages sent by the client are
+// discarded.
+class DW_API ReplayClient : public Object, public TransportClient {
+public:
+    DW_OBJECT(ReplayClient);
+
+    ReplayClient(Context* ctx, const Path& path, ClientId client, Function<void()> connected,
+                 Function<void()> connection_failed, Function<void()> disconnected);
+    ~ReplayClient() = default;
+
+    // The host and port are ignored.
+    void connect(const String& host, u16 port) override;
+    void disconnect() override;
+
+    void update(float dt) override;
+    void send(const byte* data, u32 length,
+              TransportChannel channel = TransportChannel::Reliable) override;
+    Option<ClientPacket> receive() override;
+
+    ClientConnectionState connectionState() const override;
+
+    // Time within the replay, in seconds.
+    double time() const;
+
+private:
+    Path path_;
+    ClientId client_;
+    ReplayReader reader_;
+    ClientConnectionState connection_state_;
+    double time_;
+
+    // Next record for the client which is due after the current time, if any.
+    Option<ReplayRecord> next_record_;
+    Vector<ReplayRecord> received_;
+    usize next_received_;
+
+    Function<void()> connected_;
+    Function<void()> connection_failed_;
+    Function<void()> disconnected_;
+
+    // Reads the next record sent to the client, or returns false at the end of the replay.
+    bool readNextRecord();
+};
+}  // namespace dw
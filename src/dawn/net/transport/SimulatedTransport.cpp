@@ -0,0 +1,302 @@
+/*
+ * Dawn Engine
+ * Written by David Avedissian (c) 2012-2019 (git@dga.dev)
+ */
+#include "Base.h"
+#include "net/transport/SimulatedTransport.h"
+
+#include <algorithm>
+
+namespace dw {
+namespace {
+// Each direction of each link gets its own random number stream, derived from the seed.
+NetworkConditions deriveConditions(const NetworkConditions& conditions, u64 stream) {
+    NetworkConditions derived = conditions;
+    derived.seed = conditions.seed + (stream + 1) * 0x9E3779B97F4A7C15ull;
+    return derived;
+}
+
+// Adds the effect of simulated conditions to the stats of the transport underneath. Packets are
+// delayed by the latency plus half the jitter on average in each direction.
+TransportConnectionStats simulatedStats(TransportConnectionStats stats,
+                                        const NetworkConditions& conditions) {
+    stats.rtt += 2.0f * (conditions.latency + conditions.jitter * 0.5f);
+    stats.packet_loss += (1.0f - stats.packet_loss) * conditions.packet_loss;
+    return stats;
+}
+
+// Orders the in flight heap so that the earliest delivery is at the front.
+template <typename T> bool deliversLater(const T& a, const T& b) {
+    if (a.delivery_time != b.delivery_time) {
+        return a.delivery_time > b.delivery_time;
+    }
+    return a.sequence > b.sequence;
+}
+}  // namespace
+
+NetworkSimulator::NetworkSimulator(const NetworkConditions& conditions)
+    : next_sequence_(0), link_free_time_(0.0), last_delivery_time_(0.0) {
+    setConditions(conditions);
+}
+
+void NetworkSimulator::setConditions(const NetworkConditions& conditions) {
+    conditions_ = conditions;
+    random_.seed(conditions.seed);
+}
+
+const NetworkConditions& NetworkSimulator::conditions() const {
+    return conditions_;
+}
+
+void NetworkSimulator::send(double time, const byte* data, u32 length,
+                            TransportChannel channel) {
+    bool reliable = channel == TransportChannel::Reliable;
+
+    // Wait for the link to finish sending earlier packets.
+    double arrival_time = time;
+    if (conditions_.bandwidth > 0) {
+        double start_time = std::max(time, link_free_time_);
+        if (!reliable && start_time - time > conditions_.max_queue_delay) {
+            return;
+        }
+        link_free_time_ = start_time + static_cast<double>(length) / conditions_.bandwidth;
+        arrival_time = link_free_time_;
+    }
+
+    if (random01() < conditions_.packet_loss && !reliable) {
+        return;
+    }
+
+    int copies = random01() < conditions_.duplicate_chance && !reliable ? 2 : 1;
+    for (int i = 0; i < copies; ++i) {
+        double delivery_time = arrival_time + conditions_.latency + random01() * conditions_.jitter;
+        if (random01() < conditions_.reorder_chance && !reliable) {
+            // Held back packets don't hold back any packets sent after them.
+            delivery_time += random01() * (conditions_.latency + conditions_.jitter);
+        } else {
+            delivery_time = std::max(delivery_time, last_delivery_time_);
+            last_delivery_time_ = delivery_time;
+        }
+        schedule(delivery_time, SimulatedPacket{channel, Vector<byte>(data, data + length)});
+    }
+}
+
+Option<SimulatedPacket> NetworkSimulator::receive(double time) {
+    if (in_flight_.empty() || in_flight_.front().delivery_time > time) {
+        return {};
+    }
+    std::pop_heap(in_flight_.begin(), in_flight_.end(), deliversLater<InFlightPacket>);
+    SimulatedPacket packet = std::move(in_flight_.back().packet);
+    in_flight_.pop_back();
+    return {std::move(packet)};
+}
+
+usize NetworkSimulator::packetsInFlight() const {
+    return in_flight_.size();
+}
+
+void NetworkSimulator::clear() {
+    in_flight_.clear();
+    link_free_time_ = 0.0;
+    last_delivery_time_ = 0.0;
+}
+
+float NetworkSimulator::random01() {
+    // Use the top 24 bits, so the result is the same regardless of the standard library.
+    return static_cast<float>(random_() >> 40) / static_cast<float>(1 << 24);
+}
+
+void NetworkSimulator::schedule(double delivery_time, SimulatedPacket packet) {
+    in_flight_.emplace_back(InFlightPacket{delivery_time, next_sequence_++, std::move(packet)});
+    std::push_heap(in_flight_.begin(), in_flight_.end(), deliversLater<InFlightPacket>);
+}
+
+SimulatedServer::SimulatedServer(Context* ctx, UniquePtr<TransportServer> server,
+                                 const NetworkConditions& conditions)
+    : Object(ctx), server_(std::move(server)), conditions_(conditions), time_(0.0) {
+}
+
+void SimulatedServer::setConditions(const NetworkConditions& conditions) {
+    conditions_ = conditions;
+    for (usize i = 0; i < links_.size(); ++i) {
+        if (links_[i]) {
+            links_[i]->outgoing.setConditions(deriveConditions(conditions, i * 2));
+            links_[i]->incoming.setConditions(deriveConditions(conditions, i * 2 + 1));
+        }
+    }
+}
+
+const NetworkConditions& SimulatedServer::conditions() const {
+    return conditions_;
+}
+
+void SimulatedServer::listen(const String& host, u16 port, u16 max_connections) {
+    links_.clear();
+    server_->listen(host, port, max_connections);
+}
+
+void SimulatedServer::disconnect() {
+    links_.clear();
+    server_->disconnect();
+}
+
+void SimulatedServer::update(float dt) {
+    time_ += dt;
+
+    // Packets returned by receive() in the previous tick are no longer in use.
+    delivered_.clear();
+
+    // Pass packets which have made it across the simulated link to the real transport.
+    for (ClientId client = 0; client < links_.size(); ++client) {
+        if (!links_[client]) {
+            continue;
+        }
+        if (!server_->isClientConnected(client)) {
+            links_[client].reset();
+            continue;
+        }
+        while (auto packet = links_[client]->outgoing.receive(time_)) {
+            server_->send(client, packet->data.data(), static_cast<u32>(packet->data.size()),
+                          packet->channel);
+        }
+    }
+
+    server_->update(dt);
+}
+
+void SimulatedServer::send(ClientId client, const byte* data, u32 length,
+                           TransportChannel channel) {
+    if (!server_->isClientConnected(client)) {
+        return;
+    }
+    link(client).outgoing.send(time_, data, length, channel);
+}
+
+Option<ServerPacket> SimulatedServer::receive(ClientId client) {
+    if (!server_->isClientConnected(client)) {
+        return {};
+    }
+
+    // Move everything the real transport has received into the simulated link.
+    auto& client_link = link(client);
+    while (auto packet = server_->receive(client)) {
+        client_link.incoming.send(time_, packet->data, packet->length, packet->channel);
+    }
+
+    auto received = client_link.incoming.receive(time_);
+    if (!received) {
+        return {};
+    }
+    delivered_.emplace_back(std::move(*received));
+    auto& packet = delivered_.back();
+    return {ServerPacket{client, packet.data.data(), static_cast<u32>(packet.data.size()),
+                         packet.channel}};
+}
+
+bool SimulatedServer::isClientConnected(ClientId client) const {
+    return server_->isClientConnected(client);
+}
+
+usize SimulatedServer::numConnections() const {
+    return server_->numConnections();
+}
+
+usize SimulatedServer::maxConnections() const {
+    return server_->maxConnections();
+}
+
+ServerConnectionState SimulatedServer::connectionState() const {
+    return server_->connectionState();
+}
+
+TransportConnectionStats SimulatedServer::connectionStats(ClientId client) const {
+    auto stats = simulatedStats(server_->connectionStats(client), conditions_);
+    if (client < links_.size() && links_[client]) {
+        stats.queued_packets += links_[client]->outgoing.packetsInFlight();
+    }
+    return stats;
+}
+
+SimulatedServer::ClientLink& SimulatedServer::link(ClientId client) {
+    if (client >= links_.size()) {
+        links_.resize(client + 1);
+    }
+    if (!links_[client]) {
+        links_[client] = makeUnique<ClientLink>();
+        links_[client]->outgoing.setConditions(deriveConditions(conditions_, client * 2u));
+        links_[client]->incoming.setConditions(deriveConditions(conditions_, client * 2u + 1));
+    }
+    return *links_[client];
+}
+
+SimulatedClient::SimulatedClient(Context* ctx, UniquePtr<TransportClient> client,
+                                 const NetworkConditions& conditions)
+    : Object(ctx), client_(std::move(client)), time_(0.0) {
+    setConditions(conditions);
+}
+
+void SimulatedClient::setConditions(const NetworkConditions& conditions) {
+    outgoing_.setConditions(deriveConditions(conditions, 0));
+    incoming_.setConditions(deriveConditions(conditions, 1));
+}
+
+const NetworkConditions& SimulatedClient::conditions() const {
+    return outgoing_.conditions();
+}
+
+void SimulatedClient::connect(const String& host, u16 port) {
+    outgoing_.clear();
+    incoming_.clear();
+    client_->connect(host, port);
+}
+
+void SimulatedClient::disconnect() {
+    outgoing_.clear();
+    incoming_.clear();
+    client_->disconnect();
+}
+
+void SimulatedClient::update(float dt) {
+    time_ += dt;
+
+    // Packets returned by receive() in the previous tick are no longer in use.
+    delivered_.clear();
+
+    if (client_->connectionState() == ClientConnectionState::Connected) {
+        while (auto packet = outgoing_.receive(time_)) {
+            client_->send(packet->data.data(), static_cast<u32>(packet->data.size()),
+                          packet->channel);
+        }
+    }
+
+    client_->update(dt);
+}
+
+void SimulatedClient::send(const byte* data, u32 length, TransportChannel channel) {
+    outgoing_.send(time_, data, length, channel);
+}
+
+Option<ClientPacket> SimulatedClient::receive() {
+    while (auto packet = client_->receive()) {
+        incoming_.send(time_, packet->data, packet->length, packet->channel);
+    }
+
+    auto received = incoming_.receive(time_);
+    if (!received) {
+        return {};
+    }
+    delivered_.emplace_back(std::move(*received));
+    auto& packet = delivered_.back();
+    return {ClientPacket{packet.data.data(), static_cast<u32>(packet.data.size()), packet.channel}};
+}
+
+ClientConnectionState SimulatedClient::connectionState() const {
+    return client_->connectionState();
+}
+
+TransportConnectionStats SimulatedClient::connectionStats() const {
+    auto stats = simulatedStats(client_->connectionStats(), conditions());
+    stats.queued_packets += outgoing_.packetsInFlight();
+    return stats;
+}
+}  // namespace dw
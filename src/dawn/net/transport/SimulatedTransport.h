@@ -0,0 +1,163 @@
+/*
+ * Dawn Engine
+ * Written by David Avedissian (c) 2012-2019 (git@dga.dev)
+ */
+#pragma once
+
+#include "net/transport/Transport.h"
+
+#include <random>
+
+namespace dw {
+// Conditions of a simulated network link. All times are in seconds.
+struct DW_API NetworkConditions {
+    // One way delay applied to every packet.
+    float latency = 0.0f;
+
+    // Maximum random delay added on top of the latency.
+    float jitter = 0.0f;
+
+    // Probability of a packet being dropped.
+    float packet_loss = 0.0f;
+
+    // Probability of a packet being delivered twice.
+    float duplicate_chance = 0.0f;
+
+    // Probability of a packet being held back for up to (latency + jitter) longer, allowing later
+    // packets to overtake it. Other packets are always delivered in the order they were sent.
+    float reorder_chance = 0.0f;
+
+    // Link capacity in bytes per second, or 0 for unlimited.
+    u32 bandwidth = 0;
+
+    // Packets which would have to wait longer than this for the link to become free are dropped.
+    float max_queue_delay = 1.0f;
+
+    // Seed of the random number generator. Links using the same seed and sending the same packets
+    // at the same times behave identically.
+    u64 seed = 0;
+};
+
+// A packet which has made it across a simulated link.
+struct DW_API SimulatedPacket {
+    TransportChannel channel;
+    Vector<byte> data;
+};
+
+// Simulates a single direction of a network link. Packets are sent into the simulator at a point
+// in time, and can be received once they've arrived. Packets sent on the reliable channel are
+// delayed like any other packet, but are never lost, duplicated or reordered, as the transport
+// underneath would resend them.
+class DW_API NetworkSimulator {
+public:
+    explicit NetworkSimulator(const NetworkConditions& conditions = {});
+
+    // Change the link conditions. This also resets the random number generator with the new seed.
+    void setConditions(const NetworkConditions& conditions);
+    const NetworkConditions& conditions() const;
+
+    // Send a packet into the link at a time.
+    void send(double time, const byte* data, u32 length,
+              TransportChannel channel = TransportChannel::Unreliable);
+
+    // Receive the next packet which has arrived by a time, if any.
+    Option<SimulatedPacket> receive(double time);
+
+    // Number of packets which have been sent but not received.
+    usize packetsInFlight() const;
+
+    // Drop all packets in flight.
+    void clear();
+
+private:
+    struct InFlightPacket {
+        double delivery_time;
+        u64 sequence;
+        SimulatedPacket packet;
+    };
+
+    NetworkConditions conditions_;
+    std::mt19937_64 random_;
+    Vector<InFlightPacket> in_flight_;
+    u64 next_sequence_;
+    double link_free_time_;
+    double last_delivery_time_;
+
+    float random01();
+    void schedule(double delivery_time, SimulatedPacket packet);
+};
+
+// A transport server which routes all packets through a NetworkSimulator in each direction before
+// passing them to another transport.
+class DW_API SimulatedServer : public Object, public TransportServer {
+public:
+    DW_OBJECT(SimulatedServer);
+
+    SimulatedServer(Context* ctx, UniquePtr<TransportServer> server,
+                    const NetworkConditions& conditions);
+    ~SimulatedServer() = default;
+
+    void setConditions(const NetworkConditions& conditions);
+    const NetworkConditions& conditions() const;
+
+    void listen(const String& host, u16 port, u16 max_connections) override;
+    void disconnect() override;
+
+    void update(float dt) override;
+    void send(ClientId client, const byte* data, u32 length,
+              TransportChannel channel = TransportChannel::Reliable) override;
+    Option<ServerPacket> receive(ClientId client) override;
+    bool isClientConnected(ClientId client) const override;
+    usize numConnections() const override;
+    usize maxConnections() const override;
+
+    ServerConnectionState connectionState() const override;
+    TransportConnectionStats connectionStats(ClientId client) const override;
+
+private:
+    struct ClientLink {
+        NetworkSimulator outgoing;
+        NetworkSimulator incoming;
+    };
+
+    UniquePtr<TransportServer> server_;
+    NetworkConditions conditions_;
+    Vector<UniquePtr<ClientLink>> links_;
+    Vector<SimulatedPacket> delivered_;
+    double time_;
+
+    ClientLink& link(ClientId client);
+};
+
+// A transport client which routes all packets through a NetworkSimulator in each direction before
+// passing them to another transport.
+class DW_API SimulatedClient : public Object, public TransportClient {
+public:
+    DW_OBJECT(SimulatedClient);
+
+    SimulatedClient(Context* ctx, UniquePtr<TransportClient> client,
+                    const NetworkConditions& conditions);
+    ~SimulatedClient() = default;
+
+    void setConditions(const NetworkConditions& conditions);
+    const NetworkConditions& conditions() const;
+
+    void connect(const String& host, u16 port) override;
+    void disconnect() override;
+
+    void update(float dt) override;
+    void send(const byte* data, u32 length,
+              TransportChannel channel = TransportChannel::Reliable) override;
+    Option<ClientPacket> receive() override;
+
+    ClientConnectionState connectionState() const override;
+    TransportConnectionStats connectionStats() const override;
+
+private:
+    UniquePtr<TransportClient> client_;
+    NetworkSimulator outgoing_;
+    NetworkSimulator incoming_;
+    Vector<SimulatedPacket> delivered_;
+    double time_;
+};
+}  // namespace dw
@@ -0,0 +1,267 @@
+/*
+ * Dawn Engine
+ * Written by David Avedissian (c) 2012-2019 (git@dga.dev)
+ */
+#include "Testing.h"
+#include "net/transport/ThreadedTransport.h"
+
+namespace {
+const dw::byte new_client_packet = 0xBB;
+
+// A server with a single client, which sends back every packet it receives.
+class EchoServer : public dw::TransportServer {
+public:
+    // When set, the next update replaces the client with a new one, which sends new_client_packet.
+    dw::Atomic<bool> reconnect{false};
+
+    // Number of packets returned by receive().
+    dw::Atomic<dw::usize> received_packets{0};
+
+    EchoServer(dw::Function<void(dw::ClientId)> client_connected,
+               dw::Function<void(dw::ClientId)> client_disconnected)
+        : client_connected_(client_connected),
+          client_disconnected_(client_disconnected),
+          listening_(false),
+          connected_(false) {
+    }
+
+    void listen(const dw::String&, dw::u16, dw::u16) override {
+        listening_ = true;
+    }
+
+    void disconnect() override {
+        if (connected_) {
+            connected_ = false;
+            client_disconnected_(0);
+        }
+        listening_ = false;
+    }
+
+    void update(float) override {
+        received_.clear();
+        next_received_ = 0;
+        if (listening_ && !connected_) {
+            connected_ = true;
+            client_connected_(0);
+        } else if (connected_ && reconnect.exchange(false)) {
+            client_disconnected_(0);
+            client_connected_(0);
+            sent_.clear();
+            sent_.emplace_back(dw::TransportChannel::Reliable,
+                               dw::Vector<dw::byte>{new_client_packet});
+        }
+        received_.swap(sent_);
+    }
+
+    void send(dw::ClientId, const dw::byte* data, dw::u32 length,
+              dw::TransportChannel channel) override {
+        sent_.emplace_back(channel, dw::Vector<dw::byte>(data, data + length));
+    }
+
+    dw::Option<dw::ServerPacket> receive(dw::ClientId client) override {
+        if (client != 0 || next_received_ >= received_.size()) {
+            return {};
+        }
+        auto& packet = received_[next_received_++];
+        received_packets++;
+        return {dw::ServerPacket{client, packet.second.data(),
+                                 static_cast<dw::u32>(packet.second.size()), packet.first}};
+    }
+
+    bool isClientConnected(dw::ClientId client) const override {
+        return client == 0 && connected_;
+    }
+
+    dw::usize numConnections() const override {
+        return connected_ ? 1 : 0;
+    }
+
+    dw::usize maxConnections() const override {
+        return 1;
+    }
+
+    dw::ServerConnectionState connectionState() const override {
+        return listening_ ? dw::ServerConnectionState::Listening
+                          : dw::ServerConnectionState::NotListening;
+    }
+
+private:
+    using Packet = dw::Pair<dw::TransportChannel, dw::Vector<dw::byte>>;
+
+    dw::Function<void(dw::ClientId)> client_connected_;
+    dw::Function<void(dw::ClientId)> client_disconnected_;
+    bool listening_;
+    bool connected_;
+    dw::Vector<Packet> sent_;
+    dw::Vector<Packet> received_;
+    dw::usize next_received_ = 0;
+};
+
+dw::UniquePtr<dw::TransportServer> createEchoServer(
+    dw::Function<void(dw::ClientId)> client_connected,
+    dw::Function<void(dw::ClientId)> client_disconnected) {
+    return dw::makeUnique<EchoServer>(client_connected, client_disconnected);
+}
+
+// Updates the server on the game thread until a condition is met, or a second has passed.
+template <typename Condition> bool updateUntil(dw::ThreadedServer& server, Condition condition) {
+    for (int i = 0; i < 1000; ++i) {
+        server.update(0.001f);
+        if (condition()) {
+            return true;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return false;
+}
+
+// Waits for the network thread until a condition is met, or a second has passed.
+template <typename Condition> bool waitUntil(Condition condition) {
+    for (int i = 0; i < 1000; ++i) {
+        if (condition()) {
+            return true;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return false;
+}
+}  // namespace
+
+class ThreadedServerTest : public ::testing::Test {
+public:
+    void SetUp() override {
+        context_ = dw::makeUnique<dw::Context>("", "");
+    }
+
+protected:
+    dw::UniquePtr<dw::Context> context_;
+};
+
+TEST_F(ThreadedServerTest, ConnectionEventsArriveOnGameThread) {
+    auto game_thread = std::this_thread::get_id();
+    int connected = 0;
+    int disconnected = 0;
+    dw::ThreadedServer server(
+        context_.get(), createEchoServer,
+        [&](dw::ClientId) {
+            EXPECT_EQ(game_thread, std::this_thread::get_id());
+            connected++;
+        },
+        [&](dw::ClientId) { disconnected++; });
+    server.listen("", 0, 1);
+    ASSERT_TRUE(updateUntil(server, [&]() { return server.isClientConnected(0); }));
+    EXPECT_EQ(1, connected);
+    EXPECT_EQ(1u, server.numConnections());
+
+    server.disconnect();
+    EXPECT_EQ(1, disconnected);
+    EXPECT_FALSE(server.isClientConnected(0));
+}
+
+TEST_F(ThreadedServerTest, PacketsAreSentAndReceived) {
+    dw::ThreadedServer server(context_.get(), createEchoServer, [](dw::ClientId) {},
+                              [](dw::ClientId) {});
+    server.listen("", 0, 1);
+    ASSERT_TRUE(updateUntil(server, [&]() { return server.isClientConnected(0); }));
+
+    dw::byte reliable[] = {1, 2, 3};
+    dw::byte unreliable[] = {4, 5};
+    server.send(0, reliable, 3, dw::TransportChannel::Reliable);
+    server.send(0, unreliable, 2, dw::TransportChannel::Unreliable);
+
+    dw::Vector<dw::Pair<dw::TransportChannel, dw::Vector<dw::byte>>> received;
+    ASSERT_TRUE(updateUntil(server, [&]() {
+        while (auto packet = server.receive(0)) {
+            received.emplace_back(packet->channel,
+                                  dw::Vector<dw::byte>(packet->data, packet->data + packet->length));
+        }
+        return received.size() == 2;
+    }));
+    EXPECT_EQ(dw::TransportChannel::Reliable, received[0].first);
+    EXPECT_EQ(dw::Vector<dw::byte>(reliable, reliable + 3), received[0].second);
+    EXPECT_EQ(dw::TransportChannel::Unreliable, received[1].first);
+    EXPECT_EQ(dw::Vector<dw::byte>(unreliable, unreliable + 2), received[1].second);
+}
+
+TEST_F(ThreadedServerTest, PacketFilterDropsPackets) {
+    dw::ThreadedServer server(context_.get(), createEchoServer, [](dw::ClientId) {},
+                              [](dw::ClientId) {},
+                              [](const dw::byte* data, dw::u32) { return data[0] != 0; });
+    server.listen("", 0, 1);
+    ASSERT_TRUE(updateUntil(server, [&]() { return server.isClientConnected(0); }));
+
+    dw::byte rejected = 0;
+    dw::byte accepted = 1;
+    server.send(0, &rejected, 1);
+    server.send(0, &accepted, 1);
+
+    dw::Vector<dw::byte> received;
+    ASSERT_TRUE(updateUntil(server, [&]() {
+        while (auto packet = server.receive(0)) {
+            received.push_back(packet->data[0]);
+        }
+        return !received.empty();
+    }));
+    EXPECT_EQ(dw::Vector<dw::byte>{1}, received);
+    EXPECT_EQ(1u, server.droppedPackets());
+}
+
+TEST_F(ThreadedServerTest, ReconnectedClientOnlyReceivesItsOwnPackets) {
+    EchoServer* echo_server = nullptr;
+    int connected = 0;
+    int disconnected = 0;
+    dw::ThreadedServer server(
+        context_.get(),
+        [&](dw::Function<void(dw::ClientId)> client_connected,
+            dw::Function<void(dw::ClientId)> client_disconnected) {
+            auto echo = dw::makeUnique<EchoServer>(client_connected, client_disconnected);
+            echo_server = echo.get();
+            return dw::UniquePtr<dw::TransportServer>(std::move(echo));
+        },
+        [&](dw::ClientId) { connected++; }, [&](dw::ClientId) { disconnected++; });
+    server.listen("", 0, 1);
+    ASSERT_TRUE(updateUntil(server, [&]() { return server.isClientConnected(0); }));
+
+    // Queue a packet from the first client, then replace it with a new client in the same slot
+    // before the game thread reads anything.
+    dw::byte stale = 1;
+    server.send(0, &stale, 1);
+    ASSERT_TRUE(waitUntil([&]() { return echo_server->received_packets == 1; }));
+    echo_server->reconnect = true;
+    ASSERT_TRUE(waitUntil([&]() { return echo_server->received_packets == 2; }));
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+    dw::Vector<dw::byte> received;
+    ASSERT_TRUE(updateUntil(server, [&]() {
+        while (auto packet = server.receive(0)) {
+            received.push_back(packet->data[0]);
+        }
+        return !received.empty();
+    }));
+    EXPECT_EQ(dw::Vector<dw::byte>{new_client_packet}, received);
+    EXPECT_EQ(2, connected);
+    EXPECT_EQ(1, disconnected);
+}
+
+TEST_F(ThreadedServerTest, ListensAgainAfterDisconnecting) {
+    int connected = 0;
+    dw::ThreadedServer server(context_.get(), createEchoServer,
+                              [&](dw::ClientId) { connected++; }, [](dw::ClientId) {});
+    server.listen("", 0, 1);
+    ASSERT_TRUE(updateUntil(server, [&]() { return server.isClientConnected(0); }));
+    server.disconnect();
+
+    server.listen("", 0, 1);
+    ASSERT_TRUE(updateUntil(server, [&]() { return server.isClientConnected(0); }));
+    EXPECT_EQ(2, connected);
+    dw::byte data = 7;
+    server.send(0, &data, 1);
+    dw::Vector<dw::byte> received;
+    ASSERT_TRUE(updateUntil(server, [&]() {
+        while (auto packet = server.receive(0)) {
+            received.push_back(packet->data[0]);
+        }
+        return !received.empty();
+    }));
+    EXPECT_EQ(dw::Vector<dw::byte>{7}, received);
+}
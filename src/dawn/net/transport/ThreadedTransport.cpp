@@ -0,0 +1,284 @@
+/*
+ * Dawn Engine
+ * Written by David Avedissian (c) 2012-2019 (git@dga.dev)
+ */
+#include "Base.h"
+#include "core/Timer.h"
+#include "net/Sequence.h"
+#include "net/transport/ThreadedTransport.h"
+
+namespace dw {
+namespace {
+// Packets passed to the game thread are tagged with their channel in the low byte, and the
+// generation of the connection they were received on in the remaining bits.
+const u32 channel_bits = 8;
+const u32 max_generation = 0xFFFFFF;
+
+u32 packetTag(TransportChannel channel, u32 generation) {
+    return (generation << channel_bits) | static_cast<u32>(channel);
+}
+
+u32 packetGeneration(u32 tag) {
+    return tag >> channel_bits;
+}
+
+TransportChannel packetChannel(u32 tag) {
+    return static_cast<TransportChannel>(tag & ((1u << channel_bits) - 1));
+}
+
+// Generations wrap around, so they're compared as sequence numbers.
+bool isNewerGeneration(u32 a, u32 b) {
+    return isNewerSequence(a << channel_bits, b << channel_bits);
+}
+}  // namespace
+
+ThreadedServer::ThreadedServer(Context* ctx, const ServerFactory& factory,
+                               Function<void(ClientId)> client_connected,
+                               Function<void(ClientId)> client_disconnected,
+                               PacketFilter packet_filter, double update_interval)
+    : Object(ctx),
+      client_connected_(client_connected),
+      client_disconnected_(client_disconnected),
+      packet_filter_(packet_filter),
+      update_interval_(update_interval),
+      connection_state_(ServerConnectionState::NotListening),
+      num_connections_(0),
+      running_(false),
+      dropped_packets_(0) {
+    server_ = factory(
+        [this](ClientId client) { pushEvent(ConnectionEvent::Connected, client); },
+        [this](ClientId client) { pushEvent(ConnectionEvent::Disconnected, client); });
+}
+
+ThreadedServer::~ThreadedServer() {
+    stop();
+    // Destroy the underlying transport first, as it may call the connection callbacks.
+    server_.reset();
+}
+
+void ThreadedServer::listen(const String& host, u16 port, u16 max_connections) {
+    if (connection_state_ == ServerConnectionState::Listening) {
+        disconnect();
+    }
+    events_.reset();
+    network_generations_.assign(max_connections, 0);
+    server_->listen(host, port, max_connections);
+    channels_.clear();
+    for (u16 i = 0; i < max_connections; ++i) {
+        channels_.emplace_back(makeUnique<ClientChannels>());
+    }
+    connected_.assign(max_connections, false);
+    generations_.assign(max_connections, 0);
+    {
+        LockGuard<Mutex> lock(stats_mutex_);
+        connection_stats_.assign(max_connections, {});
+    }
+    num_connections_ = 0;
+    connection_state_ = ServerConnectionState::Listening;
+    start();
+}
+
+void ThreadedServer::disconnect() {
+    stop();
+    server_->disconnect();
+
+    // Report any clients which the game thread still thinks are connected.
+    for (ClientId client = 0; client < connected_.size(); ++client) {
+        if (connected_[client]) {
+            connected_[client] = false;
+            client_disconnected_(client);
+        }
+    }
+    num_connections_ = 0;
+    channels_.clear();
+    events_.reset();
+    connection_state_ = ServerConnectionState::NotListening;
+}
+
+void ThreadedServer::update(float) {
+    // Packets returned by receive() in the previous tick are no longer in use, and packets sent
+    // since then which didn't fit in the ring buffers can now be handed over.
+    for (auto& channels : channels_) {
+        channels->incoming.release();
+        channels->outgoing.flush();
+    }
+
+    // Process connection events in the order that they happened.
+    while (auto message = events_.read()) {
+        assert(message->length == sizeof(ConnectionEvent) + sizeof(ClientId) + sizeof(u32));
+        auto event = static_cast<ConnectionEvent>(message->data[0]);
+        ClientId client;
+        u32 generation;
+        memcpy(&client, message->data + sizeof(ConnectionEvent), sizeof(ClientId));
+        memcpy(&generation, message->data + sizeof(ConnectionEvent) + sizeof(ClientId),
+               sizeof(u32));
+        if (client >= connected_.size()) {
+            continue;
+        }
+        if (event == ConnectionEvent::Connected && !connected_[client]) {
+            connected_[client] = true;
+            generations_[client] = generation;
+            num_connections_++;
+            client_connected_(client);
+        } else if (event == ConnectionEvent::Disconnected && connected_[client]) {
+            // Discard anything received on this connection which hasn't been read. Packets from a
+            // later connection in the same slot may already be queued behind them, so keep those.
+            auto& incoming = channels_[client]->incoming;
+            while (auto packet = incoming.peek()) {
+                if (isNewerGeneration(packetGeneration(packet->tag), generation)) {
+                    break;
+                }
+                incoming.read();
+            }
+            incoming.release();
+            connected_[client] = false;
+            num_connections_--;
+            client_disconnected_(client);
+        }
+    }
+    events_.release();
+}
+
+void ThreadedServer::send(ClientId client, const byte* data, u32 length,
+                          TransportChannel channel) {
+    if (!isClientConnected(client)) {
+        return;
+    }
+    channels_[client]->outgoing.write(data, length, channel);
+}
+
+Option<ServerPacket> ThreadedServer::receive(ClientId client) {
+    if (!isClientConnected(client)) {
+        return {};
+    }
+    auto& incoming = channels_[client]->incoming;
+    while (auto message = incoming.peek()) {
+        u32 generation = packetGeneration(message->tag);
+        if (isNewerGeneration(generation, generations_[client])) {
+            // Received on a later connection in the same slot, which update() hasn't reported yet.
+            return {};
+        }
+        incoming.read();
+        if (generation == generations_[client]) {
+            return {ServerPacket{client, message->data, message->length,
+                                 packetChannel(message->tag)}};
+        }
+        // Otherwise, it was received on a previous connection.
+    }
+    return {};
+}
+
+bool ThreadedServer::isClientConnected(ClientId client) const {
+    return client < connected_.size() && connected_[client];
+}
+
+usize ThreadedServer::numConnections() const {
+    return num_connections_;
+}
+
+usize ThreadedServer::maxConnections() const {
+    return connected_.size();
+}
+
+ServerConnectionState ThreadedServer::connectionState() const {
+    return connection_state_;
+}
+
+TransportConnectionStats ThreadedServer::connectionStats(ClientId client) const {
+    if (!isClientConnected(client)) {
+        return {};
+    }
+    TransportConnectionStats stats;
+    {
+        LockGuard<Mutex> lock(stats_mutex_);
+        stats = connection_stats_[client];
+    }
+    // Include packets which haven't been handed to the network thread yet.
+    stats.queued_packets += channels_[client]->outgoing.pendingMessages();
+    return stats;
+}
+
+u64 ThreadedServer::droppedPackets() const {
+    return dropped_packets_.load(std::memory_order_relaxed);
+}
+
+void ThreadedServer::start() {
+    assert(!running_);
+    running_ = true;
+    thread_ = Thread([this]() { run(); });
+}
+
+void ThreadedServer::stop() {
+    if (!running_) {
+        return;
+    }
+    running_ = false;
+    thread_.join();
+}
+
+void ThreadedServer::run() {
+    auto last_update = time::beginTiming();
+    while (running_) {
+        auto now = time::beginTiming();
+        float dt = static_cast<float>(time::elapsed(last_update, now));
+        last_update = now;
+
+        // Send packets queued by the game thread.
+        for (ClientId client = 0; client < channels_.size(); ++client) {
+            auto& outgoing = channels_[client]->outgoing;
+            while (auto message = outgoing.read()) {
+                if (server_->isClientConnected(client)) {
+                    server_->send(client, message->data, message->length,
+                                  static_cast<TransportChannel>(message->tag));
+                }
+            }
+            outgoing.release();
+        }
+
+        server_->update(dt);
+
+        // Validate received packets and pass them to the game thread.
+        for (ClientId client = 0; client < channels_.size(); ++client) {
+            auto& incoming = channels_[client]->incoming;
+            while (auto packet = server_->receive(client)) {
+                if (packet_filter_ && !packet_filter_(packet->data, packet->length)) {
+                    dropped_packets_.fetch_add(1, std::memory_order_relaxed);
+                    continue;
+                }
+                incoming.write(packet->data, packet->length,
+                               packetTag(packet->channel, network_generations_[client]));
+            }
+            incoming.flush();
+        }
+        events_.flush();
+
+        {
+            LockGuard<Mutex> lock(stats_mutex_);
+            for (ClientId client = 0; client < connection_stats_.size(); ++client) {
+                connection_stats_[client] = server_->connectionStats(client);
+            }
+        }
+
+        // Sleep for the rest of the update interval.
+        double remaining = update_interval_ - time::elapsed(now);
+        if (remaining > 0.0) {
+            std::this_thread::sleep_for(time::Duration<time::seconds>(remaining));
+        }
+    }
+}
+
+void ThreadedServer::pushEvent(ConnectionEvent event, ClientId client) {
+    u32 generation = 0;
+    if (client < network_generations_.size()) {
+        if (event == ConnectionEvent::Connected) {
+            network_generations_[client] = (network_generations_[client] + 1) & max_generation;
+        }
+        generation = network_generations_[client];
+    }
+    byte message[sizeof(ConnectionEvent) + sizeof(ClientId) + sizeof(u32)];
+    message[0] = static_cast<byte>(event);
+    memcpy(message + sizeof(ConnectionEvent), &client, sizeof(ClientId));
+    memcpy(message + sizeof(ConnectionEvent) + sizeof(ClientId), &generation, sizeof(u32));
+    events_.write(message, sizeof(message), TransportChannel::Reliable);
+}
+}  // namespace dw
@@ -0,0 +1,98 @@
+/*
+ * Dawn Engine
+ * Written by David Avedissian (c) 2012-2019 (git@dga.dev)
+ */
+#pragma once
+
+#include "core/Concurrency.h"
+#include "net/transport/Transport.h"
+#include "net/transport/InProcessTransport.h"
+
+namespace dw {
+// A transport server which runs another transport on a dedicated network thread. Pumping the
+// transport, socket I/O and validating received packets all happen on the network thread, which
+// exchanges packets with the game thread through a pair of lock free ring buffers per client.
+// Connection callbacks are queued by the network thread and called from update() on the game
+// thread. Each connection to a client slot has its own generation, so packets which were received
+// from a previous client in the same slot never reach the next one.
+//
+// Apart from the constructor and destructor, the underlying transport is only used by the network
+// thread while listening, so it doesn't need to be thread safe itself.
+class DW_API ThreadedServer : public Object, public TransportServer {
+public:
+    DW_OBJECT(ThreadedServer);
+
+    // Creates the underlying transport, given the callbacks it should call when a client connects
+    // or disconnects.
+    using ServerFactory = Function<UniquePtr<TransportServer>(Function<void(ClientId)>,
+                                                              Function<void(ClientId)>)>;
+
+    // Called on the network thread for each received packet. Packets it returns false for are
+    // dropped before they reach the game thread.
+    using PacketFilter = Function<bool(const byte* data, u32 length)>;
+
+    ThreadedServer(Context* ctx, const ServerFactory& factory,
+                   Function<void(ClientId)> client_connected,
+                   Function<void(ClientId)> client_disconnected, PacketFilter packet_filter = {},
+                   double update_interval = 0.002);
+    ~ThreadedServer();
+
+    void listen(const String& host, u16 port, u16 max_connections) override;
+    void disconnect() override;
+
+    void update(float dt) override;
+    void send(ClientId client, const byte* data, u32 length,
+              TransportChannel channel = TransportChannel::Reliable) override;
+    Option<ServerPacket> receive(ClientId client) override;
+    bool isClientConnected(ClientId client) const override;
+    usize numConnections() const override;
+    usize maxConnections() const override;
+
+    ServerConnectionState connectionState() const override;
+
+    // Stats of the underlying transport as of its last update on the network thread.
+    TransportConnectionStats connectionStats(ClientId client) const override;
+
+    // Number of received packets which were dropped by the packet filter.
+    u64 droppedPackets() const;
+
+private:
+    struct ClientChannels {
+        InProcessChannel incoming;  // Network thread to game thread.
+        InProcessChannel outgoing;  // Game thread to network thread.
+    };
+
+    enum class ConnectionEvent : byte { Connected, Disconnected };
+
+    UniquePtr<TransportServer> server_;
+    Function<void(ClientId)> client_connected_;
+    Function<void(ClientId)> client_disconnected_;
+    PacketFilter packet_filter_;
+    double update_interval_;
+
+    // Shared between both threads. Only resized while the network thread is stopped.
+    Vector<UniquePtr<ClientChannels>> channels_;
+    InProcessChannel events_;  // Network thread to game thread.
+
+    // Game thread only.
+    ServerConnectionState connection_state_;
+    Vector<bool> connected_;
+    Vector<u32> generations_;  // Generation of each client's current or last connection.
+    usize num_connections_;
+
+    // Network thread.
+    Thread thread_;
+    Vector<u32> network_generations_;
+    Atomic<bool> running_;
+    Atomic<u64> dropped_packets_;
+
+    // Connection stats captured by the network thread after each update.
+    mutable Mutex stats_mutex_;
+    Vector<TransportConnectionStats> connection_stats_;
+
+    void start();
+    void stop();
+    void run();
+    void pushEvent(ConnectionEvent event, ClientId client);
+};
+}  // namespace dw
@@ -12,13 +12,33 @@ enum class ClientConnectionState { Disconnected, Connecting, Connected };
 
 using ClientId = u16;
 
+// Delivery guarantees of a message sent over a transport.
+enum class TransportChannel {
+    Reliable,   // Always arrives, in the order it was sent.
+    Unreliable  // May be dropped, duplicated or arrive out of order, but never waits for resends.
+};
+
+// Packets are views into memory owned by the transport. The data stays valid until the next call
+// to update() on the transport which returned it.
 struct ServerPacket {
     ClientId client;
-    Vector<byte> data;
+    const byte* data;
+    u32 length;
+    TransportChannel channel;
 };
 
 struct ClientPacket {
-    Vector<byte> data;
+    const byte* data;
+    u32 length;
+    TransportChannel channel;
+};
+
+// Quality of a single connection, as measured by the transport. Values which a transport can't
+// measure are left as 0.
+struct TransportConnectionStats {
+    float rtt = 0.0f;           // Round trip time, in seconds.
+    float packet_loss = 0.0f;   // Fraction of packets lost, between 0 and 1.
+    usize queued_packets = 0;   // Packets sent which are waiting to be handed over to the network.
 };
 
 class DW_API TransportServer {
@@ -29,13 +49,18 @@ public:
     virtual void disconnect() = 0;
 
     virtual void update(float dt) = 0;
-    virtual void send(ClientId client, const byte* data, u32 length) = 0;
+    virtual void send(ClientId client, const byte* data, u32 length,
+                      TransportChannel channel = TransportChannel::Reliable) = 0;
     virtual Option<ServerPacket> receive(ClientId client) = 0;
     virtual bool isClientConnected(ClientId client) const = 0;
     virtual usize numConnections() const = 0;
     virtual usize maxConnections() const = 0;
 
     virtual ServerConnectionState connectionState() const = 0;
+
+    virtual TransportConnectionStats connectionStats(ClientId) const {
+        return {};
+    }
 };
 
 class DW_API TransportClient {
@@ -45,9 +70,14 @@ public:
     virtual void disconnect() = 0;
 
     virtual void update(float dt) = 0;
-    virtual void send(const byte* data, u32 length) = 0;
+    virtual void send(const byte* data, u32 length,
+                      TransportChannel channel = TransportChannel::Reliable) = 0;
     virtual Option<ClientPacket> receive() = 0;
 
     virtual ClientConnectionState connectionState() const = 0;
+
+    virtual TransportConnectionStats connectionStats() const {
+        return {};
+    }
 };
 }  // namespace dw
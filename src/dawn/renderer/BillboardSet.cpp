@@ -126,12 +126,16 @@ void BillboardSet::setParticleDirection(u32 particle_id, const Vec3& direction)
 }
 
 void BillboardSet::draw(Renderer* renderer, uint view, detail::Transform& camera_transform,
-                        const Mat4&, const Mat4& view_projection_matrix) {
+                        const Mat4&, const Mat4& view_projection_matrix,
+                        detail::RenderableInstanceState&) {
     update(camera_transform);
 
     auto rhi = renderer->rhi();
     rhi->setVertexBuffer(vb_->internalHandle());
     rhi->setIndexBuffer(ib_->internalHandle());
+    // Any billboard may be close enough to the camera to fill the screen.
+    auto screen_size = rhi->backbufferSize();
+    material_->requestTextureScreenSize(static_cast<float>(std::max(screen_size.x, screen_size.y)));
     material_->applyRendererState(Mat4::identity, view_projection_matrix);
     rhi->submit(view, material_->program()->internalHandle(), particle_count_ * 6);
 }
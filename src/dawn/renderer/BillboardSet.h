@@ -27,7 +27,8 @@ public:
     void setParticleDirection(u32 particle_id, const Vec3& direction);
 
     void draw(Renderer* renderer, uint view, detail::Transform& camera, const Mat4&,
-              const Mat4& view_projection_matrix) override;
+              const Mat4& view_projection_matrix,
+              detail::RenderableInstanceState& instance_state) override;
 
 private:
     Vec2 particle_size_;
@@ -51,7 +51,8 @@ CustomRenderable::~CustomRenderable() {
 }
 
 void CustomRenderable::draw(Renderer* renderer, uint view, detail::Transform&,
-                            const Mat4& model_matrix, const Mat4& view_projection_matrix) {
+                            const Mat4& model_matrix, const Mat4& view_projection_matrix,
+                            detail::RenderableInstanceState&) {
     auto rhi = renderer->rhi();
     usize vertex_count =
         index_buffer_ ? index_buffer_->indexCount() : vertex_buffer_->vertexCount();
@@ -62,6 +63,10 @@ void CustomRenderable::draw(Renderer* renderer, uint view, detail::Transform&,
     // TODO: Move this common "render vertex/index buffer + material" code somewhere to avoid
     // duplication with Mesh.
     // TODO: Support unset material.
+    // Custom renderables have no bounds, so their textures are requested at the size of the
+    // screen.
+    auto screen_size = rhi->backbufferSize();
+    material_->requestTextureScreenSize(static_cast<float>(std::max(screen_size.x, screen_size.y)));
     material_->applyRendererState(model_matrix, view_projection_matrix);
     rhi->submit(view, material_->program()->internalHandle(), vertex_count);
 }
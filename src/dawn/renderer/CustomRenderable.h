@@ -37,7 +37,8 @@ public:
     ~CustomRenderable() override;
 
     void draw(Renderer* renderer, uint view, detail::Transform& camera, const Mat4& model_matrix,
-              const Mat4& view_projection_matrix) override;
+              const Mat4& view_projection_matrix,
+              detail::RenderableInstanceState& instance_state) override;
 
     VertexBuffer* vertexBuffer() const;
     IndexBuffer* indexBuffer() const;
@@ -17,12 +17,16 @@ FrameBuffer::FrameBuffer(Context* ctx, Vector<SharedPtr<Texture>> textures) : Ob
                    [](const SharedPtr<Texture>& texture) -> gfx::TextureHandle {
                        return texture->internalHandle();
                    });
-    handle_ = ctx->module<Renderer>()->rhi()->createFrameBuffer(texture_handles);
+    auto* renderer = ctx->module<Renderer>();
+    LockGuard<RecursiveMutex> lock(renderer->resourceMutex());
+    handle_ = renderer->rhi()->createFrameBuffer(texture_handles);
 }
 
 FrameBuffer::~FrameBuffer() {
     if (handle_.isValid()) {
-        module<Renderer>()->rhi()->deleteFrameBuffer(handle_);
+        auto* renderer = module<Renderer>();
+        LockGuard<RecursiveMutex> lock(renderer->resourceMutex());
+        renderer->rhi()->deleteFrameBuffer(handle_);
     }
 }
 
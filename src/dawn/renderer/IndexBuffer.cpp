@@ -17,7 +17,9 @@ IndexBuffer::IndexBuffer(Context* ctx, gfx::Memory data, gfx::IndexBufferType ty
     } else {
         assert(false);
     }
-    handle_ = context_->module<Renderer>()->rhi()->createIndexBuffer(std::move(data), type, usage);
+    auto* renderer = context_->module<Renderer>();
+    LockGuard<RecursiveMutex> lock(renderer->resourceMutex());
+    handle_ = renderer->rhi()->createIndexBuffer(std::move(data), type, usage);
 }
 
 IndexBuffer::IndexBuffer(Context* ctx, gfx::IndexBufferHandle handle, usize index_count,
@@ -26,7 +28,9 @@ IndexBuffer::IndexBuffer(Context* ctx, gfx::IndexBufferHandle handle, usize inde
 }
 
 IndexBuffer::~IndexBuffer() {
-    context_->module<Renderer>()->rhi()->deleteIndexBuffer(handle_);
+    auto* renderer = context_->module<Renderer>();
+    LockGuard<RecursiveMutex> lock(renderer->resourceMutex());
+    renderer->rhi()->deleteIndexBuffer(handle_);
 }
 
 void IndexBuffer::update(gfx::Memory data, uint offset) {
@@ -37,7 +41,9 @@ void IndexBuffer::update(gfx::Memory data, uint offset) {
     } else {
         assert(false);
     };
-    context_->module<Renderer>()->rhi()->updateIndexBuffer(handle_, std::move(data), offset);
+    auto* renderer = context_->module<Renderer>();
+    LockGuard<RecursiveMutex> lock(renderer->resourceMutex());
+    renderer->rhi()->updateIndexBuffer(handle_, std::move(data), offset);
 }
 
 void IndexBuffer::bind(gfx::Renderer* r) {
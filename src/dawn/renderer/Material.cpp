@@ -31,8 +31,59 @@ Material::Material(Context* ctx, SharedPtr<Program> program)
 Material::~Material() {
 }
 
-Result<void> Material::beginLoad(const String& asset_name, InputStream& src) {
-    return makeError("Material loading unimplemented");
+Result<void> Material::beginLoad(const String&, InputStream& src) {
+    auto json = Json::parse(stream::read<String>(src), nullptr, false);
+    if (json.is_discarded() || !json.is_object()) {
+        return makeError("Material is not a valid JSON object.");
+    }
+    auto vertex_shader = json.find("vertex_shader");
+    auto fragment_shader = json.find("fragment_shader");
+    if (vertex_shader == json.end() || !vertex_shader->is_string() ||
+        fragment_shader == json.end() || !fragment_shader->is_string()) {
+        return makeError("Material must have a vertex_shader and a fragment_shader.");
+    }
+
+    auto* resource_cache = module<ResourceCache>();
+    vertex_shader_ = resource_cache->getAsync<VertexShader>(vertex_shader->get<String>());
+    fragment_shader_ = resource_cache->getAsync<FragmentShader>(fragment_shader->get<String>());
+    addDependency(vertex_shader_);
+    addDependency(fragment_shader_);
+    auto textures = json.find("textures");
+    if (textures != json.end()) {
+        if (!textures->is_array() || textures->size() > texture_units_.size()) {
+            return makeError(str::format("Material textures must be an array of at most {} paths.",
+                                         texture_units_.size()));
+        }
+        for (auto& texture : *textures) {
+            if (!texture.is_string()) {
+                return makeError("Material textures must be an array of paths.");
+            }
+            textures_.emplace_back(resource_cache->getAsync<Texture>(texture.get<String>()));
+            addDependency(textures_.back());
+        }
+    }
+    colour_write_ = json.value("colour_write", colour_write_);
+    depth_write_ = json.value("depth_write", depth_write_);
+    return Result<void>();
+}
+
+Result<void> Material::endLoad() {
+    // Nothing to do for materials which weren't loaded from a file.
+    if (!vertex_shader_.isValid()) {
+        return Result<void>();
+    }
+    program_ = makeShared<Program>(context(), vertex_shader_.get(), fragment_shader_.get());
+    for (usize i = 0; i < textures_.size(); ++i) {
+        texture_units_[i] = textures_[i].get();
+    }
+    vertex_shader_ = {};
+    fragment_shader_ = {};
+    textures_.clear();
+    return Result<void>();
+}
+
+void Material::setProgram(SharedPtr<Program> program) {
+    program_ = std::move(program);
 }
 
 void Material::setStateEnable(gfx::RenderState state) {
@@ -87,6 +138,15 @@ void Material::setTexture(SharedPtr<Texture> texture, uint unit) {
     texture_units_[unit] = std::move(texture);
 }
 
+void Material::requestTextureScreenSize(float screen_pixels) {
+    for (auto& texture : texture_units_) {
+        if (!texture) {
+            continue;
+        }
+        texture->requestScreenSize(screen_pixels);
+    }
+}
+
 void Material::applyRendererState(const Mat4& model_matrix, const Mat4& view_projection_matrix) {
     auto* renderer = module<Renderer>()->rhi();
 
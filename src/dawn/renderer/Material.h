@@ -8,8 +8,21 @@
 #include "core/math/Defs.h"
 #include "renderer/Program.h"
 #include "renderer/Texture.h"
+#include "resource/ResourceCache.h"
 
 namespace dw {
+// Materials are loaded from JSON files of the form:
+//
+//   {
+//     "vertex_shader": "base:materials/basic.vs",
+//     "fragment_shader": "base:materials/basic.fs",
+//     "textures": ["base:textures/noise.jpg"],
+//     "depth_write": true,
+//     "colour_write": true
+//   }
+//
+// Textures are bound to texture units in order. The shaders and textures are loaded before the
+// material finishes loading.
 class DW_API Material : public Resource {
 public:
     DW_OBJECT(Material);
@@ -19,7 +32,9 @@ public:
     ~Material() override;
 
     Result<void> beginLoad(const String& asset_name, InputStream& src) override;
+    Result<void> endLoad() override;
 
+    void setProgram(SharedPtr<Program> program);
     void setStateEnable(gfx::RenderState state);
     void setStateDisable(gfx::RenderState state);
     void setCullFrontFace(gfx::CullFrontFace front_face);
@@ -35,6 +50,10 @@ public:
 
     void setTexture(SharedPtr<Texture> texture, uint unit = 0);
 
+    // Requests that the material's textures are streamed in at the level of detail needed to cover
+    // screen_pixels pixels (see Texture::requestScreenSize()).
+    void requestTextureScreenSize(float screen_pixels);
+
     template <typename T> void setUniform(const String& name, const T& value) {
         uniforms_[name] = value;
     }
@@ -66,5 +85,10 @@ private:
 
     Array<SharedPtr<Texture>, 8> texture_units_;
     HashMap<String, gfx::UniformData> uniforms_;
+
+    // Dependencies, held between beginLoad() and endLoad().
+    ResourceHandle<VertexShader> vertex_shader_;
+    ResourceHandle<FragmentShader> fragment_shader_;
+    Vector<ResourceHandle<Texture>> textures_;
 };
 }  // namespace dw
@@ -4,35 +4,21 @@
  */
 #include "Base.h"
 #include "core/io/InputStream.h"
+#include "core/io/MemoryInputStream.h"
 #include "renderer/Mesh.h"
+#include "renderer/MeshImporter.h"
+#include "renderer/MeshOptimiser.h"
 #include "renderer/Renderer.h"
 #include "core/StringUtils.h"
-
-#define ASSIMP_BUILD_BOOST_WORKAROUND
-#include <assimp/Importer.hpp>
-#include <assimp/scene.h>
-#include <assimp/DefaultLogger.hpp>
-#include <assimp/Logger.hpp>
-#include <assimp/postprocess.h>
 #include "resource/ResourceCache.h"
 
+#include <algorithm>
+#include <limits>
+
 namespace dw {
 namespace {
-class DawnAssimpLogStream : public Assimp::LogStream {
-public:
-    DawnAssimpLogStream(Context* ctx) : logger{ctx->module<Logger>()} {
-    }
-    ~DawnAssimpLogStream() = default;
-
-    void write(const char* message_cstr) {
-        String message{message_cstr};
-        logger->withObjectName("Mesh").info("Assimp Importer: {}",
-                                            message.substr(0, message.length() - 1));
-    }
-
-private:
-    Logger* logger;
-};
+// Number of levels of detail generated for meshes which haven't been cooked.
+const usize runtime_lod_count = 3;
 }  // namespace
 
 Mesh::Node::Node(Mat4 transform, Node* parent, Vector<SubMesh*> submeshes)
@@ -60,13 +46,13 @@ const Mat4& Mesh::Node::transform() const {
 }
 
 void Mesh::Node::draw(Renderer* renderer, uint view, const Mat4& model_matrix,
-                      const Mat4& view_projection_matrix) {
+                      const Mat4& view_projection_matrix, usize lod) {
     const Mat4 current_model_matrix = model_matrix * transform_;
     for (auto& submesh : submeshes_) {
-        submesh->draw(renderer, view, current_model_matrix, view_projection_matrix);
+        submesh->draw(renderer, view, current_model_matrix, view_projection_matrix, lod);
     }
     for (auto& child : children_) {
-        child->draw(renderer, view, current_model_matrix, view_projection_matrix);
+        child->draw(renderer, view, current_model_matrix, view_projection_matrix, lod);
     }
 }
 
@@ -74,162 +60,180 @@ Mesh::SubMesh::SubMesh(usize index_buffer_offset, usize index_count, SharedPtr<M
     : index_buffer_offset_(index_buffer_offset), index_count_(index_count), material_(material) {
 }
 
+void Mesh::SubMesh::addLod(usize index_buffer_offset, usize index_count) {
+    lods_.emplace_back(IndexRange{index_buffer_offset, index_count});
+}
+
 void Mesh::SubMesh::draw(Renderer* renderer, uint view, const Mat4& model_matrix,
-                         const Mat4& view_projection_matrix) {
+                         const Mat4& view_projection_matrix, usize lod) {
+    // Submeshes with fewer levels of detail use their least detailed one.
+    usize index_buffer_offset = index_buffer_offset_;
+    usize index_count = index_count_;
+    if (lod > 0 && !lods_.empty()) {
+        auto& range = lods_[std::min(lod, lods_.size()) - 1];
+        index_buffer_offset = range.offset;
+        index_count = range.count;
+    }
+
     // TODO: Revamp material system.
     material_->applyRendererState(model_matrix, view_projection_matrix);
     renderer->rhi()->setStateDisable(gfx::RenderState::CullFace);
-    renderer->rhi()->submit(view, material_->program()->internalHandle(), index_count_,
-                            index_buffer_offset_);
+    renderer->rhi()->submit(view, material_->program()->internalHandle(), index_count,
+                            index_buffer_offset);
 }
 
 Mesh::Mesh(Context* context)
-    : Resource(context), vertex_buffer_(nullptr), index_buffer_(nullptr), root_node_(nullptr) {
+    : Resource(context),
+      vertex_buffer_(nullptr),
+      index_buffer_(nullptr),
+      root_node_(nullptr),
+      gpu_bytes_(0),
+      bounds_centre_(Vec3::zero),
+      bounds_radius_(0.0f),
+      lod_threshold_(0.001f),
+      lod_hysteresis_(0.25f),
+      vertex_count_(0),
+      index_type_(gfx::IndexBufferType::U32) {
 }
 
 Mesh::~Mesh() {
 }
 
 Result<void> Mesh::beginLoad(const String& asset_name, InputStream& is) {
-    // Read stream.
-    assert(is.size() > 0);
-    u64 size = is.size();
-    UniquePtr<byte[]> data{new byte[size]};
-    is.readData(data.get(), size);
-    assert(is.eof());
-
-    const unsigned int severity = Assimp::Logger::Debugging | Assimp::Logger::Info |
-                                  Assimp::Logger::Warn | Assimp::Logger::Err;
-
-    // Run importer.
-    Assimp::DefaultLogger::create("", Assimp::Logger::VERBOSE, 0);
-    Assimp::DefaultLogger::get()->attachStream(new DawnAssimpLogStream(context()), severity);
-    Assimp::Importer importer;
-    auto flags = aiProcess_CalcTangentSpace | aiProcess_Triangulate |
-                 aiProcess_JoinIdenticalVertices | aiProcess_SortByPType;
-    const aiScene* scene = importer.ReadFileFromMemory(data.get(), size, flags, asset_name.c_str());
-    Assimp::DefaultLogger::kill();
-    if (!scene) {
-        return makeError(str::format("Unable to load mesh {}. Reason: {}", asset_name,
-                                     importer.GetErrorString()));
-    }
-
-    // TODO: Load materials.
-    // For now, load a basic material.
-    material_ = makeShared<Material>(
-        context(),
-        makeShared<Program>(
-            context(),
-            *module<ResourceCache>()->get<VertexShader>("base:materials/basic-no-texture.vs"),
-            *module<ResourceCache>()->get<FragmentShader>("base:materials/basic-no-texture.fs")));
-    material_->program()->setUniform("light_direction", Vec3{1.0f, 1.0f, 1.0f}.Normalized());
-
-    // Build a vertex and index buffer containing all the mesh data.
-    struct Vertex {
-        Vec3 position;
-        Vec3 normal;
-    };
-    Vector<Vertex> vertices;
-    Vector<u32> indices;
-    for (uint i = 0; i < scene->mNumMeshes; ++i) {
-        const auto* mesh = scene->mMeshes[i];
-
-        // Check the mesh for any issues, and abort if so.
-        if (!mesh->HasPositions()) {
+    // Cooked meshes are used in place when the stream is already in memory, such as when it's
+    // mapped from a resource package. Otherwise, the stream is read into memory first.
+    Vector<byte> buffer;
+    const byte* data;
+    usize size;
+    auto* memory_stream = dynamic_cast<MemoryInputStream*>(&is);
+    if (memory_stream) {
+        data = memory_stream->data() + memory_stream->position();
+        size = memory_stream->size() - memory_stream->position();
+    } else {
+        auto read_result = is.readAll();
+        if (!read_result) {
             return makeError(
-                str::format("Unable to load mesh {}. Submesh {} has no positions.", asset_name, i));
+                str::format("Unable to read mesh {}. Reason: {}", asset_name, read_result.error()));
         }
-        if (!mesh->HasNormals()) {
-            return makeError(
-                str::format("Unable to load mesh {}. Submesh {} has no normals.", asset_name, i));
+        buffer = std::move(*read_result);
+        data = buffer.data();
+        size = buffer.size();
+    }
+
+    // Meshes which haven't been cooked are imported with Assimp, and optimised in the same way as
+    // the mesh cooker does.
+    MeshData imported_mesh;
+    MeshDataView mesh;
+    if (isCookedMesh(data, size)) {
+        auto read_result = readCookedMesh(data, size);
+        if (!read_result) {
+            return makeError(str::format("Unable to load cooked mesh {}. Reason: {}", asset_name,
+                                         read_result.error()));
         }
-        if (!mesh->HasFaces()) {
-            return makeError(
-                str::format("Unable to load mesh {}. Submesh {} has no faces.", asset_name, i));
+        mesh = *read_result;
+    } else {
+        auto import_result = importMesh(context(), asset_name, data, size);
+        if (!import_result) {
+            return makeError(import_result.error());
         }
+        imported_mesh = std::move(*import_result);
+        MeshOptimiseOptions options;
+        options.max_lods = runtime_lod_count;
+        optimiseMesh(imported_mesh, options);
+        mesh = viewMeshData(imported_mesh);
+    }
 
-        const u32 vertex_offset = static_cast<u32>(vertices.size());
-        const u32 index_offset = static_cast<u32>(indices.size());
-
-        for (usize v = 0; v < mesh->mNumVertices; ++v) {
-            aiVector3D& position = mesh->mVertices[v];
-            aiVector3D& normal = mesh->mNormals[v];
-            vertices.emplace_back(
-                Vertex{{position.x, position.y, position.z}, {normal.x, normal.y, normal.z}});
+    // TODO: Load materials.
+    // For now, use a basic material. Its program is created in endLoad() once the shaders have
+    // loaded.
+    auto* resource_cache = module<ResourceCache>();
+    vertex_shader_ = resource_cache->getAsync<VertexShader>("base:materials/basic-no-texture.vs");
+    fragment_shader_ =
+        resource_cache->getAsync<FragmentShader>("base:materials/basic-no-texture.fs");
+    addDependency(vertex_shader_);
+    addDependency(fragment_shader_);
+    material_ = makeShared<Material>(context());
+
+    // GPU buffers are built in endLoad(). This is the only copy of the vertex and index data.
+    vertex_data_ = gfx::Memory(mesh.vertices, mesh.vertex_count * sizeof(MeshVertex));
+    vertex_count_ = mesh.vertex_count;
+    index_data_ = gfx::Memory(mesh.indices, mesh.index_count * mesh.index_size);
+    index_type_ =
+        mesh.index_size == sizeof(u16) ? gfx::IndexBufferType::U16 : gfx::IndexBufferType::U32;
+    gpu_bytes_ = mesh.vertex_count * sizeof(MeshVertex) + mesh.index_count * mesh.index_size;
+
+    for (usize i = 0; i < mesh.submesh_count; ++i) {
+        auto& submesh_data = mesh.submeshes[i];
+        auto submesh =
+            makeUnique<SubMesh>(submesh_data.index_offset, submesh_data.index_count, material_);
+        for (usize l = 0; l < submesh_data.lod_count; ++l) {
+            auto& lod = mesh.lods[submesh_data.lod_offset + l];
+            submesh->addLod(lod.index_offset, lod.index_count);
         }
-        for (usize f = 0; f < mesh->mNumFaces; ++f) {
-            aiFace& face = mesh->mFaces[f];
-            if (face.mNumIndices != 3) {
-                return makeError(str::format(
-                    "Unable to load mesh {}. Face {} in submesh {} has {} indices (must be exactly "
-                    "3).",
-                    asset_name, f, i, face.mNumIndices));
+        submeshes_.emplace_back(std::move(submesh));
+    }
+    lod_errors_ = meshLodErrors(mesh);
+    bounds_centre_ = Vec3{mesh.bounds_centre[0], mesh.bounds_centre[1], mesh.bounds_centre[2]};
+    bounds_radius_ = mesh.bounds_radius;
+
+    // Set up node hierarchy. Nodes are in depth first order, so parents are created first.
+    Vector<Node*> nodes(mesh.node_count);
+    for (usize i = 0; i < mesh.node_count; ++i) {
+        auto& node_data = mesh.nodes[i];
+        Mat4 transform;
+        for (int r = 0; r < 4; ++r) {
+            for (int c = 0; c < 4; ++c) {
+                transform[r][c] = node_data.transform[r * 4 + c];
             }
-            indices.emplace_back(face.mIndices[0] + vertex_offset);
-            indices.emplace_back(face.mIndices[1] + vertex_offset);
-            indices.emplace_back(face.mIndices[2] + vertex_offset);
         }
-
-        auto submesh = makeUnique<SubMesh>(index_offset, mesh->mNumFaces * 3, material_);
-        submeshes_.emplace_back(std::move(submesh));
+        Vector<SubMesh*> submeshes(node_data.submesh_count);
+        for (usize s = 0; s < node_data.submesh_count; ++s) {
+            submeshes[s] = submeshes_[mesh.node_submeshes[node_data.submesh_offset + s]].get();
+        }
+        Node* parent = i == 0 ? nullptr : nodes[node_data.parent];
+        auto node = makeUnique<Node>(transform, parent, submeshes);
+        nodes[i] = node.get();
+        if (parent) {
+            parent->addChild(std::move(node));
+        } else {
+            root_node_ = std::move(node);
+        }
     }
+    return Result<void>();
+}
 
-    // Build GPU buffers.
+Result<void> Mesh::endLoad() {
+    material_->setProgram(
+        makeShared<Program>(context(), vertex_shader_.get(), fragment_shader_.get()));
+    material_->program()->setUniform("light_direction", Vec3{1.0f, 1.0f, 1.0f}.Normalized());
+    vertex_shader_ = {};
+    fragment_shader_ = {};
+
+    // Build GPU buffers. This matches the layout of MeshVertex.
     gfx::VertexDecl decl;
     decl.begin()
         .add(gfx::VertexDecl::Attribute::Position, 3, gfx::VertexDecl::AttributeType::Float)
-        .add(gfx::VertexDecl::Attribute::Normal, 3, gfx::VertexDecl::AttributeType::Float)
+        .add(gfx::VertexDecl::Attribute::Normal, 4, gfx::VertexDecl::AttributeType::Uint8, true)
         .end();
     vertex_buffer_ =
-        makeShared<VertexBuffer>(context(), gfx::Memory(vertices), vertices.size(), decl);
-    index_buffer_ =
-        makeShared<IndexBuffer>(context(), gfx::Memory(indices), gfx::IndexBufferType::U32);
-
-    // Set up node hierarchy.
-    Function<UniquePtr<Node>(aiNode*, Node*)> create_node_tree =
-        [this, &create_node_tree](aiNode* ai_node, Node* parent) -> UniquePtr<Node> {
-        // Convert transform.
-        const aiMatrix4x4 ai_transform = ai_node->mTransformation;
-        Mat4 transform;
-        transform[0][0] = ai_transform.a1;
-        transform[0][1] = ai_transform.a2;
-        transform[0][2] = ai_transform.a3;
-        transform[0][3] = ai_transform.a4;
-        transform[1][0] = ai_transform.b1;
-        transform[1][1] = ai_transform.b2;
-        transform[1][2] = ai_transform.b3;
-        transform[1][3] = ai_transform.b4;
-        transform[2][0] = ai_transform.c1;
-        transform[2][1] = ai_transform.c2;
-        transform[2][2] = ai_transform.c3;
-        transform[2][3] = ai_transform.c4;
-        transform[3][0] = ai_transform.d1;
-        transform[3][1] = ai_transform.d2;
-        transform[3][2] = ai_transform.d3;
-        transform[3][3] = ai_transform.d4;
-
-        // Create node.
-        Vector<SubMesh*> submeshes;
-        submeshes.resize(ai_node->mNumMeshes);
-        for (usize i = 0; i < ai_node->mNumMeshes; ++i) {
-            submeshes[i] = submeshes_[ai_node->mMeshes[i]].get();
-        }
-        auto node = makeUnique<Node>(transform, parent, submeshes);
-
-        // Add children.
-        for (usize c = 0; c < ai_node->mNumChildren; ++c) {
-            node->addChild(create_node_tree(ai_node->mChildren[c], node.get()));
-        }
-
-        return node;
-    };
-    root_node_ = create_node_tree(scene->mRootNode, nullptr);
-
+        makeShared<VertexBuffer>(context(), std::move(vertex_data_), vertex_count_, decl);
+    index_buffer_ = makeShared<IndexBuffer>(context(), std::move(index_data_), index_type_);
     return Result<void>();
 }
 
 void Mesh::draw(Renderer* renderer, uint view, detail::Transform&, const Mat4& model_matrix,
-                const Mat4& view_projection_matrix) {
+                const Mat4& view_projection_matrix,
+                detail::RenderableInstanceState& instance_state) {
+    float projected_scale = projectedScale(model_matrix, view_projection_matrix);
+    if (!lod_errors_.empty()) {
+        instance_state.lod = selectMeshLod(lod_errors_, projected_scale, instance_state.lod,
+                                           lod_threshold_, lod_hysteresis_);
+    }
+
+    // Textures are streamed in at the size of the mesh's bounding sphere on screen.
+    auto screen_height = static_cast<float>(renderer->rhi()->backbufferSize().y);
+    material_->requestTextureScreenSize(bounds_radius_ * 2.0f * projected_scale * screen_height);
+
     // usize vertex_count = index_buffer_->indexCount();
     auto rhi = renderer->rhi();
     rhi->setVertexBuffer(vertex_buffer_->internalHandle());
@@ -238,10 +242,43 @@ void Mesh::draw(Renderer* renderer, uint view, detail::Transform&, const Mat4& m
     // duplication with CustomMeshRenderable.
     // TODO: Support unset material.
 
-    root_node_->draw(renderer, view, model_matrix, view_projection_matrix);
+    root_node_->draw(renderer, view, model_matrix, view_projection_matrix, instance_state.lod);
+}
+
+void Mesh::setLodThreshold(float threshold, float hysteresis) {
+    lod_threshold_ = threshold;
+    lod_hysteresis_ = hysteresis;
+}
+
+usize Mesh::lodCount() const {
+    return lod_errors_.size() + 1;
+}
+
+ResourceFootprint Mesh::footprint() const {
+    ResourceFootprint footprint;
+    footprint.gpu_bytes = gpu_bytes_;
+    return footprint;
 }
 
 Mesh::Node* Mesh::rootNode() {
     return root_node_.get();
 }
+
+float Mesh::projectedScale(const Mat4& model_matrix, const Mat4& view_projection_matrix) const {
+    // Node transforms within the mesh are ignored, so this is approximate for meshes whose nodes
+    // are far apart.
+    Vec4 clip = view_projection_matrix * model_matrix * Vec4{bounds_centre_, 1.0f};
+    float model_scale = std::max({model_matrix.Col3(0).Length(), model_matrix.Col3(1).Length(),
+                                  model_matrix.Col3(2).Length()});
+
+    // Meshes which are close enough to surround the camera are always drawn at full detail.
+    if (clip.w <= bounds_radius_ * model_scale) {
+        return std::numeric_limits<float>::max();
+    }
+
+    // The length of the second row of the view projection matrix is the vertical projection
+    // scale, as the view matrix doesn't scale. Clip space is two units high.
+    float projection_scale = view_projection_matrix.Row3(1).Length();
+    return model_scale * projection_scale / clip.w * 0.5f;
+}
 }  // namespace dw
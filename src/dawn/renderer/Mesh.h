@@ -5,9 +5,11 @@
 #pragma once
 
 #include "renderer/Renderable.h"
+#include "renderer/Shader.h"
 #include "renderer/VertexBuffer.h"
 #include "renderer/IndexBuffer.h"
 #include "resource/Resource.h"
+#include "resource/ResourceCache.h"
 #include <dawn-gfx/Renderer.h>
 
 namespace dw {
@@ -21,9 +23,22 @@ public:
 
     // Resource.
     Result<void> beginLoad(const String& asset_name, InputStream& src) override;
+    Result<void> endLoad() override;
+    ResourceFootprint footprint() const override;
 
+    /// Draws the mesh at the least detailed level of detail whose error is below the LOD threshold
+    /// on screen. The level drawn is kept for each scene node, and the threshold has hysteresis.
     void draw(Renderer* renderer, uint view, detail::Transform& camera, const Mat4& model_matrix,
-              const Mat4& view_projection_matrix) override;
+              const Mat4& view_projection_matrix,
+              detail::RenderableInstanceState& instance_state) override;
+
+    /// Sets the largest error allowed on screen, as a fraction of the screen height, and the
+    /// hysteresis applied to it (see selectMeshLod()). The default is 0.001 (about a pixel at
+    /// 1080p), with 0.25 hysteresis.
+    void setLodThreshold(float threshold, float hysteresis);
+
+    /// Number of levels of detail, including full detail.
+    usize lodCount() const;
 
     class Node;
     class SubMesh;
@@ -31,10 +46,29 @@ public:
     Node* rootNode();
 
 private:
+    // Size of one mesh unit on screen, as a fraction of the screen height.
+    float projectedScale(const Mat4& model_matrix, const Mat4& view_projection_matrix) const;
+
     SharedPtr<VertexBuffer> vertex_buffer_;
     SharedPtr<IndexBuffer> index_buffer_;
     UniquePtr<Node> root_node_;
     Vector<UniquePtr<SubMesh>> submeshes_;
+    usize gpu_bytes_;
+
+    // Levels of detail.
+    Vector<float> lod_errors_;
+    Vec3 bounds_centre_;
+    float bounds_radius_;
+    float lod_threshold_;
+    float lod_hysteresis_;
+
+    // Mesh data, held between beginLoad() and endLoad().
+    gfx::Memory vertex_data_;
+    usize vertex_count_;
+    gfx::Memory index_data_;
+    gfx::IndexBufferType index_type_;
+    ResourceHandle<VertexShader> vertex_shader_;
+    ResourceHandle<FragmentShader> fragment_shader_;
 };
 
 class DW_API Mesh::Node {
@@ -49,7 +83,7 @@ public:
     const Mat4& transform() const;
 
     void draw(Renderer* renderer, uint view, const Mat4& model_matrix,
-              const Mat4& view_projection_matrix);
+              const Mat4& view_projection_matrix, usize lod);
 
 private:
     Mat4 transform_;
@@ -62,12 +96,21 @@ class DW_API Mesh::SubMesh {
 public:
     SubMesh(usize index_buffer_offset, usize index_count, SharedPtr<Material> material);
 
+    // Adds a simplified level of detail, less detailed than any added before.
+    void addLod(usize index_buffer_offset, usize index_count);
+
     void draw(Renderer* renderer, uint view, const Mat4& model_matrix,
-              const Mat4& view_projection_matrix);
+              const Mat4& view_projection_matrix, usize lod);
 
 private:
+    struct IndexRange {
+        usize offset;
+        usize count;
+    };
+
     usize index_buffer_offset_;
     usize index_count_;
+    Vector<IndexRange> lods_;
     SharedPtr<Material> material_;
 };
 }  // namespace dw
@@ -0,0 +1,296 @@
+/*
+ * Dawn Engine
+ * Written by David Avedissian (c) 2012-2019 (git@dga.dev)
+ */
+#include "Base.h"
+#include "renderer/MeshData.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace dw {
+namespace {
+const u32 cooked_mesh_magic = 0x534d5744;  // "DWMS"
+const u32 cooked_mesh_version = 2;
+const usize cooked_mesh_alignment = 16;
+
+// Alignment required of cooked mesh data in memory, so that its tables can be read in place. This
+// is lower than the section alignment, so that meshes can be read from packages built with a
+// smaller alignment.
+const usize cooked_mesh_data_alignment = 4;
+static_assert(alignof(MeshVertex) <= cooked_mesh_data_alignment &&
+                  alignof(MeshSubMeshData) <= cooked_mesh_data_alignment &&
+                  alignof(MeshNodeData) <= cooked_mesh_data_alignment &&
+                  alignof(MeshLodData) <= cooked_mesh_data_alignment,
+              "Cooked mesh tables must not require more than cooked_mesh_data_alignment.");
+
+// Offsets are from the start of the cooked mesh, and each section is aligned to
+// cooked_mesh_alignment bytes.
+struct CookedMeshHeader {
+    u32 magic;
+    u32 version;
+    u32 vertex_count;
+    u32 vertex_stride;
+    u32 index_count;
+    u32 index_size;
+    u32 submesh_count;
+    u32 node_count;
+    u32 node_submesh_count;
+    u32 lod_count;
+    float bounds_centre[3];
+    float bounds_radius;
+    u64 vertex_offset;
+    u64 index_offset;
+    u64 submesh_offset;
+    u64 node_offset;
+    u64 node_submesh_offset;
+    u64 lod_offset;
+};
+static_assert(sizeof(CookedMeshHeader) == 104, "CookedMeshHeader must match the file format.");
+
+void append(Vector<byte>& out, const void* data, usize size) {
+    auto* bytes = static_cast<const byte*>(data);
+    out.insert(out.end(), bytes, bytes + size);
+}
+
+u64 appendSection(Vector<byte>& out, const void* data, usize size) {
+    out.resize((out.size() + cooked_mesh_alignment - 1) / cooked_mesh_alignment *
+               cooked_mesh_alignment);
+    u64 offset = out.size();
+    append(out, data, size);
+    return offset;
+}
+
+bool sectionInBounds(u64 offset, u64 count, u64 element_size, usize size) {
+    if (offset % cooked_mesh_alignment != 0 || offset > size) {
+        return false;
+    }
+    return count <= (size - offset) / element_size;
+}
+}  // namespace
+
+u32 MeshDataView::index(usize i) const {
+    if (index_size == sizeof(u16)) {
+        return static_cast<const u16*>(indices)[i];
+    }
+    return static_cast<const u32*>(indices)[i];
+}
+
+u8 quantiseNormal(float n) {
+    float clamped = std::min(std::max(n, -1.0f), 1.0f);
+    return static_cast<u8>(std::lround((clamped * 0.5f + 0.5f) * 255.0f));
+}
+
+float unquantiseNormal(u8 n) {
+    return static_cast<float>(n) / 255.0f * 2.0f - 1.0f;
+}
+
+void computeMeshBounds(MeshData& mesh) {
+    if (mesh.vertices.empty()) {
+        return;
+    }
+    float min[3], max[3];
+    for (int i = 0; i < 3; ++i) {
+        min[i] = max[i] = mesh.vertices[0].position[i];
+    }
+    for (auto& vertex : mesh.vertices) {
+        for (int i = 0; i < 3; ++i) {
+            min[i] = std::min(min[i], vertex.position[i]);
+            max[i] = std::max(max[i], vertex.position[i]);
+        }
+    }
+    for (int i = 0; i < 3; ++i) {
+        mesh.bounds_centre[i] = (min[i] + max[i]) * 0.5f;
+    }
+    float radius_squared = 0.0f;
+    for (auto& vertex : mesh.vertices) {
+        float distance_squared = 0.0f;
+        for (int i = 0; i < 3; ++i) {
+            float d = vertex.position[i] - mesh.bounds_centre[i];
+            distance_squared += d * d;
+        }
+        radius_squared = std::max(radius_squared, distance_squared);
+    }
+    mesh.bounds_radius = std::sqrt(radius_squared);
+}
+
+MeshDataView viewMeshData(const MeshData& mesh) {
+    MeshDataView view;
+    view.vertices = mesh.vertices.data();
+    view.vertex_count = mesh.vertices.size();
+    view.indices = mesh.indices.data();
+    view.index_count = mesh.indices.size();
+    view.index_size = sizeof(u32);
+    view.submeshes = mesh.submeshes.data();
+    view.submesh_count = mesh.submeshes.size();
+    view.nodes = mesh.nodes.data();
+    view.node_count = mesh.nodes.size();
+    view.node_submeshes = mesh.node_submeshes.data();
+    view.node_submesh_count = mesh.node_submeshes.size();
+    view.lods = mesh.lods.data();
+    view.lod_count = mesh.lods.size();
+    memcpy(view.bounds_centre, mesh.bounds_centre, sizeof(view.bounds_centre));
+    view.bounds_radius = mesh.bounds_radius;
+    return view;
+}
+
+Vector<byte> cookMesh(const MeshData& mesh) {
+    CookedMeshHeader header = {};
+    header.magic = cooked_mesh_magic;
+    header.version = cooked_mesh_version;
+    header.vertex_count = static_cast<u32>(mesh.vertices.size());
+    header.vertex_stride = sizeof(MeshVertex);
+    header.index_count = static_cast<u32>(mesh.indices.size());
+    header.index_size = mesh.vertices.size() <= 0x10000 ? sizeof(u16) : sizeof(u32);
+    header.submesh_count = static_cast<u32>(mesh.submeshes.size());
+    header.node_count = static_cast<u32>(mesh.nodes.size());
+    header.node_submesh_count = static_cast<u32>(mesh.node_submeshes.size());
+    header.lod_count = static_cast<u32>(mesh.lods.size());
+    memcpy(header.bounds_centre, mesh.bounds_centre, sizeof(header.bounds_centre));
+    header.bounds_radius = mesh.bounds_radius;
+
+    // The header is filled in once the section offsets are known.
+    Vector<byte> out;
+    append(out, &header, sizeof(header));
+    header.vertex_offset =
+        appendSection(out, mesh.vertices.data(), mesh.vertices.size() * sizeof(MeshVertex));
+    if (header.index_size == sizeof(u16)) {
+        Vector<u16> indices(mesh.indices.begin(), mesh.indices.end());
+        header.index_offset = appendSection(out, indices.data(), indices.size() * sizeof(u16));
+    } else {
+        header.index_offset =
+            appendSection(out, mesh.indices.data(), mesh.indices.size() * sizeof(u32));
+    }
+    header.submesh_offset = appendSection(out, mesh.submeshes.data(),
+                                          mesh.submeshes.size() * sizeof(MeshSubMeshData));
+    header.node_offset =
+        appendSection(out, mesh.nodes.data(), mesh.nodes.size() * sizeof(MeshNodeData));
+    header.node_submesh_offset = appendSection(out, mesh.node_submeshes.data(),
+                                               mesh.node_submeshes.size() * sizeof(u32));
+    header.lod_offset =
+        appendSection(out, mesh.lods.data(), mesh.lods.size() * sizeof(MeshLodData));
+    memcpy(out.data(), &header, sizeof(header));
+    return out;
+}
+
+Vector<float> meshLodErrors(const MeshDataView& mesh) {
+    usize level_count = 0;
+    for (usize s = 0; s < mesh.submesh_count; ++s) {
+        level_count = std::max<usize>(level_count, mesh.submeshes[s].lod_count);
+    }
+    Vector<float> errors(level_count, 0.0f);
+    for (usize s = 0; s < mesh.submesh_count; ++s) {
+        auto& submesh = mesh.submeshes[s];
+        if (submesh.lod_count == 0) {
+            continue;
+        }
+        for (usize l = 0; l < errors.size(); ++l) {
+            usize lod = std::min<usize>(l, submesh.lod_count - 1);
+            errors[l] = std::max(errors[l], mesh.lods[submesh.lod_offset + lod].error);
+        }
+    }
+    return errors;
+}
+
+usize selectMeshLod(const Vector<float>& lod_errors, float projected_scale, usize current_lod,
+                    float threshold, float hysteresis) {
+    auto least_detailed = [&](float limit) {
+        usize lod = 0;
+        while (lod < lod_errors.size() && lod_errors[lod] * projected_scale <= limit) {
+            lod++;
+        }
+        return lod;
+    };
+    current_lod = std::min(current_lod, lod_errors.size());
+    if (current_lod > 0 &&
+        lod_errors[current_lod - 1] * projected_scale > threshold * (1.0f + hysteresis)) {
+        return least_detailed(threshold);
+    }
+    return std::max(current_lod, least_detailed(threshold * (1.0f - hysteresis)));
+}
+
+bool isCookedMesh(const byte* data, usize size) {
+    u32 magic;
+    if (size < sizeof(magic)) {
+        return false;
+    }
+    memcpy(&magic, data, sizeof(magic));
+    return magic == cooked_mesh_magic;
+}
+
+Result<MeshDataView> readCookedMesh(const byte* data, usize size) {
+    if (size < sizeof(CookedMeshHeader) || !isCookedMesh(data, size)) {
+        return makeError("Data is not a cooked mesh.");
+    }
+    if (reinterpret_cast<uintptr>(data) % cooked_mesh_data_alignment != 0) {
+        return makeError("Cooked mesh data is not aligned.");
+    }
+    CookedMeshHeader header;
+    memcpy(&header, data, sizeof(header));
+    if (header.version != cooked_mesh_version) {
+        return makeError(str::format("Cooked mesh has version {}, expected {}. Re-cook it.",
+                                     header.version, cooked_mesh_version));
+    }
+    if (header.vertex_stride != sizeof(MeshVertex) ||
+        (header.index_size != sizeof(u16) && header.index_size != sizeof(u32)) ||
+        !sectionInBounds(header.vertex_offset, header.vertex_count, sizeof(MeshVertex), size) ||
+        !sectionInBounds(header.index_offset, header.index_count, header.index_size, size) ||
+        !sectionInBounds(header.submesh_offset, header.submesh_count, sizeof(MeshSubMeshData),
+                         size) ||
+        !sectionInBounds(header.node_offset, header.node_count, sizeof(MeshNodeData), size) ||
+        !sectionInBounds(header.node_submesh_offset, header.node_submesh_count, sizeof(u32),
+                         size) ||
+        !sectionInBounds(header.lod_offset, header.lod_count, sizeof(MeshLodData), size)) {
+        return makeError("Cooked mesh is corrupt.");
+    }
+
+    MeshDataView view;
+    view.vertices = reinterpret_cast<const MeshVertex*>(data + header.vertex_offset);
+    view.vertex_count = header.vertex_count;
+    view.indices = data + header.index_offset;
+    view.index_count = header.index_count;
+    view.index_size = header.index_size;
+    view.submeshes = reinterpret_cast<const MeshSubMeshData*>(data + header.submesh_offset);
+    view.submesh_count = header.submesh_count;
+    view.nodes = reinterpret_cast<const MeshNodeData*>(data + header.node_offset);
+    view.node_count = header.node_count;
+    view.node_submeshes = reinterpret_cast<const u32*>(data + header.node_submesh_offset);
+    view.node_submesh_count = header.node_submesh_count;
+    view.lods = reinterpret_cast<const MeshLodData*>(data + header.lod_offset);
+    view.lod_count = header.lod_count;
+    memcpy(view.bounds_centre, header.bounds_centre, sizeof(view.bounds_centre));
+    view.bounds_radius = header.bounds_radius;
+
+    // Validate the tables which the mesh is built from. The vertex and index data are used as is.
+    if (view.node_count == 0) {
+        return makeError("Cooked mesh has no nodes.");
+    }
+    for (usize i = 0; i < view.submesh_count; ++i) {
+        auto& submesh = view.submeshes[i];
+        if (u64(submesh.index_offset) + submesh.index_count > view.index_count ||
+            u64(submesh.lod_offset) + submesh.lod_count > view.lod_count) {
+            return makeError(str::format("Cooked mesh submesh {} is out of range.", i));
+        }
+    }
+    for (usize i = 0; i < view.lod_count; ++i) {
+        auto& lod = view.lods[i];
+        if (u64(lod.index_offset) + lod.index_count > view.index_count) {
+            return makeError(str::format("Cooked mesh level of detail {} is out of range.", i));
+        }
+    }
+    for (usize i = 0; i < view.node_count; ++i) {
+        auto& node = view.nodes[i];
+        bool valid_parent = i == 0 ? node.parent == mesh_root_parent : node.parent < i;
+        if (!valid_parent ||
+            u64(node.submesh_offset) + node.submesh_count > view.node_submesh_count) {
+            return makeError(str::format("Cooked mesh node {} is corrupt.", i));
+        }
+    }
+    for (usize i = 0; i < view.node_submesh_count; ++i) {
+        if (view.node_submeshes[i] >= view.submesh_count) {
+            return makeError(str::format("Cooked mesh node submesh {} is out of range.", i));
+        }
+    }
+    return {view};
+}
+}  // namespace dw
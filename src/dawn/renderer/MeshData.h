@@ -0,0 +1,114 @@
+/*
+ * Dawn Engine
+ * Written by David Avedissian (c) 2012-2019 (git@dga.dev)
+ */
+#pragma once
+
+namespace dw {
+// A mesh vertex, in the layout used by the GPU. Normals are quantised to 8 bits per component,
+// mapping [-1, 1] to [0, 255], and are unpacked in the vertex shader.
+struct MeshVertex {
+    float position[3];
+    u8 normal[4];
+};
+static_assert(sizeof(MeshVertex) == 16, "MeshVertex must match the cooked mesh format.");
+
+// A range of indices drawn with a single material, with optional simplified levels of detail.
+struct MeshSubMeshData {
+    u32 index_offset;
+    u32 index_count;
+    u32 lod_offset;  // Offset of the submesh's simplified levels of detail within the LOD list.
+    u32 lod_count;
+};
+
+// A simplified level of detail of a submesh, which uses the same vertices as the submesh. Levels
+// of detail are ordered from most to least detailed.
+struct MeshLodData {
+    u32 index_offset;
+    u32 index_count;
+    float error;  // Furthest distance of the simplified surface from the original, in mesh units.
+    u32 reserved;
+};
+
+// A node in the mesh hierarchy. Nodes are stored in depth first order, so a node's parent always
+// comes before it, and the root is the first node.
+struct MeshNodeData {
+    float transform[16];  // Row-major.
+    u32 parent;           // mesh_root_parent for the root node.
+    u32 submesh_offset;   // Offset of the node's submeshes within the node submesh list.
+    u32 submesh_count;
+    u32 reserved;
+};
+static_assert(sizeof(MeshNodeData) == 80, "MeshNodeData must match the cooked mesh format.");
+
+const u32 mesh_root_parent = 0xffffffff;
+
+// Mesh data on the CPU. This is produced by importing a source mesh (see MeshImporter.h), and can
+// be cooked into a binary form which is used in place when loaded.
+struct DW_API MeshData {
+    Vector<MeshVertex> vertices;
+    Vector<u32> indices;
+    Vector<MeshSubMeshData> submeshes;
+    Vector<MeshNodeData> nodes;
+    Vector<u32> node_submeshes;  // Indices into submeshes, referenced by each node.
+    Vector<MeshLodData> lods;
+    float bounds_centre[3] = {0.0f, 0.0f, 0.0f};
+    float bounds_radius = 0.0f;
+};
+
+// A read only view of mesh data, either cooked or in a MeshData. Indices are either 16 or 32 bits.
+struct DW_API MeshDataView {
+    const MeshVertex* vertices = nullptr;
+    usize vertex_count = 0;
+    const void* indices = nullptr;
+    usize index_count = 0;
+    usize index_size = 0;
+    const MeshSubMeshData* submeshes = nullptr;
+    usize submesh_count = 0;
+    const MeshNodeData* nodes = nullptr;
+    usize node_count = 0;
+    const u32* node_submeshes = nullptr;
+    usize node_submesh_count = 0;
+    const MeshLodData* lods = nullptr;
+    usize lod_count = 0;
+    float bounds_centre[3] = {0.0f, 0.0f, 0.0f};
+    float bounds_radius = 0.0f;
+
+    // Returns the index at position i, regardless of the index size.
+    u32 index(usize i) const;
+};
+
+// Quantises a normal component in [-1, 1] to 8 bits, and back again.
+DW_API u8 quantiseNormal(float n);
+DW_API float unquantiseNormal(u8 n);
+
+// Computes a bounding sphere which contains every vertex.
+DW_API void computeMeshBounds(MeshData& mesh);
+
+// Returns a view of mesh data. The view refers to the data directly, so must not outlive it.
+DW_API MeshDataView viewMeshData(const MeshData& mesh);
+
+// Cooks mesh data into the binary format used by the engine. Indices are stored as 16 bits if
+// every vertex can be addressed with them.
+DW_API Vector<byte> cookMesh(const MeshData& mesh);
+
+// Returns the error of each level of detail of a mesh, starting from level 1 (level 0 is full
+// detail). At level l, each submesh draws its l'th level of detail, or its least detailed one if it
+// has fewer, so a level's error is the largest error of any submesh at that level.
+DW_API Vector<float> meshLodErrors(const MeshDataView& mesh);
+
+// Selects a level of detail for a mesh, given the size of one mesh unit on screen as a fraction of
+// the screen height. The least detailed level whose error is no larger than the threshold on
+// screen is chosen. To avoid switching back and forth at the boundary, a less detailed level is
+// only chosen once its error is below threshold * (1 - hysteresis), and a more detailed one only
+// once the current level's error is above threshold * (1 + hysteresis).
+DW_API usize selectMeshLod(const Vector<float>& lod_errors, float projected_scale,
+                           usize current_lod, float threshold, float hysteresis);
+
+// Returns true if the data starts with a cooked mesh header.
+DW_API bool isCookedMesh(const byte* data, usize size);
+
+// Returns a view of a cooked mesh without copying it. The data must be 4 byte aligned. Only the
+// header and tables are validated, so the cost doesn't depend on the number of vertices.
+DW_API Result<MeshDataView> readCookedMesh(const byte* data, usize size);
+}  // namespace dw
@@ -0,0 +1,153 @@
+/*
+ * Dawn Engine
+ * Written by David Avedissian (c) 2012-2019 (git@dga.dev)
+ */
+#include "Testing.h"
+#include "renderer/MeshData.h"
+
+#include <limits>
+
+namespace {
+// A quad made of two triangles, with a root node and a child node both drawing it.
+dw::MeshData createQuad() {
+    dw::MeshData mesh;
+    for (int i = 0; i < 4; ++i) {
+        float x = static_cast<float>(i % 2), y = static_cast<float>(i / 2);
+        mesh.vertices.emplace_back(dw::MeshVertex{{x, y, 0.0f}, {128, 128, 255, 0}});
+    }
+    mesh.indices = {0, 1, 2, 2, 1, 3};
+    mesh.submeshes = {{0, 3}, {3, 3}};
+    dw::MeshNodeData root = {};
+    root.transform[0] = root.transform[5] = root.transform[10] = root.transform[15] = 1.0f;
+    root.parent = dw::mesh_root_parent;
+    root.submesh_offset = 0;
+    root.submesh_count = 1;
+    dw::MeshNodeData child = root;
+    child.transform[3] = 5.0f;
+    child.parent = 0;
+    child.submesh_offset = 1;
+    child.submesh_count = 1;
+    mesh.nodes = {root, child};
+    mesh.node_submeshes = {0, 1};
+    return mesh;
+}
+}  // namespace
+
+TEST(MeshDataTest, CookThenRead) {
+    auto mesh = createQuad();
+    auto cooked = dw::cookMesh(mesh);
+    ASSERT_TRUE(dw::isCookedMesh(cooked.data(), cooked.size()));
+    auto view = dw::readCookedMesh(cooked.data(), cooked.size());
+    ASSERT_TRUE(view);
+
+    ASSERT_EQ(4, view->vertex_count);
+    EXPECT_EQ(1.0f, view->vertices[3].position[0]);
+    EXPECT_EQ(255, view->vertices[3].normal[2]);
+    ASSERT_EQ(6, view->index_count);
+    for (dw::usize i = 0; i < mesh.indices.size(); ++i) {
+        EXPECT_EQ(mesh.indices[i], view->index(i));
+    }
+    ASSERT_EQ(2, view->submesh_count);
+    EXPECT_EQ(3, view->submeshes[1].index_offset);
+    ASSERT_EQ(2, view->node_count);
+    EXPECT_EQ(dw::mesh_root_parent, view->nodes[0].parent);
+    EXPECT_EQ(0, view->nodes[1].parent);
+    EXPECT_EQ(5.0f, view->nodes[1].transform[3]);
+    ASSERT_EQ(2, view->node_submesh_count);
+    EXPECT_EQ(1, view->node_submeshes[1]);
+
+    // The view refers to the cooked data rather than copying it.
+    EXPECT_GE(reinterpret_cast<const dw::byte*>(view->vertices), cooked.data());
+    EXPECT_LT(reinterpret_cast<const dw::byte*>(view->vertices), cooked.data() + cooked.size());
+}
+
+TEST(MeshDataTest, SmallMeshesUse16BitIndices) {
+    auto cooked = dw::cookMesh(createQuad());
+    EXPECT_EQ(2, dw::readCookedMesh(cooked.data(), cooked.size())->index_size);
+
+    auto large_mesh = createQuad();
+    large_mesh.vertices.resize(0x10001);
+    large_mesh.indices.back() = 0x10000;
+    auto large_cooked = dw::cookMesh(large_mesh);
+    auto large_view = dw::readCookedMesh(large_cooked.data(), large_cooked.size());
+    ASSERT_TRUE(large_view);
+    EXPECT_EQ(4, large_view->index_size);
+    EXPECT_EQ(0x10000, large_view->index(5));
+}
+
+TEST(MeshDataTest, QuantisedNormals) {
+    EXPECT_EQ(0, dw::quantiseNormal(-1.0f));
+    EXPECT_EQ(255, dw::quantiseNormal(1.0f));
+    EXPECT_EQ(255, dw::quantiseNormal(2.0f));
+    for (float n = -1.0f; n <= 1.0f; n += 0.01f) {
+        EXPECT_NEAR(n, dw::unquantiseNormal(dw::quantiseNormal(n)), 1.0f / 255.0f);
+    }
+}
+
+TEST(MeshDataTest, CorruptMeshesAreRejected) {
+    auto cooked = dw::cookMesh(createQuad());
+    EXPECT_FALSE(dw::readCookedMesh(cooked.data(), cooked.size() / 2));
+
+    auto bad_submesh = createQuad();
+    bad_submesh.submeshes[1].index_count = 4;
+    cooked = dw::cookMesh(bad_submesh);
+    EXPECT_FALSE(dw::readCookedMesh(cooked.data(), cooked.size()));
+
+    auto bad_parent = createQuad();
+    bad_parent.nodes[1].parent = 1;
+    cooked = dw::cookMesh(bad_parent);
+    EXPECT_FALSE(dw::readCookedMesh(cooked.data(), cooked.size()));
+
+    dw::String not_a_mesh = "this is not a cooked mesh, but it's long enough to have a header";
+    EXPECT_FALSE(dw::isCookedMesh(reinterpret_cast<const dw::byte*>(not_a_mesh.data()),
+                                  not_a_mesh.size()));
+}
+
+TEST(MeshDataTest, CookedMeshesNeedOnlyFourByteAlignment) {
+    auto cooked = dw::cookMesh(createQuad());
+
+    // The vector's storage is at least 16 byte aligned, so offsetting it by 4 bytes gives data
+    // which is 4 but not 16 byte aligned.
+    dw::Vector<dw::byte> buffer(cooked.size() + 4);
+    memcpy(buffer.data() + 4, cooked.data(), cooked.size());
+    auto view = dw::readCookedMesh(buffer.data() + 4, cooked.size());
+    ASSERT_TRUE(view);
+    EXPECT_EQ(4, view->vertex_count);
+
+    memmove(buffer.data() + 2, cooked.data(), cooked.size());
+    EXPECT_FALSE(dw::readCookedMesh(buffer.data() + 2, cooked.size()));
+}
+
+TEST(MeshDataTest, LodErrorsCoverEverySubmesh) {
+    auto mesh = createQuad();
+    mesh.lods = {{0, 3, 1.0f, 0}, {0, 3, 2.0f, 0}, {3, 3, 1.5f, 0}};
+    mesh.submeshes[0].lod_offset = 0;
+    mesh.submeshes[0].lod_count = 2;
+    mesh.submeshes[1].lod_offset = 2;
+    mesh.submeshes[1].lod_count = 1;
+    EXPECT_EQ((dw::Vector<float>{1.5f, 2.0f}), dw::meshLodErrors(dw::viewMeshData(mesh)));
+    EXPECT_TRUE(dw::meshLodErrors(dw::viewMeshData(createQuad())).empty());
+}
+
+TEST(MeshDataTest, SelectLodWithHysteresis) {
+    dw::Vector<float> errors = {1.0f, 2.0f, 4.0f};
+    const float threshold = 0.01f, hysteresis = 0.25f;
+
+    // Far away, every level's error is small enough.
+    EXPECT_EQ(3, dw::selectMeshLod(errors, 0.001f, 0, threshold, hysteresis));
+
+    // Close up, full detail is needed.
+    EXPECT_EQ(0, dw::selectMeshLod(errors, 1.0f, 3, threshold, hysteresis));
+    EXPECT_EQ(0, dw::selectMeshLod(errors, std::numeric_limits<float>::max(), 2, threshold,
+                                   hysteresis));
+
+    // Level 2 has an error of 0.008 on screen, which is within the threshold, but a less detailed
+    // level isn't chosen until it's within the hysteresis band.
+    EXPECT_EQ(1, dw::selectMeshLod(errors, 0.004f, 0, threshold, hysteresis));
+    EXPECT_EQ(1, dw::selectMeshLod(errors, 0.004f, 1, threshold, hysteresis));
+    EXPECT_EQ(2, dw::selectMeshLod(errors, 0.0035f, 1, threshold, hysteresis));
+
+    // Once chosen, level 2 is kept until its error exceeds the threshold plus hysteresis.
+    EXPECT_EQ(2, dw::selectMeshLod(errors, 0.006f, 2, threshold, hysteresis));
+    EXPECT_EQ(1, dw::selectMeshLod(errors, 0.007f, 2, threshold, hysteresis));
+}
@@ -0,0 +1,127 @@
+/*
+ * Dawn Engine
+ * Written by David Avedissian (c) 2012-2019 (git@dga.dev)
+ */
+#include "Base.h"
+#include "renderer/MeshImporter.h"
+
+#define ASSIMP_BUILD_BOOST_WORKAROUND
+#include <assimp/Importer.hpp>
+#include <assimp/scene.h>
+#include <assimp/DefaultLogger.hpp>
+#include <assimp/Logger.hpp>
+#include <assimp/postprocess.h>
+
+namespace dw {
+namespace {
+class DawnAssimpLogStream : public Assimp::LogStream {
+public:
+    DawnAssimpLogStream(Context* ctx) : logger{ctx->module<Logger>()} {
+    }
+    ~DawnAssimpLogStream() = default;
+
+    void write(const char* message_cstr) {
+        String message{message_cstr};
+        logger->withObjectName("Mesh").info("Assimp Importer: {}",
+                                            message.substr(0, message.length() - 1));
+    }
+
+private:
+    Logger* logger;
+};
+
+// Assimp's logger is global, so imports on different loader threads must not overlap.
+Mutex import_mutex;
+
+void addNode(MeshData& mesh, const aiNode* ai_node, u32 parent) {
+    MeshNodeData node = {};
+    const aiMatrix4x4& ai_transform = ai_node->mTransformation;
+    for (int r = 0; r < 4; ++r) {
+        for (int c = 0; c < 4; ++c) {
+            node.transform[r * 4 + c] = ai_transform[r][c];
+        }
+    }
+    node.parent = parent;
+    node.submesh_offset = static_cast<u32>(mesh.node_submeshes.size());
+    node.submesh_count = ai_node->mNumMeshes;
+    for (uint i = 0; i < ai_node->mNumMeshes; ++i) {
+        mesh.node_submeshes.emplace_back(ai_node->mMeshes[i]);
+    }
+    auto index = static_cast<u32>(mesh.nodes.size());
+    mesh.nodes.emplace_back(node);
+    for (uint c = 0; c < ai_node->mNumChildren; ++c) {
+        addNode(mesh, ai_node->mChildren[c], index);
+    }
+}
+}  // namespace
+
+Result<MeshData> importMesh(Context* ctx, const String& asset_name, const byte* data,
+                            usize size) {
+    const unsigned int severity = Assimp::Logger::Debugging | Assimp::Logger::Info |
+                                  Assimp::Logger::Warn | Assimp::Logger::Err;
+
+    // Run importer.
+    LockGuard<Mutex> lock(import_mutex);
+    Assimp::DefaultLogger::create("", Assimp::Logger::VERBOSE, 0);
+    Assimp::DefaultLogger::get()->attachStream(new DawnAssimpLogStream(ctx), severity);
+    Assimp::Importer importer;
+    auto flags = aiProcess_CalcTangentSpace | aiProcess_Triangulate |
+                 aiProcess_JoinIdenticalVertices | aiProcess_SortByPType;
+    const aiScene* scene = importer.ReadFileFromMemory(data, size, flags, asset_name.c_str());
+    Assimp::DefaultLogger::kill();
+    if (!scene) {
+        return makeError(str::format("Unable to load mesh {}. Reason: {}", asset_name,
+                                     importer.GetErrorString()));
+    }
+
+    // Build a single vertex and index buffer containing all the submeshes.
+    MeshData mesh;
+    for (uint i = 0; i < scene->mNumMeshes; ++i) {
+        const auto* ai_mesh = scene->mMeshes[i];
+
+        // Check the mesh for any issues, and abort if so.
+        if (!ai_mesh->HasPositions()) {
+            return makeError(
+                str::format("Unable to load mesh {}. Submesh {} has no positions.", asset_name, i));
+        }
+        if (!ai_mesh->HasNormals()) {
+            return makeError(
+                str::format("Unable to load mesh {}. Submesh {} has no normals.", asset_name, i));
+        }
+        if (!ai_mesh->HasFaces()) {
+            return makeError(
+                str::format("Unable to load mesh {}. Submesh {} has no faces.", asset_name, i));
+        }
+
+        const u32 vertex_offset = static_cast<u32>(mesh.vertices.size());
+        const u32 index_offset = static_cast<u32>(mesh.indices.size());
+
+        for (usize v = 0; v < ai_mesh->mNumVertices; ++v) {
+            const aiVector3D& position = ai_mesh->mVertices[v];
+            const aiVector3D& normal = ai_mesh->mNormals[v];
+            mesh.vertices.emplace_back(MeshVertex{
+                {position.x, position.y, position.z},
+                {quantiseNormal(normal.x), quantiseNormal(normal.y), quantiseNormal(normal.z), 0}});
+        }
+        for (usize f = 0; f < ai_mesh->mNumFaces; ++f) {
+            const aiFace& face = ai_mesh->mFaces[f];
+            if (face.mNumIndices != 3) {
+                return makeError(str::format(
+                    "Unable to load mesh {}. Face {} in submesh {} has {} indices (must be exactly "
+                    "3).",
+                    asset_name, f, i, face.mNumIndices));
+            }
+            mesh.indices.emplace_back(face.mIndices[0] + vertex_offset);
+            mesh.indices.emplace_back(face.mIndices[1] + vertex_offset);
+            mesh.indices.emplace_back(face.mIndices[2] + vertex_offset);
+        }
+
+        mesh.submeshes.emplace_back(MeshSubMeshData{index_offset, ai_mesh->mNumFaces * 3, 0, 0});
+    }
+
+    // Flatten the node hierarchy.
+    addNode(mesh, scene->mRootNode, mesh_root_parent);
+    computeMeshBounds(mesh);
+    return {std::move(mesh)};
+}
+}  // namespace dw
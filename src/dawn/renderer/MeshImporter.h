@@ -0,0 +1,14 @@
+/*
+ * Dawn Engine
+ * Written by David Avedissian (c) 2012-2019 (git@dga.dev)
+ */
+#pragma once
+
+#include "renderer/MeshData.h"
+
+namespace dw {
+// Imports a source mesh (any format supported by Assimp) into mesh data. This is used by the mesh
+// cooker, and by Mesh when loading a mesh which hasn't been cooked.
+DW_API Result<MeshData> importMesh(Context* ctx, const String& asset_name, const byte* data,
+                                   usize size);
+}  // namespace dw
@@ -0,0 +1,308 @@
+/*
+ * Dawn Engine
+ * Written by David Avedissian (c) 2012-2019 (git@dga.dev)
+ */
+#include "Base.h"
+#include "renderer/MeshOptimiser.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace dw {
+namespace {
+const u64 no_cell = ~0ull;
+
+// Grid resolution of the first level of detail. Each later level halves it until the number of
+// triangles has halved.
+const u32 max_lod_grid_size = 256;
+
+// Clusters the vertices used by a range of triangles into a grid, and replaces each vertex with
+// a representative of its cell. Triangles which collapse are removed.
+Vector<u32> clusterTriangles(const MeshData& mesh, usize index_offset, usize index_count,
+                             u32 grid_size, float& error) {
+    float cell_size = mesh.bounds_radius * 2.0f / static_cast<float>(grid_size);
+    error = cell_size * std::sqrt(3.0f);
+    if (cell_size <= 0.0f) {
+        return {};
+    }
+
+    // Find the cell containing each vertex.
+    Vector<u64> vertex_cell(mesh.vertices.size(), no_cell);
+    Vector<u32> used_vertices;
+    for (usize i = index_offset; i < index_offset + index_count; ++i) {
+        u32 v = mesh.indices[i];
+        if (vertex_cell[v] != no_cell) {
+            continue;
+        }
+        u64 cell = 0;
+        for (int axis = 0; axis < 3; ++axis) {
+            float origin = mesh.bounds_centre[axis] - mesh.bounds_radius;
+            auto coord = static_cast<i64>((mesh.vertices[v].position[axis] - origin) / cell_size);
+            coord = std::min(std::max(coord, i64(0)), i64(grid_size) - 1);
+            cell |= static_cast<u64>(coord) << (axis * 21);
+        }
+        vertex_cell[v] = cell;
+        used_vertices.emplace_back(v);
+    }
+
+    // The representative of each cell is the vertex closest to the average of the cell's
+    // vertices, so that no new vertices are needed.
+    struct Cell {
+        float sum[3] = {0.0f, 0.0f, 0.0f};
+        usize count = 0;
+        u32 representative = 0;
+        float distance_squared = 0.0f;
+    };
+    HashMap<u64, Cell> cells;
+    for (u32 v : used_vertices) {
+        auto& cell = cells[vertex_cell[v]];
+        for (int axis = 0; axis < 3; ++axis) {
+            cell.sum[axis] += mesh.vertices[v].position[axis];
+        }
+        cell.count++;
+    }
+    for (auto& entry : cells) {
+        for (int axis = 0; axis < 3; ++axis) {
+            entry.second.sum[axis] /= static_cast<float>(entry.second.count);
+        }
+        entry.second.count = 0;
+    }
+    for (u32 v : used_vertices) {
+        auto& cell = cells[vertex_cell[v]];
+        float distance_squared = 0.0f;
+        for (int axis = 0; axis < 3; ++axis) {
+            float d = mesh.vertices[v].position[axis] - cell.sum[axis];
+            distance_squared += d * d;
+        }
+        if (cell.count == 0 || distance_squared < cell.distance_squared) {
+            cell.representative = v;
+            cell.distance_squared = distance_squared;
+        }
+        cell.count++;
+    }
+
+    // Rotate each remaining triangle so that its smallest index comes first, which preserves
+    // winding while allowing duplicates to be removed.
+    Vector<Array<u32, 3>> triangles;
+    for (usize i = index_offset; i + 2 < index_offset + index_count; i += 3) {
+        Array<u32, 3> t;
+        for (int k = 0; k < 3; ++k) {
+            t[k] = cells[vertex_cell[mesh.indices[i + k]]].representative;
+        }
+        if (t[0] == t[1] || t[1] == t[2] || t[0] == t[2]) {
+            continue;
+        }
+        std::rotate(t.begin(), std::min_element(t.begin(), t.end()), t.end());
+        triangles.emplace_back(t);
+    }
+    std::sort(triangles.begin(), triangles.end());
+    triangles.erase(std::unique(triangles.begin(), triangles.end()), triangles.end());
+
+    Vector<u32> indices;
+    indices.reserve(triangles.size() * 3);
+    for (auto& t : triangles) {
+        indices.insert(indices.end(), t.begin(), t.end());
+    }
+    return indices;
+}
+}  // namespace
+
+VertexCacheStats analyseVertexCache(const MeshDataView& mesh, usize cache_size) {
+    // A vertex is in the cache if fewer than cache_size vertices have been added since it was.
+    Vector<u64> added_at(mesh.vertex_count, 0);
+    Vector<bool> used(mesh.vertex_count, false);
+    u64 misses = 0;
+    usize used_count = 0;
+    usize triangle_count = 0;
+    auto simulate = [&](usize index_offset, usize index_count) {
+        for (usize i = index_offset; i < index_offset + index_count; ++i) {
+            u32 v = mesh.index(i);
+            if (v >= mesh.vertex_count) {
+                continue;
+            }
+            if (!used[v]) {
+                used[v] = true;
+                used_count++;
+            }
+            if (added_at[v] == 0 || misses - added_at[v] >= cache_size) {
+                added_at[v] = ++misses;
+            }
+        }
+        triangle_count += index_count / 3;
+    };
+    if (mesh.submesh_count == 0) {
+        simulate(0, mesh.index_count);
+    }
+    for (usize s = 0; s < mesh.submesh_count; ++s) {
+        simulate(mesh.submeshes[s].index_offset, mesh.submeshes[s].index_count);
+    }
+
+    VertexCacheStats stats;
+    if (triangle_count > 0) {
+        stats.acmr = static_cast<float>(misses) / static_cast<float>(triangle_count);
+        stats.atvr = static_cast<float>(misses) / static_cast<float>(used_count);
+    }
+    return stats;
+}
+
+void optimiseVertexCache(u32* indices, usize index_count, usize vertex_count, usize cache_size) {
+    usize triangle_count = index_count / 3;
+    if (triangle_count == 0) {
+        return;
+    }
+
+    // Build a list of the triangles using each vertex. live is the number of triangles using a
+    // vertex which haven't been emitted yet.
+    Vector<u32> live(vertex_count, 0);
+    for (usize i = 0; i < triangle_count * 3; ++i) {
+        live[indices[i]]++;
+    }
+    Vector<u32> adjacency_offset(vertex_count + 1, 0);
+    for (usize v = 0; v < vertex_count; ++v) {
+        adjacency_offset[v + 1] = adjacency_offset[v] + live[v];
+    }
+    Vector<u32> adjacency(triangle_count * 3);
+    Vector<u32> adjacency_end(adjacency_offset.begin(), adjacency_offset.end() - 1);
+    for (usize t = 0; t < triangle_count; ++t) {
+        for (usize k = 0; k < 3; ++k) {
+            adjacency[adjacency_end[indices[t * 3 + k]]++] = static_cast<u32>(t);
+        }
+    }
+
+    // Emit the triangles around a fanning vertex, then pick the next fanning vertex from the
+    // vertices just emitted, preferring ones which will still be in the cache once their
+    // remaining triangles are emitted. When there are none, fall back to recently used vertices
+    // (the dead end stack), then to the next vertex in order with triangles remaining.
+    Vector<u64> cache_time(vertex_count, 0);
+    Vector<bool> emitted(triangle_count, false);
+    Vector<u32> dead_end;
+    Vector<u32> candidates;
+    Vector<u32> output;
+    output.reserve(triangle_count * 3);
+    u64 time = cache_size + 1;
+    usize cursor = 0;
+    u32 fanning = indices[0];
+    while (true) {
+        candidates.clear();
+        for (u32 a = adjacency_offset[fanning]; a < adjacency_offset[fanning + 1]; ++a) {
+            u32 t = adjacency[a];
+            if (emitted[t]) {
+                continue;
+            }
+            for (usize k = 0; k < 3; ++k) {
+                u32 v = indices[t * 3 + k];
+                output.emplace_back(v);
+                dead_end.emplace_back(v);
+                candidates.emplace_back(v);
+                live[v]--;
+                if (time - cache_time[v] > cache_size) {
+                    cache_time[v] = time++;
+                }
+            }
+            emitted[t] = true;
+        }
+
+        i64 best_priority = -1;
+        bool found = false;
+        u32 next = 0;
+        for (u32 v : candidates) {
+            if (live[v] == 0) {
+                continue;
+            }
+            i64 priority = 0;
+            i64 age = static_cast<i64>(time - cache_time[v]);
+            if (age + 2 * static_cast<i64>(live[v]) <= static_cast<i64>(cache_size)) {
+                priority = age;
+            }
+            if (priority > best_priority) {
+                best_priority = priority;
+                next = v;
+                found = true;
+            }
+        }
+        while (!found && !dead_end.empty()) {
+            u32 v = dead_end.back();
+            dead_end.pop_back();
+            if (live[v] > 0) {
+                next = v;
+                found = true;
+            }
+        }
+        while (!found && cursor < vertex_count) {
+            if (live[cursor] > 0) {
+                next = static_cast<u32>(cursor);
+                found = true;
+            } else {
+                cursor++;
+            }
+        }
+        if (!found) {
+            break;
+        }
+        fanning = next;
+    }
+    std::copy(output.begin(), output.end(), indices);
+}
+
+void optimiseVertexFetch(MeshData& mesh) {
+    const u32 unused = 0xffffffff;
+    Vector<u32> remap(mesh.vertices.size(), unused);
+    Vector<MeshVertex> vertices;
+    vertices.reserve(mesh.vertices.size());
+    for (auto& index : mesh.indices) {
+        if (remap[index] == unused) {
+            remap[index] = static_cast<u32>(vertices.size());
+            vertices.emplace_back(mesh.vertices[index]);
+        }
+        index = remap[index];
+    }
+    mesh.vertices = std::move(vertices);
+}
+
+void generateMeshLods(MeshData& mesh, usize max_lods) {
+    if (max_lods == 0) {
+        return;
+    }
+    if (mesh.bounds_radius <= 0.0f) {
+        computeMeshBounds(mesh);
+    }
+    for (auto& submesh : mesh.submeshes) {
+        submesh.lod_offset = static_cast<u32>(mesh.lods.size());
+        submesh.lod_count = 0;
+        usize previous_index_count = submesh.index_count;
+        for (u32 grid_size = max_lod_grid_size; grid_size >= 2 && submesh.lod_count < max_lods;
+             grid_size /= 2) {
+            float error;
+            auto indices = clusterTriangles(mesh, submesh.index_offset, submesh.index_count,
+                                            grid_size, error);
+            if (indices.empty()) {
+                break;
+            }
+            if (indices.size() > previous_index_count / 2) {
+                continue;
+            }
+            MeshLodData lod = {};
+            lod.index_offset = static_cast<u32>(mesh.indices.size());
+            lod.index_count = static_cast<u32>(indices.size());
+            lod.error = error;
+            mesh.indices.insert(mesh.indices.end(), indices.begin(), indices.end());
+            mesh.lods.emplace_back(lod);
+            submesh.lod_count++;
+            previous_index_count = indices.size();
+        }
+    }
+}
+
+void optimiseMesh(MeshData& mesh, const MeshOptimiseOptions& options) {
+    generateMeshLods(mesh, options.max_lods);
+    for (auto& submesh : mesh.submeshes) {
+        optimiseVertexCache(mesh.indices.data() + submesh.index_offset, submesh.index_count,
+                            mesh.vertices.size(), options.cache_size);
+    }
+    for (auto& lod : mesh.lods) {
+        optimiseVertexCache(mesh.indices.data() + lod.index_offset, lod.index_count,
+                            mesh.vertices.size(), options.cache_size);
+    }
+    optimiseVertexFetch(mesh);
+}
+}  // namespace dw
@@ -0,0 +1,51 @@
+/*
+ * Dawn Engine
+ * Written by David Avedissian (c) 2012-2019 (git@dga.dev)
+ */
+#pragma once
+
+#include "renderer/MeshData.h"
+
+namespace dw {
+// Number of entries in the simulated post-transform vertex cache. This is a conservative size, as
+// triangle orders tuned for a small cache still work well with a larger one.
+const usize default_vertex_cache_size = 16;
+
+// How well a mesh uses the post-transform vertex cache, simulated as a FIFO cache.
+struct VertexCacheStats {
+    // Average cache miss ratio: vertices transformed per triangle. This ranges from 3 (no reuse)
+    // down to around 0.5 for large regular meshes.
+    float acmr = 0.0f;
+    // Average transform to vertex ratio: vertices transformed per vertex used. 1 is ideal.
+    float atvr = 0.0f;
+};
+
+struct MeshOptimiseOptions {
+    usize cache_size = default_vertex_cache_size;
+    // Maximum number of simplified levels of detail to generate for each submesh.
+    usize max_lods = 0;
+};
+
+// Simulates drawing the full detail submeshes of a mesh, or every index if it has no submeshes.
+DW_API VertexCacheStats analyseVertexCache(const MeshDataView& mesh,
+                                           usize cache_size = default_vertex_cache_size);
+
+// Reorders a list of triangles to reduce vertex cache misses, using Tipsify (Sander, Nehab and
+// Barczak, "Fast Triangle Reordering for Vertex Locality and Reduced Overdraw", 2007). Winding
+// is preserved. Indices must be less than vertex_count.
+DW_API void optimiseVertexCache(u32* indices, usize index_count, usize vertex_count,
+                                usize cache_size = default_vertex_cache_size);
+
+// Reorders vertices into the order in which they're first used, so that vertex fetches are close
+// together in memory. Vertices which aren't used by any triangle are removed.
+DW_API void optimiseVertexFetch(MeshData& mesh);
+
+// Generates simplified levels of detail for each submesh by vertex clustering. Each level halves
+// the number of triangles, and uses existing vertices, so only indices are added. Submeshes too
+// small to simplify further get fewer levels.
+DW_API void generateMeshLods(MeshData& mesh, usize max_lods);
+
+// Generates levels of detail if requested, then optimises every index range for the vertex cache
+// and the vertices for fetch locality.
+DW_API void optimiseMesh(MeshData& mesh, const MeshOptimiseOptions& options);
+}  // namespace dw
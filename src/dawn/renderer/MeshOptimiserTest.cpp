@@ -0,0 +1,151 @@
+/*
+ * Dawn Engine
+ * Written by David Avedissian (c) 2012-2019 (git@dga.dev)
+ */
+#include "Testing.h"
+#include "renderer/MeshOptimiser.h"
+
+#include <algorithm>
+#include <random>
+
+namespace {
+// A flat grid of size x size quads in a single submesh, with its triangles in a random order.
+dw::MeshData createShuffledGrid(dw::u32 size) {
+    dw::MeshData mesh;
+    for (dw::u32 y = 0; y <= size; ++y) {
+        for (dw::u32 x = 0; x <= size; ++x) {
+            mesh.vertices.emplace_back(dw::MeshVertex{
+                {static_cast<float>(x), static_cast<float>(y), 0.0f}, {128, 128, 255, 0}});
+        }
+    }
+    dw::Vector<dw::Array<dw::u32, 3>> triangles;
+    for (dw::u32 y = 0; y < size; ++y) {
+        for (dw::u32 x = 0; x < size; ++x) {
+            dw::u32 v = y * (size + 1) + x;
+            triangles.push_back({v, v + 1, v + size + 1});
+            triangles.push_back({v + 1, v + size + 2, v + size + 1});
+        }
+    }
+    std::shuffle(triangles.begin(), triangles.end(), std::mt19937{1234});
+    for (auto& t : triangles) {
+        mesh.indices.insert(mesh.indices.end(), t.begin(), t.end());
+    }
+    mesh.submeshes.push_back({0, static_cast<dw::u32>(mesh.indices.size()), 0, 0});
+    dw::MeshNodeData root = {};
+    root.parent = dw::mesh_root_parent;
+    root.submesh_count = 1;
+    mesh.nodes.push_back(root);
+    mesh.node_submeshes.push_back(0);
+    dw::computeMeshBounds(mesh);
+    return mesh;
+}
+
+// Returns the triangles of a range of indices, each rotated so that its smallest vertex comes
+// first, and sorted. Triangles are compared by position, so that this doesn't depend on the
+// order of the vertices.
+dw::Vector<dw::Array<float, 9>> sortedTriangles(const dw::MeshData& mesh, dw::usize offset,
+                                                dw::usize count) {
+    dw::Vector<dw::Array<float, 9>> triangles;
+    for (dw::usize i = offset; i < offset + count; i += 3) {
+        dw::Array<dw::Array<float, 3>, 3> t;
+        for (int k = 0; k < 3; ++k) {
+            auto& position = mesh.vertices[mesh.indices[i + k]].position;
+            t[k] = {position[0], position[1], position[2]};
+        }
+        std::rotate(t.begin(), std::min_element(t.begin(), t.end()), t.end());
+        dw::Array<float, 9> flattened;
+        for (int k = 0; k < 9; ++k) {
+            flattened[k] = t[k / 3][k % 3];
+        }
+        triangles.push_back(flattened);
+    }
+    std::sort(triangles.begin(), triangles.end());
+    return triangles;
+}
+}  // namespace
+
+TEST(MeshOptimiserTest, AnalyseVertexCache) {
+    // A single triangle transforms every vertex once.
+    dw::MeshData mesh;
+    mesh.vertices.resize(3);
+    mesh.indices = {0, 1, 2};
+    auto stats = dw::analyseVertexCache(dw::viewMeshData(mesh));
+    EXPECT_FLOAT_EQ(3.0f, stats.acmr);
+    EXPECT_FLOAT_EQ(1.0f, stats.atvr);
+
+    // A second triangle sharing an edge only transforms one more vertex.
+    mesh.vertices.resize(4);
+    mesh.indices = {0, 1, 2, 2, 1, 3};
+    stats = dw::analyseVertexCache(dw::viewMeshData(mesh));
+    EXPECT_FLOAT_EQ(2.0f, stats.acmr);
+    EXPECT_FLOAT_EQ(1.0f, stats.atvr);
+
+    // With a cache of one vertex, only consecutive repeats hit.
+    stats = dw::analyseVertexCache(dw::viewMeshData(mesh), 1);
+    EXPECT_FLOAT_EQ(2.5f, stats.acmr);
+}
+
+TEST(MeshOptimiserTest, OptimiseVertexCacheReducesMisses) {
+    auto mesh = createShuffledGrid(32);
+    auto original_triangles = sortedTriangles(mesh, 0, mesh.indices.size());
+    auto before = dw::analyseVertexCache(dw::viewMeshData(mesh));
+
+    dw::optimiseVertexCache(mesh.indices.data(), mesh.indices.size(), mesh.vertices.size());
+    auto after = dw::analyseVertexCache(dw::viewMeshData(mesh));
+    EXPECT_LT(after.acmr, before.acmr);
+    EXPECT_LT(after.acmr, 1.0f);
+    EXPECT_LT(after.atvr, 1.6f);
+
+    // The same triangles are drawn, with the same winding.
+    EXPECT_EQ(original_triangles, sortedTriangles(mesh, 0, mesh.indices.size()));
+}
+
+TEST(MeshOptimiserTest, OptimiseVertexFetch) {
+    auto mesh = createShuffledGrid(8);
+    auto original_triangles = sortedTriangles(mesh, 0, mesh.indices.size());
+    mesh.vertices.emplace_back(dw::MeshVertex{{100.0f, 100.0f, 100.0f}, {0, 0, 0, 0}});
+
+    dw::optimiseVertexFetch(mesh);
+
+    // Vertices are in the order they're first used, and unused vertices are removed.
+    EXPECT_EQ(81, mesh.vertices.size());
+    dw::u32 next_new_vertex = 0;
+    for (auto index : mesh.indices) {
+        ASSERT_LE(index, next_new_vertex);
+        if (index == next_new_vertex) {
+            next_new_vertex++;
+        }
+    }
+    EXPECT_EQ(original_triangles, sortedTriangles(mesh, 0, mesh.indices.size()));
+}
+
+TEST(MeshOptimiserTest, GenerateLods) {
+    auto mesh = createShuffledGrid(64);
+    dw::MeshOptimiseOptions options;
+    options.max_lods = 3;
+    dw::optimiseMesh(mesh, options);
+
+    auto& submesh = mesh.submeshes[0];
+    ASSERT_EQ(3, submesh.lod_count);
+    dw::usize previous_index_count = submesh.index_count;
+    float previous_error = 0.0f;
+    for (dw::usize l = 0; l < submesh.lod_count; ++l) {
+        auto& lod = mesh.lods[submesh.lod_offset + l];
+        EXPECT_GT(lod.index_count, 0);
+        EXPECT_LE(lod.index_count, previous_index_count / 2);
+        EXPECT_GT(lod.error, previous_error);
+        for (dw::usize i = lod.index_offset; i < lod.index_offset + lod.index_count; ++i) {
+            ASSERT_LT(mesh.indices[i], mesh.vertices.size());
+        }
+        previous_index_count = lod.index_count;
+        previous_error = lod.error;
+    }
+
+    // Levels of detail survive cooking.
+    auto cooked = dw::cookMesh(mesh);
+    auto view = dw::readCookedMesh(cooked.data(), cooked.size());
+    ASSERT_TRUE(view);
+    ASSERT_EQ(3, view->lod_count);
+    EXPECT_EQ(mesh.lods[2].index_count, view->lods[2].index_count);
+    EXPECT_FLOAT_EQ(mesh.bounds_radius, view->bounds_radius);
+}
@@ -34,6 +34,16 @@ void SceneNodePool::free(SystemNode* node) {
 void SceneNodePool::free(Node* node) {
     delete node;
 }
+
+RenderableInstanceState* RendererSceneNodeData::instanceState(usize camera_id,
+                                                              usize camera_count) {
+    assert(camera_id < camera_count);
+    // Size for every camera at once, so that pointers to other cameras' state stay valid.
+    if (instance_states.size() != camera_count) {
+        instance_states.resize(camera_count);
+    }
+    return &instance_states[camera_id];
+}
 }  // namespace detail
 
 SystemNode::SystemNode(detail::SceneNodePool* pool, const SystemPosition& p, const Quat& o)
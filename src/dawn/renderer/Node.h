@@ -48,8 +48,20 @@ struct Transform {
     static Transform fromMat4(const Mat4& matrix);
 };
 
+// State kept by a renderable for each scene node it's attached to and camera it's drawn from, as
+// a renderable such as a mesh can be shared between many nodes, and each camera sees it at a
+// different distance.
+struct RenderableInstanceState {
+    usize lod = 0;  // Level of detail last drawn.
+};
+
 struct RendererSceneNodeData {
     SharedPtr<Renderable> renderable;
+    Vector<RenderableInstanceState> instance_states;  // Indexed by camera.
+
+    // Returns the state of the renderable when drawn from a camera. The pointer stays valid until
+    // the number of cameras changes.
+    RenderableInstanceState* instanceState(usize camera_id, usize camera_count);
 };
 }  // namespace detail
 
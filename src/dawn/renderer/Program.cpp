@@ -10,6 +10,7 @@ namespace dw {
 
 Program::Program(Context* ctx, SharedPtr<VertexShader> vs, SharedPtr<FragmentShader> fs)
     : Resource{ctx}, r{module<Renderer>()->rhi()}, vertex_shader_{vs}, fragment_shader_{fs} {
+    LockGuard<RecursiveMutex> lock(module<Renderer>()->resourceMutex());
     handle_ = r->createProgram();
     r->attachShader(handle_, vs->internalHandle());
     r->attachShader(handle_, fs->internalHandle());
@@ -32,6 +33,7 @@ gfx::ProgramHandle Program::internalHandle() const {
 }
 
 void Program::applyRendererState() {
+    assert(module<Renderer>()->isMainThread());
     // Set textures.
     for (uint i = 0; i < static_cast<uint>(texture_units_.size()); i++) {
         if (!texture_units_[i]) {
@@ -244,6 +244,7 @@ Result<void> RenderPipeline::beginLoad(const String& asset_name, InputStream& sr
 }
 
 void RenderPipeline::render(float dt, float interpolation, SceneGraph* scene_graph, u32 camera_id) {
+    assert(module<Renderer>()->isMainThread());
     auto rhi = module<Renderer>()->rhi();
     for (uint view = 0; view < nodes_.size(); ++view) {
         nodes_[view]->prepareForRendering(rhi, view);
@@ -24,8 +24,10 @@ public:
     void setMaterial(SharedPtr<Material> material);
 
     /// Draws this renderable to the specified view.
+    /// @param instance_state State kept between frames for the scene node being drawn.
     virtual void draw(Renderer* renderer, uint view, detail::Transform& camera,
-                      const Mat4& model_matrix, const Mat4& view_projection_matrix) = 0;
+                      const Mat4& model_matrix, const Mat4& view_projection_matrix,
+                      detail::RenderableInstanceState& instance_state) = 0;
 
 protected:
     SharedPtr<Material> material_;
@@ -38,6 +38,7 @@ private:
 
 Renderer::Renderer(Context* ctx)
     : Module(ctx),
+      main_thread_(std::this_thread::get_id()),
       frame_time_(0.0f),
       frames_per_second_(0),
       frame_counter_(0),
@@ -47,7 +48,12 @@ Renderer::Renderer(Context* ctx)
 }
 
 bool Renderer::frame() {
-    auto result = renderer_->frame();
+    assert(isMainThread());
+    bool result;
+    {
+        LockGuard<RecursiveMutex> lock(resource_mutex_);
+        result = renderer_->frame();
+    }
 
     // Update frame counter.
     frame_counter_++;
@@ -65,6 +71,14 @@ gfx::Renderer* Renderer::rhi() const {
     return renderer_.get();
 }
 
+RecursiveMutex& Renderer::resourceMutex() {
+    return resource_mutex_;
+}
+
+bool Renderer::isMainThread() const {
+    return std::this_thread::get_id() == main_thread_;
+}
+
 double Renderer::frameTime() const {
     return frame_time_;
 }
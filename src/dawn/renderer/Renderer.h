@@ -4,6 +4,7 @@
  */
 #pragma once
 
+#include "core/Concurrency.h"
 #include "core/Timer.h"
 
 #include <dawn-gfx/Renderer.h>
@@ -20,8 +21,20 @@ public:
     bool frame();
 
     /// Get the renderer hardware interface.
+    ///
+    /// Only the functions which create, update or delete resources (buffers, textures, shaders,
+    /// programs and frame buffers) may be called from other threads, such as resource loaders and
+    /// game sessions updated on worker threads, and only while holding resourceMutex(). Everything
+    /// else, including view and render state, uniforms, transient buffers, submission and frame(),
+    /// must only be called on the main thread during rendering.
     gfx::Renderer* rhi() const;
 
+    /// Mutex which serialises the creation, update and deletion of renderer resources.
+    RecursiveMutex& resourceMutex();
+
+    /// Returns true if called on the main thread, which created the renderer.
+    bool isMainThread() const;
+
     /// Access the last frame time
     double frameTime() const;
 
@@ -33,6 +46,8 @@ private:
 
     UniquePtr<gfx::Renderer> renderer_;
     SharedPtr<RendererLoggerImpl> renderer_logger_;  // needs to be shared as type is not defined.
+    RecursiveMutex resource_mutex_;
+    Thread::id main_thread_;
 
     double frame_time_;
     int frames_per_second_;
@@ -90,8 +90,8 @@ void SceneGraph::updateSceneGraph() {
             for (usize c = 0; c < cameras.size(); ++c) {
                 usize f = frame_to_frame_id.at(cameras[c].scene_node->frame());
                 Mat4& model_matrix = system_model_matrices_per_frame_[f][node];
-                render_operations_per_camera_[c].emplace_back(
-                    detail::RenderOperation{renderable, model_matrix});
+                render_operations_per_camera_[c].emplace_back(detail::RenderOperation{
+                    renderable, model_matrix, node->data.instanceState(c, cameras.size())});
             }
         }
     }
@@ -139,7 +139,7 @@ void SceneGraph::renderSceneFromCamera(float dt, float, u32 camera_id, uint view
     for (auto& op : render_operations_per_camera_[camera_id]) {
         if (op.renderable->material()->mask() & mask) {
             op.renderable->draw(module<Renderer>(), view, camera_transform, op.model,
-                                view_proj_matrix);
+                                view_proj_matrix, *op.instance_state);
         }
     }
 }
@@ -188,12 +188,15 @@ void SceneGraph::renderTree(Node* node, const Mat4& frame_model_matrix,
         if (camera_id == -1) {
             auto& cameras = camera_entity_system_->cameras;
             for (usize c = 0; c < cameras.size(); ++c) {
-                render_operations_per_camera_[c].emplace_back(
-                    detail::RenderOperation{renderable, frame_model_matrix * model_matrix});
+                render_operations_per_camera_[c].emplace_back(detail::RenderOperation{
+                    renderable, frame_model_matrix * model_matrix,
+                    node->data.instanceState(c, cameras.size())});
             }
         } else {
-            render_operations_per_camera_[camera_id].emplace_back(
-                detail::RenderOperation{renderable, frame_model_matrix * model_matrix});
+            render_operations_per_camera_[camera_id].emplace_back(detail::RenderOperation{
+                renderable, frame_model_matrix * model_matrix,
+                node->data.instanceState(static_cast<usize>(camera_id),
+                                         camera_entity_system_->cameras.size())});
         }
     }
 
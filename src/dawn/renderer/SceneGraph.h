@@ -13,6 +13,7 @@ namespace detail {
 struct RenderOperation {
     Renderable* renderable;
     Mat4 model;
+    RenderableInstanceState* instance_state;
 };
 }  // namespace detail
 
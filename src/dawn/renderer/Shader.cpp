@@ -6,29 +6,59 @@
 #include "core/io/InputStream.h"
 #include "renderer/Shader.h"
 #include "renderer/Renderer.h"
-
-#include <dawn-gfx/Shader.h>
+#include "renderer/ShaderCache.h"
 
 namespace dw {
-Shader::Shader(Context* context, gfx::ShaderStage type) : Resource{context}, type_{type} {
+Shader::Shader(Context* context, gfx::ShaderStage type)
+    : Resource{context}, type_{type}, spirv_size_{0} {
 }
 
-Result<void> Shader::beginLoad(const String&, InputStream& src) {
+Result<void> Shader::beginLoad(const String& asset_name, InputStream& src) {
     u32 src_len = static_cast<u32>(src.size());
     assert(src_len != 0);
     std::string src_data;
     src_data.resize(src_len);
     src.readData(src_data.data(), src_len);
 
-    auto result = gfx::compileGLSL(src_data, type_);
+    // Shaders cooked by DwCompileShaders are used directly. GLSL source is compiled through the
+    // shader cache if there is one, which skips compilation if it was compiled by a previous run.
+    auto* data = reinterpret_cast<const byte*>(src_data.data());
+    Result<CompiledShader> result;
+    if (isCookedShader(data, src_data.size())) {
+        result = readCookedShader(data, src_data.size());
+        if (result && result->stage != type_) {
+            return makeError(
+                str::format("Cooked shader {} was compiled for a different stage.", asset_name));
+        }
+    } else if (auto* shader_cache = module<ShaderCache>()) {
+        result = shader_cache->compile(src_data, type_);
+    } else {
+        result = compileShader(src_data, type_);
+    }
     if (!result) {
-        return makeError("Failed to compile shader: " + result.error().compile_error);
+        return makeError(result.error());
     }
-    handle_ = module<Renderer>()->rhi()->createShader(type_, result.value().entry_point,
-                                                      gfx::Memory(result.value().spirv));
+    auto& spirv = result->spirv;
+    entry_point_ = result->entry_point;
+    spirv_size_ = spirv.size() * sizeof(spirv[0]);
+    spirv_ = gfx::Memory(spirv.data(), spirv_size_);
     return {};
 }
 
+Result<void> Shader::endLoad() {
+    auto* renderer = module<Renderer>();
+    LockGuard<RecursiveMutex> lock(renderer->resourceMutex());
+    handle_ = renderer->rhi()->createShader(type_, entry_point_, std::move(spirv_));
+    spirv_ = gfx::Memory();
+    return {};
+}
+
+ResourceFootprint Shader::footprint() const {
+    ResourceFootprint footprint;
+    footprint.gpu_bytes = spirv_size_;
+    return footprint;
+}
+
 gfx::ShaderHandle Shader::internalHandle() const {
     return handle_;
 }
@@ -17,12 +17,19 @@ public:
 
     // Resource.
     Result<void> beginLoad(const String& asset_name, InputStream& src) override;
+    Result<void> endLoad() override;
+    ResourceFootprint footprint() const override;
 
     gfx::ShaderHandle internalHandle() const;
 
 private:
     gfx::ShaderStage type_;
     gfx::ShaderHandle handle_;
+    usize spirv_size_;
+
+    // Compiled shader, held between beginLoad() and endLoad().
+    String entry_point_;
+    gfx::Memory spirv_;
 };
 
 class DW_API VertexShader : public Shader {
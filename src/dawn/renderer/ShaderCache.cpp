@@ -0,0 +1,218 @@
+/*
+ * Dawn Engine
+ * Written by David Avedissian (c) 2012-2019 (git@dga.dev)
+ */
+#include "Base.h"
+#include "core/io/File.h"
+#include "core/io/FileSystem.h"
+#include "core/math/StringHash.h"
+#include "renderer/ShaderCache.h"
+
+#include <dawn-gfx/Shader.h>
+
+#include <atomic>
+
+#if DW_PLATFORM == DW_WIN32
+#include "core/platform/Windows.h"
+#else
+#include <unistd.h>
+#endif
+
+namespace dw {
+namespace {
+const u32 cooked_shader_magic = 0x48535744;  // "DWSH"
+const u32 cooked_shader_version = 1;
+
+// The header is followed by the entry point, padded to a multiple of 4 bytes, then the SPIR-V.
+struct CookedShaderHeader {
+    u32 magic;
+    u32 version;
+    u32 compiler_version;
+    u32 stage;
+    u32 entry_point_size;  // In bytes.
+    u32 spirv_size;        // In 32-bit words.
+};
+static_assert(sizeof(CookedShaderHeader) == 24, "CookedShaderHeader must match the file format.");
+
+usize paddedEntryPointSize(usize size) {
+    return (size + 3) / 4 * 4;
+}
+
+// 64-bit FNV-1a.
+u64 hashBytes(const void* data, usize size, u64 hash) {
+    auto* bytes = static_cast<const byte*>(data);
+    for (usize i = 0; i < size; ++i) {
+        hash = (hash ^ bytes[i]) * prime_64_const;
+    }
+    return hash;
+}
+
+// Returns a temporary path next to an entry which no other writer uses, whether in this process
+// or another process sharing the cache directory.
+Path uniqueTempPath(const Path& path) {
+    static std::atomic<u32> counter{0};
+#if DW_PLATFORM == DW_WIN32
+    auto pid = static_cast<u64>(GetCurrentProcessId());
+#else
+    auto pid = static_cast<u64>(getpid());
+#endif
+    return path + str::format(".{}.{}.tmp", pid, counter++);
+}
+}  // namespace
+
+Result<CompiledShader> compileShader(const String& source, gfx::ShaderStage stage) {
+    auto result = gfx::compileGLSL(source, stage);
+    if (!result) {
+        return makeError("Failed to compile shader: " + result.error().compile_error);
+    }
+    auto& spirv = result.value().spirv;
+    CompiledShader shader;
+    shader.stage = stage;
+    shader.entry_point = result.value().entry_point;
+    shader.spirv.assign(spirv.begin(), spirv.end());
+    return {std::move(shader)};
+}
+
+u64 shaderCacheKey(const String& source, gfx::ShaderStage stage) {
+    u32 prefix[2] = {shader_compiler_version, static_cast<u32>(stage)};
+    u64 hash = hashBytes(prefix, sizeof(prefix), val_64_const);
+    return hashBytes(source.data(), source.size(), hash);
+}
+
+Vector<byte> cookShader(const CompiledShader& shader) {
+    CookedShaderHeader header = {};
+    header.magic = cooked_shader_magic;
+    header.version = cooked_shader_version;
+    header.compiler_version = shader_compiler_version;
+    header.stage = static_cast<u32>(shader.stage);
+    header.entry_point_size = static_cast<u32>(shader.entry_point.size());
+    header.spirv_size = static_cast<u32>(shader.spirv.size());
+
+    usize spirv_offset = sizeof(header) + paddedEntryPointSize(shader.entry_point.size());
+    Vector<byte> out(spirv_offset + shader.spirv.size() * sizeof(u32));
+    memcpy(out.data(), &header, sizeof(header));
+    memcpy(out.data() + sizeof(header), shader.entry_point.data(), shader.entry_point.size());
+    if (!shader.spirv.empty()) {
+        memcpy(out.data() + spirv_offset, shader.spirv.data(), shader.spirv.size() * sizeof(u32));
+    }
+    return out;
+}
+
+bool isCookedShader(const byte* data, usize size) {
+    u32 magic;
+    if (size < sizeof(magic)) {
+        return false;
+    }
+    memcpy(&magic, data, sizeof(magic));
+    return magic == cooked_shader_magic;
+}
+
+Result<CompiledShader> readCookedShader(const byte* data, usize size) {
+    if (size < sizeof(CookedShaderHeader) || !isCookedShader(data, size)) {
+        return makeError("Data is not a cooked shader.");
+    }
+    CookedShaderHeader header;
+    memcpy(&header, data, sizeof(header));
+    if (header.version != cooked_shader_version) {
+        return makeError(str::format("Cooked shader has version {}, expected {}. Re-cook it.",
+                                     header.version, cooked_shader_version));
+    }
+    if (header.compiler_version != shader_compiler_version) {
+        return makeError(str::format(
+            "Cooked shader was compiled by compiler version {}, expected {}. Re-cook it.",
+            header.compiler_version, shader_compiler_version));
+    }
+    usize spirv_offset = sizeof(header) + paddedEntryPointSize(header.entry_point_size);
+    if (header.entry_point_size == 0 || header.spirv_size == 0 || spirv_offset > size ||
+        size - spirv_offset != static_cast<usize>(header.spirv_size) * sizeof(u32)) {
+        return makeError("Cooked shader is corrupt.");
+    }
+
+    CompiledShader shader;
+    shader.stage = static_cast<gfx::ShaderStage>(header.stage);
+    shader.entry_point.assign(reinterpret_cast<const char*>(data + sizeof(header)),
+                              header.entry_point_size);
+    shader.spirv.resize(header.spirv_size);
+    memcpy(shader.spirv.data(), data + spirv_offset, header.spirv_size * sizeof(u32));
+    return {std::move(shader)};
+}
+
+ShaderCache::ShaderCache(Context* context, const Path& cache_dir)
+    : Module(context), cache_dir_(cache_dir) {
+    if (!cache_dir_.empty() && cache_dir_.back() != '/' && cache_dir_.back() != '\\') {
+        cache_dir_ += '/';
+    }
+    if (!module<FileSystem>()->createDirectories(cache_dir_)) {
+        log().warn("Unable to create shader cache directory {}. Shaders won't be cached.",
+                   cache_dir_);
+    }
+}
+
+Result<CompiledShader> ShaderCache::compile(const String& source, gfx::ShaderStage stage) {
+    auto* fs = module<FileSystem>();
+    u64 key = shaderCacheKey(source, stage);
+    Path path = entryPath(key);
+
+    // Entries which can't be read, such as those written by another compiler version, are
+    // replaced.
+    if (fs->fileExists(path)) {
+        Vector<byte> data;
+        {
+            LockGuard<Mutex> lock(mutex_);
+            File file(context());
+            if (file.open(path, FileMode::Read)) {
+                data.resize(file.size());
+                if (!data.empty()) {
+                    data.resize(file.readData(data.data(), data.size()));
+                }
+            }
+        }
+        auto cached = readCookedShader(data.data(), data.size());
+        if (cached && cached->stage == stage) {
+            LockGuard<Mutex> lock(mutex_);
+            stats_.hits++;
+            return cached;
+        }
+        log().warn("Replacing invalid shader cache entry {}.", path);
+    }
+
+    auto shader = compileShader(source, stage);
+    if (!shader) {
+        return shader;
+    }
+    auto cooked = cookShader(*shader);
+    LockGuard<Mutex> lock(mutex_);
+    stats_.misses++;
+
+    // Write the entry to a temporary file, then rename it into place, so that other processes
+    // sharing the cache never read a partially written entry.
+    Path temp_path = uniqueTempPath(path);
+    bool written;
+    {
+        File file(context());
+        if (!file.open(temp_path, FileMode::Write)) {
+            log().warn("Unable to write shader cache entry {}.", path);
+            return shader;
+        }
+        written = file.writeData(cooked.data(), cooked.size()) == cooked.size() && file.close();
+    }
+    if (!written || !fs->rename(temp_path, path)) {
+        log().warn("Unable to write shader cache entry {}.", path);
+        fs->deleteFile(temp_path);
+    }
+    return shader;
+}
+
+const Path& ShaderCache::cacheDir() const {
+    return cache_dir_;
+}
+
+ShaderCacheStats ShaderCache::stats() const {
+    LockGuard<Mutex> lock(mutex_);
+    return stats_;
+}
+
+Path ShaderCache::entryPath(u64 key) const {
+    return cache_dir_ + str::format("{:016x}.dwsh", key);
+}
+}  // namespace dw
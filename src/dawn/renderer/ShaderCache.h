@@ -0,0 +1,75 @@
+/*
+ * Dawn Engine
+ * Written by David Avedissian (c) 2012-2019 (git@dga.dev)
+ */
+#pragma once
+
+#include "core/Concurrency.h"
+#include "core/io/Path.h"
+#include <dawn-gfx/Renderer.h>
+
+namespace dw {
+// Version of the GLSL to SPIR-V compiler, which is part of every shader cache key. Increment this
+// when updating dawn-gfx changes the SPIR-V produced by gfx::compileGLSL(), so that shaders
+// compiled by the previous version are no longer used.
+const u32 shader_compiler_version = 1;
+
+// A shader compiled to SPIR-V.
+struct DW_API CompiledShader {
+    gfx::ShaderStage stage = gfx::ShaderStage::Vertex;
+    String entry_point;
+    Vector<u32> spirv;
+};
+
+// Compiles GLSL source to SPIR-V.
+DW_API Result<CompiledShader> compileShader(const String& source, gfx::ShaderStage stage);
+
+// Returns the key of a shader in the shader cache, which is a hash of its source, stage and the
+// compiler version.
+DW_API u64 shaderCacheKey(const String& source, gfx::ShaderStage stage);
+
+// Cooks a compiled shader into the binary format used by the engine.
+DW_API Vector<byte> cookShader(const CompiledShader& shader);
+
+// Returns true if the data starts with a cooked shader header.
+DW_API bool isCookedShader(const byte* data, usize size);
+
+// Reads a cooked shader. Shaders cooked by a different compiler version are rejected.
+DW_API Result<CompiledShader> readCookedShader(const byte* data, usize size);
+
+struct ShaderCacheStats {
+    u64 hits = 0;    // Shaders which were read from the cache.
+    u64 misses = 0;  // Shaders which were compiled, then written to the cache.
+};
+
+// Caches compiled shaders on disk, so that each shader is only compiled the first time the engine
+// runs, or after its source changes. Each shader is stored as a cooked shader in the cache
+// directory, named after its key.
+//
+// Shipping builds can avoid compiling shaders at all by cooking them ahead of time with
+// DwCompileShaders, as Shader loads cooked shaders directly.
+class DW_API ShaderCache : public Module {
+public:
+    DW_OBJECT(ShaderCache);
+
+    // The cache directory is created if it doesn't exist, along with any missing parents.
+    ShaderCache(Context* context, const Path& cache_dir);
+    ~ShaderCache() override = default;
+
+    // Returns the cached shader with the same source and stage, or compiles it and adds it to the
+    // cache. Safe to call from resource loader threads.
+    Result<CompiledShader> compile(const String& source, gfx::ShaderStage stage);
+
+    const Path& cacheDir() const;
+    ShaderCacheStats stats() const;
+
+private:
+    Path cache_dir_;
+
+    // Serialises writes to the cache directory, and guards stats_.
+    mutable Mutex mutex_;
+    ShaderCacheStats stats_;
+
+    Path entryPath(u64 key) const;
+};
+}  // namespace dw
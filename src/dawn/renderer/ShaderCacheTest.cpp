@@ -0,0 +1,78 @@
+/*
+ * Dawn Engine
+ * Written by David Avedissian (c) 2012-2019 (git@dga.dev)
+ */
+#include "Testing.h"
+#include "core/io/File.h"
+#include "core/io/FileSystem.h"
+#include "renderer/ShaderCache.h"
+
+namespace {
+dw::CompiledShader createShader() {
+    dw::CompiledShader shader;
+    shader.stage = gfx::ShaderStage::Fragment;
+    shader.entry_point = "main";
+    shader.spirv = {0x07230203, 0x00010000, 0x12345678, 0xdeadbeef};
+    return shader;
+}
+}  // namespace
+
+TEST(ShaderCacheTest, CookedShaderRoundTrip) {
+    auto shader = createShader();
+    auto cooked = dw::cookShader(shader);
+    ASSERT_TRUE(dw::isCookedShader(cooked.data(), cooked.size()));
+    auto read = dw::readCookedShader(cooked.data(), cooked.size());
+    ASSERT_TRUE(read);
+    EXPECT_EQ(shader.stage, read->stage);
+    EXPECT_EQ(shader.entry_point, read->entry_point);
+    EXPECT_EQ(shader.spirv, read->spirv);
+
+    // GLSL source isn't mistaken for a cooked shader.
+    const dw::String source = "#version 330 core\nvoid main() {}\n";
+    EXPECT_FALSE(
+        dw::isCookedShader(reinterpret_cast<const dw::byte*>(source.data()), source.size()));
+}
+
+TEST(ShaderCacheTest, CorruptCookedShader) {
+    auto cooked = dw::cookShader(createShader());
+    EXPECT_FALSE(dw::readCookedShader(cooked.data(), cooked.size() - 1));
+    EXPECT_FALSE(dw::readCookedShader(cooked.data(), 8));
+
+    // Change the compiler version.
+    auto other_compiler = cooked;
+    other_compiler[8]++;
+    EXPECT_FALSE(dw::readCookedShader(other_compiler.data(), other_compiler.size()));
+}
+
+TEST(ShaderCacheTest, KeyDependsOnSourceAndStage) {
+    const dw::String source = "void main() {}";
+    auto key = dw::shaderCacheKey(source, gfx::ShaderStage::Vertex);
+    EXPECT_EQ(key, dw::shaderCacheKey(source, gfx::ShaderStage::Vertex));
+    EXPECT_NE(key, dw::shaderCacheKey(source, gfx::ShaderStage::Fragment));
+    EXPECT_NE(key, dw::shaderCacheKey("void main() { }", gfx::ShaderStage::Vertex));
+}
+
+TEST(ShaderCacheTest, UsesCachedShader) {
+    dw::Context context("", "");
+    context.addModule<dw::Logger>();
+    auto* fs = context.addModule<dw::FileSystem>();
+    auto* cache =
+        context.addModule<dw::ShaderCache>(fs->tempDir() + "/dawn-shader-cache-test");
+
+    // Add an entry to the cache, which is returned instead of compiling the (invalid) source.
+    const dw::String source = "not GLSL";
+    auto shader = createShader();
+    auto cooked = dw::cookShader(shader);
+    dw::Path path = cache->cacheDir() +
+                    dw::str::format("{:016x}.dwsh", dw::shaderCacheKey(source, shader.stage));
+    {
+        dw::File file(&context, path, dw::FileMode::Write);
+        file.writeData(cooked.data(), cooked.size());
+    }
+    auto result = cache->compile(source, shader.stage);
+    fs->deleteFile(path);
+    ASSERT_TRUE(result);
+    EXPECT_EQ(shader.spirv, result->spirv);
+    EXPECT_EQ(1u, cache->stats().hits);
+    EXPECT_EQ(0u, cache->stats().misses);
+}
@@ -3,70 +3,198 @@
  * Written by David Avedissian (c) 2012-2019 (git@dga.dev)
  */
 #include "Base.h"
-#include "renderer/StbImage.h"
+#include "core/io/MemoryInputStream.h"
 #include "renderer/Texture.h"
 #include "renderer/Renderer.h"
+#include "renderer/TextureStreamer.h"
+
+#include <limits>
 
 namespace dw {
 
 // Internal.
 namespace {
-int imageCallbackRead(void* user, char* data, int size) {
-    InputStream& stream = *reinterpret_cast<InputStream*>(user);
-    // If we want to read past the end of the buffer, clamp the size to prevent an error occurring,
-    // as the stream API will read either the entire block or nothing at all.
-    if ((stream.position() + size) > stream.size()) {
-        size = static_cast<int>(stream.size() - stream.position());
+gfx::TextureFormat gfxTextureFormat(TextureDataFormat format) {
+    switch (format) {
+        case TextureDataFormat::BC1:
+            return gfx::TextureFormat::BC1;
+        case TextureDataFormat::BC3:
+            return gfx::TextureFormat::BC3;
+        case TextureDataFormat::BC7:
+            return gfx::TextureFormat::BC7;
+        default:
+            return gfx::TextureFormat::RGBA8;
     }
-    return static_cast<int>(stream.readData(data, static_cast<u32>(size)));
-}
-
-void imageCallbackSkip(void* user, int n) {
-    InputStream& stream = *reinterpret_cast<InputStream*>(user);
-    stream.seek(stream.position() + n);
-}
-
-int imageCallbackEof(void* user) {
-    InputStream& stream = *reinterpret_cast<InputStream*>(user);
-    return stream.eof() ? 1 : 0;
 }
 }  // namespace
 
-Texture::Texture(Context* ctx) : Resource(ctx) {
+Texture::Texture(Context* ctx)
+    : Resource(ctx),
+      format_(TextureDataFormat::RGBA8),
+      resident_mip_(0),
+      requested_screen_size_(0),
+      stream_id_(0) {
 }
 
 Texture::~Texture() {
+    if (stream_id_ != 0) {
+        auto* streamer = module<TextureStreamer>();
+        if (streamer) {
+            streamer->removeTexture(*this);
+        }
+    }
     if (handle_.isValid()) {
-        module<Renderer>()->rhi()->deleteTexture(handle_);
+        auto* renderer = module<Renderer>();
+        LockGuard<RecursiveMutex> lock(renderer->resourceMutex());
+        renderer->rhi()->deleteTexture(handle_);
     }
 }
 
 SharedPtr<Texture> Texture::createTexture2D(Context* ctx, const Vec2i& size,
                                             gfx::TextureFormat format, gfx::Memory data) {
     auto texture = makeShared<Texture>(ctx);
-    texture->handle_ =
-        ctx->module<Renderer>()->rhi()->createTexture2D(size.x, size.y, format, std::move(data));
+    auto* renderer = ctx->module<Renderer>();
+    LockGuard<RecursiveMutex> lock(renderer->resourceMutex());
+    texture->handle_ = renderer->rhi()->createTexture2D(size.x, size.y, format, std::move(data));
     return texture;
 }
 
-Result<void> Texture::beginLoad(const String&, InputStream& src) {
-    stbi_io_callbacks callbacks = {
-        &imageCallbackRead,
-        &imageCallbackSkip,
-        &imageCallbackEof,
-    };
-    int width, height, bpp;
-    byte* buffer = stbi_load_from_callbacks(&callbacks, reinterpret_cast<void*>(&src), &width,
-                                            &height, &bpp, 4);
-    gfx::Memory data(buffer, static_cast<usize>(width * height * 4),
-                     [](byte* buffer) { stbi_image_free(buffer); });
-    handle_ = module<Renderer>()->rhi()->createTexture2D(
-        static_cast<u16>(width), static_cast<u16>(height), gfx::TextureFormat::RGBA8,
-        std::move(data));
+Result<void> Texture::beginLoad(const String& asset_name, InputStream& src) {
+    // Cooked textures are uploaded straight from the stream when it's already in memory, such as
+    // when it's mapped from a resource package. Otherwise, the stream is read into memory first.
+    Vector<byte> buffer;
+    const byte* data;
+    usize size;
+    auto* memory_stream = dynamic_cast<MemoryInputStream*>(&src);
+    if (memory_stream) {
+        data = memory_stream->data() + memory_stream->position();
+        size = memory_stream->size() - memory_stream->position();
+    } else {
+        auto read_result = src.readAll();
+        if (!read_result) {
+            return makeError(str::format("Unable to read texture {}. Reason: {}", asset_name,
+                                         read_result.error()));
+        }
+        buffer = std::move(*read_result);
+        data = buffer.data();
+        size = buffer.size();
+    }
+
+    // Cooked textures are already block compressed, so their blocks are uploaded as is. Anything
+    // else is decoded by stb_image into RGBA8.
+    if (isCookedTexture(data, size)) {
+        auto texture = readCookedTexture(data, size);
+        if (!texture) {
+            return makeError(
+                str::format("Unable to load texture {}. Reason: {}", asset_name, texture.error()));
+        }
+        format_ = texture->format;
+        size_ = Vec2i{static_cast<int>(texture->width), static_cast<int>(texture->height)};
+
+        // Textures are created with a single level. Streamed textures start with the least
+        // detailed level which is at least the streamer's initial size, and record where each
+        // level is so that the streamer can read them later. Otherwise, the most detailed level
+        // is uploaded.
+        usize mip = 0;
+        auto* streamer = module<TextureStreamer>();
+        if (streamer) {
+            mip = selectTextureMip(texture->width, texture->height, texture->mips.size(),
+                                   static_cast<float>(streamer->initialSize()));
+        }
+        if (mip > 0) {
+            asset_name_ = asset_name;
+            for (auto& level : texture->mips) {
+                mips_.emplace_back(StreamedMip{level.width, level.height,
+                                               static_cast<u64>(level.data - data), level.size});
+            }
+            resident_mip_ = mip;
+        }
+        decoded_data_ = gfx::Memory(texture->mips[mip].data, texture->mips[mip].size);
+    } else {
+        auto image = decodeImage(data, size);
+        if (!image) {
+            return makeError(image.error());
+        }
+        format_ = TextureDataFormat::RGBA8;
+        size_ = Vec2i{static_cast<int>(image->width), static_cast<int>(image->height)};
+        decoded_data_ = gfx::Memory(image->mips[0].data(), image->mips[0].size());
+    }
+    if (size_.x > std::numeric_limits<u16>::max() || size_.y > std::numeric_limits<u16>::max()) {
+        return makeError(str::format("Unable to load texture {}. {}x{} is too large.", asset_name,
+                                     size_.x, size_.y));
+    }
+    return Result<void>();
+}
+
+Result<void> Texture::endLoad() {
+    auto* renderer = module<Renderer>();
+    {
+        LockGuard<RecursiveMutex> lock(renderer->resourceMutex());
+        auto size = residentSize();
+        handle_ = renderer->rhi()->createTexture2D(
+            static_cast<u16>(size.x), static_cast<u16>(size.y), gfxTextureFormat(format_),
+            std::move(decoded_data_));
+        decoded_data_ = gfx::Memory();
+    }
+    if (isStreamed()) {
+        auto* streamer = module<TextureStreamer>();
+        if (streamer) {
+            streamer->addTexture(*this);
+        }
+    }
     return Result<void>();
 }
 
+ResourceFootprint Texture::footprint() const {
+    ResourceFootprint footprint;
+    auto size = residentSize();
+    footprint.gpu_bytes =
+        textureMipSize(format_, static_cast<u32>(size.x), static_cast<u32>(size.y));
+    return footprint;
+}
+
 gfx::TextureHandle Texture::internalHandle() const {
     return handle_;
 }
+
+void Texture::requestScreenSize(float screen_pixels) {
+    const auto max_size = static_cast<float>(std::numeric_limits<u16>::max());
+    auto size = static_cast<u32>(std::min(std::max(screen_pixels, 0.0f), max_size));
+    u32 current = requested_screen_size_.load(std::memory_order_relaxed);
+    while (size > current && !requested_screen_size_.compare_exchange_weak(
+                                 current, size, std::memory_order_relaxed)) {
+    }
+}
+
+bool Texture::isStreamed() const {
+    return !mips_.empty();
+}
+
+usize Texture::residentMip() const {
+    return resident_mip_;
+}
+
+usize Texture::mipCount() const {
+    return isStreamed() ? mips_.size() : 1;
+}
+
+Vec2i Texture::residentSize() const {
+    if (!isStreamed()) {
+        return size_;
+    }
+    auto& mip = mips_[resident_mip_];
+    return Vec2i{static_cast<int>(mip.width), static_cast<int>(mip.height)};
+}
+
+void Texture::replaceResidentMip(usize mip, gfx::Memory data) {
+    auto* renderer = module<Renderer>();
+    LockGuard<RecursiveMutex> lock(renderer->resourceMutex());
+    auto* rhi = renderer->rhi();
+    auto handle = rhi->createTexture2D(static_cast<u16>(mips_[mip].width),
+                                       static_cast<u16>(mips_[mip].height),
+                                       gfxTextureFormat(format_), std::move(data));
+    rhi->deleteTexture(handle_);
+    handle_ = handle;
+    resident_mip_ = mip;
+}
 }  // namespace dw
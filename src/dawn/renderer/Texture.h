@@ -5,9 +5,15 @@
 #pragma once
 
 #include "resource/Resource.h"
+#include "renderer/TextureData.h"
 #include <dawn-gfx/Renderer.h>
 
 namespace dw {
+class TextureStreamer;
+
+// Cooked textures with more than one mip level are streamed if the TextureStreamer module exists.
+// They start with a low detail level resident, and the streamer replaces it with the level which
+// matches the size they're drawn at on screen, within its memory budget.
 class DW_API Texture : public Resource {
 public:
     DW_OBJECT(Texture);
@@ -20,10 +26,50 @@ public:
 
     // Resource.
     Result<void> beginLoad(const String& asset_name, InputStream& src) override;
+    Result<void> endLoad() override;
+    ResourceFootprint footprint() const override;
 
     gfx::TextureHandle internalHandle() const;
 
+    // Records that the texture is being drawn this frame, covering up to screen_pixels pixels
+    // along its largest side. Renderables call this each time they draw.
+    void requestScreenSize(float screen_pixels);
+
+    // Returns true if the texture's resident mip level is managed by the TextureStreamer.
+    bool isStreamed() const;
+
+    // Mip level currently resident on the GPU, where 0 is the most detailed level.
+    usize residentMip() const;
+    usize mipCount() const;
+
 private:
+    friend class TextureStreamer;
+
+    // Location of a mip level within the cooked texture.
+    struct StreamedMip {
+        u32 width;
+        u32 height;
+        u64 offset;
+        u64 size;
+    };
+
     gfx::TextureHandle handle_;
+    Vec2i size_;
+    TextureDataFormat format_;
+
+    // Streaming state. mips_ is empty if the texture isn't streamed.
+    String asset_name_;
+    Vector<StreamedMip> mips_;
+    usize resident_mip_;
+    Atomic<u32> requested_screen_size_;  // Largest size requested since the streamer last updated.
+    u64 stream_id_;
+
+    Vec2i residentSize() const;
+
+    // Replaces the resident mip level with a new one. Only called by the TextureStreamer.
+    void replaceResidentMip(usize mip, gfx::Memory data);
+
+    // Decoded image or compressed blocks, held between beginLoad() and endLoad().
+    gfx::Memory decoded_data_;
 };
 }  // namespace dw
@@ -0,0 +1,466 @@
+/*
+ * Dawn Engine
+ * Written by David Avedissian (c) 2012-2019 (git@dga.dev)
+ */
+#include "Base.h"
+#include "renderer/TextureCompression.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace dw {
+namespace {
+const usize block_pixels = 16;
+
+// Interpolation weights of BC7 4 bit indices, out of 64.
+const u32 bc7_weights[16] = {0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64};
+
+// Fits a line through the first channels of a block's pixels along their principal axis, found
+// by power iteration on their covariance matrix. The endpoints are the extremes of the pixels
+// projected onto the line.
+void fitLine(const byte* pixels, int channels, float* start, float* end) {
+    float mean[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+    for (usize i = 0; i < block_pixels; ++i) {
+        for (int c = 0; c < channels; ++c) {
+            mean[c] += pixels[i * 4 + c];
+        }
+    }
+    for (int c = 0; c < channels; ++c) {
+        mean[c] /= static_cast<float>(block_pixels);
+    }
+    float covariance[4][4] = {};
+    for (usize i = 0; i < block_pixels; ++i) {
+        for (int a = 0; a < channels; ++a) {
+            for (int b = 0; b < channels; ++b) {
+                covariance[a][b] += (pixels[i * 4 + a] - mean[a]) * (pixels[i * 4 + b] - mean[b]);
+            }
+        }
+    }
+    float axis[4] = {1.0f, 1.0f, 1.0f, 1.0f};
+    for (int iteration = 0; iteration < 8; ++iteration) {
+        float next[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+        float length_squared = 0.0f;
+        for (int a = 0; a < channels; ++a) {
+            for (int b = 0; b < channels; ++b) {
+                next[a] += covariance[a][b] * axis[b];
+            }
+            length_squared += next[a] * next[a];
+        }
+        if (length_squared < 1e-12f) {
+            // Every pixel is the same, or they vary perpendicular to the starting axis.
+            break;
+        }
+        float length = std::sqrt(length_squared);
+        for (int c = 0; c < channels; ++c) {
+            axis[c] = next[c] / length;
+        }
+    }
+    float min_t = std::numeric_limits<float>::max(), max_t = std::numeric_limits<float>::lowest();
+    for (usize i = 0; i < block_pixels; ++i) {
+        float t = 0.0f;
+        for (int c = 0; c < channels; ++c) {
+            t += (pixels[i * 4 + c] - mean[c]) * axis[c];
+        }
+        min_t = std::min(min_t, t);
+        max_t = std::max(max_t, t);
+    }
+    for (int c = 0; c < channels; ++c) {
+        start[c] = std::min(std::max(mean[c] + axis[c] * min_t, 0.0f), 255.0f);
+        end[c] = std::min(std::max(mean[c] + axis[c] * max_t, 0.0f), 255.0f);
+    }
+}
+
+// Returns the index of the palette entry closest to a pixel, comparing the first channels.
+u32 nearestEntry(const byte* pixel, const byte (*palette)[4], u32 palette_size, int channels,
+                 u32& error) {
+    u32 best = 0;
+    error = std::numeric_limits<u32>::max();
+    for (u32 i = 0; i < palette_size; ++i) {
+        u32 distance = 0;
+        for (int c = 0; c < channels; ++c) {
+            int d = static_cast<int>(pixel[c]) - static_cast<int>(palette[i][c]);
+            distance += static_cast<u32>(d * d);
+        }
+        if (distance < error) {
+            error = distance;
+            best = i;
+        }
+    }
+    return best;
+}
+
+u16 packRgb565(const float* rgb) {
+    auto quantise = [](float value, float max) {
+        return static_cast<u16>(std::lround(value / 255.0f * max));
+    };
+    return static_cast<u16>(quantise(rgb[0], 31.0f) << 11 | quantise(rgb[1], 63.0f) << 5 |
+                            quantise(rgb[2], 31.0f));
+}
+
+void unpackRgb565(u16 colour, byte* rgb) {
+    u32 r = colour >> 11, g = (colour >> 5) & 0x3f, b = colour & 0x1f;
+    rgb[0] = static_cast<byte>(r << 3 | r >> 2);
+    rgb[1] = static_cast<byte>(g << 2 | g >> 4);
+    rgb[2] = static_cast<byte>(b << 3 | b >> 2);
+}
+
+// Builds the palette of a BC1 colour block. In BC1, endpoints with c0 <= c1 select a 3 colour
+// palette with transparent black. BC3 colour blocks always use the 4 colour palette.
+void colourPalette(u16 c0, u16 c1, bool four_colour, byte (*palette)[4]) {
+    unpackRgb565(c0, palette[0]);
+    unpackRgb565(c1, palette[1]);
+    for (int c = 0; c < 3; ++c) {
+        if (four_colour) {
+            palette[2][c] = static_cast<byte>((2 * palette[0][c] + palette[1][c]) / 3);
+            palette[3][c] = static_cast<byte>((palette[0][c] + 2 * palette[1][c]) / 3);
+        } else {
+            palette[2][c] = static_cast<byte>((palette[0][c] + palette[1][c]) / 2);
+            palette[3][c] = 0;
+        }
+    }
+    palette[0][3] = palette[1][3] = palette[2][3] = 255;
+    palette[3][3] = four_colour ? 255 : 0;
+}
+
+void encodeColourBlock(const byte* pixels, byte* block) {
+    float start[3], end[3];
+    fitLine(pixels, 3, start, end);
+    u16 c0 = packRgb565(end), c1 = packRgb565(start);
+    if (c0 < c1) {
+        std::swap(c0, c1);
+    }
+
+    // c0 > c1 selects the 4 colour palette. If the endpoints are equal, every pixel uses c0.
+    byte palette[4][4];
+    colourPalette(c0, c1, true, palette);
+    u32 indices = 0;
+    if (c0 != c1) {
+        for (usize i = 0; i < block_pixels; ++i) {
+            u32 error;
+            indices |= nearestEntry(&pixels[i * 4], palette, 4, 3, error) << (i * 2);
+        }
+    }
+    block[0] = static_cast<byte>(c0 & 0xff);
+    block[1] = static_cast<byte>(c0 >> 8);
+    block[2] = static_cast<byte>(c1 & 0xff);
+    block[3] = static_cast<byte>(c1 >> 8);
+    for (int i = 0; i < 4; ++i) {
+        block[4 + i] = static_cast<byte>(indices >> (i * 8));
+    }
+}
+
+void decodeColourBlock(const byte* block, bool always_four_colour, byte* pixels) {
+    u16 c0 = static_cast<u16>(block[0] | block[1] << 8);
+    u16 c1 = static_cast<u16>(block[2] | block[3] << 8);
+    byte palette[4][4];
+    colourPalette(c0, c1, always_four_colour || c0 > c1, palette);
+    for (usize i = 0; i < block_pixels; ++i) {
+        u32 index = (block[4 + i / 4] >> ((i % 4) * 2)) & 0x3;
+        memcpy(&pixels[i * 4], palette[index], 4);
+    }
+}
+
+// Builds the palette of a BC3 alpha block. a0 > a1 selects 8 interpolated values, otherwise 6
+// interpolated values plus 0 and 255.
+void alphaPalette(byte a0, byte a1, byte* palette) {
+    palette[0] = a0;
+    palette[1] = a1;
+    if (a0 > a1) {
+        for (u32 i = 1; i < 7; ++i) {
+            palette[i + 1] = static_cast<byte>(((7 - i) * a0 + i * a1) / 7);
+        }
+    } else {
+        for (u32 i = 1; i < 5; ++i) {
+            palette[i + 1] = static_cast<byte>(((5 - i) * a0 + i * a1) / 5);
+        }
+        palette[6] = 0;
+        palette[7] = 255;
+    }
+}
+
+void encodeAlphaBlock(const byte* pixels, byte* block) {
+    byte a0 = 0, a1 = 255;
+    for (usize i = 0; i < block_pixels; ++i) {
+        a0 = std::max(a0, pixels[i * 4 + 3]);
+        a1 = std::min(a1, pixels[i * 4 + 3]);
+    }
+    byte palette[8];
+    alphaPalette(a0, a1, palette);
+    u64 indices = 0;
+    if (a0 != a1) {
+        for (usize i = 0; i < block_pixels; ++i) {
+            u64 best = 0;
+            int best_error = 256;
+            for (u64 p = 0; p < 8; ++p) {
+                int error = std::abs(static_cast<int>(pixels[i * 4 + 3]) - palette[p]);
+                if (error < best_error) {
+                    best_error = error;
+                    best = p;
+                }
+            }
+            indices |= best << (i * 3);
+        }
+    }
+    block[0] = a0;
+    block[1] = a1;
+    for (int i = 0; i < 6; ++i) {
+        block[2 + i] = static_cast<byte>(indices >> (i * 8));
+    }
+}
+
+void decodeAlphaBlock(const byte* block, byte* pixels) {
+    byte palette[8];
+    alphaPalette(block[0], block[1], palette);
+    u64 indices = 0;
+    for (int i = 0; i < 6; ++i) {
+        indices |= static_cast<u64>(block[2 + i]) << (i * 8);
+    }
+    for (usize i = 0; i < block_pixels; ++i) {
+        pixels[i * 4 + 3] = palette[(indices >> (i * 3)) & 0x7];
+    }
+}
+
+// Reads and writes BC7 blocks, which are packed least significant bit first.
+class BlockBits {
+public:
+    explicit BlockBits(byte* block) : block_(block), position_(0) {
+    }
+
+    void write(u32 value, u32 bits) {
+        for (u32 i = 0; i < bits; ++i, ++position_) {
+            if ((value >> i) & 1) {
+                block_[position_ / 8] |= static_cast<byte>(1 << (position_ % 8));
+            }
+        }
+    }
+
+    u32 read(u32 bits) {
+        u32 value = 0;
+        for (u32 i = 0; i < bits; ++i, ++position_) {
+            value |= static_cast<u32>((block_[position_ / 8] >> (position_ % 8)) & 1) << i;
+        }
+        return value;
+    }
+
+private:
+    byte* block_;
+    u32 position_;
+};
+
+void bc7Palette(const byte* e0, const byte* e1, byte (*palette)[4]) {
+    for (u32 i = 0; i < 16; ++i) {
+        for (int c = 0; c < 4; ++c) {
+            u32 value = (64 - bc7_weights[i]) * e0[c] + bc7_weights[i] * e1[c];
+            palette[i][c] = static_cast<byte>((value + 32) >> 6);
+        }
+    }
+}
+
+// Calls a function with the position and index of each 4x4 block of a level.
+template <typename BlockFunction>
+void forEachBlock(u32 width, u32 height, BlockFunction function) {
+    u32 blocks_x = (width + 3) / 4, blocks_y = (height + 3) / 4;
+    for (u32 by = 0; by < blocks_y; ++by) {
+        for (u32 bx = 0; bx < blocks_x; ++bx) {
+            function(bx, by, static_cast<usize>(by) * blocks_x + bx);
+        }
+    }
+}
+}  // namespace
+
+void encodeBlockBC1(const byte* pixels, byte* block) {
+    encodeColourBlock(pixels, block);
+}
+
+void encodeBlockBC3(const byte* pixels, byte* block) {
+    encodeAlphaBlock(pixels, block);
+    encodeColourBlock(pixels, block + 8);
+}
+
+void encodeBlockBC7(const byte* pixels, byte* block) {
+    float start[4], end[4];
+    fitLine(pixels, 4, start, end);
+
+    // Each endpoint is 7 bits per channel plus a shared low bit (the p-bit). Try each combination
+    // of p-bits, and keep the one with the least error.
+    byte best_q[2][4] = {};
+    u32 best_p[2] = {0, 0};
+    u32 best_indices[block_pixels] = {};
+    u32 best_error = std::numeric_limits<u32>::max();
+    for (u32 p = 0; p < 4; ++p) {
+        u32 p0 = p & 1, p1 = p >> 1;
+        byte q[2][4], e[2][4];
+        for (int c = 0; c < 4; ++c) {
+            auto quantise = [](float value, u32 p_bit) {
+                long q = std::lround((value - static_cast<float>(p_bit)) / 2.0f);
+                return static_cast<byte>(std::min(std::max(q, 0l), 127l));
+            };
+            q[0][c] = quantise(start[c], p0);
+            q[1][c] = quantise(end[c], p1);
+            e[0][c] = static_cast<byte>(q[0][c] << 1 | p0);
+            e[1][c] = static_cast<byte>(q[1][c] << 1 | p1);
+        }
+        byte palette[16][4];
+        bc7Palette(e[0], e[1], palette);
+        u32 indices[block_pixels];
+        u32 error = 0;
+        for (usize i = 0; i < block_pixels; ++i) {
+            u32 pixel_error;
+            indices[i] = nearestEntry(&pixels[i * 4], palette, 16, 4, pixel_error);
+            error += pixel_error;
+        }
+        if (error < best_error) {
+            best_error = error;
+            memcpy(best_q, q, sizeof(q));
+            best_p[0] = p0;
+            best_p[1] = p1;
+            memcpy(best_indices, indices, sizeof(indices));
+        }
+    }
+
+    // The first index is stored without its top bit, so it must be less than 8. If it isn't,
+    // swap the endpoints, which reverses the palette.
+    if (best_indices[0] >= 8) {
+        std::swap(best_q[0], best_q[1]);
+        std::swap(best_p[0], best_p[1]);
+        for (auto& index : best_indices) {
+            index = 15 - index;
+        }
+    }
+
+    memset(block, 0, 16);
+    BlockBits bits(block);
+    bits.write(1 << 6, 7);
+    for (int c = 0; c < 4; ++c) {
+        bits.write(best_q[0][c], 7);
+        bits.write(best_q[1][c], 7);
+    }
+    bits.write(best_p[0], 1);
+    bits.write(best_p[1], 1);
+    for (usize i = 0; i < block_pixels; ++i) {
+        bits.write(best_indices[i], i == 0 ? 3 : 4);
+    }
+}
+
+void decodeBlockBC1(const byte* block, byte* pixels) {
+    decodeColourBlock(block, false, pixels);
+}
+
+void decodeBlockBC3(const byte* block, byte* pixels) {
+    decodeColourBlock(block + 8, true, pixels);
+    decodeAlphaBlock(block, pixels);
+}
+
+bool decodeBlockBC7(const byte* block, byte* pixels) {
+    // The mode is the position of the lowest set bit.
+    if ((block[0] & 0x7f) != 0x40) {
+        memset(pixels, 0, block_pixels * 4);
+        return false;
+    }
+    byte copy[16];
+    memcpy(copy, block, sizeof(copy));
+    BlockBits bits(copy);
+    bits.read(7);
+    byte e[2][4];
+    for (int c = 0; c < 4; ++c) {
+        e[0][c] = static_cast<byte>(bits.read(7) << 1);
+        e[1][c] = static_cast<byte>(bits.read(7) << 1);
+    }
+    u32 p0 = bits.read(1), p1 = bits.read(1);
+    for (int c = 0; c < 4; ++c) {
+        e[0][c] = static_cast<byte>(e[0][c] | p0);
+        e[1][c] = static_cast<byte>(e[1][c] | p1);
+    }
+    byte palette[16][4];
+    bc7Palette(e[0], e[1], palette);
+    for (usize i = 0; i < block_pixels; ++i) {
+        memcpy(&pixels[i * 4], palette[bits.read(i == 0 ? 3 : 4)], 4);
+    }
+    return true;
+}
+
+Result<TextureData> compressTexture(const TextureData& texture, TextureDataFormat format) {
+    if (texture.format != TextureDataFormat::RGBA8) {
+        return makeError("Only RGBA8 textures can be compressed.");
+    }
+    TextureData compressed;
+    compressed.format = format;
+    compressed.width = texture.width;
+    compressed.height = texture.height;
+    if (format == TextureDataFormat::RGBA8) {
+        compressed.mips = texture.mips;
+        return {std::move(compressed)};
+    }
+    usize block_size = textureMipSize(format, 4, 4);
+    auto view = viewTextureData(texture);
+    for (auto& mip : view.mips) {
+        Vector<byte> out(textureMipSize(format, mip.width, mip.height));
+        forEachBlock(mip.width, mip.height, [&](u32 bx, u32 by, usize block_index) {
+            byte pixels[block_pixels * 4];
+            for (u32 y = 0; y < 4; ++y) {
+                for (u32 x = 0; x < 4; ++x) {
+                    u32 src_x = std::min(bx * 4 + x, mip.width - 1);
+                    u32 src_y = std::min(by * 4 + y, mip.height - 1);
+                    memcpy(&pixels[(y * 4 + x) * 4], &mip.data[(src_y * mip.width + src_x) * 4], 4);
+                }
+            }
+            byte* block = &out[block_index * block_size];
+            switch (format) {
+                case TextureDataFormat::BC1:
+                    encodeBlockBC1(pixels, block);
+                    break;
+                case TextureDataFormat::BC3:
+                    encodeBlockBC3(pixels, block);
+                    break;
+                default:
+                    encodeBlockBC7(pixels, block);
+                    break;
+            }
+        });
+        compressed.mips.emplace_back(std::move(out));
+    }
+    return {std::move(compressed)};
+}
+
+Result<TextureData> decompressTexture(const TextureDataView& texture) {
+    TextureData decompressed;
+    decompressed.width = texture.width;
+    decompressed.height = texture.height;
+    usize block_size = textureMipSize(texture.format, 4, 4);
+    for (auto& mip : texture.mips) {
+        if (texture.format == TextureDataFormat::RGBA8) {
+            decompressed.mips.emplace_back(mip.data, mip.data + mip.size);
+            continue;
+        }
+        Vector<byte> out(textureMipSize(TextureDataFormat::RGBA8, mip.width, mip.height));
+        bool supported = true;
+        forEachBlock(mip.width, mip.height, [&](u32 bx, u32 by, usize block_index) {
+            byte pixels[block_pixels * 4];
+            const byte* block = &mip.data[block_index * block_size];
+            switch (texture.format) {
+                case TextureDataFormat::BC1:
+                    decodeBlockBC1(block, pixels);
+                    break;
+                case TextureDataFormat::BC3:
+                    decodeBlockBC3(block, pixels);
+                    break;
+                default:
+                    supported = decodeBlockBC7(block, pixels) && supported;
+                    break;
+            }
+            for (u32 y = 0; y < 4 && by * 4 + y < mip.height; ++y) {
+                for (u32 x = 0; x < 4 && bx * 4 + x < mip.width; ++x) {
+                    memcpy(&out[((by * 4 + y) * mip.width + bx * 4 + x) * 4],
+                           &pixels[(y * 4 + x) * 4], 4);
+                }
+            }
+        });
+        if (!supported) {
+            return makeError("Texture contains BC7 blocks in a mode other than 6.");
+        }
+        decompressed.mips.emplace_back(std::move(out));
+    }
+    return {std::move(decompressed)};
+}
+}  // namespace dw
@@ -0,0 +1,26 @@
+/*
+ * Dawn Engine
+ * Written by David Avedissian (c) 2012-2019 (git@dga.dev)
+ */
+#pragma once
+
+#include "renderer/TextureData.h"
+
+namespace dw {
+// Encodes and decodes single 4x4 blocks. Pixels are RGBA8, in rows. BC1 blocks are 8 bytes and
+// are always opaque. BC3 and BC7 blocks are 16 bytes. The BC7 encoder only emits mode 6 (a
+// single RGBA line with 4 bit indices), so the decoder only supports that mode, and returns
+// false for any other.
+DW_API void encodeBlockBC1(const byte* pixels, byte* block);
+DW_API void encodeBlockBC3(const byte* pixels, byte* block);
+DW_API void encodeBlockBC7(const byte* pixels, byte* block);
+DW_API void decodeBlockBC1(const byte* block, byte* pixels);
+DW_API void decodeBlockBC3(const byte* block, byte* pixels);
+DW_API bool decodeBlockBC7(const byte* block, byte* pixels);
+
+// Compresses every mip level of RGBA8 texture data into a block compressed format.
+DW_API Result<TextureData> compressTexture(const TextureData& texture, TextureDataFormat format);
+
+// Decompresses every mip level of texture data back into RGBA8.
+DW_API Result<TextureData> decompressTexture(const TextureDataView& texture);
+}  // namespace dw
@@ -0,0 +1,134 @@
+/*
+ * Dawn Engine
+ * Written by David Avedissian (c) 2012-2019 (git@dga.dev)
+ */
+#include "Testing.h"
+#include "renderer/TextureCompression.h"
+
+#include <cstdlib>
+
+namespace {
+// A width x height RGBA8 texture with a smooth diagonal gradient. Every channel depends on the
+// same value, so the colours of each block lie on a line, which block compression represents well.
+dw::TextureData createGradient(dw::u32 width, dw::u32 height) {
+    dw::TextureData texture;
+    texture.width = width;
+    texture.height = height;
+    dw::Vector<dw::byte> pixels;
+    for (dw::u32 y = 0; y < height; ++y) {
+        for (dw::u32 x = 0; x < width; ++x) {
+            dw::u32 t = (x + y) * 255 / (width + height - 2);
+            pixels.push_back(static_cast<dw::byte>(t));
+            pixels.push_back(static_cast<dw::byte>(t / 2));
+            pixels.push_back(static_cast<dw::byte>(128));
+            pixels.push_back(static_cast<dw::byte>(255 - t));
+        }
+    }
+    texture.mips.push_back(pixels);
+    return texture;
+}
+
+// Returns the largest difference of any channel, comparing the first channels of each pixel.
+int maxError(const dw::Vector<dw::byte>& a, const dw::Vector<dw::byte>& b, int channels) {
+    int max_error = 0;
+    for (dw::usize i = 0; i < a.size(); ++i) {
+        if (static_cast<int>(i % 4) < channels) {
+            max_error = std::max(max_error, std::abs(static_cast<int>(a[i]) - b[i]));
+        }
+    }
+    return max_error;
+}
+
+dw::Vector<dw::byte> roundTrip(const dw::TextureData& texture, dw::TextureDataFormat format) {
+    auto compressed = dw::compressTexture(texture, format);
+    EXPECT_TRUE(compressed);
+    EXPECT_EQ(dw::textureMipSize(format, texture.width, texture.height),
+              compressed->mips[0].size());
+    auto decompressed = dw::decompressTexture(dw::viewTextureData(*compressed));
+    EXPECT_TRUE(decompressed);
+    return decompressed->mips[0];
+}
+}  // namespace
+
+TEST(TextureCompressionTest, DecodeBC1) {
+    // c0 = pure red, c1 = pure blue, in 4 colour mode. The indices select c0, c1, 2/3 c0 + 1/3 c1
+    // and 1/3 c0 + 2/3 c1 in every row.
+    const dw::byte block[8] = {0x00, 0xf8, 0x1f, 0x00, 0xe4, 0xe4, 0xe4, 0xe4};
+    dw::byte pixels[64];
+    dw::decodeBlockBC1(block, pixels);
+    const dw::byte expected[4][4] = {{255, 0, 0, 255}, {0, 0, 255, 255}, {170, 0, 85, 255},
+                                     {85, 0, 170, 255}};
+    for (int i = 0; i < 16; ++i) {
+        for (int c = 0; c < 4; ++c) {
+            EXPECT_EQ(expected[i % 4][c], pixels[i * 4 + c]) << "pixel " << i << " channel " << c;
+        }
+    }
+
+    // With c0 <= c1, the last index is transparent black.
+    const dw::byte three_colour_block[8] = {0x1f, 0x00, 0x00, 0xf8, 0xff, 0xff, 0xff, 0xff};
+    dw::decodeBlockBC1(three_colour_block, pixels);
+    EXPECT_EQ(0, pixels[0]);
+    EXPECT_EQ(0, pixels[3]);
+}
+
+TEST(TextureCompressionTest, SolidColoursAreExact) {
+    // Colours which can be represented exactly by each format.
+    dw::byte pixels[64];
+    for (int i = 0; i < 16; ++i) {
+        pixels[i * 4 + 0] = 255;
+        pixels[i * 4 + 1] = 130;
+        pixels[i * 4 + 2] = 0;
+        pixels[i * 4 + 3] = 255;
+    }
+    dw::byte block[16], decoded[64];
+    dw::encodeBlockBC1(pixels, block);
+    dw::decodeBlockBC1(block, decoded);
+    EXPECT_EQ(0, memcmp(pixels, decoded, sizeof(pixels)));
+
+    for (int i = 0; i < 16; ++i) {
+        pixels[i * 4 + 3] = 77;
+    }
+    dw::encodeBlockBC3(pixels, block);
+    dw::decodeBlockBC3(block, decoded);
+    EXPECT_EQ(0, memcmp(pixels, decoded, sizeof(pixels)));
+
+    for (int i = 0; i < 16; ++i) {
+        pixels[i * 4 + 0] = 201;
+        pixels[i * 4 + 1] = 13;
+        pixels[i * 4 + 2] = 99;
+        pixels[i * 4 + 3] = 255;
+    }
+    dw::encodeBlockBC7(pixels, block);
+    ASSERT_TRUE(dw::decodeBlockBC7(block, decoded));
+    EXPECT_EQ(0, memcmp(pixels, decoded, sizeof(pixels)));
+}
+
+TEST(TextureCompressionTest, GradientsAreClose) {
+    auto texture = createGradient(16, 16);
+    auto& original = texture.mips[0];
+    EXPECT_LE(maxError(original, roundTrip(texture, dw::TextureDataFormat::BC1), 3), 12);
+    EXPECT_LE(maxError(original, roundTrip(texture, dw::TextureDataFormat::BC3), 4), 12);
+    EXPECT_LE(maxError(original, roundTrip(texture, dw::TextureDataFormat::BC7), 4), 6);
+
+    // BC1 is opaque.
+    auto bc1 = roundTrip(texture, dw::TextureDataFormat::BC1);
+    for (dw::usize i = 3; i < bc1.size(); i += 4) {
+        ASSERT_EQ(255, bc1[i]);
+    }
+}
+
+TEST(TextureCompressionTest, PartialBlocks) {
+    // Levels which aren't a multiple of 4 pixels are padded to whole blocks.
+    auto texture = createGradient(6, 3);
+    EXPECT_EQ(2 * 8, dw::textureMipSize(dw::TextureDataFormat::BC1, 6, 3));
+    auto decoded = roundTrip(texture, dw::TextureDataFormat::BC7);
+    ASSERT_EQ(texture.mips[0].size(), decoded.size());
+    EXPECT_LE(maxError(texture.mips[0], decoded, 4), 12);
+}
+
+TEST(TextureCompressionTest, UnsupportedBC7Mode) {
+    // Mode 0 blocks are valid BC7, but aren't produced by the encoder.
+    dw::byte block[16] = {0x01};
+    dw::byte pixels[64];
+    EXPECT_FALSE(dw::decodeBlockBC7(block, pixels));
+}
@@ -0,0 +1,250 @@
+/*
+ * Dawn Engine
+ * Written by David Avedissian (c) 2012-2019 (git@dga.dev)
+ */
+#include "Base.h"
+#include "renderer/StbImage.h"
+#include "renderer/TextureData.h"
+
+#include <algorithm>
+#include <queue>
+
+namespace dw {
+namespace {
+const u32 cooked_texture_magic = 0x58545744;  // "DWTX"
+const u32 cooked_texture_version = 1;
+const usize cooked_texture_alignment = 16;
+
+// Offsets are from the start of the cooked texture. The mip table contains mip_count
+// CookedTextureMip entries, and each level is aligned to cooked_texture_alignment bytes so that
+// it can be uploaded in place.
+struct CookedTextureHeader {
+    u32 magic;
+    u32 version;
+    u32 format;
+    u32 width;
+    u32 height;
+    u32 mip_count;
+    u64 mip_table_offset;
+};
+static_assert(sizeof(CookedTextureHeader) == 32, "CookedTextureHeader must match the file format.");
+
+struct CookedTextureMip {
+    u32 width;
+    u32 height;
+    u64 offset;
+    u64 size;
+};
+static_assert(sizeof(CookedTextureMip) == 24, "CookedTextureMip must match the file format.");
+
+u64 appendSection(Vector<byte>& out, const void* data, usize size) {
+    out.resize((out.size() + cooked_texture_alignment - 1) / cooked_texture_alignment *
+               cooked_texture_alignment);
+    u64 offset = out.size();
+    auto* bytes = static_cast<const byte*>(data);
+    out.insert(out.end(), bytes, bytes + size);
+    return offset;
+}
+
+u32 mipDimension(u32 size, usize level) {
+    return std::max(size >> level, 1u);
+}
+}  // namespace
+
+bool isBlockCompressed(TextureDataFormat format) {
+    return format != TextureDataFormat::RGBA8;
+}
+
+usize textureMipSize(TextureDataFormat format, u32 width, u32 height) {
+    usize blocks = static_cast<usize>((width + 3) / 4) * static_cast<usize>((height + 3) / 4);
+    switch (format) {
+        case TextureDataFormat::RGBA8:
+            return static_cast<usize>(width) * static_cast<usize>(height) * 4;
+        case TextureDataFormat::BC1:
+            return blocks * 8;
+        case TextureDataFormat::BC3:
+        case TextureDataFormat::BC7:
+            return blocks * 16;
+    }
+    return 0;
+}
+
+usize textureMipCount(u32 width, u32 height) {
+    usize count = 1;
+    for (u32 size = std::max(width, height); size > 1; size >>= 1) {
+        count++;
+    }
+    return count;
+}
+
+usize selectTextureMip(u32 width, u32 height, usize mip_count, float screen_pixels) {
+    auto mip_size = [&](usize mip) {
+        return static_cast<float>(std::max(mipDimension(width, mip), mipDimension(height, mip)));
+    };
+    usize mip = 0;
+    while (mip + 1 < mip_count && mip_size(mip + 1) >= screen_pixels) {
+        mip++;
+    }
+    return mip;
+}
+
+usize fitTextureBudget(Vector<TextureMipRequest>& requests, usize budget) {
+    auto request_size = [&requests](usize i) {
+        auto& request = requests[i];
+        return textureMipSize(request.format, mipDimension(request.width, request.mip),
+                              mipDimension(request.height, request.mip));
+    };
+    usize total = 0;
+    std::priority_queue<Pair<usize, usize>> largest;
+    for (usize i = 0; i < requests.size(); ++i) {
+        usize size = request_size(i);
+        total += size;
+        largest.emplace(size, i);
+    }
+    while (total > budget && !largest.empty()) {
+        usize i = largest.top().second;
+        largest.pop();
+        if (requests[i].mip >= requests[i].max_mip) {
+            continue;
+        }
+        total -= request_size(i);
+        requests[i].mip++;
+        usize size = request_size(i);
+        total += size;
+        largest.emplace(size, i);
+    }
+    return total;
+}
+
+Result<TextureData> decodeImage(const byte* data, usize size) {
+    int width, height, bpp;
+    byte* pixels = stbi_load_from_memory(data, static_cast<int>(size), &width, &height, &bpp, 4);
+    if (!pixels) {
+        return makeError(str::format("Unable to decode image. Reason: {}", stbi_failure_reason()));
+    }
+    TextureData texture;
+    texture.width = static_cast<u32>(width);
+    texture.height = static_cast<u32>(height);
+    texture.mips.emplace_back(pixels, pixels + textureMipSize(TextureDataFormat::RGBA8,
+                                                              texture.width, texture.height));
+    stbi_image_free(pixels);
+    return {std::move(texture)};
+}
+
+void generateMipChain(TextureData& texture) {
+    assert(texture.format == TextureDataFormat::RGBA8 && !texture.mips.empty());
+    texture.mips.resize(1);
+    usize mip_count = textureMipCount(texture.width, texture.height);
+    for (usize level = 1; level < mip_count; ++level) {
+        u32 src_width = mipDimension(texture.width, level - 1);
+        u32 src_height = mipDimension(texture.height, level - 1);
+        u32 width = mipDimension(texture.width, level);
+        u32 height = mipDimension(texture.height, level);
+        const auto& src = texture.mips[level - 1];
+        Vector<byte> mip(textureMipSize(TextureDataFormat::RGBA8, width, height));
+        for (u32 y = 0; y < height; ++y) {
+            for (u32 x = 0; x < width; ++x) {
+                // Average the 2x2 source pixels, clamped at the edges of levels with an odd size.
+                u32 x0 = std::min(x * 2, src_width - 1), x1 = std::min(x * 2 + 1, src_width - 1);
+                u32 y0 = std::min(y * 2, src_height - 1), y1 = std::min(y * 2 + 1, src_height - 1);
+                auto pixel = [&](u32 src_x, u32 src_y, u32 c) -> u32 {
+                    return src[(src_y * src_width + src_x) * 4 + c];
+                };
+                for (u32 c = 0; c < 4; ++c) {
+                    u32 sum =
+                        pixel(x0, y0, c) + pixel(x1, y0, c) + pixel(x0, y1, c) + pixel(x1, y1, c);
+                    mip[(y * width + x) * 4 + c] = static_cast<byte>((sum + 2) / 4);
+                }
+            }
+        }
+        texture.mips.emplace_back(std::move(mip));
+    }
+}
+
+TextureDataView viewTextureData(const TextureData& texture) {
+    TextureDataView view;
+    view.format = texture.format;
+    view.width = texture.width;
+    view.height = texture.height;
+    for (usize level = 0; level < texture.mips.size(); ++level) {
+        view.mips.emplace_back(TextureMipView{mipDimension(texture.width, level),
+                                              mipDimension(texture.height, level),
+                                              texture.mips[level].data(),
+                                              texture.mips[level].size()});
+    }
+    return view;
+}
+
+Vector<byte> cookTexture(const TextureData& texture) {
+    CookedTextureHeader header = {};
+    header.magic = cooked_texture_magic;
+    header.version = cooked_texture_version;
+    header.format = static_cast<u32>(texture.format);
+    header.width = texture.width;
+    header.height = texture.height;
+    header.mip_count = static_cast<u32>(texture.mips.size());
+
+    // Write the header and mip levels, then go back and fill in the offsets.
+    Vector<byte> out;
+    appendSection(out, &header, sizeof(header));
+    Vector<CookedTextureMip> mips(texture.mips.size());
+    for (usize level = 0; level < texture.mips.size(); ++level) {
+        mips[level].width = mipDimension(texture.width, level);
+        mips[level].height = mipDimension(texture.height, level);
+        auto& mip = texture.mips[level];
+        mips[level].offset = appendSection(out, mip.data(), mip.size());
+        mips[level].size = mip.size();
+    }
+    header.mip_table_offset =
+        appendSection(out, mips.data(), mips.size() * sizeof(CookedTextureMip));
+    memcpy(out.data(), &header, sizeof(header));
+    return out;
+}
+
+bool isCookedTexture(const byte* data, usize size) {
+    u32 magic;
+    if (size < sizeof(magic)) {
+        return false;
+    }
+    memcpy(&magic, data, sizeof(magic));
+    return magic == cooked_texture_magic;
+}
+
+Result<TextureDataView> readCookedTexture(const byte* data, usize size) {
+    if (size < sizeof(CookedTextureHeader) || !isCookedTexture(data, size)) {
+        return makeError("Data is not a cooked texture.");
+    }
+    CookedTextureHeader header;
+    memcpy(&header, data, sizeof(header));
+    if (header.version != cooked_texture_version) {
+        return makeError(str::format("Cooked texture has version {}, expected {}. Re-cook it.",
+                                     header.version, cooked_texture_version));
+    }
+    if (header.format > static_cast<u32>(TextureDataFormat::BC7) || header.width == 0 ||
+        header.height == 0 || header.mip_count == 0 ||
+        header.mip_count > textureMipCount(header.width, header.height) ||
+        header.mip_table_offset > size ||
+        header.mip_count > (size - header.mip_table_offset) / sizeof(CookedTextureMip)) {
+        return makeError("Cooked texture is corrupt.");
+    }
+
+    TextureDataView view;
+    view.format = static_cast<TextureDataFormat>(header.format);
+    view.width = header.width;
+    view.height = header.height;
+    for (usize level = 0; level < header.mip_count; ++level) {
+        CookedTextureMip mip;
+        memcpy(&mip, data + header.mip_table_offset + level * sizeof(CookedTextureMip),
+               sizeof(mip));
+        if (mip.width != mipDimension(header.width, level) ||
+            mip.height != mipDimension(header.height, level) ||
+            mip.size != textureMipSize(view.format, mip.width, mip.height) || mip.offset > size ||
+            mip.size > size - mip.offset) {
+            return makeError(str::format("Cooked texture mip level {} is corrupt.", level));
+        }
+        view.mips.emplace_back(
+            TextureMipView{mip.width, mip.height, data + mip.offset, static_cast<usize>(mip.size)});
+    }
+    return {std::move(view)};
+}
+}  // namespace dw
@@ -0,0 +1,83 @@
+/*
+ * Dawn Engine
+ * Written by David Avedissian (c) 2012-2019 (git@dga.dev)
+ */
+#pragma once
+
+namespace dw {
+// Pixel formats of texture data. The block compressed formats store each 4x4 block of pixels in a
+// fixed number of bytes: 8 for BC1 (RGB), and 16 for BC3 (RGBA) and BC7 (RGBA, higher quality).
+enum class TextureDataFormat : u32 { RGBA8 = 0, BC1 = 1, BC3 = 2, BC7 = 3 };
+
+// Texture data on the CPU, with its mip levels ordered from most to least detailed. Each level
+// is half the size of the previous one, rounded down, and at least 1 pixel.
+struct DW_API TextureData {
+    TextureDataFormat format = TextureDataFormat::RGBA8;
+    u32 width = 0;
+    u32 height = 0;
+    Vector<Vector<byte>> mips;
+};
+
+struct TextureMipView {
+    u32 width;
+    u32 height;
+    const byte* data;
+    usize size;
+};
+
+// A read only view of texture data, either cooked or in a TextureData.
+struct DW_API TextureDataView {
+    TextureDataFormat format = TextureDataFormat::RGBA8;
+    u32 width = 0;
+    u32 height = 0;
+    Vector<TextureMipView> mips;
+};
+
+// Returns true if the format is block compressed.
+DW_API bool isBlockCompressed(TextureDataFormat format);
+
+// Returns the size in bytes of a single mip level. Block compressed levels are padded to a whole
+// number of blocks.
+DW_API usize textureMipSize(TextureDataFormat format, u32 width, u32 height);
+
+// Returns the number of mip levels in a full mip chain, down to 1x1.
+DW_API usize textureMipCount(u32 width, u32 height);
+
+// A texture whose resident mip level is managed by a memory budget. max_mip is the least detailed
+// level it may use, and mip is the level requested, which fitTextureBudget() makes less detailed.
+struct TextureMipRequest {
+    TextureDataFormat format;
+    u32 width;
+    u32 height;
+    usize max_mip;
+    usize mip;
+};
+
+// Returns the least detailed mip level which is at least screen_pixels pixels along its largest
+// side, or the most detailed level if none are.
+DW_API usize selectTextureMip(u32 width, u32 height, usize mip_count, float screen_pixels);
+
+// Makes mip requests less detailed until their total size fits within a budget, one level at a
+// time, starting with whichever request is largest. Returns the total size, which is still over
+// the budget if every request has reached its max_mip.
+DW_API usize fitTextureBudget(Vector<TextureMipRequest>& requests, usize budget);
+
+// Decodes an image in any format supported by stb_image into a single RGBA8 level.
+DW_API Result<TextureData> decodeImage(const byte* data, usize size);
+
+// Replaces the mip levels of RGBA8 texture data with a full mip chain generated from the most
+// detailed level with a 2x2 box filter.
+DW_API void generateMipChain(TextureData& texture);
+
+// Returns a view of texture data. The view refers to the data directly, so must not outlive it.
+DW_API TextureDataView viewTextureData(const TextureData& texture);
+
+// Cooks texture data into the binary format used by the engine.
+DW_API Vector<byte> cookTexture(const TextureData& texture);
+
+// Returns true if the data starts with a cooked texture header.
+DW_API bool isCookedTexture(const byte* data, usize size);
+
+// Returns a view of a cooked texture without copying its mip levels.
+DW_API Result<TextureDataView> readCookedTexture(const byte* data, usize size);
+}  // namespace dw
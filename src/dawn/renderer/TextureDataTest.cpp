@@ -0,0 +1,131 @@
+/*
+ * Dawn Engine
+ * Written by David Avedissian (c) 2012-2019 (git@dga.dev)
+ */
+#include "Testing.h"
+#include "renderer/TextureCompression.h"
+
+namespace {
+// A width x height RGBA8 texture where every pixel is the same colour.
+dw::TextureData createSolidTexture(dw::u32 width, dw::u32 height, dw::byte value) {
+    dw::TextureData texture;
+    texture.width = width;
+    texture.height = height;
+    texture.mips.emplace_back(width * height * 4, value);
+    return texture;
+}
+}  // namespace
+
+TEST(TextureDataTest, MipSizes) {
+    EXPECT_EQ(1, dw::textureMipCount(1, 1));
+    EXPECT_EQ(9, dw::textureMipCount(256, 256));
+    EXPECT_EQ(9, dw::textureMipCount(256, 3));
+    EXPECT_EQ(256 * 4, dw::textureMipSize(dw::TextureDataFormat::RGBA8, 16, 16));
+    EXPECT_EQ(16 * 8, dw::textureMipSize(dw::TextureDataFormat::BC1, 16, 16));
+    EXPECT_EQ(16 * 16, dw::textureMipSize(dw::TextureDataFormat::BC7, 16, 16));
+    // Levels smaller than a block still take a whole block.
+    EXPECT_EQ(16, dw::textureMipSize(dw::TextureDataFormat::BC3, 1, 1));
+}
+
+TEST(TextureDataTest, GenerateMipChain) {
+    auto texture = createSolidTexture(8, 2, 100);
+    // Make the left half of the most detailed level white.
+    for (dw::u32 y = 0; y < 2; ++y) {
+        for (dw::u32 x = 0; x < 4; ++x) {
+            memset(&texture.mips[0][(y * 8 + x) * 4], 255, 4);
+        }
+    }
+    dw::generateMipChain(texture);
+    ASSERT_EQ(4, texture.mips.size());
+    auto view = dw::viewTextureData(texture);
+    EXPECT_EQ(4, view.mips[1].width);
+    EXPECT_EQ(1, view.mips[1].height);
+    EXPECT_EQ(1, view.mips[3].width);
+    EXPECT_EQ(1, view.mips[3].height);
+    EXPECT_EQ(255, texture.mips[1][0]);
+    EXPECT_EQ(100, texture.mips[1][3 * 4]);
+    // The 1x1 level is the average of the whole texture.
+    EXPECT_EQ(178, texture.mips[3][0]);
+}
+
+TEST(TextureDataTest, CookThenRead) {
+    auto texture = createSolidTexture(32, 16, 40);
+    dw::generateMipChain(texture);
+    auto compressed = dw::compressTexture(texture, dw::TextureDataFormat::BC7);
+    ASSERT_TRUE(compressed);
+    auto cooked = dw::cookTexture(*compressed);
+    ASSERT_TRUE(dw::isCookedTexture(cooked.data(), cooked.size()));
+
+    auto view = dw::readCookedTexture(cooked.data(), cooked.size());
+    ASSERT_TRUE(view);
+    EXPECT_EQ(dw::TextureDataFormat::BC7, view->format);
+    EXPECT_EQ(32, view->width);
+    EXPECT_EQ(16, view->height);
+    ASSERT_EQ(6, view->mips.size());
+    for (dw::usize level = 0; level < view->mips.size(); ++level) {
+        auto& mip = view->mips[level];
+        ASSERT_EQ(compressed->mips[level].size(), mip.size);
+        EXPECT_EQ(0, memcmp(compressed->mips[level].data(), mip.data, mip.size));
+        // The view refers to the cooked data rather than copying it.
+        EXPECT_GE(mip.data, cooked.data());
+        EXPECT_LE(mip.data + mip.size, cooked.data() + cooked.size());
+    }
+
+    // The cooked mip levels decompress to the original colour.
+    auto decompressed = dw::decompressTexture(*view);
+    ASSERT_TRUE(decompressed);
+    EXPECT_EQ(texture.mips, decompressed->mips);
+}
+
+TEST(TextureDataTest, RejectsCorruptTextures) {
+    auto cooked = dw::cookTexture(createSolidTexture(4, 4, 0));
+    EXPECT_FALSE(dw::isCookedTexture(cooked.data(), 2));
+    EXPECT_FALSE(dw::readCookedTexture(cooked.data(), 16));
+
+    // Truncated data.
+    EXPECT_FALSE(dw::readCookedTexture(cooked.data(), cooked.size() - 1));
+
+    // A mip count larger than the texture size allows.
+    auto corrupt = cooked;
+    corrupt[20] = 10;
+    EXPECT_FALSE(dw::readCookedTexture(corrupt.data(), corrupt.size()));
+
+    // An unknown format.
+    corrupt = cooked;
+    corrupt[8] = 200;
+    EXPECT_FALSE(dw::readCookedTexture(corrupt.data(), corrupt.size()));
+}
+
+TEST(TextureDataTest, SelectTextureMip) {
+    // The least detailed level which covers the requested size on screen is chosen.
+    EXPECT_EQ(0, dw::selectTextureMip(1024, 512, 11, 2000.0f));
+    EXPECT_EQ(0, dw::selectTextureMip(1024, 512, 11, 600.0f));
+    EXPECT_EQ(1, dw::selectTextureMip(1024, 512, 11, 512.0f));
+    EXPECT_EQ(3, dw::selectTextureMip(1024, 512, 11, 100.0f));
+    EXPECT_EQ(10, dw::selectTextureMip(1024, 512, 11, 0.0f));
+    // Textures without a full mip chain stop at their least detailed level.
+    EXPECT_EQ(3, dw::selectTextureMip(1024, 512, 4, 0.0f));
+}
+
+TEST(TextureDataTest, FitTextureBudget) {
+    // Two BC1 textures, 256x256 (32 KiB at mip 0) and 64x64 (2 KiB at mip 0).
+    dw::Vector<dw::TextureMipRequest> requests = {
+        {dw::TextureDataFormat::BC1, 256, 256, 4, 0},
+        {dw::TextureDataFormat::BC1, 64, 64, 2, 0},
+    };
+    EXPECT_EQ(34 * 1024, dw::fitTextureBudget(requests, 64 * 1024));
+    EXPECT_EQ(0, requests[0].mip);
+    EXPECT_EQ(0, requests[1].mip);
+
+    // The largest texture loses detail first.
+    EXPECT_EQ(10 * 1024, dw::fitTextureBudget(requests, 16 * 1024));
+    EXPECT_EQ(1, requests[0].mip);
+    EXPECT_EQ(0, requests[1].mip);
+
+    // Once both are the same size, either may lose detail, but neither goes past max_mip.
+    requests[0].mip = requests[1].mip = 0;
+    auto total = dw::fitTextureBudget(requests, 0);
+    EXPECT_EQ(4, requests[0].mip);
+    EXPECT_EQ(2, requests[1].mip);
+    EXPECT_EQ(dw::textureMipSize(dw::TextureDataFormat::BC1, 16, 16) * 2, total);
+}
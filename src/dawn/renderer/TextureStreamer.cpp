@@ -0,0 +1,238 @@
+/*
+ * Dawn Engine
+ * Written by David Avedissian (c) 2012-2019 (git@dga.dev)
+ */
+#include "Base.h"
+#include "renderer/TextureStreamer.h"
+#include "resource/ResourceCache.h"
+
+namespace dw {
+namespace {
+usize defaultStreamingThreads() {
+#ifdef DW_EMSCRIPTEN
+    return 0;
+#else
+    return 1;
+#endif
+}
+}  // namespace
+
+TextureStreamer::TextureStreamer(Context* context)
+    : TextureStreamer(context, defaultStreamingThreads()) {
+}
+
+TextureStreamer::TextureStreamer(Context* context, usize streaming_threads, u32 initial_size)
+    : Module(context),
+      next_id_(1),
+      frame_(0),
+      budget_(0),
+      initial_size_(initial_size),
+      mips_streamed_in_(0),
+      mips_streamed_out_(0),
+      stopping_(false) {
+    for (usize i = 0; i < streaming_threads; ++i) {
+        streaming_threads_.emplace_back([this]() { streamingMain(); });
+    }
+}
+
+TextureStreamer::~TextureStreamer() {
+    {
+        LockGuard<Mutex> lock(queue_mutex_);
+        stopping_ = true;
+    }
+    queue_changed_.notify_all();
+    for (auto& thread : streaming_threads_) {
+        thread.join();
+    }
+
+    // Textures which outlive the streamer keep their resident level.
+    LockGuard<Mutex> lock(mutex_);
+    for (auto& entry : textures_) {
+        entry.second.texture->stream_id_ = 0;
+    }
+}
+
+void TextureStreamer::update() {
+    frame_++;
+
+    // Without streaming threads, the main thread reads levels itself.
+    Vector<MipReadResult> completed;
+    {
+        UniqueLock<Mutex> lock(queue_mutex_);
+        if (streaming_threads_.empty()) {
+            while (!pending_reads_.empty()) {
+                auto read = std::move(pending_reads_.front());
+                pending_reads_.pop_front();
+                lock.unlock();
+                auto result = readMip(read);
+                lock.lock();
+                completed_reads_.emplace_back(std::move(result));
+            }
+        }
+        completed.swap(completed_reads_);
+    }
+
+    LockGuard<Mutex> lock(mutex_);
+
+    // Replace resident levels with those which have been read. Textures destroyed in the meantime
+    // are no longer in textures_.
+    for (auto& result : completed) {
+        auto it = textures_.find(result.id);
+        if (it == textures_.end()) {
+            continue;
+        }
+        auto& streamed = it->second;
+        streamed.reading_mip = no_mip;
+        if (!result.data) {
+            log().warn("Unable to stream mip {} of {}: {}", result.mip,
+                       streamed.texture->asset_name_, result.error);
+            streamed.failed = true;
+            continue;
+        }
+        if (result.mip < streamed.texture->residentMip()) {
+            mips_streamed_in_++;
+        } else {
+            mips_streamed_out_++;
+        }
+        streamed.texture->replaceResidentMip(
+            result.mip, gfx::Memory(result.data.release(), result.size,
+                                    [](byte* data) { delete[] data; }));
+    }
+
+    // Choose the level of each texture from the size it was requested at, then fit them within
+    // the budget.
+    Vector<Pair<u64, StreamedTexture*>> textures;
+    Vector<TextureMipRequest> requests;
+    textures.reserve(textures_.size());
+    requests.reserve(textures_.size());
+    for (auto& entry : textures_) {
+        auto& streamed = entry.second;
+        auto* texture = streamed.texture;
+        u32 requested_size = texture->requested_screen_size_.exchange(0, std::memory_order_relaxed);
+        if (requested_size > 0) {
+            streamed.requested_size = requested_size;
+            streamed.requested_frame = frame_;
+        } else if (frame_ - streamed.requested_frame > streamed_texture_request_timeout) {
+            streamed.requested_size = 0;
+        }
+        auto width = static_cast<u32>(texture->size_.x);
+        auto height = static_cast<u32>(texture->size_.y);
+        usize mip = std::min(selectTextureMip(width, height, texture->mips_.size(),
+                                              static_cast<float>(streamed.requested_size)),
+                             streamed.initial_mip);
+        textures.emplace_back(entry.first, &streamed);
+        requests.emplace_back(
+            TextureMipRequest{texture->format_, width, height, streamed.initial_mip, mip});
+    }
+    usize budget = budget_.load(std::memory_order_relaxed);
+    if (budget > 0) {
+        fitTextureBudget(requests, budget);
+    }
+
+    // Read each level which isn't already resident. A texture only reads one level at a time,
+    // and picks the next once it has been replaced.
+    Vector<MipRead> reads;
+    for (usize i = 0; i < textures.size(); ++i) {
+        auto& streamed = *textures[i].second;
+        auto* texture = streamed.texture;
+        usize mip = requests[i].mip;
+        if (streamed.failed || streamed.reading_mip != no_mip || mip == texture->residentMip()) {
+            continue;
+        }
+        streamed.reading_mip = mip;
+        auto& layout = texture->mips_[mip];
+        reads.emplace_back(
+            MipRead{textures[i].first, texture->asset_name_, mip, layout.offset, layout.size});
+    }
+    if (!reads.empty()) {
+        {
+            LockGuard<Mutex> queue_lock(queue_mutex_);
+            for (auto& read : reads) {
+                pending_reads_.emplace_back(std::move(read));
+            }
+        }
+        queue_changed_.notify_all();
+    }
+}
+
+void TextureStreamer::setBudget(usize bytes) {
+    budget_ = bytes;
+}
+
+usize TextureStreamer::budget() const {
+    return budget_;
+}
+
+u32 TextureStreamer::initialSize() const {
+    return initial_size_;
+}
+
+TextureStreamerStats TextureStreamer::stats() {
+    LockGuard<Mutex> lock(mutex_);
+    TextureStreamerStats stats;
+    stats.textures = textures_.size();
+    for (auto& entry : textures_) {
+        stats.resident_bytes += entry.second.texture->footprint().gpu_bytes;
+        if (entry.second.reading_mip != no_mip) {
+            stats.pending_reads++;
+        }
+    }
+    stats.mips_streamed_in = mips_streamed_in_;
+    stats.mips_streamed_out = mips_streamed_out_;
+    return stats;
+}
+
+void TextureStreamer::addTexture(Texture& texture) {
+    LockGuard<Mutex> lock(mutex_);
+    u64 id = next_id_++;
+    texture.stream_id_ = id;
+    textures_.emplace(
+        id, StreamedTexture{&texture, texture.residentMip(), no_mip, 0, frame_, false});
+}
+
+void TextureStreamer::removeTexture(Texture& texture) {
+    LockGuard<Mutex> lock(mutex_);
+    textures_.erase(texture.stream_id_);
+    texture.stream_id_ = 0;
+}
+
+void TextureStreamer::streamingMain() {
+    UniqueLock<Mutex> lock(queue_mutex_);
+    while (true) {
+        queue_changed_.wait(lock, [this]() { return stopping_ || !pending_reads_.empty(); });
+        if (stopping_) {
+            return;
+        }
+        auto read = std::move(pending_reads_.front());
+        pending_reads_.pop_front();
+        lock.unlock();
+        auto result = readMip(read);
+        lock.lock();
+        completed_reads_.emplace_back(std::move(result));
+    }
+}
+
+TextureStreamer::MipReadResult TextureStreamer::readMip(const MipRead& read) {
+    MipReadResult result{read.id, read.mip, nullptr, 0, ""};
+    auto stream = module<ResourceCache>()->loadRaw(read.asset_name);
+    if (!stream) {
+        result.error = stream.error();
+        return result;
+    }
+    auto& src = *stream.value();
+    if (read.offset + read.size > src.size()) {
+        result.error = "Cooked texture has changed since it was loaded.";
+        return result;
+    }
+    auto size = static_cast<usize>(read.size);
+    UniquePtr<byte[]> data{new byte[size]};
+    src.seek(static_cast<usize>(read.offset));
+    if (src.readData(data.get(), size) != size) {
+        result.error = "Unable to read the mip level.";
+        return result;
+    }
+    result.data = std::move(data);
+    result.size = size;
+    return result;
+}
+}  // namespace dw
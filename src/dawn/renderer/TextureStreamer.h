@@ -0,0 +1,113 @@
+/*
+ * Dawn Engine
+ * Written by David Avedissian (c) 2012-2019 (git@dga.dev)
+ */
+#pragma once
+
+#include "core/Collections.h"
+#include "core/Concurrency.h"
+#include "renderer/Texture.h"
+
+namespace dw {
+// Size in pixels of the mip level which streamed textures start with, along their largest side.
+const u32 default_streamed_texture_initial_size = 64;
+
+// Number of frames a streamed texture keeps its level after it was last requested.
+const u64 streamed_texture_request_timeout = 120;
+
+struct TextureStreamerStats {
+    usize textures = 0;
+    usize resident_bytes = 0;   // GPU memory used by the resident levels of streamed textures.
+    usize pending_reads = 0;    // Levels which are being read.
+    u64 mips_streamed_in = 0;   // Resident levels replaced by more detailed ones.
+    u64 mips_streamed_out = 0;  // Resident levels replaced by less detailed ones.
+};
+
+// Streams the mip levels of cooked textures, so that only the detail which is visible is kept on
+// the GPU. Streamed textures start with the least detailed level which is at least initial_size
+// pixels, which stays available so that they can always be drawn.
+//
+// Each frame, update() picks a level for each texture from the largest size it was drawn at
+// since the last update (see Texture::requestScreenSize()). Textures which haven't been drawn for
+// streamed_texture_request_timeout frames go back to their initial level. If the chosen levels
+// don't fit in the memory budget, the largest are made less detailed first. Levels are read from
+// the texture's resource on streaming threads, then replace the resident level in update().
+class DW_API TextureStreamer : public Module {
+public:
+    DW_OBJECT(TextureStreamer);
+
+    explicit TextureStreamer(Context* context);
+    // If streaming_threads is 0, levels are read on the main thread in update().
+    TextureStreamer(Context* context, usize streaming_threads,
+                    u32 initial_size = default_streamed_texture_initial_size);
+    ~TextureStreamer() override;
+
+    // Uploads levels which have been read, then chooses the level of each texture and starts
+    // reading any which aren't resident. Called once per frame on the main thread.
+    void update();
+
+    // Sets the maximum GPU memory used by the resident levels of streamed textures. 0 means no
+    // limit.
+    void setBudget(usize bytes);
+    usize budget() const;
+
+    u32 initialSize() const;
+
+    TextureStreamerStats stats();
+
+private:
+    friend class Texture;
+
+    static const usize no_mip = ~usize(0);
+
+    struct StreamedTexture {
+        Texture* texture;
+        usize initial_mip;
+        usize reading_mip;    // no_mip if no level is being read.
+        u32 requested_size;   // Largest size requested in the frame requested_frame.
+        u64 requested_frame;
+        bool failed;
+    };
+
+    struct MipRead {
+        u64 id;
+        String asset_name;
+        usize mip;
+        u64 offset;
+        u64 size;
+    };
+
+    struct MipReadResult {
+        u64 id;
+        usize mip;
+        UniquePtr<byte[]> data;
+        usize size;
+        String error;
+    };
+
+    // Guards textures_. Textures remove themselves when destroyed, so holding this also keeps
+    // them alive.
+    Mutex mutex_;
+    HashMap<u64, StreamedTexture> textures_;
+    u64 next_id_;
+    u64 frame_;
+    Atomic<usize> budget_;
+    u32 initial_size_;
+    u64 mips_streamed_in_;
+    u64 mips_streamed_out_;
+
+    // Read queues, guarded by queue_mutex_.
+    Vector<Thread> streaming_threads_;
+    Mutex queue_mutex_;
+    ConditionVariable queue_changed_;
+    bool stopping_;
+    Deque<MipRead> pending_reads_;
+    Vector<MipReadResult> completed_reads_;
+
+    void addTexture(Texture& texture);
+    void removeTexture(Texture& texture);
+
+    void streamingMain();
+    MipReadResult readMip(const MipRead& read);
+};
+}  // namespace dw
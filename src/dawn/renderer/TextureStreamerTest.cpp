@@ -0,0 +1,72 @@
+/*
+ * Dawn Engine
+ * Written by David Avedissian (c) 2012-2019 (git@dga.dev)
+ */
+#include "Testing.h"
+#include "core/io/File.h"
+#include "renderer/Renderer.h"
+#include "renderer/Texture.h"
+#include "renderer/TextureData.h"
+#include "renderer/TextureStreamer.h"
+#include "resource/ResourceCache.h"
+
+class TextureStreamerTest : public ::testing::Test {
+public:
+    void SetUp() override {
+        context_ = new dw::Context("", "");
+        context_->addModule<dw::Logger>();
+        context_->addModule<dw::FileSystem>();
+        auto* renderer = context_->addModule<dw::Renderer>();
+        ASSERT_TRUE(renderer->rhi()->init(dw::gfx::RendererType::Null, 1280, 800, "",
+                                          dw::gfx::InputCallbacks{}, false));
+        auto* cache = context_->addModule<dw::ResourceCache>(0);
+        cache->addPath("test", context_->module<dw::FileSystem>()->tempDir());
+        streamer_ = context_->addModule<dw::TextureStreamer>(0, 4);
+
+        // A 32x32 texture with a full mip chain, of which the 4x4 level is loaded first.
+        dw::TextureData texture;
+        texture.width = 32;
+        texture.height = 32;
+        texture.mips.emplace_back(32 * 32 * 4, dw::byte(100));
+        dw::generateMipChain(texture);
+        auto cooked = dw::cookTexture(texture);
+        dw::File file(context_, texturePath(), dw::FileMode::Write);
+        file.writeData(cooked.data(), cooked.size());
+    }
+
+    void TearDown() override {
+        context_->module<dw::FileSystem>()->deleteFile(texturePath());
+        // Textures must be destroyed before the renderer.
+        context_->clearModules();
+        delete context_;
+    }
+
+protected:
+    dw::Context* context_;
+    dw::TextureStreamer* streamer_;
+
+    dw::Path texturePath() {
+        return context_->module<dw::FileSystem>()->tempDir() + "/texture_streamer_test.dwtx";
+    }
+};
+
+TEST_F(TextureStreamerTest, StreamsOnMainThreadWithoutStreamingThreads) {
+    auto texture =
+        context_->module<dw::ResourceCache>()->get<dw::Texture>("test:texture_streamer_test.dwtx");
+    ASSERT_TRUE(texture);
+    ASSERT_TRUE((*texture)->isStreamed());
+    EXPECT_EQ(3, (*texture)->residentMip());
+    EXPECT_EQ(1, streamer_->stats().textures);
+
+    // The first update starts reading the most detailed level, which the next update reads on the
+    // main thread and makes resident.
+    (*texture)->requestScreenSize(32.0f);
+    streamer_->update();
+    EXPECT_EQ(1, streamer_->stats().pending_reads);
+    streamer_->update();
+    EXPECT_EQ(0, (*texture)->residentMip());
+    auto stats = streamer_->stats();
+    EXPECT_EQ(0, stats.pending_reads);
+    EXPECT_EQ(1, stats.mips_streamed_in);
+    EXPECT_EQ(32 * 32 * 4, stats.resident_bytes);
+}
@@ -10,7 +10,9 @@ namespace dw {
 VertexBuffer::VertexBuffer(Context* context, gfx::Memory data, usize vertex_count,
                            const gfx::VertexDecl& decl, gfx::BufferUsage usage)
     : Object{context}, vertex_count_{vertex_count} {
-    handle_ = context->module<Renderer>()->rhi()->createVertexBuffer(std::move(data), decl, usage);
+    auto* renderer = context->module<Renderer>();
+    LockGuard<RecursiveMutex> lock(renderer->resourceMutex());
+    handle_ = renderer->rhi()->createVertexBuffer(std::move(data), decl, usage);
 }
 
 VertexBuffer::VertexBuffer(Context* context, gfx::VertexBufferHandle handle, usize vertex_count)
@@ -18,12 +20,16 @@ VertexBuffer::VertexBuffer(Context* context, gfx::VertexBufferHandle handle, usi
 }
 
 VertexBuffer::~VertexBuffer() {
-    context_->module<Renderer>()->rhi()->deleteVertexBuffer(handle_);
+    auto* renderer = context_->module<Renderer>();
+    LockGuard<RecursiveMutex> lock(renderer->resourceMutex());
+    renderer->rhi()->deleteVertexBuffer(handle_);
 }
 
 void VertexBuffer::update(gfx::Memory data, usize vertex_count, usize offset) {
     vertex_count_ = vertex_count;
-    context_->module<Renderer>()->rhi()->updateVertexBuffer(handle_, std::move(data), offset);
+    auto* renderer = context_->module<Renderer>();
+    LockGuard<RecursiveMutex> lock(renderer->resourceMutex());
+    renderer->rhi()->updateVertexBuffer(handle_, std::move(data), offset);
 }
 
 void VertexBuffer::bind(gfx::Renderer* r) {
@@ -5,6 +5,7 @@
 #include "Base.h"
 #include "core/io/InputStream.h"
 #include "resource/Resource.h"
+#include "resource/ResourceCache.h"
 
 namespace dw {
 
@@ -16,6 +17,14 @@ Result<void> Resource::load(const String& asset_name, InputStream& src) {
     if (!begin_load_result) {
         return begin_load_result;
     }
+    for (auto& dependency : dependencies_) {
+        auto dependency_result = module<ResourceCache>()->wait(*dependency);
+        if (!dependency_result) {
+            return makeError(str::format("Dependency {} failed to load. Reason: {}",
+                                         dependency->path(), dependency_result.error()));
+        }
+    }
+    dependencies_.clear();
     auto end_load_result = endLoad();
     if (!end_load_result) {
         return end_load_result;
@@ -35,4 +44,16 @@ Result<void> Resource::save(OutputStream&) {
 bool Resource::hasLoaded() const {
     return loaded_;
 }
+
+ResourceFootprint Resource::footprint() const {
+    return {};
+}
+
+const Vector<SharedPtr<ResourceLoad>>& Resource::dependencies() const {
+    return dependencies_;
+}
+
+void Resource::addDependency(SharedPtr<ResourceLoad> dependency) {
+    dependencies_.emplace_back(std::move(dependency));
+}
 }  // namespace dw
@@ -9,6 +9,19 @@
 #include "core/io/OutputStream.h"
 
 namespace dw {
+class ResourceLoad;
+template <typename T> class ResourceHandle;
+
+// Memory used by a loaded resource.
+struct ResourceFootprint {
+    usize cpu_bytes = 0;
+    usize gpu_bytes = 0;
+};
+
+// Loading a resource is split into two stages. beginLoad() reads the resource and does any CPU
+// work such as decoding, and may run on a resource loader thread. endLoad() creates renderer
+// objects once every dependency added by beginLoad() has loaded. It may run on any thread, while
+// holding Renderer::resourceMutex().
 class DW_API Resource : public Object {
 public:
     DW_OBJECT(Resource);
@@ -16,6 +29,7 @@ public:
     Resource(Context* context);
     virtual ~Resource() = default;
 
+    // Loads the resource on the calling thread, waiting for any dependencies.
     Result<void> load(const String& asset_name, InputStream& src);
     virtual Result<void> beginLoad(const String& asset_name, InputStream& src) = 0;
     virtual Result<void> endLoad();
@@ -23,7 +37,24 @@ public:
 
     bool hasLoaded() const;
 
+    // Memory used by the resource once it has loaded, used by the resource cache to stay within
+    // its memory budget.
+    virtual ResourceFootprint footprint() const;
+
+    // Resources which must finish loading before endLoad() is called.
+    const Vector<SharedPtr<ResourceLoad>>& dependencies() const;
+
 protected:
     bool loaded_;
+
+    void addDependency(SharedPtr<ResourceLoad> dependency);
+    template <typename T> void addDependency(const ResourceHandle<T>& dependency) {
+        addDependency(dependency.load());
+    }
+
+private:
+    friend class ResourceCache;
+
+    Vector<SharedPtr<ResourceLoad>> dependencies_;
 };
 }  // namespace dw
@@ -5,43 +5,77 @@
 #include "Base.h"
 #include "core/io/File.h"
 #include "core/io/FileSystem.h"
+#include "renderer/Renderer.h"
 #include "resource/ResourceCache.h"
 
 namespace dw {
-Pair<String, Path> parseResourcePath(const ResourcePath& resource_path) {
-    auto split_point = resource_path.find(':');
-    if (split_point == String::npos) {
-        return {"unknown_package", ""};
-    }
-    return {resource_path.substr(0, split_point), "/" + resource_path.substr(split_point + 1)};
+namespace {
+usize defaultLoaderThreads() {
+#ifdef DW_EMSCRIPTEN
+    return 0;
+#else
+    usize hardware_threads = Thread::hardware_concurrency();
+    return hardware_threads > 2 ? std::min<usize>(hardware_threads - 1, 4) : 1;
+#endif
 }
+}  // namespace
 
-ResourcePackage::ResourcePackage(Context* ctx, const Path& package) : Object(ctx) {
+ResourceLoad::ResourceLoad(ResourcePath path, SharedPtr<Resource> resource)
+    : path_(std::move(path)),
+      resource_(std::move(resource)),
+      state_(ResourceLoadState::Loading),
+      last_used_frame_(0) {
 }
 
-Result<SharedPtr<InputStream>> ResourcePackage::getFile(const ResourcePath& path_within_location) {
-    return makeError(
-        "ResourcePackage::getFile() - Loading from a ResourcePackage is unimplemented.");
+const ResourcePath& ResourceLoad::path() const {
+    return path_;
 }
 
-ResourceFilesystemPath::ResourceFilesystemPath(Context* ctx, const Path& path)
-    : Object(ctx), path_{path} {
+ResourceLoadState ResourceLoad::state() const {
+    return state_.load(std::memory_order_acquire);
 }
 
-Result<SharedPtr<InputStream>> ResourceFilesystemPath::getFile(
-    const ResourcePath& path_within_location) {
-    Path full_path = path_ + path_within_location;
-    log().info("Loading resource from filesystem at " + full_path);
-    if (module<FileSystem>()->fileExists(full_path)) {
-        return {makeShared<File>(context(), full_path, FileMode::Read)};
-    }
-    return makeError(str::format("File {} does not exist.", full_path));
+bool ResourceLoad::isReady() const {
+    return state() != ResourceLoadState::Loading;
+}
+
+const String& ResourceLoad::error() const {
+    return error_;
 }
 
-ResourceCache::ResourceCache(Context* context) : Module(context) {
+const SharedPtr<Resource>& ResourceLoad::resource() const {
+    return resource_;
+}
+
+ResourceCache::ResourceCache(Context* context) : ResourceCache(context, defaultLoaderThreads()) {
+}
+
+ResourceCache::ResourceCache(Context* context, usize loader_threads)
+    : Module(context),
+      snapshot_stale_(false),
+      memory_budget_(0),
+      frame_(0),
+      hits_(0),
+      misses_(0),
+      evictions_(0),
+      resident_bytes_(0),
+      over_budget_(false),
+      queue_generation_(0),
+      stopping_(false) {
+    for (usize i = 0; i < loader_threads; ++i) {
+        loader_threads_.emplace_back([this]() { loaderMain(); });
+    }
 }
 
 ResourceCache::~ResourceCache() {
+    {
+        LockGuard<Mutex> lock(queue_mutex_);
+        stopping_ = true;
+    }
+    queue_changed_.notify_all();
+    for (auto& thread : loader_threads_) {
+        thread.join();
+    }
 }
 
 void ResourceCache::addPath(const String& package, const Path& path) {
@@ -50,12 +84,24 @@ void ResourceCache::addPath(const String& package, const Path& path) {
 #else
     // TODO(David): Don't hard code resource paths in this way.
     const auto& real_path = "/media/" + package;
+#endif
+    LockGuard<RecursiveMutex> lock(mutex_);
+#ifndef DW_EMSCRIPTEN
+    // Prefer a package built from the directory, if there is one.
+    Path package_path = real_path + resource_package_extension;
+    if (module<FileSystem>()->fileExists(package_path)) {
+        log().info("Mounting resource package {} as {}", package_path, package);
+        resource_packages_.emplace(
+            makePair(package, makeUnique<ResourcePackage>(context(), package_path)));
+        return;
+    }
 #endif
     resource_packages_.emplace(
         makePair(package, makeUnique<ResourceFilesystemPath>(context(), real_path)));
 }
 
 void ResourceCache::addPackage(const String& package, UniquePtr<ResourcePackage> file) {
+    LockGuard<RecursiveMutex> lock(mutex_);
     resource_packages_.emplace(makePair(package, std::move(file)));
 }
 
@@ -64,12 +110,399 @@ Result<SharedPtr<InputStream>> ResourceCache::loadRaw(const ResourcePath& resour
     auto path = parseResourcePath(resource_path);
     String package = path.first;
 
-    // Look up package and get the file within that package.
-    auto package_it = resource_packages_.find(package);
-    if (package_it == resource_packages_.end()) {
-        return makeError(str::format("Attempting to load from unknown package: {} - Full path: {}",
-                                     package, resource_path));
+    // Look up package, then get the file within that package without holding the lock, as it may
+    // read and decompress the file. Locations are never removed, so the pointer stays valid.
+    ResourceLocation* location;
+    {
+        LockGuard<RecursiveMutex> lock(mutex_);
+        auto package_it = resource_packages_.find(package);
+        if (package_it == resource_packages_.end()) {
+            return makeError(
+                str::format("Attempting to load from unknown package: {} - Full path: {}",
+                            package, resource_path));
+        }
+        location = package_it->second.get();
+    }
+    return location->getFile(simplifyAbsolutePath(path.second));
+}
+
+Result<void> ResourceCache::wait(ResourceLoad& load) {
+    UniqueLock<Mutex> lock(queue_mutex_);
+    while (!load.isReady()) {
+        u64 generation = queue_generation_;
+        if (!pending_begin_load_.empty()) {
+            auto next = std::move(pending_begin_load_.front());
+            pending_begin_load_.pop_front();
+            lock.unlock();
+            beginLoad(next);
+            lock.lock();
+            continue;
+        }
+        if (!pending_end_load_.empty()) {
+            lock.unlock();
+            usize finished = endLoads();
+            lock.lock();
+            if (finished > 0) {
+                continue;
+            }
+        }
+        queue_changed_.wait(lock, [&]() { return queue_generation_ != generation; });
+    }
+    if (load.state() == ResourceLoadState::Failed) {
+        return makeError(load.error());
+    }
+    return Result<void>();
+}
+
+void ResourceCache::update() {
+    // Without loader threads, the main thread does all the work.
+    if (loader_threads_.empty()) {
+        UniqueLock<Mutex> lock(queue_mutex_);
+        while (!pending_begin_load_.empty()) {
+            auto next = std::move(pending_begin_load_.front());
+            pending_begin_load_.pop_front();
+            lock.unlock();
+            beginLoad(next);
+            lock.lock();
+        }
+    }
+    endLoads();
+
+    // Eviction relies on every resource being in the snapshot.
+    {
+        LockGuard<RecursiveMutex> lock(mutex_);
+        if (snapshot_stale_) {
+            publishSnapshot();
+        }
+    }
+
+    frame_.fetch_add(1, std::memory_order_relaxed);
+    updateFootprints();
+    if (memory_budget_.load(std::memory_order_relaxed) > 0) {
+        evictUnusedResources();
+    }
+}
+
+void ResourceCache::setMemoryBudget(usize bytes) {
+    memory_budget_ = bytes;
+}
+
+usize ResourceCache::memoryBudget() const {
+    return memory_budget_;
+}
+
+ResourceCacheStats ResourceCache::stats() {
+    ResourceCacheStats stats;
+    stats.hits = hits_.load(std::memory_order_relaxed);
+    stats.misses = misses_.load(std::memory_order_relaxed);
+    LockGuard<RecursiveMutex> lock(mutex_);
+    stats.evictions = evictions_;
+    stats.resident_bytes = resident_bytes_;
+    stats.resident_by_type = resident_by_type_;
+    return stats;
+}
+
+SharedPtr<ResourceLoad> ResourceCache::findInSnapshot(const ResourcePath& resource_path) {
+    auto snapshot = std::atomic_load(&snapshot_);
+    if (!snapshot) {
+        return nullptr;
+    }
+    auto it = snapshot->find(resource_path);
+    return it != snapshot->end() ? it->second : nullptr;
+}
+
+void ResourceCache::publishSnapshot() {
+    SharedPtr<const ResourceMap> snapshot = makeShared<ResourceMap>(resource_cache_);
+    std::atomic_store(&snapshot_, std::move(snapshot));
+    snapshot_stale_ = false;
+}
+
+SharedPtr<ResourceLoad> ResourceCache::findOrStartLoad(
+    const ResourcePath& resource_path, const Function<SharedPtr<Resource>()>& create) {
+    // Only write the frame if it has changed, to avoid contending on the cache line.
+    u64 frame = frame_.load(std::memory_order_relaxed);
+    auto mark_used = [frame](ResourceLoad& load) {
+        if (load.last_used_frame_.load(std::memory_order_relaxed) != frame) {
+            load.last_used_frame_.store(frame, std::memory_order_relaxed);
+        }
+    };
+
+    auto existing_load = findInSnapshot(resource_path);
+    if (existing_load) {
+        hits_.fetch_add(1, std::memory_order_relaxed);
+        mark_used(*existing_load);
+        return existing_load;
+    }
+
+    // Check again with the lock held, as the resource may have been requested since the snapshot
+    // was published.
+    SharedPtr<ResourceLoad> load;
+    {
+        LockGuard<RecursiveMutex> lock(mutex_);
+        auto it = resource_cache_.find(resource_path);
+        if (it != resource_cache_.end()) {
+            hits_.fetch_add(1, std::memory_order_relaxed);
+            mark_used(*it->second);
+            return it->second;
+        }
+        misses_.fetch_add(1, std::memory_order_relaxed);
+        load = makeShared<ResourceLoad>(resource_path, create());
+        mark_used(*load);
+        resource_cache_.emplace(resource_path, load);
+        snapshot_stale_ = true;
+    }
+    {
+        LockGuard<Mutex> lock(queue_mutex_);
+        pending_begin_load_.emplace_back(load);
+        queue_generation_++;
+    }
+    queue_changed_.notify_all();
+    return load;
+}
+
+void ResourceCache::addLoadedResource(const ResourcePath& resource_path,
+                                      SharedPtr<Resource> resource) {
+    auto load = makeShared<ResourceLoad>(resource_path, resource);
+    load->state_ = ResourceLoadState::Loaded;
+    load->last_used_frame_ = frame_.load(std::memory_order_relaxed);
+    LockGuard<RecursiveMutex> lock(mutex_);
+    auto it = resource_cache_.find(resource_path);
+    if (it != resource_cache_.end()) {
+        log().warn("Found an existing resource at {}. Replacing with an instance of '{}'",
+                   resource_path, resource->typeName());
+        if (it->second->state() == ResourceLoadState::Loaded) {
+            removeResident(*it->second);
+        }
+        it->second = load;
+        publishSnapshot();
+    } else {
+        resource_cache_.emplace(resource_path, load);
+        snapshot_stale_ = true;
+    }
+    addResident(*load);
+}
+
+void ResourceCache::addResident(ResourceLoad& load) {
+    load.footprint_ = load.resource_->footprint();
+    auto& type_stats = resident_by_type_[load.resource_->typeName()];
+    type_stats.count++;
+    type_stats.cpu_bytes += load.footprint_.cpu_bytes;
+    type_stats.gpu_bytes += load.footprint_.gpu_bytes;
+    resident_bytes_ += load.footprint_.cpu_bytes + load.footprint_.gpu_bytes;
+}
+
+void ResourceCache::removeResident(ResourceLoad& load) {
+    auto& type_stats = resident_by_type_[load.resource_->typeName()];
+    type_stats.count--;
+    type_stats.cpu_bytes -= load.footprint_.cpu_bytes;
+    type_stats.gpu_bytes -= load.footprint_.gpu_bytes;
+    resident_bytes_ -= load.footprint_.cpu_bytes + load.footprint_.gpu_bytes;
+}
+
+void ResourceCache::updateFootprints() {
+    LockGuard<RecursiveMutex> lock(mutex_);
+    for (auto& entry : resource_cache_) {
+        auto& load = *entry.second;
+        if (load.state() == ResourceLoadState::Loaded) {
+            removeResident(load);
+            addResident(load);
+        }
+    }
+}
+
+void ResourceCache::evictUnusedResources() {
+    LockGuard<RecursiveMutex> lock(mutex_);
+    usize budget = memory_budget_;
+    if (resident_bytes_ <= budget) {
+        over_budget_ = false;
+        return;
+    }
+
+    // A resource is unused if the only references to its load are held by resource_cache_ and
+    // the current snapshot, and its load holds the only reference to the resource. Loads which a
+    // reader is still looking up in an older snapshot are skipped until the next update.
+    const long cache_load_references = 2;
+    Vector<ResourceMap::iterator> candidates;
+    for (auto it = resource_cache_.begin(); it != resource_cache_.end(); ++it) {
+        auto& load = *it->second;
+        if (load.state() == ResourceLoadState::Loaded &&
+            it->second.use_count() == cache_load_references && load.resource_.use_count() == 1) {
+            candidates.emplace_back(it);
+        }
+    }
+    std::sort(candidates.begin(), candidates.end(),
+              [](const ResourceMap::iterator& a, const ResourceMap::iterator& b) {
+                  return a->second->last_used_frame_.load(std::memory_order_relaxed) <
+                         b->second->last_used_frame_.load(std::memory_order_relaxed);
+              });
+
+    usize evicted = 0;
+    for (auto& it : candidates) {
+        if (resident_bytes_ <= budget) {
+            break;
+        }
+        log().info("Evicting resource {} ({} bytes)", it->first,
+                   it->second->footprint_.cpu_bytes + it->second->footprint_.gpu_bytes);
+        removeResident(*it->second);
+        resource_cache_.erase(it);
+        evicted++;
+    }
+    if (evicted > 0) {
+        evictions_ += evicted;
+        publishSnapshot();
+    }
+    // Only warn when the budget is first exceeded, rather than every frame.
+    if (resident_bytes_ > budget && !over_budget_) {
+        over_budget_ = true;
+        log().warn("Resources in use ({} bytes) exceed the memory budget of {} bytes.",
+                   resident_bytes_, budget);
+    }
+}
+
+void ResourceCache::loaderMain() {
+    UniqueLock<Mutex> lock(queue_mutex_);
+    while (true) {
+        queue_changed_.wait(lock, [this]() { return stopping_ || !pending_begin_load_.empty(); });
+        if (stopping_) {
+            return;
+        }
+        auto next = std::move(pending_begin_load_.front());
+        pending_begin_load_.pop_front();
+        lock.unlock();
+        beginLoad(next);
+        lock.lock();
+    }
+}
+
+void ResourceCache::beginLoad(const SharedPtr<ResourceLoad>& load) {
+    // Load the file which contains this resource data.
+    auto resource_data = loadRaw(load->path());
+    if (!resource_data) {
+        finishLoad(*load, ResourceLoadState::Failed,
+                   str::format("Cannot find resource {}. Reason: {}", load->path(),
+                               resource_data.error()));
+        return;
+    }
+    log().info("Loading asset '{}'", load->path());
+    auto begin_load_result =
+        load->resource_->beginLoad(load->path(), *resource_data.value().get());
+    if (!begin_load_result) {
+        finishLoad(*load, ResourceLoadState::Failed,
+                   str::format("Failed to load resource {}. Reason: {}", load->path(),
+                               begin_load_result.error()));
+        return;
+    }
+
+    // Renderer objects are created in update(), or by a thread waiting for the resource.
+    {
+        LockGuard<Mutex> lock(queue_mutex_);
+        pending_end_load_.emplace_back(load);
+        queue_generation_++;
+    }
+    queue_changed_.notify_all();
+}
+
+usize ResourceCache::endLoads() {
+    Vector<SharedPtr<ResourceLoad>> pending;
+    {
+        LockGuard<Mutex> lock(queue_mutex_);
+        pending.swap(pending_end_load_);
+    }
+
+    // A resource may depend on another which is also waiting to finish, so keep going until no
+    // more progress is made.
+    usize finished = 0;
+    bool progress = true;
+    while (progress && !pending.empty()) {
+        progress = false;
+        for (auto it = pending.begin(); it != pending.end();) {
+            if (tryEndLoad(**it)) {
+                it = pending.erase(it);
+                finished++;
+                progress = true;
+            } else {
+                ++it;
+            }
+        }
+    }
+
+    if (!pending.empty()) {
+        LockGuard<Mutex> lock(queue_mutex_);
+        pending_end_load_.insert(pending_end_load_.end(), pending.begin(), pending.end());
+    }
+    return finished;
+}
+
+bool ResourceCache::tryEndLoad(ResourceLoad& load) {
+    auto& resource = *load.resource_;
+    for (auto& dependency : resource.dependencies()) {
+        if (!dependency->isReady()) {
+            return false;
+        }
+    }
+
+    // The dependencies are no longer needed once they're ready. Keeping them would keep evicted
+    // resources alive.
+    auto dependencies = std::move(resource.dependencies_);
+    resource.dependencies_.clear();
+    for (auto& dependency : dependencies) {
+        if (dependency->state() == ResourceLoadState::Failed) {
+            finishLoad(load, ResourceLoadState::Failed,
+                       str::format("Failed to load resource {}. Reason: Dependency {} failed to "
+                                   "load. Reason: {}",
+                                   load.path(), dependency->path(), dependency->error()));
+            return true;
+        }
+    }
+    // Renderer objects may be created from any thread while holding the renderer's resource mutex.
+    // It's released before taking mutex_, as evicting resources under mutex_ deletes renderer
+    // objects.
+    Result<void> end_load_result;
+    {
+        auto* renderer = module<Renderer>();
+        UniqueLock<RecursiveMutex> renderer_lock;
+        if (renderer) {
+            renderer_lock = UniqueLock<RecursiveMutex>(renderer->resourceMutex());
+        }
+        end_load_result = resource.endLoad();
+    }
+    if (!end_load_result) {
+        finishLoad(load, ResourceLoadState::Failed,
+                   str::format("Failed to load resource {}. Reason: {}", load.path(),
+                               end_load_result.error()));
+        return true;
+    }
+    resource.loaded_ = true;
+    {
+        LockGuard<RecursiveMutex> lock(mutex_);
+        auto it = resource_cache_.find(load.path());
+        if (it != resource_cache_.end() && it->second.get() == &load) {
+            addResident(load);
+        }
+    }
+    finishLoad(load, ResourceLoadState::Loaded);
+    return true;
+}
+
+void ResourceCache::finishLoad(ResourceLoad& load, ResourceLoadState state, String error) {
+    if (state == ResourceLoadState::Failed) {
+        log().error("{}", error);
+
+        // Remove the failed load, so that the next request tries again. It may have already been
+        // replaced by a custom resource.
+        LockGuard<RecursiveMutex> lock(mutex_);
+        auto it = resource_cache_.find(load.path());
+        if (it != resource_cache_.end() && it->second.get() == &load) {
+            resource_cache_.erase(it);
+            publishSnapshot();
+        }
+    }
+    {
+        LockGuard<Mutex> lock(queue_mutex_);
+        load.error_ = std::move(error);
+        load.state_.store(state, std::memory_order_release);
+        queue_generation_++;
     }
-    return package_it->second->getFile(simplifyAbsolutePath(path.second));
+    queue_changed_.notify_all();
 }
 }  // namespace dw
@@ -5,103 +5,214 @@
 #pragma once
 
 #include "core/Collections.h"
+#include "core/Concurrency.h"
 #include "core/io/File.h"
 #include "resource/Resource.h"
+#include "resource/ResourceLocation.h"
+#include "resource/ResourcePackage.h"
 
 namespace dw {
-using ResourcePath = String;
+enum class ResourceLoadState { Loading, Loaded, Failed };
 
-Pair<String, Path> parseResourcePath(const ResourcePath& resource_path);
-
-class DW_API ResourceLocation {
+// A resource requested from the resource cache, shared between every handle to it.
+class DW_API ResourceLoad {
 public:
-    virtual ~ResourceLocation() = default;
-    virtual Result<SharedPtr<InputStream>> getFile(
-        const ResourcePath& path_within_location) = 0;
-};
+    ResourceLoad(ResourcePath path, SharedPtr<Resource> resource);
 
-class DW_API ResourcePackage : public Object, public ResourceLocation {
-public:
-    DW_OBJECT(ResourcePackage);
+    const ResourcePath& path() const;
+    ResourceLoadState state() const;
+
+    // True once the resource has either loaded or failed to load.
+    bool isReady() const;
+
+    // Reason that the resource failed to load. Only valid once the state is Failed.
+    const String& error() const;
 
-    ResourcePackage(Context* ctx, const Path& package);
+    // The resource, which is only safe to use once it has loaded.
+    const SharedPtr<Resource>& resource() const;
 
-    Result<SharedPtr<InputStream>> getFile(
-        const ResourcePath& path_within_location) override;
+private:
+    friend class ResourceCache;
+
+    ResourcePath path_;
+    SharedPtr<Resource> resource_;
+    Atomic<ResourceLoadState> state_;
+    String error_;
+    Atomic<u64> last_used_frame_;
+    ResourceFootprint footprint_;  // Updated every frame once loaded, guarded by the cache's mutex.
 };
 
-class DW_API ResourceFilesystemPath : public Object, public ResourceLocation {
+// A handle to a resource which may still be loading.
+template <typename T> class ResourceHandle {
 public:
-    DW_OBJECT(ResourceFilesystemPath);
+    ResourceHandle() = default;
+    explicit ResourceHandle(SharedPtr<ResourceLoad> load) : load_(std::move(load)) {
+    }
 
-    ResourceFilesystemPath(Context* ctx, const Path& path);
+    bool isValid() const {
+        return load_ != nullptr;
+    }
 
-    Result<SharedPtr<InputStream>> getFile(
-        const ResourcePath& path_within_location) override;
+    bool isReady() const {
+        return load_ && load_->isReady();
+    }
+
+    bool isLoaded() const {
+        return load_ && load_->state() == ResourceLoadState::Loaded;
+    }
+
+    // Returns the resource if it has loaded, otherwise nullptr.
+    SharedPtr<T> get() const {
+        return isLoaded() ? staticPointerCast<T>(load_->resource()) : nullptr;
+    }
+
+    const SharedPtr<ResourceLoad>& load() const {
+        return load_;
+    }
 
 private:
-    Path path_;
+    SharedPtr<ResourceLoad> load_;
+};
+
+// Memory used by the resident resources of a single type.
+struct ResourceTypeStats {
+    usize count = 0;
+    usize cpu_bytes = 0;
+    usize gpu_bytes = 0;
 };
 
+struct ResourceCacheStats {
+    u64 hits = 0;
+    u64 misses = 0;
+    u64 evictions = 0;
+    usize resident_bytes = 0;
+    HashMap<String, ResourceTypeStats> resident_by_type;
+};
+
+// Resources can be requested from multiple threads (for example, game sessions updated in
+// parallel). Resources are read and decoded on loader threads, then their renderer objects are
+// created in update(), or by any thread which waits for them. A thread which waits for a resource
+// runs queued loads itself rather than blocking, so that a load can't be left waiting on a thread
+// which is blocked (such as the main thread while sessions are updated in parallel).
+//
+// Each resource is only loaded once, however many threads request it, and resources which fail
+// to load are removed so that they can be requested again. Resources requested before the last
+// update() are looked up in a snapshot of the cache without taking the cache's lock. Copying the
+// snapshot pointer is not lock free, as the standard library guards atomic SharedPtr operations
+// with a striped lock, but it's held far more briefly than the cache's lock. Resources requested
+// since are looked up with the cache's lock held.
+//
+// The memory used by each resident resource is queried again in update(), as it can change after
+// loading (for example, as textures stream in). If a memory budget is set, update() then evicts
+// the least recently requested resources which no handle or other resource refers to, until the
+// resident resources fit within the budget.
 class DW_API ResourceCache : public Module {
 public:
     DW_OBJECT(ResourceCache);
 
-    ResourceCache(Context* context);
-    ~ResourceCache();
+    explicit ResourceCache(Context* context);
+    // If loader_threads is 0, loads only make progress when they are waited on or in update().
+    ResourceCache(Context* context, usize loader_threads);
+    ~ResourceCache() override;
 
     void addPath(const String& package, const Path& path);
     void addPackage(const String& package, UniquePtr<ResourcePackage> file);
 
     // Raw API to read resource data.
-    Result<SharedPtr<InputStream>> loadRaw(const ResourcePath &resource_path);
+    Result<SharedPtr<InputStream>> loadRaw(const ResourcePath& resource_path);
 
     template <typename T>
     SharedPtr<T> addCustomResource(const ResourcePath& resource_path, SharedPtr<T> resource) {
-        String name(resource_path);
-
         if (!resource) {
-            log().warn("NULL resource provided at {}. Skipping.", name);
+            log().warn("NULL resource provided at {}. Skipping.", resource_path);
             return nullptr;
         }
-
-        if (resource_cache_.find(name) != resource_cache_.end()) {
-            log().warn("Found an existing resource at {}. Replacing with an instance of '{}'", name,
-                       resource->typeName());
-        }
-        resource_cache_[name] = resource;
+        addLoadedResource(resource_path, resource);
         return resource;
     }
 
-    template <typename T> Result<SharedPtr<T>, String> get(const ResourcePath& resource_path) {
-        String name(resource_path);
-
-        // If the resource already exists, return it.
-        auto it = resource_cache_.find(name);
-        if (it != resource_cache_.end()) {
-            return staticPointerCast<T>((*it).second);
-        }
+    // Starts loading a resource in the background, or returns the existing load if the resource
+    // has already been requested.
+    template <typename T> ResourceHandle<T> getAsync(const ResourcePath& resource_path) {
+        return ResourceHandle<T>{findOrStartLoad(
+            resource_path, [this]() -> SharedPtr<Resource> { return makeShared<T>(context()); })};
+    }
 
-        // Load the file which contains this resource data.
-        auto resource_data = loadRaw(resource_path);
-        if (!resource_data) {
-            return makeError(str::format("Cannot find resource {}. Reason: {}", resource_path,
-                                resource_data.error()));
-        }
-        SharedPtr<T> resource = makeShared<T>(context());
-        resource_cache_.emplace(name, resource);
-        log().info("Loading asset '{}'", resource_path);
-        auto load_result = resource->load(resource_path, *resource_data.value().get());
-        if (!load_result) {
-            return makeError(str::format("Failed to load resource {}. Reason: {}", resource_path,
-                                load_result.error()));
+    // Loads a resource, blocking until it has finished loading.
+    template <typename T> Result<SharedPtr<T>, String> get(const ResourcePath& resource_path) {
+        auto handle = getAsync<T>(resource_path);
+        auto result = wait(*handle.load());
+        if (!result) {
+            return makeError(result.error());
         }
-        return resource;
+        return handle.get();
     }
 
-private:
+    // Blocks until a resource has finished loading, running and finishing queued loads in the
+    // meantime.
+    Result<void> wait(ResourceLoad& load);
 
-    Map<String, UniquePtr<ResourceLocation>> resource_packages_;
-    HashMap<String, SharedPtr<Resource>> resource_cache_;
+    // Finishes loads which have been read and decoded, by creating their renderer objects. Called
+    // once per frame on the main thread.
+    void update();
+
+    // Sets the maximum memory used by resident resources, CPU and GPU combined. 0 means no limit.
+    void setMemoryBudget(usize bytes);
+    usize memoryBudget() const;
+
+    ResourceCacheStats stats();
+
+private:
+    using ResourceMap = HashMap<String, SharedPtr<ResourceLoad>>;
+
+    RecursiveMutex mutex_;
+    Map<String, UniquePtr<ResourceLocation>> resource_packages_;  // Never removed.
+    ResourceMap resource_cache_;
+
+    // An immutable copy of resource_cache_ for lookups without mutex_. Only accessed through
+    // std::atomic_load() and std::atomic_store(). Readers hold a reference to the snapshot they're
+    // using, so a replaced snapshot is freed as soon as its last reader has finished with it.
+    //
+    // Copying the map is O(n), so new resources are only added to the snapshot once per update(),
+    // and are found in resource_cache_ until then. Removing or replacing a resource republishes
+    // the snapshot immediately, so that it never returns a load which the cache has dropped.
+    SharedPtr<const ResourceMap> snapshot_;
+    bool snapshot_stale_;  // Guarded by mutex_.
+
+    // Memory accounting, guarded by mutex_ except for the counters.
+    Atomic<usize> memory_budget_;
+    Atomic<u64> frame_;
+    Atomic<u64> hits_;
+    Atomic<u64> misses_;
+    u64 evictions_;
+    usize resident_bytes_;
+    HashMap<String, ResourceTypeStats> resident_by_type_;
+    bool over_budget_;
+
+    // Load queues, guarded by queue_mutex_. queue_generation_ changes whenever a queue changes or
+    // a load finishes, so that waiters don't miss any progress.
+    Vector<Thread> loader_threads_;
+    Mutex queue_mutex_;
+    ConditionVariable queue_changed_;
+    u64 queue_generation_;
+    bool stopping_;
+    Deque<SharedPtr<ResourceLoad>> pending_begin_load_;
+    Vector<SharedPtr<ResourceLoad>> pending_end_load_;
+
+    SharedPtr<ResourceLoad> findInSnapshot(const ResourcePath& resource_path);
+    void publishSnapshot();
+    SharedPtr<ResourceLoad> findOrStartLoad(const ResourcePath& resource_path,
+                                            const Function<SharedPtr<Resource>()>& create);
+    void addLoadedResource(const ResourcePath& resource_path, SharedPtr<Resource> resource);
+    void addResident(ResourceLoad& load);
+    void removeResident(ResourceLoad& load);
+    void updateFootprints();
+    void evictUnusedResources();
+
+    void loaderMain();
+    void beginLoad(const SharedPtr<ResourceLoad>& load);
+    usize endLoads();
+    bool tryEndLoad(ResourceLoad& load);
+    void finishLoad(ResourceLoad& load, ResourceLoadState state, String error = "");
 };
 }  // namespace dw
@@ -0,0 +1,300 @@
+/*
+ * Dawn Engine
+ * Written by David Avedissian (c) 2012-2019 (git@dga.dev)
+ */
+#include "Testing.h"
+#include "core/ThreadPool.h"
+#include "core/io/File.h"
+#include "resource/ResourceCache.h"
+
+#include <chrono>
+
+namespace {
+dw::Atomic<int> begin_load_count{0};
+
+// A resource containing a string. A resource with the contents "depends:<path>" depends on the
+// resource at <path>, and one containing "fail" fails to load.
+class TestResource : public dw::Resource {
+public:
+    DW_OBJECT(TestResource);
+
+    explicit TestResource(dw::Context* ctx) : dw::Resource(ctx) {
+    }
+
+    dw::Result<void> beginLoad(const dw::String&, dw::InputStream& src) override {
+        begin_load_thread = std::this_thread::get_id();
+        begin_load_count++;
+        contents = dw::stream::read<dw::String>(src);
+        if (contents == "fail") {
+            return dw::makeError("Failed on purpose.");
+        }
+        if (contents.find("depends:") == 0) {
+            dependency = module<dw::ResourceCache>()->getAsync<TestResource>(contents.substr(8));
+            addDependency(dependency);
+        }
+        return dw::Result<void>();
+    }
+
+    dw::Result<void> endLoad() override {
+        end_load_thread = std::this_thread::get_id();
+        dependency_loaded_first = !dependency.isValid() || dependency.isLoaded();
+        return dw::Result<void>();
+    }
+
+    dw::ResourceFootprint footprint() const override {
+        dw::ResourceFootprint footprint;
+        footprint.cpu_bytes = contents.size();
+        return footprint;
+    }
+
+    dw::String contents;
+    dw::ResourceHandle<TestResource> dependency;
+    std::thread::id begin_load_thread;
+    std::thread::id end_load_thread;
+    bool dependency_loaded_first = false;
+};
+}  // namespace
+
+class ResourceCacheTest : public ::testing::Test {
+public:
+    void SetUp() override {
+        context_ = new dw::Context("", "");
+        context_->addModule<dw::Logger>();
+        context_->addModule<dw::FileSystem>();
+        writeFile("a", "contents of a");
+        writeFile("b", "depends:test:resource_cache_test_a");
+        writeFile("c", "depends:test:resource_cache_test_fail");
+        writeFile("fail", "fail");
+        writeFile("x", "0123456789");
+        writeFile("y", "abcdefghij");
+    }
+
+    void TearDown() override {
+        context_->removeModule<dw::ResourceCache>();
+        for (auto name : {"a", "b", "c", "fail", "x", "y"}) {
+            context_->module<dw::FileSystem>()->deleteFile(tempPath(name));
+        }
+    }
+
+    dw::ResourceCache* createCache(dw::usize loader_threads) {
+        auto* cache = context_->addModule<dw::ResourceCache>(loader_threads);
+        cache->addPath("test", context_->module<dw::FileSystem>()->tempDir());
+        return cache;
+    }
+
+    // Calls update() until a resource is ready, as the engine does each frame.
+    void updateUntilReady(dw::ResourceCache* cache, const dw::ResourceLoad& load) {
+        auto start = std::chrono::steady_clock::now();
+        while (!load.isReady() &&
+               std::chrono::steady_clock::now() - start < std::chrono::seconds(10)) {
+            cache->update();
+            std::this_thread::yield();
+        }
+    }
+
+protected:
+    dw::Context* context_;
+
+    dw::Path tempPath(const dw::String& name) {
+        return context_->module<dw::FileSystem>()->tempDir() + "/resource_cache_test_" + name;
+    }
+
+    void writeFile(const dw::String& name, const dw::String& contents) {
+        dw::File file(context_, tempPath(name), dw::FileMode::Write);
+        file.writeData(contents.data(), contents.size());
+    }
+};
+
+TEST_F(ResourceCacheTest, GetLoadsImmediately) {
+    auto* cache = createCache(0);
+    auto resource = cache->get<TestResource>("test:resource_cache_test_a");
+    ASSERT_TRUE(resource);
+    EXPECT_TRUE((*resource)->hasLoaded());
+    EXPECT_EQ("contents of a", (*resource)->contents);
+    EXPECT_EQ(std::this_thread::get_id(), (*resource)->end_load_thread);
+}
+
+TEST_F(ResourceCacheTest, GetAsyncFinishesOnMainThread) {
+    auto* cache = createCache(2);
+    auto handle = cache->getAsync<TestResource>("test:resource_cache_test_a");
+    updateUntilReady(cache, *handle.load());
+    ASSERT_TRUE(handle.isLoaded());
+    EXPECT_EQ("contents of a", handle.get()->contents);
+    EXPECT_NE(std::this_thread::get_id(), handle.get()->begin_load_thread);
+    EXPECT_EQ(std::this_thread::get_id(), handle.get()->end_load_thread);
+}
+
+TEST_F(ResourceCacheTest, GetFinishesOnWorkerThreads) {
+    // The main thread is blocked while the workers wait, as it is while sessions are updated in
+    // parallel, so the workers must finish loads themselves. parallelFor runs tasks on the calling
+    // thread too, so it's called from another thread.
+    auto* cache = createCache(2);
+    dw::ThreadPool pool(2);
+    dw::Vector<dw::String> contents(4);
+    dw::Thread thread([&]() {
+        pool.parallelFor(contents.size(), [&](dw::usize i) {
+            auto resource = cache->get<TestResource>(i % 2 == 0 ? "test:resource_cache_test_a"
+                                                                : "test:resource_cache_test_b");
+            if (resource) {
+                contents[i] = (*resource)->contents;
+            }
+        });
+    });
+    thread.join();
+    EXPECT_EQ("contents of a", contents[0]);
+    EXPECT_EQ("depends:test:resource_cache_test_a", contents[1]);
+    EXPECT_EQ(contents[0], contents[2]);
+    EXPECT_EQ(contents[1], contents[3]);
+}
+
+TEST_F(ResourceCacheTest, SharesLoadsOfTheSameResource) {
+    auto* cache = createCache(2);
+    auto first = cache->getAsync<TestResource>("test:resource_cache_test_a");
+    auto second = cache->getAsync<TestResource>("test:resource_cache_test_a");
+    EXPECT_EQ(first.load(), second.load());
+    updateUntilReady(cache, *first.load());
+    EXPECT_EQ(first.get(), second.get());
+}
+
+TEST_F(ResourceCacheTest, DependenciesLoadFirst) {
+    auto* cache = createCache(2);
+    auto handle = cache->getAsync<TestResource>("test:resource_cache_test_b");
+    updateUntilReady(cache, *handle.load());
+    ASSERT_TRUE(handle.isLoaded());
+    EXPECT_TRUE(handle.get()->dependency_loaded_first);
+    EXPECT_EQ("contents of a", handle.get()->dependency.get()->contents);
+}
+
+TEST_F(ResourceCacheTest, FailedDependencyFailsResource) {
+    auto* cache = createCache(0);
+    auto resource = cache->get<TestResource>("test:resource_cache_test_c");
+    EXPECT_FALSE(resource);
+}
+
+TEST_F(ResourceCacheTest, MissingResourceFails) {
+    auto* cache = createCache(2);
+    auto handle = cache->getAsync<TestResource>("test:resource_cache_test_missing");
+    EXPECT_FALSE(cache->wait(*handle.load()));
+    EXPECT_TRUE(handle.isReady());
+    EXPECT_FALSE(handle.isLoaded());
+    EXPECT_EQ(nullptr, handle.get());
+}
+
+TEST_F(ResourceCacheTest, FailedLoadsCanBeRetried) {
+    auto* cache = createCache(2);
+    EXPECT_FALSE(cache->get<TestResource>("test:resource_cache_test_late"));
+
+    // Once the resource exists, requesting it again should load it.
+    writeFile("late", "contents of late");
+    auto resource = cache->get<TestResource>("test:resource_cache_test_late");
+    context_->module<dw::FileSystem>()->deleteFile(tempPath("late"));
+    ASSERT_TRUE(resource);
+    EXPECT_EQ("contents of late", (*resource)->contents);
+}
+
+TEST_F(ResourceCacheTest, ConcurrentRequestsLoadOnce) {
+    auto* cache = createCache(2);
+    begin_load_count = 0;
+    dw::Vector<dw::SharedPtr<dw::ResourceLoad>> loads(8);
+    dw::Vector<dw::Thread> threads;
+    for (dw::usize i = 0; i < loads.size(); ++i) {
+        threads.emplace_back([cache, &loads, i]() {
+            for (int j = 0; j < 100; ++j) {
+                auto handle = cache->getAsync<TestResource>("test:resource_cache_test_a");
+                if (j == 0) {
+                    loads[i] = handle.load();
+                } else {
+                    EXPECT_EQ(loads[i], handle.load());
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    for (auto& load : loads) {
+        EXPECT_EQ(loads[0], load);
+    }
+    updateUntilReady(cache, *loads[0]);
+    EXPECT_EQ(dw::ResourceLoadState::Loaded, loads[0]->state());
+    EXPECT_EQ(1, begin_load_count);
+}
+
+TEST_F(ResourceCacheTest, StatsCountHitsMissesAndResidentMemory) {
+    auto* cache = createCache(0);
+    ASSERT_TRUE(cache->get<TestResource>("test:resource_cache_test_x"));
+    ASSERT_TRUE(cache->get<TestResource>("test:resource_cache_test_x"));
+    ASSERT_TRUE(cache->get<TestResource>("test:resource_cache_test_y"));
+    auto stats = cache->stats();
+    EXPECT_EQ(1, stats.hits);
+    EXPECT_EQ(2, stats.misses);
+    EXPECT_EQ(20, stats.resident_bytes);
+    auto& type_stats = stats.resident_by_type[TestResource::typeNameStatic()];
+    EXPECT_EQ(2, type_stats.count);
+    EXPECT_EQ(20, type_stats.cpu_bytes);
+    EXPECT_EQ(0, type_stats.gpu_bytes);
+}
+
+TEST_F(ResourceCacheTest, EvictsLeastRecentlyUsedResources) {
+    auto* cache = createCache(0);
+    ASSERT_TRUE(cache->get<TestResource>("test:resource_cache_test_x"));
+    cache->update();
+    ASSERT_TRUE(cache->get<TestResource>("test:resource_cache_test_y"));
+    cache->update();
+
+    // Only one resource fits in the budget, so the least recently used one is evicted.
+    cache->setMemoryBudget(15);
+    cache->update();
+    auto stats = cache->stats();
+    EXPECT_EQ(1, stats.evictions);
+    EXPECT_EQ(10, stats.resident_bytes);
+
+    // Requesting the evicted resource loads it again, and evicts the other one.
+    ASSERT_TRUE(cache->get<TestResource>("test:resource_cache_test_x"));
+    EXPECT_EQ(3, cache->stats().misses);
+    cache->update();
+    EXPECT_EQ(2, cache->stats().evictions);
+    EXPECT_EQ(10, cache->stats().resident_bytes);
+}
+
+TEST_F(ResourceCacheTest, ReferencedResourcesAreNotEvicted) {
+    auto* cache = createCache(0);
+    auto x = cache->get<TestResource>("test:resource_cache_test_x");
+    ASSERT_TRUE(x);
+    cache->setMemoryBudget(1);
+    cache->update();
+    EXPECT_EQ(0, cache->stats().evictions);
+    EXPECT_EQ(10, cache->stats().resident_bytes);
+
+    // Once released, the resource can be evicted.
+    x = dw::SharedPtr<TestResource>();
+    cache->update();
+    EXPECT_EQ(1, cache->stats().evictions);
+    EXPECT_EQ(0, cache->stats().resident_bytes);
+}
+
+TEST_F(ResourceCacheTest, ResourcesWithHandlesAreNotEvicted) {
+    auto* cache = createCache(0);
+    auto x = cache->getAsync<TestResource>("test:resource_cache_test_x");
+    ASSERT_TRUE(cache->wait(*x.load()));
+    cache->setMemoryBudget(1);
+    cache->update();
+    EXPECT_EQ(0, cache->stats().evictions);
+    EXPECT_EQ(10, cache->stats().resident_bytes);
+
+    x = dw::ResourceHandle<TestResource>();
+    cache->update();
+    EXPECT_EQ(1, cache->stats().evictions);
+}
+
+TEST_F(ResourceCacheTest, ResidentMemoryFollowsFootprintChanges) {
+    auto* cache = createCache(0);
+    auto x = cache->get<TestResource>("test:resource_cache_test_x");
+    ASSERT_TRUE(x);
+    EXPECT_EQ(10, cache->stats().resident_bytes);
+
+    (*x)->contents += "0123456789";
+    cache->update();
+    EXPECT_EQ(20, cache->stats().resident_bytes);
+    EXPECT_EQ(20, cache->stats().resident_by_type[TestResource::typeNameStatic()].cpu_bytes);
+}
@@ -0,0 +1,32 @@
+/*
+ * Dawn Engine
+ * Written by David Avedissian (c) 2012-2019 (git@dga.dev)
+ */
+#include "Base.h"
+#include "core/io/File.h"
+#include "core/io/FileSystem.h"
+#include "resource/ResourceLocation.h"
+
+namespace dw {
+Pair<String, Path> parseResourcePath(const ResourcePath& resource_path) {
+    auto split_point = resource_path.find(':');
+    if (split_point == String::npos) {
+        return {"unknown_package", ""};
+    }
+    return {resource_path.substr(0, split_point), "/" + resource_path.substr(split_point + 1)};
+}
+
+ResourceFilesystemPath::ResourceFilesystemPath(Context* ctx, const Path& path)
+    : Object(ctx), path_{path} {
+}
+
+Result<SharedPtr<InputStream>> ResourceFilesystemPath::getFile(
+    const ResourcePath& path_within_location) {
+    Path full_path = path_ + path_within_location;
+    log().info("Loading resource from filesystem at " + full_path);
+    if (module<FileSystem>()->fileExists(full_path)) {
+        return {makeShared<File>(context(), full_path, FileMode::Read)};
+    }
+    return makeError(str::format("File {} does not exist.", full_path));
+}
+}  // namespace dw
@@ -0,0 +1,34 @@
+/*
+ * Dawn Engine
+ * Written by David Avedissian (c) 2012-2019 (git@dga.dev)
+ */
+#pragma once
+
+#include "core/Collections.h"
+#include "core/io/InputStream.h"
+
+namespace dw {
+using ResourcePath = String;
+
+Pair<String, Path> parseResourcePath(const ResourcePath& resource_path);
+
+class DW_API ResourceLocation {
+public:
+    virtual ~ResourceLocation() = default;
+    virtual Result<SharedPtr<InputStream>> getFile(
+        const ResourcePath& path_within_location) = 0;
+};
+
+class DW_API ResourceFilesystemPath : public Object, public ResourceLocation {
+public:
+    DW_OBJECT(ResourceFilesystemPath);
+
+    ResourceFilesystemPath(Context* ctx, const Path& path);
+
+    Result<SharedPtr<InputStream>> getFile(
+        const ResourcePath& path_within_location) override;
+
+private:
+    Path path_;
+};
+}  // namespace dw
@@ -0,0 +1,351 @@
+/*
+ * Dawn Engine
+ * Written by David Avedissian (c) 2012-2019 (git@dga.dev)
+ */
+#include "Base.h"
+#include "core/io/MemoryInputStream.h"
+#include "resource/ResourcePackage.h"
+
+#include <lz4.h>
+
+#include <algorithm>
+
+namespace dw {
+namespace {
+const u32 package_magic = 0x4b505744;  // "DWPK"
+const u32 package_version = 1;
+
+struct PackageHeader {
+    u32 magic;
+    u32 version;
+    u32 entry_count;
+    u32 alignment;
+    u64 toc_offset;
+    u64 path_table_offset;
+    u64 path_table_size;
+};
+static_assert(sizeof(PackageHeader) == 40, "PackageHeader must match the file format.");
+
+// 64-bit FNV-1a. The hash is part of the file format, so it must never change.
+u64 packagePathHash(const ResourcePath& path) {
+    u64 hash = 0xcbf29ce484222325ull;
+    for (char c : path) {
+        hash ^= static_cast<u8>(c);
+        hash *= 0x100000001b3ull;
+    }
+    return hash;
+}
+
+// LZ4 can't expand data by more than this ratio, which bounds the memory allocated for a
+// compressed file by the size of the package.
+const u64 lz4_max_expansion = 255;
+}  // namespace
+
+struct PackageTocEntry {
+    u64 path_hash;
+    u64 offset;       // Offset of the data from the start of the package.
+    u64 stored_size;  // Size of the data in the package.
+    u64 size;         // Size of the data once decompressed.
+    u32 path_offset;  // Offset of the path within the path table.
+    u32 path_length;
+    u32 compression;
+    u32 reserved;
+};
+static_assert(sizeof(PackageTocEntry) == 48, "TocEntry must match the file format.");
+
+namespace {
+bool isValidEntry(const PackageTocEntry& entry, u64 file_size, u64 path_table_size) {
+    if (entry.stored_size > file_size || entry.offset > file_size - entry.stored_size ||
+        u64(entry.path_offset) + entry.path_length > path_table_size) {
+        return false;
+    }
+    switch (static_cast<PackageCompression>(entry.compression)) {
+        case PackageCompression::None:
+            return entry.size == entry.stored_size;
+        case PackageCompression::LZ4:
+            // The writer never compresses files which LZ4 can't, so the sizes always fit in an int.
+            return entry.size <= static_cast<u64>(LZ4_MAX_INPUT_SIZE) &&
+                   entry.stored_size <= static_cast<u64>(LZ4_COMPRESSBOUND(LZ4_MAX_INPUT_SIZE)) &&
+                   entry.size <= entry.stored_size * lz4_max_expansion;
+        default:
+            // Reported when the file is read.
+            return true;
+    }
+}
+}  // namespace
+
+ResourcePackage::ResourcePackage(Context* ctx, const Path& package)
+    : Object(ctx),
+      path_(package),
+      file_(makeShared<MappedFile>(ctx)),
+      toc_(nullptr),
+      toc_size_(0),
+      path_table_(nullptr) {
+    if (!file_->open(package)) {
+        return;
+    }
+    PackageHeader header;
+    if (file_->size() < sizeof(PackageHeader)) {
+        log().error("Resource package {} is truncated.", package);
+        file_->close();
+        return;
+    }
+    memcpy(&header, file_->data(), sizeof(PackageHeader));
+    if (header.magic != package_magic || header.version != package_version) {
+        log().error("{} is not a resource package, or has an unsupported version.", package);
+        file_->close();
+        return;
+    }
+    u64 toc_size = u64(header.entry_count) * sizeof(PackageTocEntry);
+    if (header.toc_offset % alignof(PackageTocEntry) != 0 || header.toc_offset > file_->size() ||
+        toc_size > file_->size() - header.toc_offset ||
+        header.path_table_offset > file_->size() ||
+        header.path_table_size > file_->size() - header.path_table_offset) {
+        log().error("Resource package {} is corrupt.", package);
+        file_->close();
+        return;
+    }
+
+    // The TOC is aligned within the file, and the mapping is page aligned, so it can be read in
+    // place.
+    toc_ = reinterpret_cast<const PackageTocEntry*>(file_->data() + header.toc_offset);
+    toc_size_ = header.entry_count;
+    path_table_ = reinterpret_cast<const char*>(file_->data() + header.path_table_offset);
+    for (usize i = 0; i < toc_size_; ++i) {
+        if (!isValidEntry(toc_[i], file_->size(), header.path_table_size)) {
+            log().error("Resource package {} is corrupt.", package);
+            toc_ = nullptr;
+            toc_size_ = 0;
+            file_->close();
+            return;
+        }
+    }
+}
+
+Result<SharedPtr<InputStream>> ResourcePackage::getFile(const ResourcePath& path_within_location) {
+    if (!isOpen()) {
+        return makeError(str::format("Resource package {} failed to open.", path_));
+    }
+    auto* entry = findEntry(path_within_location);
+    if (!entry) {
+        return makeError(
+            str::format("File {} does not exist in package {}.", path_within_location, path_));
+    }
+    const byte* data = file_->data() + entry->offset;
+    switch (static_cast<PackageCompression>(entry->compression)) {
+        case PackageCompression::None:
+            return {makeShared<MemoryInputStream>(data, static_cast<usize>(entry->size), file_)};
+        case PackageCompression::LZ4: {
+            Vector<byte> decompressed(static_cast<usize>(entry->size));
+            int result = LZ4_decompress_safe(reinterpret_cast<const char*>(data),
+                                             reinterpret_cast<char*>(decompressed.data()),
+                                             static_cast<int>(entry->stored_size),
+                                             static_cast<int>(entry->size));
+            if (result < 0 || static_cast<u64>(result) != entry->size) {
+                return makeError(str::format("Failed to decompress {} in package {}.",
+                                             path_within_location, path_));
+            }
+            return {makeShared<MemoryInputStream>(std::move(decompressed))};
+        }
+        default:
+            return makeError(str::format("File {} in package {} has unknown compression {}.",
+                                         path_within_location, path_, entry->compression));
+    }
+}
+
+bool ResourcePackage::isOpen() const {
+    return file_->isOpen();
+}
+
+bool ResourcePackage::contains(const ResourcePath& path_within_location) const {
+    return findEntry(path_within_location) != nullptr;
+}
+
+usize ResourcePackage::fileCount() const {
+    return toc_size_;
+}
+
+const PackageTocEntry* ResourcePackage::findEntry(const ResourcePath& path_within_location) const {
+    if (!toc_) {
+        return nullptr;
+    }
+    u64 hash = packagePathHash(path_within_location);
+    auto* end = toc_ + toc_size_;
+    auto* it = std::lower_bound(
+        toc_, end, hash, [](const PackageTocEntry& entry, u64 h) { return entry.path_hash < h; });
+    for (; it != end && it->path_hash == hash; ++it) {
+        if (path_within_location.size() == it->path_length &&
+            path_within_location.compare(0, it->path_length, path_table_ + it->path_offset,
+                                         it->path_length) == 0) {
+            return it;
+        }
+    }
+    return nullptr;
+}
+
+ResourcePackageWriter::ResourcePackageWriter(Context* ctx) : Object(ctx), alignment_(16) {
+}
+
+ResourcePackageWriter::~ResourcePackageWriter() {
+    if (file_) {
+        auto result = close();
+        if (!result) {
+            log().error("Failed to write resource package: {}", result.error());
+        }
+    }
+}
+
+Result<void> ResourcePackageWriter::open(const Path& path, u32 alignment) {
+    if (alignment == 0 || (alignment & (alignment - 1)) != 0) {
+        return makeError(str::format("Alignment {} is not a power of two.", alignment));
+    }
+    file_ = makeUnique<File>(context());
+    if (!file_->open(path, FileMode::Write)) {
+        file_.reset();
+        return makeError(str::format("Unable to create resource package {}.", path));
+    }
+    path_ = path;
+    alignment_ = alignment;
+    entries_.clear();
+    paths_.clear();
+
+    // The header is written once the TOC is known.
+    PackageHeader header = {};
+    if (!write(&header, sizeof(PackageHeader))) {
+        return writeFailed();
+    }
+    return Result<void>();
+}
+
+Result<void> ResourcePackageWriter::add(const ResourcePath& path_within_location,
+                                       const byte* data, usize size,
+                                       PackageCompression compression) {
+    if (!file_) {
+        return makeError("Resource package is not open.");
+    }
+    if (!paths_.insert(path_within_location).second) {
+        return makeError(
+            str::format("File {} was added more than once.", path_within_location));
+    }
+
+    Vector<byte> compressed;
+    if (compression == PackageCompression::LZ4) {
+        if (size > static_cast<usize>(LZ4_MAX_INPUT_SIZE)) {
+            compression = PackageCompression::None;
+        } else {
+            compressed.resize(static_cast<usize>(LZ4_compressBound(static_cast<int>(size))));
+            int compressed_size = LZ4_compress_default(
+                reinterpret_cast<const char*>(data), reinterpret_cast<char*>(compressed.data()),
+                static_cast<int>(size), static_cast<int>(compressed.size()));
+            if (compressed_size <= 0 || static_cast<usize>(compressed_size) >= size) {
+                compression = PackageCompression::None;
+            } else {
+                compressed.resize(static_cast<usize>(compressed_size));
+            }
+        }
+    }
+
+    if (!pad(alignment_)) {
+        return writeFailed();
+    }
+    PendingEntry entry;
+    entry.path_hash = packagePathHash(path_within_location);
+    entry.path = path_within_location;
+    entry.offset = file_->position();
+    entry.size = size;
+    entry.compression = compression;
+    bool written;
+    if (compression == PackageCompression::None) {
+        entry.stored_size = size;
+        written = write(data, size);
+    } else {
+        entry.stored_size = compressed.size();
+        written = write(compressed.data(), compressed.size());
+    }
+    if (!written) {
+        return writeFailed();
+    }
+    entries_.emplace_back(std::move(entry));
+    return Result<void>();
+}
+
+Result<void> ResourcePackageWriter::close() {
+    if (!file_) {
+        return makeError("Resource package is not open.");
+    }
+
+    std::sort(entries_.begin(), entries_.end(), [](const PendingEntry& a, const PendingEntry& b) {
+        return a.path_hash != b.path_hash ? a.path_hash < b.path_hash : a.path < b.path;
+    });
+
+    // Write the TOC, building the path table as we go.
+    if (!pad(alignof(PackageTocEntry))) {
+        return writeFailed();
+    }
+    PackageHeader header;
+    header.magic = package_magic;
+    header.version = package_version;
+    header.entry_count = static_cast<u32>(entries_.size());
+    header.alignment = alignment_;
+    header.toc_offset = file_->position();
+    String path_table;
+    for (auto& pending : entries_) {
+        PackageTocEntry entry;
+        entry.path_hash = pending.path_hash;
+        entry.offset = pending.offset;
+        entry.stored_size = pending.stored_size;
+        entry.size = pending.size;
+        entry.path_offset = static_cast<u32>(path_table.size());
+        entry.path_length = static_cast<u32>(pending.path.size());
+        entry.compression = static_cast<u32>(pending.compression);
+        entry.reserved = 0;
+        if (!write(&entry, sizeof(entry))) {
+            return writeFailed();
+        }
+        path_table += pending.path;
+    }
+    header.path_table_offset = file_->position();
+    header.path_table_size = path_table.size();
+    if (!write(path_table.data(), path_table.size())) {
+        return writeFailed();
+    }
+
+    file_->seek(0);
+    if (!write(&header, sizeof(PackageHeader)) || !file_->close()) {
+        return writeFailed();
+    }
+    file_.reset();
+    entries_.clear();
+    paths_.clear();
+    return Result<void>();
+}
+
+bool ResourcePackageWriter::isOpen() const {
+    return file_ != nullptr;
+}
+
+bool ResourcePackageWriter::write(const void* data, usize size) {
+    return file_->writeData(data, size) == size;
+}
+
+bool ResourcePackageWriter::pad(usize alignment) {
+    static const byte zeroes[64] = {};
+    usize remainder = file_->position() % alignment;
+    usize padding = remainder == 0 ? 0 : alignment - remainder;
+    while (padding > 0) {
+        usize chunk = std::min(padding, sizeof(zeroes));
+        if (!write(zeroes, chunk)) {
+            return false;
+        }
+        padding -= chunk;
+    }
+    return true;
+}
+
+Result<void> ResourcePackageWriter::writeFailed() {
+    file_.reset();
+    entries_.clear();
+    paths_.clear();
+    return makeError(str::format("Unable to write to resource package {}.", path_));
+}
+}  // namespace dw
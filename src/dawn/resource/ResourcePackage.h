@@ -0,0 +1,102 @@
+/*
+ * Dawn Engine
+ * Written by David Avedissian (c) 2012-2019 (git@dga.dev)
+ */
+#pragma once
+
+#include "core/io/File.h"
+#include "core/io/MappedFile.h"
+#include "resource/ResourceLocation.h"
+
+namespace dw {
+// A resource package is a single file containing many resources, so that loading them doesn't
+// need a file open for each one. The file is laid out as:
+//
+//   Header: magic, version, entry count, entry alignment, offsets of the TOC and path table.
+//   Entries: the data of each file, each starting at a multiple of the entry alignment.
+//   Table of contents (TOC): one record per file, sorted by the hash of its path.
+//   Path table: the path of each file, used to resolve hash collisions.
+//
+// A package is mapped into memory once, files are found by binary searching the TOC in place,
+// and uncompressed files are read straight out of the mapping without copying. All values are
+// little endian.
+const char* const resource_package_extension = ".dwpk";
+
+// Compression applied to a single file within a package.
+enum class PackageCompression : u32 { None = 0, LZ4 = 1 };
+
+// A TOC record, as stored in the package.
+struct PackageTocEntry;
+
+class DW_API ResourcePackage : public Object, public ResourceLocation {
+public:
+    DW_OBJECT(ResourcePackage);
+
+    // Maps a package into memory. If it can't be opened, errors are logged and every file will
+    // fail to load.
+    ResourcePackage(Context* ctx, const Path& package);
+
+    Result<SharedPtr<InputStream>> getFile(
+        const ResourcePath& path_within_location) override;
+
+    bool isOpen() const;
+    bool contains(const ResourcePath& path_within_location) const;
+    usize fileCount() const;
+
+private:
+    Path path_;
+    SharedPtr<MappedFile> file_;
+    const PackageTocEntry* toc_;
+    usize toc_size_;
+    const char* path_table_;
+
+    const PackageTocEntry* findEntry(const ResourcePath& path_within_location) const;
+};
+
+// Writes a resource package. Files are written as they're added, and the TOC is written when the
+// package is closed.
+class DW_API ResourcePackageWriter : public Object {
+public:
+    DW_OBJECT(ResourcePackageWriter);
+
+    ResourcePackageWriter(Context* ctx);
+    ~ResourcePackageWriter();
+
+    // Creates a package. Each file will start at a multiple of alignment, which must be a power
+    // of two.
+    Result<void> open(const Path& path, u32 alignment = 16);
+
+    // Adds a file to the package at a path such as "/textures/ship.png". Compressed files which
+    // don't get any smaller are stored uncompressed. Fails if the path was already added.
+    Result<void> add(const ResourcePath& path_within_location, const byte* data, usize size,
+                     PackageCompression compression = PackageCompression::None);
+
+    // Writes the TOC and closes the file.
+    Result<void> close();
+
+    // If open(), add() or close() fails to write to the file, the package is left incomplete and
+    // closed.
+
+    bool isOpen() const;
+
+private:
+    struct PendingEntry {
+        u64 path_hash;
+        ResourcePath path;
+        u64 offset;
+        u64 stored_size;
+        u64 size;
+        PackageCompression compression;
+    };
+
+    Path path_;
+    UniquePtr<File> file_;
+    u32 alignment_;
+    Vector<PendingEntry> entries_;
+    HashSet<ResourcePath> paths_;
+
+    bool write(const void* data, usize size);
+    bool pad(usize alignment);
+    Result<void> writeFailed();
+};
+}  // namespace dw
@@ -0,0 +1,171 @@
+/*
+ * Dawn Engine
+ * Written by David Avedissian (c) 2012-2019 (git@dga.dev)
+ */
+#include "Testing.h"
+#include "core/io/File.h"
+#include "core/io/MemoryInputStream.h"
+#include "resource/ResourcePackage.h"
+
+class ResourcePackageTest : public ::testing::Test {
+public:
+    void SetUp() override {
+        context_ = new dw::Context("", "");
+        context_->addModule<dw::Logger>();
+        context_->addModule<dw::FileSystem>();
+        package_path_ = context_->module<dw::FileSystem>()->tempDir() + "/package_test.dwpk";
+    }
+
+    void TearDown() override {
+        context_->module<dw::FileSystem>()->deleteFile(package_path_);
+    }
+
+    dw::String readFile(dw::ResourcePackage& package, const dw::ResourcePath& path) {
+        auto stream = package.getFile(path);
+        EXPECT_TRUE(stream);
+        if (!stream) {
+            return "";
+        }
+        auto data = (*stream)->readAll();
+        EXPECT_TRUE(data);
+        return dw::String(data->begin(), data->end());
+    }
+
+protected:
+    dw::Context* context_;
+    dw::Path package_path_;
+};
+
+TEST_F(ResourcePackageTest, WriteThenRead) {
+    dw::String a = "first file", b = "second file";
+    {
+        dw::ResourcePackageWriter writer(context_);
+        ASSERT_TRUE(writer.open(package_path_));
+        ASSERT_TRUE(writer.add("/a.txt", reinterpret_cast<const dw::byte*>(a.data()), a.size()));
+        ASSERT_TRUE(
+            writer.add("/dir/b.txt", reinterpret_cast<const dw::byte*>(b.data()), b.size()));
+        ASSERT_TRUE(writer.close());
+    }
+
+    dw::ResourcePackage package(context_, package_path_);
+    ASSERT_TRUE(package.isOpen());
+    EXPECT_EQ(2, package.fileCount());
+    EXPECT_TRUE(package.contains("/a.txt"));
+    EXPECT_TRUE(package.contains("/dir/b.txt"));
+    EXPECT_EQ(a, readFile(package, "/a.txt"));
+    EXPECT_EQ(b, readFile(package, "/dir/b.txt"));
+}
+
+TEST_F(ResourcePackageTest, MissingFile) {
+    {
+        dw::ResourcePackageWriter writer(context_);
+        ASSERT_TRUE(writer.open(package_path_));
+        ASSERT_TRUE(writer.add("/a.txt", reinterpret_cast<const dw::byte*>("a"), 1));
+    }
+
+    dw::ResourcePackage package(context_, package_path_);
+    EXPECT_FALSE(package.contains("/b.txt"));
+    EXPECT_FALSE(package.getFile("/b.txt"));
+}
+
+TEST_F(ResourcePackageTest, FilesAreAligned) {
+    {
+        dw::ResourcePackageWriter writer(context_);
+        ASSERT_TRUE(writer.open(package_path_, 64));
+        ASSERT_TRUE(writer.add("/a", reinterpret_cast<const dw::byte*>("abc"), 3));
+        ASSERT_TRUE(writer.add("/b", reinterpret_cast<const dw::byte*>("defgh"), 5));
+        ASSERT_TRUE(writer.close());
+    }
+
+    dw::ResourcePackage package(context_, package_path_);
+    for (auto path : {"/a", "/b"}) {
+        auto stream = package.getFile(path);
+        ASSERT_TRUE(stream);
+        auto* memory = dynamic_cast<dw::MemoryInputStream*>(stream->get());
+        ASSERT_NE(nullptr, memory);
+        EXPECT_EQ(0, reinterpret_cast<dw::uintptr>(memory->data()) % 64);
+    }
+}
+
+TEST_F(ResourcePackageTest, CompressedFiles) {
+    dw::String repetitive(4096, 'x');
+    dw::String short_string = "xyz";
+    {
+        dw::ResourcePackageWriter writer(context_);
+        ASSERT_TRUE(writer.open(package_path_));
+        ASSERT_TRUE(writer.add("/repetitive",
+                               reinterpret_cast<const dw::byte*>(repetitive.data()),
+                               repetitive.size(), dw::PackageCompression::LZ4));
+        ASSERT_TRUE(writer.add("/short", reinterpret_cast<const dw::byte*>(short_string.data()),
+                               short_string.size(), dw::PackageCompression::LZ4));
+        ASSERT_TRUE(writer.close());
+    }
+
+    // The compressed file should be much smaller than the original.
+    {
+        dw::File file(context_, package_path_, dw::FileMode::Read);
+        EXPECT_LT(file.size(), repetitive.size());
+    }
+
+    dw::ResourcePackage package(context_, package_path_);
+    EXPECT_EQ(repetitive, readFile(package, "/repetitive"));
+    EXPECT_EQ(short_string, readFile(package, "/short"));
+}
+
+TEST_F(ResourcePackageTest, DuplicateFilesAreRejected) {
+    dw::ResourcePackageWriter writer(context_);
+    ASSERT_TRUE(writer.open(package_path_));
+    ASSERT_TRUE(writer.add("/a", reinterpret_cast<const dw::byte*>("a"), 1));
+    EXPECT_FALSE(writer.add("/a", reinterpret_cast<const dw::byte*>("b"), 1));
+    ASSERT_TRUE(writer.close());
+
+    // The package is still usable.
+    dw::ResourcePackage package(context_, package_path_);
+    EXPECT_EQ(1, package.fileCount());
+    EXPECT_EQ("a", readFile(package, "/a"));
+}
+
+TEST_F(ResourcePackageTest, InvalidPackage) {
+    {
+        dw::File file(context_, package_path_, dw::FileMode::Write);
+        dw::String contents = "this is not a package, but it is long enough to have a header";
+        file.writeData(contents.data(), contents.size());
+    }
+
+    dw::ResourcePackage package(context_, package_path_);
+    EXPECT_FALSE(package.isOpen());
+    EXPECT_FALSE(package.getFile("/a"));
+}
+
+TEST_F(ResourcePackageTest, CorruptEntriesAreRejected) {
+    {
+        dw::ResourcePackageWriter writer(context_);
+        ASSERT_TRUE(writer.open(package_path_));
+        ASSERT_TRUE(writer.add("/a", reinterpret_cast<const dw::byte*>("abc"), 3));
+        ASSERT_TRUE(writer.close());
+    }
+    dw::Vector<dw::byte> contents;
+    {
+        dw::File file(context_, package_path_, dw::FileMode::Read);
+        contents.resize(file.size());
+        file.readData(contents.data(), contents.size());
+    }
+
+    // Overwrite a field of the only TOC entry, which starts at the offset stored in the header.
+    auto write_corrupt_package = [&](dw::usize field_offset, dw::u64 value) {
+        dw::u64 toc_offset;
+        memcpy(&toc_offset, contents.data() + 16, sizeof(toc_offset));
+        auto corrupt = contents;
+        memcpy(corrupt.data() + toc_offset + field_offset, &value, sizeof(value));
+        dw::File file(context_, package_path_, dw::FileMode::Write);
+        file.writeData(corrupt.data(), corrupt.size());
+    };
+
+    // Uncompressed file whose size doesn't match its stored size.
+    write_corrupt_package(24, 1000);
+    EXPECT_FALSE(dw::ResourcePackage(context_, package_path_).isOpen());
+
+    // Offset which overflows when the stored size is added.
+    write_corrupt_package(8, ~dw::u64(0));
+    EXPECT_FALSE(dw::ResourcePackage(context_, package_path_).isOpen());
+}
@@ -0,0 +1,129 @@
+/*
+ * Dawn Engine
+ * Written by David Avedissian (c) 2012-2019 (git@dga.dev)
+ */
+#include "Base.h"
+#include "core/Context.h"
+#include "core/io/File.h"
+#include "core/io/FileSystem.h"
+#include "renderer/ShaderCache.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+
+// Compiles every GLSL shader in a directory to SPIR-V for shipping builds, so that the engine
+// never compiles shaders at startup. Shaders are recognised by their extension (.vs, .gs or .fs),
+// and are cooked to the same relative path in the output directory, which keeps their resource
+// paths unchanged. Shader detects cooked shaders by their contents. Other files are copied, so
+// the output directory can be packed with DwPack in place of the input directory.
+//
+// Usage: DwCompileShaders <input directory> <output directory>
+
+namespace fs = std::filesystem;
+
+namespace {
+void printUsage() {
+    std::cerr << "Usage: DwCompileShaders <input directory> <output directory>" << std::endl;
+}
+
+bool shaderStage(const fs::path& path, gfx::ShaderStage& stage) {
+    auto extension = path.extension();
+    if (extension == ".vs") {
+        stage = gfx::ShaderStage::Vertex;
+    } else if (extension == ".gs") {
+        stage = gfx::ShaderStage::Geometry;
+    } else if (extension == ".fs") {
+        stage = gfx::ShaderStage::Fragment;
+    } else {
+        return false;
+    }
+    return true;
+}
+}  // namespace
+
+int main(int argc, char** argv) {
+    if (argc != 3) {
+        printUsage();
+        return EXIT_FAILURE;
+    }
+    fs::path input_dir = argv[1];
+    fs::path output_dir = argv[2];
+    if (!fs::is_directory(input_dir)) {
+        std::cerr << input_dir << " is not a directory." << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    dw::Context context("", "");
+    context.addModule<dw::Logger>();
+    context.addModule<dw::FileSystem>();
+
+    dw::Vector<fs::path> files;
+    for (auto& entry : fs::recursive_directory_iterator(input_dir)) {
+        if (entry.is_regular_file()) {
+            files.emplace_back(entry.path());
+        }
+    }
+    std::sort(files.begin(), files.end());
+
+    int compiled = 0;
+    int failed = 0;
+    for (auto& file_path : files) {
+        fs::path output_path = output_dir / fs::relative(file_path, input_dir);
+        std::error_code error;
+        fs::create_directories(output_path.parent_path(), error);
+        if (error) {
+            std::cerr << "Unable to create " << output_path.parent_path() << ": "
+                      << error.message() << std::endl;
+            return EXIT_FAILURE;
+        }
+
+        gfx::ShaderStage stage;
+        if (!shaderStage(file_path, stage)) {
+            fs::copy_file(file_path, output_path, fs::copy_options::overwrite_existing, error);
+            if (error) {
+                std::cerr << "Unable to copy " << file_path << ": " << error.message()
+                          << std::endl;
+                return EXIT_FAILURE;
+            }
+            continue;
+        }
+
+        dw::String source;
+        {
+            dw::File file(&context, file_path.string(), dw::FileMode::Read);
+            source.resize(file.size());
+            if (!source.empty()) {
+                file.readData(source.data(), source.size());
+            }
+        }
+        auto shader = dw::compileShader(source, stage);
+        if (!shader) {
+            // Keep going, so that every error is reported at once.
+            std::cerr << file_path.generic_string() << ": " << shader.error() << std::endl;
+            failed++;
+            continue;
+        }
+        auto cooked = dw::cookShader(*shader);
+        {
+            dw::File file(&context);
+            if (!file.open(output_path.string(), dw::FileMode::Write)) {
+                std::cerr << "Unable to create " << output_path << std::endl;
+                return EXIT_FAILURE;
+            }
+            file.writeData(cooked.data(), cooked.size());
+        }
+        std::cout << file_path.generic_string() << " (" << source.size() << " bytes) -> "
+                  << output_path.generic_string() << " (" << cooked.size() << " bytes)"
+                  << std::endl;
+        compiled++;
+    }
+
+    std::cout << "Compiled " << compiled << " shaders";
+    if (failed > 0) {
+        std::cout << ", " << failed << " failed";
+    }
+    std::cout << "." << std::endl;
+    return failed > 0 ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,103 @@
+/*
+ * Dawn Engine
+ * Written by David Avedissian (c) 2012-2019 (git@dga.dev)
+ */
+#include "Base.h"
+#include "core/Context.h"
+#include "core/io/File.h"
+#include "core/io/FileSystem.h"
+#include "renderer/MeshData.h"
+#include "renderer/MeshImporter.h"
+#include "renderer/MeshOptimiser.h"
+
+#include <cstdlib>
+#include <iostream>
+
+// Cooks a source mesh (any format supported by Assimp) into the binary format which Mesh loads in
+// place. The cooked mesh can be given any name, as Mesh detects cooked meshes by their contents.
+//
+// Triangles are reordered for the post-transform vertex cache, and vertices for fetch locality.
+// -lods generates up to that many simplified levels of detail for each submesh, and -cache sets
+// the size of the vertex cache to optimise for.
+//
+// Usage: DwCookMesh [-lods <count>] [-cache <size>] <input mesh> <output mesh>
+
+namespace {
+void printUsage() {
+    std::cerr << "Usage: DwCookMesh [-lods <count>] [-cache <size>] <input mesh> <output mesh>"
+              << std::endl;
+}
+
+void printCacheStats(const char* label, const dw::MeshData& mesh, dw::usize cache_size) {
+    auto stats = dw::analyseVertexCache(dw::viewMeshData(mesh), cache_size);
+    std::cout << label << ": ACMR " << stats.acmr << ", ATVR " << stats.atvr << std::endl;
+}
+}  // namespace
+
+int main(int argc, char** argv) {
+    dw::MeshOptimiseOptions options;
+    dw::Vector<dw::String> positional;
+    for (int i = 1; i < argc; ++i) {
+        dw::String arg = argv[i];
+        if (arg == "-lods" && i + 1 < argc) {
+            options.max_lods = std::strtoul(argv[++i], nullptr, 10);
+        } else if (arg == "-cache" && i + 1 < argc) {
+            options.cache_size = std::strtoul(argv[++i], nullptr, 10);
+        } else {
+            positional.emplace_back(arg);
+        }
+    }
+    if (positional.size() != 2 || options.cache_size == 0) {
+        printUsage();
+        return EXIT_FAILURE;
+    }
+    dw::Path input = positional[0];
+    dw::Path output = positional[1];
+
+    dw::Context context("", "");
+    context.addModule<dw::Logger>();
+    context.addModule<dw::FileSystem>();
+
+    dw::Vector<dw::byte> source;
+    {
+        dw::File file(&context, input, dw::FileMode::Read);
+        source.resize(file.size());
+        if (!source.empty()) {
+            file.readData(source.data(), source.size());
+        }
+    }
+    auto mesh = dw::importMesh(&context, input, source.data(), source.size());
+    if (!mesh) {
+        std::cerr << mesh.error() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    printCacheStats("Before optimisation", *mesh, options.cache_size);
+    dw::optimiseMesh(*mesh, options);
+    printCacheStats("After optimisation", *mesh, options.cache_size);
+    for (dw::usize s = 0; s < mesh->submeshes.size(); ++s) {
+        auto& submesh = mesh->submeshes[s];
+        std::cout << "Submesh " << s << ": " << submesh.index_count / 3 << " triangles";
+        for (dw::usize l = 0; l < submesh.lod_count; ++l) {
+            auto& lod = mesh->lods[submesh.lod_offset + l];
+            std::cout << ", LOD " << l + 1 << " " << lod.index_count / 3 << " triangles (error "
+                      << lod.error << ")";
+        }
+        std::cout << std::endl;
+    }
+
+    auto cooked = dw::cookMesh(*mesh);
+    {
+        dw::File file(&context);
+        if (!file.open(output, dw::FileMode::Write)) {
+            std::cerr << "Unable to create " << output << std::endl;
+            return EXIT_FAILURE;
+        }
+        file.writeData(cooked.data(), cooked.size());
+    }
+    std::cout << "Cooked " << input << " (" << source.size() << " bytes) to " << output << " ("
+              << cooked.size() << " bytes): " << mesh->vertices.size() << " vertices, "
+              << mesh->indices.size() / 3 << " triangles, " << mesh->submeshes.size()
+              << " submeshes, " << mesh->nodes.size() << " nodes" << std::endl;
+    return EXIT_SUCCESS;
+}
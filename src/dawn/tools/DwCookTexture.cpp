@@ -0,0 +1,133 @@
+/*
+ * Dawn Engine
+ * Written by David Avedissian (c) 2012-2019 (git@dga.dev)
+ */
+#include "Base.h"
+#include "core/Context.h"
+#include "core/io/File.h"
+#include "core/io/FileSystem.h"
+#include "renderer/TextureCompression.h"
+#include "renderer/TextureData.h"
+
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+
+// Cooks a source image (any format supported by stb_image) into the binary format which Texture
+// uploads directly. The cooked texture can be given any name, as Texture detects cooked textures
+// by their contents.
+//
+// A full mip chain is generated unless -nomips is given, and each level is compressed with
+// -format (bc7 by default). bc1 is opaque and half the size of bc3 and bc7, bc3 stores alpha
+// separately from colour, and bc7 is the highest quality.
+//
+// Usage: DwCookTexture [-format rgba8|bc1|bc3|bc7] [-nomips] <input image> <output texture>
+
+namespace {
+void printUsage() {
+    std::cerr << "Usage: DwCookTexture [-format rgba8|bc1|bc3|bc7] [-nomips] <input image> "
+                 "<output texture>"
+              << std::endl;
+}
+
+bool parseFormat(const dw::String& name, dw::TextureDataFormat& format) {
+    if (name == "rgba8") {
+        format = dw::TextureDataFormat::RGBA8;
+    } else if (name == "bc1") {
+        format = dw::TextureDataFormat::BC1;
+    } else if (name == "bc3") {
+        format = dw::TextureDataFormat::BC3;
+    } else if (name == "bc7") {
+        format = dw::TextureDataFormat::BC7;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+// Returns the root mean square error of each channel of two RGBA8 levels, averaged over the
+// channels.
+double rootMeanSquareError(const dw::Vector<dw::byte>& a, const dw::Vector<dw::byte>& b) {
+    double sum = 0.0;
+    for (dw::usize i = 0; i < a.size(); ++i) {
+        double d = static_cast<double>(a[i]) - static_cast<double>(b[i]);
+        sum += d * d;
+    }
+    return a.empty() ? 0.0 : std::sqrt(sum / static_cast<double>(a.size()));
+}
+}  // namespace
+
+int main(int argc, char** argv) {
+    dw::TextureDataFormat format = dw::TextureDataFormat::BC7;
+    bool generate_mips = true;
+    dw::Vector<dw::String> positional;
+    for (int i = 1; i < argc; ++i) {
+        dw::String arg = argv[i];
+        if (arg == "-format" && i + 1 < argc) {
+            if (!parseFormat(argv[++i], format)) {
+                printUsage();
+                return EXIT_FAILURE;
+            }
+        } else if (arg == "-nomips") {
+            generate_mips = false;
+        } else {
+            positional.emplace_back(arg);
+        }
+    }
+    if (positional.size() != 2) {
+        printUsage();
+        return EXIT_FAILURE;
+    }
+    dw::Path input = positional[0];
+    dw::Path output = positional[1];
+
+    dw::Context context("", "");
+    context.addModule<dw::Logger>();
+    context.addModule<dw::FileSystem>();
+
+    dw::Vector<dw::byte> source;
+    {
+        dw::File file(&context, input, dw::FileMode::Read);
+        source.resize(file.size());
+        if (!source.empty()) {
+            file.readData(source.data(), source.size());
+        }
+    }
+    auto image = dw::decodeImage(source.data(), source.size());
+    if (!image) {
+        std::cerr << image.error() << std::endl;
+        return EXIT_FAILURE;
+    }
+    if (generate_mips) {
+        dw::generateMipChain(*image);
+    }
+    auto texture = dw::compressTexture(*image, format);
+    if (!texture) {
+        std::cerr << texture.error() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    // Report the error introduced by compression at each level.
+    auto decompressed = dw::decompressTexture(dw::viewTextureData(*texture));
+    if (decompressed) {
+        for (dw::usize level = 0; level < image->mips.size(); ++level) {
+            std::cout << "Mip " << level << ": " << texture->mips[level].size() << " bytes, RMSE "
+                      << rootMeanSquareError(image->mips[level], decompressed->mips[level])
+                      << std::endl;
+        }
+    }
+
+    auto cooked = dw::cookTexture(*texture);
+    {
+        dw::File file(&context);
+        if (!file.open(output, dw::FileMode::Write)) {
+            std::cerr << "Unable to create " << output << std::endl;
+            return EXIT_FAILURE;
+        }
+        file.writeData(cooked.data(), cooked.size());
+    }
+    std::cout << "Cooked " << input << " (" << source.size() << " bytes) to " << output << " ("
+              << cooked.size() << " bytes): " << texture->width << "x" << texture->height << ", "
+              << texture->mips.size() << " mip levels" << std::endl;
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,112 @@
+/*
+ * Dawn Engine
+ * Written by David Avedissian (c) 2012-2019 (git@dga.dev)
+ */
+#include "Base.h"
+#include "core/Context.h"
+#include "core/io/File.h"
+#include "core/io/FileSystem.h"
+#include "resource/ResourcePackage.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+
+// Packs a directory of resources into a resource package. When a resource location is added to
+// the resource cache, a package next to the directory (for example "media/base.dwpk" for
+// "media/base") is used in its place.
+//
+// Usage: DwPack [-align <bytes>] [-compress] <input directory> <output package>
+//
+// The alignment must be a power of two of at least 4, as cooked resources are read in place.
+
+namespace fs = std::filesystem;
+
+namespace {
+void printUsage() {
+    std::cerr << "Usage: DwPack [-align <bytes>] [-compress] <input directory> <output package>"
+              << std::endl;
+}
+}  // namespace
+
+int main(int argc, char** argv) {
+    unsigned long alignment = 16;
+    auto compression = dw::PackageCompression::None;
+    dw::Vector<dw::String> positional;
+    for (int i = 1; i < argc; ++i) {
+        dw::String arg = argv[i];
+        if (arg == "-align" && i + 1 < argc) {
+            alignment = std::strtoul(argv[++i], nullptr, 10);
+        } else if (arg == "-compress") {
+            compression = dw::PackageCompression::LZ4;
+        } else {
+            positional.emplace_back(arg);
+        }
+    }
+    if (positional.size() != 2) {
+        printUsage();
+        return EXIT_FAILURE;
+    }
+    if (alignment < 4 || alignment > 0x80000000ul || (alignment & (alignment - 1)) != 0) {
+        std::cerr << "Alignment " << alignment << " must be a power of two of at least 4."
+                  << std::endl;
+        return EXIT_FAILURE;
+    }
+    fs::path input_dir = positional[0];
+    dw::Path output = positional[1];
+    if (!fs::is_directory(input_dir)) {
+        std::cerr << input_dir << " is not a directory." << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    dw::Context context("", "");
+    context.addModule<dw::Logger>();
+    context.addModule<dw::FileSystem>();
+
+    // Collect the files first, so that the package is the same regardless of directory order.
+    dw::Vector<fs::path> files;
+    for (auto& entry : fs::recursive_directory_iterator(input_dir)) {
+        if (entry.is_regular_file()) {
+            files.emplace_back(entry.path());
+        }
+    }
+    std::sort(files.begin(), files.end());
+
+    dw::ResourcePackageWriter writer(&context);
+    auto open_result = writer.open(output, static_cast<dw::u32>(alignment));
+    if (!open_result) {
+        std::cerr << open_result.error() << std::endl;
+        return EXIT_FAILURE;
+    }
+    for (auto& file_path : files) {
+        dw::ResourcePath path_within_package =
+            "/" + fs::relative(file_path, input_dir).generic_string();
+        dw::Vector<dw::byte> data;
+        {
+            dw::File file(&context);
+            if (!file.open(file_path.string(), dw::FileMode::Read)) {
+                std::cerr << "Unable to read " << file_path << "." << std::endl;
+                return EXIT_FAILURE;
+            }
+            data.resize(file.size());
+            if (!data.empty() && file.readData(data.data(), data.size()) != data.size()) {
+                std::cerr << "Unable to read " << file_path << "." << std::endl;
+                return EXIT_FAILURE;
+            }
+        }
+        auto add_result = writer.add(path_within_package, data.data(), data.size(), compression);
+        if (!add_result) {
+            std::cerr << add_result.error() << std::endl;
+            return EXIT_FAILURE;
+        }
+        std::cout << path_within_package << " (" << data.size() << " bytes)" << std::endl;
+    }
+    auto close_result = writer.close();
+    if (!close_result) {
+        std::cerr << close_result.error() << std::endl;
+        return EXIT_FAILURE;
+    }
+    std::cout << "Wrote " << files.size() << " files to " << output << std::endl;
+    return EXIT_SUCCESS;
+}
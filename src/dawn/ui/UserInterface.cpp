@@ -13,7 +13,7 @@ static_assert(sizeof(ImDrawIdx) == sizeof(dw::u16), "Only 16-bit ImGUI indices a
 
 namespace dw {
 UserInterface::UserInterface(Context* ctx, EventSystem* event_system)
-    : Object(ctx), event_system_(event_system), mouse_wheel_(0.0f) {
+    : Object(ctx), event_system_(event_system), next_overlay_id_(1), mouse_wheel_(0.0f) {
     logic_context_ = ImGui::CreateContext();
     renderer_context_ = ImGui::CreateContext();
 
@@ -42,9 +42,13 @@ UserInterface::UserInterface(Context* ctx, EventSystem* event_system)
         unsigned char* pixels;
         int width, height;
         io.Fonts->GetTexDataAsRGBA32(&pixels, &width, &height);
-        gfx::TextureHandle handle = rhi_->createTexture2D(
-            static_cast<u16>(width), static_cast<u16>(height), gfx::TextureFormat::RGBA8,
-            gfx::Memory(pixels, width * height * 4));
+        gfx::TextureHandle handle;
+        {
+            LockGuard<RecursiveMutex> lock(module<Renderer>()->resourceMutex());
+            handle = rhi_->createTexture2D(static_cast<u16>(width), static_cast<u16>(height),
+                                           gfx::TextureFormat::RGBA8,
+                                           gfx::Memory(pixels, width * height * 4));
+        }
         io.Fonts->TexID = reinterpret_cast<void*>(static_cast<uintptr>(handle.internal()));
 
         // Set up key map.
@@ -145,11 +149,25 @@ void UserInterface::postRender() const {
     ImGui::Render();
 }
 
+UserInterface::OverlayId UserInterface::addOverlay(Function<void()> draw) {
+    OverlayId id = next_overlay_id_++;
+    overlays_.emplace(id, std::move(draw));
+    return id;
+}
+
+void UserInterface::removeOverlay(OverlayId id) {
+    overlays_.erase(id);
+}
+
 void UserInterface::update(float dt) {
     forAllContexts([dt](ImGuiIO& io) { io.DeltaTime = dt; });
+    for (auto& overlay : overlays_) {
+        overlay.second();
+    }
 }
 
 void UserInterface::render() {
+    assert(module<Renderer>()->isMainThread());
     ImGui::SetCurrentContext(logic_context_);
     drawGUI(ImGui::GetDrawData(), *logic_io_);
     ImGui::SetCurrentContext(renderer_context_);
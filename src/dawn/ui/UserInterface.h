@@ -13,9 +13,17 @@ class DW_API UserInterface : public Object {
 public:
     DW_OBJECT(UserInterface);
 
+    using OverlayId = u32;
+
     UserInterface(Context* ctx, EventSystem* event_system);
     ~UserInterface();
 
+    /// Adds a function which draws ImGui windows every update, such as debug information. Returns
+    /// a non-zero ID which removes it again. Overlays aren't drawn in headless sessions, as their
+    /// user interface isn't updated.
+    OverlayId addOverlay(Function<void()> draw);
+    void removeOverlay(OverlayId id);
+
     void preUpdate() const;
     void postUpdate() const;
     void preRender() const;
@@ -36,6 +44,10 @@ private:
     SharedPtr<Program> program_;
     gfx::VertexDecl vertex_decl_;
 
+    // Overlays, drawn in the order they were added.
+    Map<OverlayId, Function<void()>> overlays_;
+    OverlayId next_overlay_id_;
+
     // Input.
     float mouse_wheel_;
     bool mouse_pressed_[MouseButton::Count];
@@ -148,6 +148,19 @@ void CShipEngines::calculateMaxMovementForce(Vec3& pos_force, Vec3& neg_force) {
     }
 }
 
+Vec3 CShipEngines::calculateMovementForce(const Vec3& power) const {
+    Vec3 total_force{0.0f, 0.0f, 0.0f};
+    for (size_t i = 0; i < movement_engines_.size(); ++i) {
+        bool forwards = power[i] > 0.0f;
+        for (auto& engine : movement_engines_[i]) {
+            if (engine.isForwards() == forwards) {
+                total_force += engine.force() * abs(power[i]);
+            }
+        }
+    }
+    return total_force;
+}
+
 Vec3 CShipEngines::fireMovementEngines(const Vec3& power) {
     Vec3 total_force{0.0f, 0.0f, 0.0f};
     for (size_t i = 0; i < movement_engines_.size(); ++i) {
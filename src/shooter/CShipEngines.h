@@ -60,6 +60,7 @@ public:
     // Movement engines.
     void calculateMaxMovementForce(Vec3& pos_force, Vec3& neg_force);
     // power is proportional to max force.
+    Vec3 calculateMovementForce(const Vec3& power) const;
     Vec3 fireMovementEngines(const Vec3& power);
 
     // Rotational engines.
@@ -15,8 +15,63 @@
 #include "ShipFlightComputer.h"
 #include "ShooterGameMode.h"
 
+#include <limits>
+
 using namespace dw;
 
+namespace {
+// Parses a numeric command line argument. Returns nothing if it isn't a number.
+Option<float> parseFloat(const String& value) {
+    try {
+        return std::stof(value);
+    } catch (const std::exception&) {
+        return {};
+    }
+}
+
+Option<int> parseInt(const String& value) {
+    try {
+        return std::stoi(value);
+    } catch (const std::exception&) {
+        return {};
+    }
+}
+
+// Reads simulated network conditions from the command line. Times are in milliseconds, and
+// probabilities in percent. Invalid values are ignored with a warning.
+Option<NetworkConditions> parseNetworkConditions(Logger& logger, const CommandLine& cmdline) {
+    auto argument = [&](const String& name, float& value, float scale, float max) -> bool {
+        auto it = cmdline.arguments.find(name);
+        if (it == cmdline.arguments.end()) {
+            return false;
+        }
+        auto parsed = parseFloat(it->second);
+        if (!parsed || *parsed < 0.0f || *parsed > max) {
+            logger.warn("Invalid value for {}: {}. Ignoring.", name, it->second);
+            return false;
+        }
+        value = *parsed * scale;
+        return true;
+    };
+    const float no_limit = std::numeric_limits<float>::max();
+    NetworkConditions conditions;
+    float bandwidth = 0.0f;
+    bool simulated = false;
+    simulated |= argument("-net_latency", conditions.latency, 0.001f, no_limit);
+    simulated |= argument("-net_jitter", conditions.jitter, 0.001f, no_limit);
+    simulated |= argument("-net_loss", conditions.packet_loss, 0.01f, 100.0f);
+    simulated |= argument("-net_duplicate", conditions.duplicate_chance, 0.01f, 100.0f);
+    simulated |= argument("-net_reorder", conditions.reorder_chance, 0.01f, 100.0f);
+    simulated |= argument("-net_bandwidth", bandwidth, 1.0f,
+                          static_cast<float>(std::numeric_limits<u32>::max()));
+    conditions.bandwidth = static_cast<u32>(bandwidth);
+    if (!simulated) {
+        return {};
+    }
+    return conditions;
+}
+}  // namespace
+
 class ShooterGameSession : public GameSession {
 public:
     DW_OBJECT(ShooterGameSession);
@@ -36,6 +91,13 @@ public:
                                                                  net_instance_.get(), frame);
         if (net_instance_) {
             net_instance_->setEntityPipeline(entity_pipeline);
+
+            // Ships are more important to keep up to date than projectiles, which move linearly.
+            net_instance_->replicationPriority().setTypeWeight(Hash("Ship"), 2.0f);
+
+            if (gsi.params.count("net_stats") > 0) {
+                net_instance_->setStatsOverlayVisible(true);
+            }
         }
         scene_manager_->addSystem<SShipEngines>();
         scene_manager_->addSystem<SProjectile>(
@@ -57,6 +119,9 @@ public:
     }
 
     ~ShooterGameSession() override {
+        if (net_instance_ && gsi_.params.count("net_stats") > 0) {
+            log().info("Network stats: {}", net_instance_->stats().toJson().dump());
+        }
         if (!net_instance_ || net_instance_->netMode() == NetMode::Client) {
             module<Input>()->unregisterEventSystem(event_system_.get());
         }
@@ -64,8 +129,9 @@ public:
 
     void update(float dt) override {
         GameSession::update(dt);
-
-        module<Renderer>()->rhi()->setViewClear(0, {0.0f, 0.0f, 0.0f, 1.0f});
+        if (gsi_.headless) {
+            return;
+        }
 
         // Display FPS information.
         ImGui::SetNextWindowPos({10, 10});
@@ -80,6 +146,13 @@ public:
         ImGui::Text("Frame: %.4f ms", dt);
         ImGui::End();
     }
+
+    void render(float dt, float interpolation) override {
+        // Set on the main thread, as sessions may be updated on worker threads.
+        module<Renderer>()->rhi()->setViewClear(0, {0.0f, 0.0f, 0.0f, 1.0f});
+
+        GameSession::render(dt, interpolation);
+    }
 };
 
 class Shooter : public App {
@@ -106,7 +179,12 @@ public:
             server_session.headless = true;
             GameSessionInfo client_session;
             client_session.start_info =
-                GameSessionInfo::JoinNetGame{"127.0.0.1", port, NetTransport::InProcess};
+                GameSessionInfo::JoinNetGame{"127.0.0.1", port, NetTransport::InProcess,
+                                             parseNetworkConditions(log(), cmdline)};
+            if (cmdline.flags.find("-net_stats") != cmdline.flags.end()) {
+                server_session.params["net_stats"] = "1";
+                client_session.params["net_stats"] = "1";
+            }
 
             engine_->addSession(makeUnique<ShooterGameSession>(context(), server_session));
             engine_->addSession(makeUnique<ShooterGameSession>(context(), client_session));
@@ -114,13 +192,35 @@ public:
             // Add game session.
             GameSessionInfo gsi;
             auto port_arg = cmdline.arguments.find("-p");
-            u16 port = port_arg != cmdline.arguments.end() ? std::stoi(port_arg->second) : 40000;
+            u16 port = 40000;
+            if (port_arg != cmdline.arguments.end()) {
+                auto parsed_port = parseInt(port_arg->second);
+                if (parsed_port && *parsed_port > 0 && *parsed_port <= 65535) {
+                    port = static_cast<u16>(*parsed_port);
+                } else {
+                    log().warn("Invalid port {}. Using {} instead.", port_arg->second, port);
+                }
+            }
             if (cmdline.flags.find("-host") != cmdline.flags.end()) {
-                gsi.start_info = GameSessionInfo::CreateNetGame{"127.0.0.1", port, 32, "TestScene"};
+                GameSessionInfo::CreateNetGame info{"127.0.0.1", port, 32, "TestScene"};
+                info.network_thread = cmdline.flags.find("-net_thread") != cmdline.flags.end();
+                auto record_arg = cmdline.arguments.find("-record");
+                if (record_arg != cmdline.arguments.end()) {
+                    info.record_path = record_arg->second;
+                }
+                gsi.start_info = info;
+            } else if (cmdline.arguments.find("-replay") != cmdline.arguments.end()) {
+                gsi.start_info =
+                    GameSessionInfo::PlaybackNetGame{cmdline.arguments.at("-replay")};
             } else if (cmdline.arguments.find("-join") != cmdline.arguments.end()) {
-                gsi.start_info = GameSessionInfo::JoinNetGame{cmdline.arguments.at("-join"), port};
+                gsi.start_info = GameSessionInfo::JoinNetGame{
+                    cmdline.arguments.at("-join"), port, NetTransport::ReliableUDP,
+                    parseNetworkConditions(log(), cmdline)};
             }
             gsi.headless = cmdline.flags.find("-headless") != cmdline.flags.end();
+            if (cmdline.flags.find("-net_stats") != cmdline.flags.end()) {
+                gsi.params["net_stats"] = "1";
+            }
             engine_->addSession(makeUnique<ShooterGameSession>(context(), gsi));
         }
     }
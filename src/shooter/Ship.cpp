@@ -13,12 +13,21 @@
 
 using namespace dw;
 
+namespace {
+const float ship_mass = 10.0f;
+const btVector3 ship_half_extents{10.0f, 10.0f, 10.0f};
+
+// How far the predicted state can drift from the server before it's corrected.
+const float max_position_error = 0.5f;
+const float min_orientation_dot = 0.9999f;
+}  // namespace
+
 Ship::Ship(Context* ctx, NetInstance* net, SceneManager* scene_manager, Frame* frame)
     : Ship(ctx, net, scene_manager, frame, NetRole::Authority) {
 }
 
 Ship::Ship(Context* ctx, NetInstance* net, SceneManager* scene_manager, Frame* frame, NetRole role)
-    : Object(ctx), ship_entity_(nullptr), rb_(nullptr) {
+    : Object(ctx), ship_entity_(nullptr), rb_(nullptr), last_reconciled_sequence_(0) {
     auto rc = module<ResourceCache>();
     assert(rc);
 
@@ -85,16 +94,30 @@ Ship::Ship(Context* ctx, NetInstance* net, SceneManager* scene_manager, Frame* f
             net, RepLayout::build<CNetTransform, CShipEngines, CShipControls>());
     }
 
+    // Calculate mass properties, shared by the physics simulation and client side prediction.
+    auto shape = makeShared<btBoxShape>(ship_half_extents);
+    btVector3 local_inertia;
+    shape->calculateLocalInertia(ship_mass, local_inertia);
+    inv_mass_ = 1.0f / ship_mass;
+    inv_inertia_ = Vec3{1.0f / local_inertia.x(), 1.0f / local_inertia.y(), 1.0f / local_inertia.z()};
+
     // Initialise server-side details.
     if (role >= NetRole::Authority) {
-        ship_entity_->addComponent<CRigidBody>(
-            scene_manager->physicsScene(), 10.0f,
-            makeShared<btBoxShape>(btVector3{10.0f, 10.0f, 10.0f}));
+        ship_entity_->addComponent<CRigidBody>(scene_manager->physicsScene(), ship_mass, shape);
         rb_ = ship_entity_->component<CRigidBody>()->_rigidBody();
-        ship_entity_->addComponent<ShipFlightComputer>(this);
+        ship_entity_->addComponent<ShipFlightComputer>(this, inv_mass_, inv_inertia_);
+    }
+
+    // The controlling client predicts the motion of its own ship.
+    if (role == NetRole::AuthoritativeProxy) {
+        predicted_flight_computer_ = makeUnique<ShipFlightComputer>(this, inv_mass_, inv_inertia_);
+        ship_entity_->component<CNetTransform>()->locally_predicted = true;
     }
 }
 
+Ship::~Ship() {
+}
+
 void Ship::update(float dt) {
     auto input = module<Input>();
 
@@ -115,13 +138,6 @@ void Ship::update(float dt) {
         float z_movement = static_cast<float>(input->isKeyDown(Key::S)) -
                            static_cast<float>(input->isKeyDown(Key::W));
         Vec3 target_linear_velocity = Vec3{x_movement, y_movement, z_movement} * 100.0f;
-        if (!controls.target_linear_velocity.BitEquals(target_linear_velocity)) {
-            // TODO. Short circuit RPC call if no net data.
-            if (net_data) {
-                controls.setLinearVelocity(target_linear_velocity);
-            }
-            controls.target_linear_velocity = target_linear_velocity;
-        }
 
         // Control rotational thrusters.
         float pitch_direction = static_cast<float>(input->isKeyDown(Key::Up)) -
@@ -131,21 +147,24 @@ void Ship::update(float dt) {
         float roll_direction = static_cast<float>(input->isKeyDown(Key::Q)) -
                                static_cast<float>(input->isKeyDown(Key::E));
         Vec3 target_angular_velocity = Vec3{pitch_direction, yaw_direction, roll_direction} * 1.2f;
-        if (!controls.target_angular_velocity.BitEquals(target_angular_velocity)) {
-            // TODO. Short circuit RPC call if no net data.
-            if (net_data) {
-                controls.setAngularVelocity(target_angular_velocity);
-            }
-            controls.target_angular_velocity = target_angular_velocity;
-        }
 
         // Control weapon.
         bool is_firing_weapon =
             input->isMouseButtonDown(MouseButton::Left) || input->isKeyDown(Key::LeftCtrl);
-        if (controls.firing_weapon != is_firing_weapon) {
-            if (net_data) {
-                controls.toggleWeapon(is_firing_weapon);
-            }
+
+        if (net_data) {
+            // Send this ticks input to the server, and predict its effect locally.
+            ShipInput ship_input;
+            ship_input.sequence = prediction_.nextSequence();
+            ship_input.dt = dt;
+            ship_input.target_linear_velocity = target_linear_velocity;
+            ship_input.target_angular_velocity = target_angular_velocity;
+            ship_input.firing_weapon = is_firing_weapon;
+            controls.sendInput(ship_input);
+            updatePrediction(ship_input, dt);
+        } else {
+            controls.target_linear_velocity = target_linear_velocity;
+            controls.target_angular_velocity = target_angular_velocity;
             controls.firing_weapon = is_firing_weapon;
         }
     }
@@ -156,6 +175,25 @@ void Ship::update(float dt) {
         // Handle authoritative server.
         //=============================
 
+        // Apply every input received from the controlling client since the last tick, weighted
+        // by the length of the client tick each was predicted over. This keeps the server in step
+        // with the clients prediction when inputs arrive in bursts, or the client ticks faster
+        // than the server. If no inputs arrived, the previous controls are kept.
+        if (!controls.pending_inputs.empty()) {
+            ShipInput ship_input = controls.pending_inputs.front();
+            controls.pending_inputs.pop_front();
+            for (auto& next_input : controls.pending_inputs) {
+                mergeShipInput(ship_input, next_input);
+            }
+            controls.pending_inputs.clear();
+            controls.target_linear_velocity = ship_input.target_linear_velocity;
+            controls.target_angular_velocity = ship_input.target_angular_velocity;
+            controls.firing_weapon = ship_input.firing_weapon;
+            controls.last_input_sequence = ship_input.sequence;
+        }
+        ship_entity_->component<CNetTransform>()->transform_state.input_sequence =
+            controls.last_input_sequence;
+
         // Fire weapon.
         ship_entity_->component<CWeapon>()->firing = controls.firing_weapon;
 
@@ -164,7 +202,11 @@ void Ship::update(float dt) {
             controls.target_linear_velocity;
         ship_entity_->component<ShipFlightComputer>()->target_angular_velocity =
             controls.target_angular_velocity;
+    }
 
+    // Display stats of the locally controlled ship. Servers don't draw them, as they may be
+    // headless.
+    if (!net_data || net_data->role() == NetRole::AuthoritativeProxy) {
         // Calculate angular acceleration.
         /*Vec3 angular_acc = Vec3(
                 rb_->getInvInertiaTensorWorld() *
@@ -172,7 +214,6 @@ void Ship::update(float dt) {
            roll_direction}));*/
         Vec3 angular_vel = angularVelocity();
 
-        // Display stats.
         ImGui::SetNextWindowPos({10, 50});
         ImGui::SetNextWindowSize({300, 60});
         if (!ImGui::Begin("Ship", nullptr,
@@ -216,3 +257,61 @@ Vec3 Ship::localVelocity() const {
 Entity* Ship::entity() const {
     return ship_entity_;
 }
+
+void Ship::updatePrediction(const ShipInput& input, float dt) {
+    auto step = [this](const ShipMotionState& state, const ShipInput& step_input, float step_dt) {
+        return predict(state, step_input, step_dt);
+    };
+
+    // Reconcile with the latest state from the server.
+    const NetTransformState& server_state =
+        ship_entity_->component<CNetTransform>()->transform_state;
+    ShipMotionState authoritative_state{server_state.position, server_state.orientation,
+                                        server_state.velocity, server_state.angular_velocity};
+    if (!predicted_state_) {
+        predicted_state_ = authoritative_state;
+    } else if (isNewerSequence(server_state.input_sequence, last_reconciled_sequence_)) {
+        last_reconciled_sequence_ = server_state.input_sequence;
+        auto predicted_state = prediction_.acknowledge(server_state.input_sequence);
+        if (!predicted_state ||
+            predicted_state->position.Distance(authoritative_state.position) >
+                max_position_error ||
+            abs(predicted_state->orientation.Dot(authoritative_state.orientation)) <
+                min_orientation_dot) {
+            // Rewind to the server state, then replay inputs which the server hasn't applied yet.
+            predicted_state_ = prediction_.replay(authoritative_state, step);
+        }
+    }
+
+    // Predict this tick.
+    predicted_state_ = predict(*predicted_state_, input, dt);
+    prediction_.push(dt, input, *predicted_state_);
+
+    auto* transform = ship_entity_->transform();
+    transform->position = predicted_state_->position;
+    transform->orientation = predicted_state_->orientation;
+}
+
+ShipMotionState Ship::predict(const ShipMotionState& state, const ShipInput& input, float dt) {
+    Quat inv_rotation = state.orientation;
+    inv_rotation.InverseAndNormalize();
+
+    // Run the flight computer on the predicted state.
+    Vec3 movement_power, angular_power;
+    predicted_flight_computer_->target_linear_velocity = input.target_linear_velocity;
+    predicted_flight_computer_->target_angular_velocity = input.target_angular_velocity;
+    predicted_flight_computer_->calculatePower(inv_rotation * state.velocity,
+                                               inv_rotation * state.angular_velocity,
+                                               movement_power, angular_power);
+
+    // Integrate the resulting forces in the same way as the physics simulation.
+    auto* engines = ship_entity_->component<CShipEngines>();
+    Vec3 force = state.orientation * engines->calculateMovementForce(movement_power);
+    Vec3 torque = state.orientation * engines->calculateRotationalTorque(angular_power);
+    ShipMotionState next = state;
+    next.velocity += force * inv_mass_ * dt;
+    next.angular_velocity += inv_inertia_.Mul(torque) * dt;
+    next.position += next.velocity * dt;
+    next.orientation = integrateOrientation(state.orientation, next.angular_velocity, dt);
+    return next;
+}
@@ -11,12 +11,58 @@
 #include "renderer/Mesh.h"
 #include "core/math/Defs.h"
 #include "core/Delegate.h"
+#include "net/PredictionBuffer.h"
 #include "CShipEngines.h"
 
 using namespace dw;
 
 class Ship;
 
+// A single tick of input from the client controlling a ship.
+struct ShipInput {
+    InputSequence sequence = 0;
+    float dt = 0.0f;  // Length of the clients tick which the input was applied for.
+    Vec3 target_linear_velocity = Vec3::zero;
+    Vec3 target_angular_velocity = Vec3::zero;
+    bool firing_weapon = false;
+};
+
+namespace dw {
+namespace stream {
+template <> inline ShipInput read<ShipInput>(InputStream& s) {
+    ShipInput input;
+    s.read(input.sequence);
+    s.read(input.dt);
+    s.read(input.target_linear_velocity);
+    s.read(input.target_angular_velocity);
+    s.read(input.firing_weapon);
+    return input;
+}
+
+template <> inline void write<ShipInput>(OutputStream& s, const ShipInput& input) {
+    s.write(input.sequence);
+    s.write(input.dt);
+    s.write(input.target_linear_velocity);
+    s.write(input.target_angular_velocity);
+    s.write(input.firing_weapon);
+}
+}  // namespace stream
+}  // namespace dw
+
+// Combines an input into the one before it, weighting each by the length of time it was applied
+// for. The result covers both ticks, and has the sequence number of the later input.
+inline void mergeShipInput(ShipInput& merged, const ShipInput& input) {
+    float total_dt = merged.dt + input.dt;
+    float t = total_dt > 0.0f ? input.dt / total_dt : 1.0f;
+    merged.sequence = input.sequence;
+    merged.dt = total_dt;
+    merged.target_linear_velocity +=
+        (input.target_linear_velocity - merged.target_linear_velocity) * t;
+    merged.target_angular_velocity +=
+        (input.target_angular_velocity - merged.target_angular_velocity) * t;
+    merged.firing_weapon = merged.firing_weapon || input.firing_weapon;
+}
+
 class CShipControls : public Component {
 public:
     WeakPtr<Ship> ship;
@@ -25,30 +71,47 @@ public:
     Vec3 target_angular_velocity;
     bool firing_weapon;
 
-    void setLinearVelocityImpl(const Vec3& v) {
-        target_linear_velocity = v;
-    }
-    void setAngularVelocityImpl(const Vec3& v) {
-        target_angular_velocity = v;
-    }
-    void toggleWeaponImpl(const bool& toggle) {
-        firing_weapon = toggle;
+    // On the server, inputs received from the controlling client which haven't been applied yet,
+    // and the sequence number of the last input which was.
+    Deque<ShipInput> pending_inputs;
+    InputSequence last_input_sequence = 0;
+
+    // Maximum number of inputs which are queued between server ticks. Any more are merged into
+    // the newest queued input, as the client has already predicted them.
+    static const usize max_pending_inputs = 16;
+
+    void sendInputImpl(const ShipInput& input) {
+        // Ignore inputs which arrive late.
+        InputSequence newest = pending_inputs.empty() ? last_input_sequence
+                                                      : pending_inputs.back().sequence;
+        if (!isNewerSequence(input.sequence, newest)) {
+            return;
+        }
+        if (pending_inputs.size() >= max_pending_inputs) {
+            mergeShipInput(pending_inputs.back(), input);
+        } else {
+            pending_inputs.emplace_back(input);
+        }
     }
 
-    ClientRpc<Vec3> setLinearVelocity = &CShipControls::setLinearVelocityImpl;
-    ClientRpc<Vec3> setAngularVelocity = &CShipControls::setAngularVelocityImpl;
-    ClientRpc<bool> toggleWeapon = &CShipControls::toggleWeaponImpl;
+    // Inputs are sent every tick, so a lost input is better dropped than resent.
+    ClientRpc<ShipInput> sendInput{&CShipControls::sendInputImpl, RpcChannel::UnreliableSequenced};
 
     static RepLayout repLayout() {
-        return {{},
-                {BindRpc<CShipControls, RpcType::Client, Vec3>(&CShipControls::setLinearVelocity),
-                 BindRpc<CShipControls, RpcType::Client, Vec3>(&CShipControls::setAngularVelocity),
-                 BindRpc<CShipControls, RpcType::Client, bool>(&CShipControls::toggleWeapon)}};
+        return {{}, {BindRpc<CShipControls, RpcType::Client, ShipInput>(&CShipControls::sendInput)}};
     }
 };
 
 class ShipFlightComputer;
 
+// The motion of a ship, as predicted by the controlling client.
+struct ShipMotionState {
+    Vec3 position;
+    Quat orientation;
+    Vec3 velocity;
+    Vec3 angular_velocity;
+};
+
 class Ship : public Object {
 public:
     DW_OBJECT(Ship);
@@ -56,7 +119,7 @@ public:
     Ship(Context* ctx, NetInstance* net, SceneManager* scene_manager, Frame* frame);
     Ship(Context* ctx, NetInstance* net, SceneManager* scene_manager, Frame* frame,
          NetRole role);
-    ~Ship() = default;
+    ~Ship();
 
     void update(float dt);
 
@@ -73,4 +136,15 @@ public:
 private:
     Entity* ship_entity_;
     btRigidBody* rb_;
+    float inv_mass_;
+    Vec3 inv_inertia_;
+
+    // Client side prediction, used when this ship is controlled by the local client.
+    UniquePtr<ShipFlightComputer> predicted_flight_computer_;
+    PredictionBuffer<ShipInput, ShipMotionState> prediction_;
+    Option<ShipMotionState> predicted_state_;
+    InputSequence last_reconciled_sequence_;
+
+    void updatePrediction(const ShipInput& input, float dt);
+    ShipMotionState predict(const ShipMotionState& state, const ShipInput& input, float dt);
 };
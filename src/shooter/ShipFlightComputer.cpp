@@ -11,21 +11,19 @@
 
 using namespace dw;
 
-ShipFlightComputer::ShipFlightComputer(Ship* ship)
+ShipFlightComputer::ShipFlightComputer(Ship* ship, float inv_mass, const Vec3& inv_inertia)
     : target_linear_velocity{Vec3::zero}, target_angular_velocity{Vec3::zero}, ship_{ship} {
     auto engines = ship->entity()->component<CShipEngines>();
-    auto rb = ship->entity()->component<CRigidBody>();
 
     Vec3 pos_force, neg_force;
     engines->calculateMaxMovementForce(pos_force, neg_force);
-    ship_acceleration_forwards_ = rb->_rigidBody()->getInvMass() * pos_force;
-    ship_acceleration_backwards_ = rb->_rigidBody()->getInvMass() * neg_force;
+    ship_acceleration_forwards_ = inv_mass * pos_force;
+    ship_acceleration_backwards_ = inv_mass * neg_force;
 
     Vec3 pos_torque, neg_torque;
     engines->calculateMaxRotationalTorque(pos_torque, neg_torque);
-    ship_angular_acceleration_forwards_ = rb->_rigidBody()->getInvInertiaTensorWorld() * pos_torque;
-    ship_angular_acceleration_backwards_ =
-        rb->_rigidBody()->getInvInertiaTensorWorld() * neg_torque;
+    ship_angular_acceleration_forwards_ = inv_inertia.Mul(pos_torque);
+    ship_angular_acceleration_backwards_ = inv_inertia.Mul(neg_torque);
 
     /*
     log().info("Max positive: {} - max negative: {}", ship_acceleration_forwards_.ToString(),
@@ -36,52 +34,63 @@ ShipFlightComputer::ShipFlightComputer(Ship* ship)
     */
 }
 
-void ShipFlightComputerSystem::process(float dt) {
-    entityView().each([](auto entity, auto& fc) {
-        // Define reducer method.
-        auto vec_reducer = [](const Vec3& source, const Vec3& target, const Vec3& max_pos_speed,
-                              const Vec3& max_neg_speed) -> Vec3 {
-            auto reducer = [](float source, float target, float max_pos_speed,
-                              float max_neg_speed) -> float {
-                float diff = target - source;
-                if (diff > 0.0f) {
-                    // Motion is positive, capped at max_pos_speed.
-                    return min(diff, max_pos_speed);
-                } else if (diff < 0.0f) {
-                    // Motion is negative, capped at max_neg_speed.
-                    return -min(-diff, -max_neg_speed);
-                }
-                return 0.0f;
-            };
-            return Vec3{reducer(source.x, target.x, max_pos_speed.x, max_neg_speed.x),
-                        reducer(source.y, target.y, max_pos_speed.y, max_neg_speed.y),
-                        reducer(source.z, target.z, max_pos_speed.z, max_neg_speed.z)};
+void ShipFlightComputer::calculatePower(const Vec3& local_velocity,
+                                        const Vec3& local_angular_velocity, Vec3& movement_power,
+                                        Vec3& angular_power) const {
+    // Define reducer method.
+    auto vec_reducer = [](const Vec3& source, const Vec3& target, const Vec3& max_pos_speed,
+                          const Vec3& max_neg_speed) -> Vec3 {
+        auto reducer = [](float source, float target, float max_pos_speed,
+                          float max_neg_speed) -> float {
+            float diff = target - source;
+            if (diff > 0.0f) {
+                // Motion is positive, capped at max_pos_speed.
+                return min(diff, max_pos_speed);
+            } else if (diff < 0.0f) {
+                // Motion is negative, capped at max_neg_speed.
+                return -min(-diff, -max_neg_speed);
+            }
+            return 0.0f;
         };
+        return Vec3{reducer(source.x, target.x, max_pos_speed.x, max_neg_speed.x),
+                    reducer(source.y, target.y, max_pos_speed.y, max_neg_speed.y),
+                    reducer(source.z, target.z, max_pos_speed.z, max_neg_speed.z)};
+    };
 
-        // Calculate engine power to apply.
-        float timestep = 1.0f / 60.0f;
-        Vec3 movement_acceleration =
-            vec_reducer(fc.ship_->localVelocity(), fc.target_linear_velocity,
-                        fc.ship_acceleration_forwards_ * timestep,
-                        fc.ship_acceleration_backwards_ * timestep) /
-            timestep;
-        Vec3 rotational_acceleration =
-            vec_reducer(fc.ship_->angularVelocity(), fc.target_angular_velocity,
-                        fc.ship_angular_acceleration_forwards_ * timestep,
-                        fc.ship_angular_acceleration_backwards_ * timestep) /
-            timestep;
+    // Calculate engine power to apply.
+    float timestep = 1.0f / 60.0f;
+    Vec3 movement_acceleration =
+        vec_reducer(local_velocity, target_linear_velocity, ship_acceleration_forwards_ * timestep,
+                    ship_acceleration_backwards_ * timestep) /
+        timestep;
+    Vec3 rotational_acceleration =
+        vec_reducer(local_angular_velocity, target_angular_velocity,
+                    ship_angular_acceleration_forwards_ * timestep,
+                    ship_angular_acceleration_backwards_ * timestep) /
+        timestep;
 
-        // Apply.
-        Vec3 movement_power{CShipEngines::convertToPower(movement_acceleration,
-                                                         fc.ship_acceleration_forwards_,
-                                                         fc.ship_acceleration_backwards_)};
-        if (movement_acceleration.Length() > 0.01f) {
+    movement_power = Vec3::zero;
+    if (movement_acceleration.Length() > 0.01f) {
+        movement_power = CShipEngines::convertToPower(
+            movement_acceleration, ship_acceleration_forwards_, ship_acceleration_backwards_);
+    }
+    angular_power = Vec3::zero;
+    if (rotational_acceleration.Length() > 0.01f) {
+        angular_power = CShipEngines::convertToPower(rotational_acceleration,
+                                                     ship_angular_acceleration_forwards_,
+                                                     ship_angular_acceleration_backwards_);
+    }
+}
+
+void ShipFlightComputerSystem::process(float) {
+    entityView().each([](auto, auto& fc) {
+        Vec3 movement_power, angular_power;
+        fc.calculatePower(fc.ship_->localVelocity(), fc.ship_->angularVelocity(), movement_power,
+                          angular_power);
+        if (movement_power.LengthSq() > 0.0f) {
             fc.ship_->fireMovementThrusters(movement_power);
         }
-        Vec3 angular_power{CShipEngines::convertToPower(rotational_acceleration,
-                                                        fc.ship_angular_acceleration_forwards_,
-                                                        fc.ship_angular_acceleration_backwards_)};
-        if (rotational_acceleration.Length() > 0.01f) {
+        if (angular_power.LengthSq() > 0.0f) {
             fc.ship_->fireRotationalThrusters(angular_power);
         }
 
@@ -10,11 +10,16 @@ class Ship;
 
 class ShipFlightComputer : public Component {
 public:
-    explicit ShipFlightComputer(Ship* ship);
+    ShipFlightComputer(Ship* ship, float inv_mass, const Vec3& inv_inertia);
 
     Vec3 target_linear_velocity;
     Vec3 target_angular_velocity;
 
+    // Calculates the engine power needed to move towards the target velocities over a single
+    // physics step, given the ships current local velocities. Power is zero if no thrust is needed.
+    void calculatePower(const Vec3& local_velocity, const Vec3& local_angular_velocity,
+                        Vec3& movement_power, Vec3& angular_power) const;
+
 private:
     Ship* ship_;
 